@@ -69,6 +69,8 @@ namespace audioutil
         "No crappyrights, all wrongs reversed! :3";
 
     const int   CAudioUtil::MaxNbLoops           = 1200;
+    const int   CAudioUtil::MinResampleRate      = 4000;
+    const int   CAudioUtil::MaxResampleRate      = 192000;
 
 
 //------------------------------------------------
@@ -328,6 +330,16 @@ namespace audioutil
             std::bind( &CAudioUtil::ParseOptionNoConvertSamples, &GetInstance(), placeholders::_1 ),
         },
 
+        //smplrate
+        {
+            "smplrate",
+            1,
+            "Resamples the samples converted to pcm16 to the specified sample rate in hertz, when exporting a bank's samples, "
+            "or a soundfont with baked samples. Loop points are adjusted to match.",
+            "-smplrate 44100",
+            std::bind( &CAudioUtil::ParseOptionResampleRate, &GetInstance(), placeholders::_1 ),
+        },
+
         //match blob scanned containers by internal name
         {
             "nmatchoff",
@@ -381,6 +393,7 @@ namespace audioutil
         m_bUseLFOFx       = true;
         m_bMakeCvinfo     = false;
         m_bConvertSamples = true;
+        m_resamplerate    = -1;
         m_bmatchbyname    = true;
         m_nbloops         = 0;
         m_outtype         = eOutputType::SF2;
@@ -738,6 +751,21 @@ namespace audioutil
         return true;
     }
 
+    bool CAudioUtil::ParseOptionResampleRate( const std::vector<std::string> & optdata )
+    {
+        stringstream conv;
+        conv << optdata[1];
+        conv >> m_resamplerate;
+
+        if( !conv.fail() && m_resamplerate >= MinResampleRate && m_resamplerate <= MaxResampleRate )
+            return true;
+        else
+        {
+            cerr <<"Invalid sample rate \"" <<optdata[1] <<"\"! Use a sample rate between " <<MinResampleRate <<" and " <<MaxResampleRate <<" hertz please !\n";
+            return false;
+        }
+    }
+
     bool CAudioUtil::ParseOptionMakeCvinfo( const std::vector<std::string> & optdata )
     {
         m_operationMode = eOpMode::MakeCvInfo;
@@ -1240,7 +1268,7 @@ namespace audioutil
 
         //Load SWDL
         PresetBank swd = move( DSE::ParseSWDL( inputfile.toString() ) );
-        ExportPresetBank( outNewDir, swd, true, m_useHexaNumbers, !m_bConvertSamples );
+        ExportPresetBank( outNewDir, swd, true, m_useHexaNumbers, !m_bConvertSamples, m_resamplerate );
 
         return 0;
     }
@@ -1499,7 +1527,7 @@ namespace audioutil
                 if( ptrsmpls != nullptr )
                     CreateOutputDir( outNewDir );  //Create sub directory
             }
-            ExportPresetBank( outNewDir, swd, true, m_useHexaNumbers, !m_bConvertSamples );
+            ExportPresetBank( outNewDir, swd, true, m_useHexaNumbers, !m_bConvertSamples, m_resamplerate );
         };
 
         ProcessAllFilesWithExtInDir( m_swdlpath, SWDL_FileExtension, "Exporting", lambdaExport );
@@ -1848,6 +1876,7 @@ namespace audioutil
 
     void CAudioUtil::DoExportLoader( DSE::BatchAudioLoader & bal, const std::string & outputpath )
     {
+        bal.SetResampleRate( m_resamplerate );
         cout << "-------------------------------------------------------------\n";
         if( m_outtype == eOutputType::SF2 )
         {
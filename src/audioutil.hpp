@@ -87,6 +87,8 @@ namespace audioutil
 
         bool ParseOptionNoConvertSamples( const std::vector<std::string> & optdata );
 
+        bool ParseOptionResampleRate( const std::vector<std::string> & optdata );
+
         bool ParseOptionMatchByName(const std::vector<std::string> & optdata);
 
         //Execution
@@ -131,6 +133,8 @@ namespace audioutil
         static const std::vector<utils::cmdl::argumentparsing_t> Arguments_List;
         static const std::vector<utils::cmdl::optionparsing_t>   Options_List;
         static const int                                         MaxNbLoops;
+        static const int                                         MinResampleRate;
+        static const int                                         MaxResampleRate;
 
         enum struct eOpMode
         {
@@ -182,6 +186,7 @@ namespace audioutil
         bool        m_bUseLFOFx;        //Whether LFO FX are processed
         bool        m_bMakeCvinfo;      //Whether we should export a blank cvinfo file!
         bool        m_bConvertSamples;  //Whether the samples should be converted to pcm16 when exporting
+        int         m_resamplerate;     //The sample rate to resample exported samples to, or -1 to keep their original sample rate
         bool        m_bmatchbyname;     //Whether the containers inside a blob should be matched by internal name or simply matched by order in the blob.
         
         //bool        m_bForceMidiExp;    //Whether the user is forcing MIDI export.
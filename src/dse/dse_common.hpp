@@ -8,6 +8,8 @@ Description: Common data between several of the Procyon Studio Digital Sound Ele
 */
 //#include <ppmdu/pmd2/pmd2_audio_data.hpp>
 #include <utils/utility.hpp>
+#include <utils/byte_cursor.hpp>
+#include <utils/struct_layout.hpp>
 #include <cstdint>
 #include <ctime>
 #include <vector>
@@ -270,26 +272,28 @@ namespace DSE
         bool                hasLength ()const { return (datlen != SpecialChunkLen); } //Returns whether this chunk has a valid data length
         eDSEChunks          GetChunkID()const { return IntToChunkID( label ); } //Returns the enum value representing this chunk's identity, judging from the label
 
+        typedef utils::StructLayout<ChunkHeader,
+                                    UTILS_LAYOUT_FIELD_BE(ChunkHeader, label),
+                                    UTILS_LAYOUT_FIELD   (ChunkHeader, param1),
+                                    UTILS_LAYOUT_FIELD   (ChunkHeader, param2),
+                                    UTILS_LAYOUT_FIELD   (ChunkHeader, datlen)> layout_t;
+        static_assert( layout_t::Size == Size, "ChunkHeader: Layout doesn't match the header's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         //Write the structure using an iterator to a byte container
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( label,  itwriteto, false );
-            itwriteto = utils::WriteIntToBytes( param1, itwriteto );
-            itwriteto = utils::WriteIntToBytes( param2, itwriteto );
-            itwriteto = utils::WriteIntToBytes( datlen, itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<Size>( *this, itwriteto );
         }
 
         //Read the structure from an iterator on a byte container
         template<class _init>
             _init ReadFromContainer(  _init itReadfrom, _init itpastend )
         {
-            label   = utils::ReadIntFromBytes<decltype(label)> (itReadfrom, itpastend, false ); //iterator is incremented
-            param1  = utils::ReadIntFromBytes<decltype(param1)>(itReadfrom, itpastend);
-            param2  = utils::ReadIntFromBytes<decltype(param2)>(itReadfrom, itpastend);
-            datlen  = utils::ReadIntFromBytes<decltype(datlen)>(itReadfrom, itpastend);
-            return itReadfrom;
+            return utils::ReadWithCursor<Size>( *this, itReadfrom, itpastend );
         }
     };
 
@@ -368,31 +372,29 @@ namespace DSE
         uint8_t  unk50    = 0;
         uint8_t  unk51    = 0;
 
+        typedef utils::StructLayout<KeyGroup,
+                                    UTILS_LAYOUT_FIELD(KeyGroup, id),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, poly),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, priority),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, vclow),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, vchigh),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, unk50),
+                                    UTILS_LAYOUT_FIELD(KeyGroup, unk51)> layout_t;
+        static_assert( layout_t::Size == SIZE, "KeyGroup: Layout doesn't match the entry's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( id,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( poly,     itwriteto );
-            itwriteto = utils::WriteIntToBytes( priority, itwriteto );
-            itwriteto = utils::WriteIntToBytes( vclow,    itwriteto );
-            itwriteto = utils::WriteIntToBytes( vchigh,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk50,    itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk51,    itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<SIZE>( *this, itwriteto );
         }
 
-
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itpastend )
         {
-            itReadfrom = utils::ReadIntFromBytes( id,       itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( poly,     itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( priority, itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( vclow,    itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( vchigh,   itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( unk50,    itReadfrom, itpastend );
-            itReadfrom = utils::ReadIntFromBytes( unk51,    itReadfrom, itpastend );
-            return itReadfrom;
+            return utils::ReadWithCursor<SIZE>( *this, itReadfrom, itpastend );
         }
     };
 
@@ -437,37 +439,32 @@ namespace DSE
                         unk33 != 0 );
         }
 
+        typedef utils::StructLayout<LFOTblEntry,
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, unk34),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, unk52),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, dest),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, wshape),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, rate),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, unk29),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, depth),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, delay),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, unk32),
+                                    UTILS_LAYOUT_FIELD(LFOTblEntry, unk33)> layout_t;
+        static_assert( layout_t::Size == SIZE, "LFOTblEntry: Layout doesn't match the entry's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( unk34,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk52,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( dest,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( wshape, itwriteto );
-            itwriteto = utils::WriteIntToBytes( rate,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk29,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( depth,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( delay,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk32,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk33,  itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<SIZE>( *this, itwriteto );
         }
 
-
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itpastend )
         {
-            itReadfrom = utils::ReadIntFromBytes( unk34,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( unk52,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( dest,   itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( wshape, itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( rate,   itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( unk29,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( depth,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( delay,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( unk32,  itReadfrom, itpastend  );
-            itReadfrom = utils::ReadIntFromBytes( unk33,  itReadfrom, itpastend  );
-            return itReadfrom;
+            return utils::ReadWithCursor<SIZE>( *this, itReadfrom, itpastend );
         }
     };
 
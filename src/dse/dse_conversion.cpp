@@ -4,7 +4,10 @@
 #include <dse/dse_interpreter.hpp>
 #include <dse/dse_containers.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/parallel_tasks.hpp>
+#include <utils/trace.hpp>
 #include <utils/audio_utilities.hpp>
+#include <utils/audio_resampler.hpp>
 #include <utils/poco_wrapper.hpp>
 
 #include <ppmdu/fmts/sedl.hpp>
@@ -14,6 +17,7 @@
 #include <dse/bgm_blob.hpp>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
 
@@ -481,6 +485,7 @@ namespace DSE
                                   DSESampleConvertionInfo              & out_cvinfo,
                                   std::vector<int16_t>                 & out_smpl )
     {
+        UTILS_TRACE_ZONE("DSE Convert Sample");
         if( smplfmt == static_cast<uint16_t>(eDSESmplFmt::ima_adpcm) )
         {
             out_smpl = move(::audio::DecodeADPCM_NDS( in_smpl ) );
@@ -568,12 +573,130 @@ namespace DSE
     //        return eDSESmplFmt::invalid;
     //}
 
+//========================================================================================
+//  Batch Helpers
+//========================================================================================
+    /*
+        ListFilesWithExt
+            Returns the sorted paths of all the files in "dir" with the extension "ext".
+            Sorting keeps the loading order, and thus the indices in the exported file names,
+            independent from the file system.
+    */
+    static vector<string> ListFilesWithExt( const string & dir, const string & ext )
+    {
+        vector<string>          files;
+        Poco::DirectoryIterator dirit(dir);
+        Poco::DirectoryIterator diritend;
+        for( ; dirit != diritend; ++dirit )
+        {
+            if( !dirit->isFile() )
+                continue;
+            string fext = dirit.path().getExtension();
+            std::transform(fext.begin(), fext.end(), fext.begin(), ::tolower);
+            if( fext == ext )
+                files.push_back( dirit.path().absolute().toString() );
+        }
+        std::sort( files.begin(), files.end() );
+        return files;
+    }
+
+    /*
+        RunBatchJobs
+            Runs one independent job per entry of "jobnames" over the thread budget, while displaying the progress.
+            Once done, prints how many jobs succeeded, and the name and error of every failed job, ordered by job.
+            Returns the nb of jobs that failed.
+            - jobfun : Callable as jobfun( size_t jobindex ).
+    */
+    template<class _JobFun>
+        static size_t RunBatchJobs( const string & what, const vector<string> & jobnames, _JobFun jobfun )
+    {
+        utils::JobErrorList     errors;
+        utils::ProgressReporter progress( "<*>- " + what + "..", static_cast<uint32_t>(jobnames.size()) );
+        progress.Start();
+        utils::RunIndexedJobs( jobnames.size(), jobfun, errors, &progress.Completed() );
+        progress.Stop();
+
+        stringstream sstr;
+        sstr <<"<*>- " <<what <<": " <<(jobnames.size() - errors.size()) <<"/" <<jobnames.size() <<" done";
+        if( !errors.empty() )
+        {
+            sstr <<", " <<errors.size() <<" failed:\n";
+            for( const auto & err : errors.GetSorted() )
+                sstr <<"<!>-   " <<jobnames[err.first] <<" : " <<err.second <<"\n";
+        }
+        else
+            sstr <<"\n";
+
+        cout <<sstr.str();
+        if( utils::LibWide().isLogOn() )
+            clog <<sstr.str();
+        return errors.size();
+    }
+
+    static BatchAudioLoader::smdswdpair_t ParseSmdSwdPair( const std::string & smd, const std::string & swd )
+    {
+        DSE::PresetBank    bank( move( DSE::ParseSWDL( swd ) ) );
+        DSE::MusicSequence seq( move( DSE::ParseSMDL( smd ) ) );
+
+        //Tag our files with their original file name, for cvinfo lookups to work!
+        seq.metadata().origfname  = Poco::Path(smd).getBaseName();
+        bank.metadata().origfname = Poco::Path(swd).getBaseName();
+        return std::make_pair( std::move(seq), std::move(bank) );
+    }
+
+    static BatchAudioLoader::smdswdpair_t ParseBgmContainerPair( const std::string & file )
+    {
+        if( utils::LibWide().isLogOn() )
+        {
+            stringstream sstr;
+            sstr << "--------------------------------------------------------------------------\n"
+                 << "Parsing BGM container \"" <<Poco::Path(file).getFileName() <<"\"\n"
+                 << "--------------------------------------------------------------------------\n";
+            clog <<sstr.str();
+        }
+
+        auto pairdata( move( ReadBgmContainer( file ) ) );
+        //Tag our files with their original file name, for cvinfo lookups to work!
+        pairdata.first.metadata().origfname  = Poco::Path(file).getBaseName();
+        pairdata.second.metadata().origfname = Poco::Path(file).getBaseName();
+        return std::make_pair( std::move(pairdata.second), std::move(pairdata.first) );
+    }
+
+    static BatchAudioLoader::smdswdpair_t ParseSingleSMDL( const std::string & smdl )
+    {
+        BatchAudioLoader::smdswdpair_t apair( move( make_pair( move(ParseSMDL(smdl)), move( PresetBank() ) ) ) );
+        //Tag our files with their original file name, for cvinfo lookups to work!
+        apair.first.metadata().origfname = Poco::Path(smdl).getBaseName();
+        return apair;
+    }
+
+    /*
+        LoadFilesInParallel
+            Parse every file with "parsefun" in parallel, and return the pairs in the order of "files".
+            Files that failed to load are left null.
+    */
+    template<class _ParseFun>
+        static vector<unique_ptr<BatchAudioLoader::smdswdpair_t>> LoadFilesInParallel( const string & what, const vector<string> & files, _ParseFun parsefun, size_t & out_nbfailed )
+    {
+        vector<unique_ptr<BatchAudioLoader::smdswdpair_t>> loaded(files.size());
+        vector<string> names;
+        names.reserve(files.size());
+        for( const auto & fpath : files )
+            names.push_back( Poco::Path(fpath).getFileName() );
+
+        out_nbfailed = RunBatchJobs( what, names, [&]( size_t cntfile )
+        {
+            loaded[cntfile].reset( new BatchAudioLoader::smdswdpair_t( parsefun(cntfile) ) );
+        });
+        return loaded;
+    }
+
 //========================================================================================
 //  BatchAudioLoader
 //========================================================================================
 
     BatchAudioLoader::BatchAudioLoader( bool singleSF2, bool lfofxenabled )
-        : m_bSingleSF2(singleSF2),m_lfoeffects(lfofxenabled)
+        : m_bSingleSF2(singleSF2),m_lfoeffects(lfofxenabled), m_resamplerate(-1)
     {}
 
 
@@ -585,14 +708,7 @@ namespace DSE
 
     void BatchAudioLoader::LoadSmdSwdPair( const std::string & smd, const std::string & swd )
     {
-        DSE::PresetBank    bank( move( DSE::ParseSWDL( swd ) ) );
-        DSE::MusicSequence seq( move( DSE::ParseSMDL( smd ) ) );
-
-        //Tag our files with their original file name, for cvinfo lookups to work!
-        seq.metadata().origfname  = Poco::Path(smd).getBaseName();
-        bank.metadata().origfname = Poco::Path(swd).getBaseName();
-
-        m_pairs.push_back( move( std::make_pair( std::move(seq), std::move(bank) ) ) );
+        m_pairs.push_back( ParseSmdSwdPair( smd, swd ) );
     }
 
     /*
@@ -1298,8 +1414,8 @@ namespace DSE
             sstrnames <<"Prg" <<presetidcnt << "->Smpl" <<cntsplit;
 
             //Place the sample used by the current split in the soundfont
-            sf2::Sample sampl(  cursmpls[cntsplit].begin(), 
-                                cursmpls[cntsplit].end(), 
+            sf2::Sample sampl(  cursmpls[cntsplit]->begin(), 
+                                cursmpls[cntsplit]->end(), 
                                 sstrnames.str(),
                                 0,
                                 0,
@@ -1351,6 +1467,7 @@ namespace DSE
                                            const DSE::KeyGroupList      & keygroups
                                            )
     {
+        UTILS_TRACE_ZONE("DSE Bake Program");
         using namespace sf2;
 
         auto & cvinfo = presetcvinf[cntpair];
@@ -1406,6 +1523,7 @@ namespace DSE
     ***************************************************************************************/
     vector<SMDLPresetConversionInfo> BatchAudioLoader::ExportSoundfontBakedSamples( const std::string & destf )
     {
+        UTILS_TRACE_ZONE("DSE Export Soundfont Baked");
         using namespace sf2;
         vector<SMDLPresetConversionInfo> trackprgconvlist;
         m_stats = audiostats(); //reset stats
@@ -1435,7 +1553,7 @@ namespace DSE
                     continue;
 
                 SoundFont sf(pairname);
-                procpres.push_back(std::move(ProcessDSESamples(*samples, *prgptr)));
+                procpres.push_back(std::move(ProcessDSESamples(*samples, *prgptr, m_resamplerate)));
                 int cntpres = 0;
                 int cntinst = 0;
                 HandleBakedPrg(procpres.back(), &sf, pairname, cntpair, trackprgconvlist, cntinst, cntpres, prgptr->Keygrps());
@@ -1476,6 +1594,7 @@ namespace DSE
             //Prepare
             shared_ptr<SampleBank>  samples = m_master.smplbank().lock();
             deque<ProcessedPresets> procpres; //We need to put all processed stuff in there, because the samples need to exist when the soundfont is written.
+            BakedSampleCache        bakecache; //All pairs use the master bank's samples, so identical splits are only baked once for the whole set
 
             //Counters for the unique preset and instruments IDs
             int cntpres = 0;
@@ -1489,7 +1608,7 @@ namespace DSE
 
                 if (prgptr != nullptr)
                 {
-                    procpres.push_back(move(ProcessDSESamples(*samples, *prgptr)));
+                    procpres.push_back(move(ProcessDSESamples(*samples, *prgptr, m_resamplerate, true, &bakecache)));
                     HandleBakedPrg(procpres.back(), &sf, pairname, cntpair, trackprgconvlist, cntinst, cntpres, prgptr->Keygrps());
                 }
 
@@ -1499,6 +1618,9 @@ namespace DSE
             }
             cout <<"\n";
 
+            if( utils::LibWide().isLogOn() )
+                clog <<"Baked " <<bakecache.size() <<" unique samples.\n";
+
             //Write the soundfont
             try
             {
@@ -1537,6 +1659,7 @@ namespace DSE
     ***************************************************************************************/
     vector<SMDLPresetConversionInfo> BatchAudioLoader::ExportSoundfont( const std::string & destf )
     {
+        UTILS_TRACE_ZONE("DSE Export Soundfont");
         using namespace sf2;
 
         if( m_pairs.size() > CHAR_MAX && !m_bSingleSF2 )
@@ -1686,20 +1809,26 @@ namespace DSE
             merged = std::move( ExportSoundfont( outsoundfont.toString() ) );
 
         //Then the MIDIs
+        vector<string> midpaths;
         for( size_t i = 0; i < m_pairs.size(); ++i )
         {
             Poco::Path fpath(destdir);
             fpath.append( to_string(i) + "_" + m_pairs[i].first.metadata().fname);
             fpath.makeFile();
             fpath.setExtension("mid");
+            midpaths.push_back(fpath.toString());
+        }
 
-            cerr<<"<*>- Currently exporting smd to " <<fpath.toString() <<"\n";
-            DSE::SequenceToMidi( fpath.toString(), 
+        const size_t nbfailed = RunBatchJobs( "Exporting MIDIs", midpaths, [&]( size_t i )
+        {
+            DSE::SequenceToMidi( midpaths[i], 
                                  m_pairs[i].first, 
                                  merged[i],
                                  nbloops,
                                  DSE::eMIDIMode::GS );  //This will disable the drum channel, since we don't need it at all!
-        }
+        });
+        if( nbfailed != 0 )
+            throw runtime_error("BatchAudioLoader::ExportSoundfontAndMIDIs(): " + to_string(nbfailed) + " MIDI file(s) couldn't be exported!");
     }
 
     /***************************************************************************************
@@ -1709,6 +1838,7 @@ namespace DSE
     ***************************************************************************************/
     void BatchAudioLoader::ExportXMLAndMIDIs( const std::string & destdir, int nbloops )
     {
+        UTILS_TRACE_ZONE("DSE Export XML And MIDIs");
         static const string _DefaultMainSampleDirName = "mainbank";
 
         if( IsMasterBankLoaded() )
@@ -1728,30 +1858,33 @@ namespace DSE
         }
 
         //Then the MIDIs + presets + optionally samples contained in the swd of the pair
+        vector<string> trkdirs;
         for( size_t i = 0; i < m_pairs.size(); ++i )
         {
             Poco::Path fpath(destdir);
             fpath.append( to_string(i) + "_" + m_pairs[i].first.metadata().fname);
-            
-            if( ! utils::DoCreateDirectory(fpath.toString()) )
-            {
-                clog <<"Couldn't create directory for track " <<fpath.toString() << "!\n";
-                continue;
-            }
+            trkdirs.push_back(fpath.toString());
+        }
 
-            Poco::Path midpath(fpath);
+        const size_t nbfailed = RunBatchJobs( "Exporting smd + swd", trkdirs, [&]( size_t i )
+        {
+            if( ! utils::DoCreateDirectory(trkdirs[i]) )
+                throw runtime_error("Couldn't create directory for track " + trkdirs[i] + "!");
+
+            Poco::Path midpath(trkdirs[i]);
             midpath.append( to_string(i) + "_" + m_pairs[i].first.metadata().fname);
             midpath.makeFile();
             midpath.setExtension("mid");
 
-            cerr<<"<*>- Currently exporting smd + swd to " <<fpath.toString() <<"\n";
             DSE::SequenceToMidi( midpath.toString(), 
                                  m_pairs[i].first, 
                                  nbloops,
                                  DSE::eMIDIMode::GS );  //This will disable the drum channel, since we don't need it at all!
 
-            ExportPresetBank( fpath.toString(), m_pairs[i].second, false, false );
-        }
+            ExportPresetBank( trkdirs[i], m_pairs[i].second, false, false );
+        });
+        if( nbfailed != 0 )
+            throw runtime_error("BatchAudioLoader::ExportXMLAndMIDIs(): " + to_string(nbfailed) + " track(s) couldn't be exported!");
     }
 
 
@@ -1762,6 +1895,7 @@ namespace DSE
     ***************************************************************************************/
     void BatchAudioLoader::BuildMasterFromPairs()
     {
+        UTILS_TRACE_ZONE("DSE Build Master Bank");
         vector<SampleBank::smpldata_t> smpldata;
         bool                           bnosmpldata = true;
 
@@ -1887,33 +2021,30 @@ namespace DSE
     void BatchAudioLoader::LoadMatchedSMDLSWDLPairs( const std::string & swdldir, const std::string & smdldir )
     {
         //Grab all the swd and smd pairs in the folder
-        Poco::DirectoryIterator dirit(smdldir);
-        Poco::DirectoryIterator diritend;
         cout << "<*>- Loading matched smd in the " << smdldir <<" directory..\n";
 
-        unsigned int cntparsed = 0;
-        while( dirit != diritend )
+        vector<string> smdfiles;
+        vector<string> swdfiles;
+        for( const auto & smdpath : ListFilesWithExt( smdldir, SMDL_FileExtension ) )
         {
-            string fext = dirit.path().getExtension();
-            std::transform(fext.begin(), fext.end(), fext.begin(), ::tolower);
-
-            //Check all smd/swd file pairs
-            if( fext == SMDL_FileExtension )
+            Poco::File matchingswd( Poco::Path(swdldir).append(Poco::Path(smdpath).getBaseName()).makeFile().setExtension(SWDL_FileExtension) );
+            if( matchingswd.exists() && matchingswd.isFile() )
             {
-                Poco::File matchingswd( Poco::Path(swdldir).append(dirit.path().getBaseName()).makeFile().setExtension(SWDL_FileExtension) );
-                    
-                if( matchingswd.exists() && matchingswd.isFile() )
-                {
-                    cout <<"\r[" <<setfill(' ') <<setw(4) <<right <<cntparsed <<" pairs loaded] - Currently loading : " <<dirit.path().getFileName() <<"..";
-                    LoadSmdSwdPair( dirit.path().toString(), matchingswd.path() );
-                    ++cntparsed;
-                }
-                else
-                    cout<<"<!>- File " << dirit.path().toString() <<" is missing a matching .swd file! Skipping !\n";
+                smdfiles.push_back(smdpath);
+                swdfiles.push_back(matchingswd.path());
             }
-            ++dirit;
+            else
+                cout<<"<!>- File " << smdpath <<" is missing a matching .swd file! Skipping !\n";
         }
-        cout <<"\n..done\n\n";
+
+        size_t nbfailed = 0;
+        auto   loaded   = LoadFilesInParallel( "Loading smd + swd pairs", smdfiles, [&]( size_t i ){ return ParseSmdSwdPair( smdfiles[i], swdfiles[i] ); }, nbfailed );
+        if( nbfailed != 0 )
+            throw runtime_error("BatchAudioLoader::LoadMatchedSMDLSWDLPairs(): " + to_string(nbfailed) + " pair(s) couldn't be loaded!");
+
+        for( auto & ppair : loaded )
+            m_pairs.push_back( std::move(*ppair) );
+        cout <<"..done\n\n";
     }
 
 
@@ -1925,23 +2056,14 @@ namespace DSE
     */
     void BatchAudioLoader::LoadBgmContainer( const std::string & file )
     {
-        if( utils::LibWide().isLogOn() )
-            clog << "--------------------------------------------------------------------------\n"
-                 << "Parsing BGM container \"" <<Poco::Path(file).getFileName() <<"\"\n"
-                 << "--------------------------------------------------------------------------\n";
-
-        auto pairdata( move( ReadBgmContainer( file ) ) );
-        //Tag our files with their original file name, for cvinfo lookups to work!
-        pairdata.first.metadata().origfname  = Poco::Path(file).getBaseName();
-        pairdata.second.metadata().origfname = Poco::Path(file).getBaseName();
-
-        m_pairs.push_back( move( std::make_pair( std::move(pairdata.second), std::move(pairdata.first) ) ) );
+        m_pairs.push_back( ParseBgmContainerPair(file) );
     }
 
     /*
         LoadBgmContainers
             Load all pairs in the folder. 
             Bgm containers are SWDL and SMDL pairs packed into a single file using a SIR0 container.
+            Containers that fail to load are skipped, and listed once loading is done.
 
             - bgmdir : The directory where the bgm containers are located at.
             - ext    : The file extension the bgm container files have.
@@ -1949,46 +2071,20 @@ namespace DSE
     void BatchAudioLoader::LoadBgmContainers( const std::string & bgmdir, const std::string & ext )
     {
         //Grab all the bgm containers in here
-        Poco::DirectoryIterator dirit(bgmdir);
-        Poco::DirectoryIterator diritend;
         cout << "<*>- Loading bgm containers *." <<ext <<" in the " << bgmdir <<" directory..\n";
 
-        stringstream sstrloadingmesage;
-        sstrloadingmesage << " *." <<ext <<" loaded] - Currently loading : ";
-        const string loadingmsg = sstrloadingmesage.str();
+        const vector<string> bgmfiles = ListFilesWithExt( bgmdir, ext );
+        size_t nbfailed = 0;
+        auto   loaded   = LoadFilesInParallel( "Loading *." + ext, bgmfiles, [&]( size_t i ){ return ParseBgmContainerPair( bgmfiles[i] ); }, nbfailed );
+        if( nbfailed != 0 )
+            cout <<"<!>- Skipped " <<nbfailed <<" bgm container(s) that couldn't be loaded!\n";
 
-        unsigned int cntparsed = 0;
-        while( dirit != diritend )
+        for( auto & ppair : loaded )
         {
-            if( dirit->isFile() )
-            {
-                string fext = dirit.path().getExtension();
-                std::transform(fext.begin(), fext.end(), fext.begin(), ::tolower);
-
-                //Check all smd/swd file pairs
-                try
-                {
-                    if( fext == ext )
-                    {
-                        cout <<"\r[" <<setfill(' ') <<setw(4) <<right <<cntparsed <<loadingmsg <<dirit.path().getFileName() <<"..";
-                        LoadBgmContainer( dirit.path().absolute().toString() );
-                        ++cntparsed;
-                    }
-                }
-                catch( std::exception & e )
-                {
-                    cerr <<"\nBatchAudioLoader::LoadBgmContainers(): Exception : " <<e.what() <<"\n"
-                         <<"Skipping file and attemnpting to recover!\n\n";
-                    if( utils::LibWide().isLogOn() )
-                    {
-                        clog <<"\nBatchAudioLoader::LoadBgmContainers(): Exception : " <<e.what() <<"\n"
-                         <<"Skipping file and attemnpting to recover!\n\n";
-                    }
-                }
-            }
-            ++dirit;
+            if( ppair )
+                m_pairs.push_back( std::move(*ppair) );
         }
-        cout <<"\n..done\n\n";
+        cout <<"..done\n\n";
     }
 
     /*
@@ -1997,51 +2093,47 @@ namespace DSE
     */
     void BatchAudioLoader::LoadSingleSMDLs( const std::string & smdldir )
     {
-        //Grab all the swd and smd pairs in the folder
-        Poco::DirectoryIterator dirit(smdldir);
-        Poco::DirectoryIterator diritend;
+        //Grab all the smd in the folder
         cout << "<*>- Loading smd files in directory \"" << smdldir <<"\"..\n";
 
-        unsigned int cntparsed = 0;
-        while( dirit != diritend )
-        {
-            if( dirit->isFile() )
-            {
-                string fext = dirit.path().getExtension();
-                std::transform(fext.begin(), fext.end(), fext.begin(), ::tolower);
+        const vector<string> smdfiles = ListFilesWithExt( smdldir, SMDL_FileExtension );
+        size_t nbfailed = 0;
+        auto   loaded   = LoadFilesInParallel( "Loading smd", smdfiles, [&]( size_t i ){ return ParseSingleSMDL( smdfiles[i] ); }, nbfailed );
+        if( nbfailed != 0 )
+            throw runtime_error("BatchAudioLoader::LoadSingleSMDLs(): " + to_string(nbfailed) + " smd file(s) couldn't be loaded!");
 
-                if( fext == SMDL_FileExtension )
-                {
-                    cout <<"\r[" <<setfill(' ') <<setw(4) <<right <<cntparsed <<" smd loaded] - Currently loading : " <<dirit.path().getFileName() <<"..";
-                    LoadSMDL( dirit.path().toString() );
-                    ++cntparsed;
-                }
-            }
-            ++dirit;
-        }
-        cout <<"\n..done\n\n";
+        for( auto & ppair : loaded )
+            m_pairs.push_back( std::move(*ppair) );
+        cout <<"..done\n\n";
     }
 
     /*
     */
     void BatchAudioLoader::LoadSMDL( const std::string & smdl )
     {
-        m_pairs.push_back( move( make_pair( move(ParseSMDL(smdl)), move( PresetBank() ) ) ) );
-        //Tag our files with their original file name, for cvinfo lookups to work!
-        m_pairs.back().first.metadata().origfname = Poco::Path(smdl).getBaseName();
+        m_pairs.push_back( ParseSingleSMDL(smdl) );
     }
 
     /*
     */
     void BatchAudioLoader::ExportMIDIs( const std::string & destdir, const std::string & cvinfopath, int nbloops )
     {
+        UTILS_TRACE_ZONE("DSE Export MIDIs");
         DSE::SMDLConvInfoDB cvinf;
 
         if( ! cvinfopath.empty() )
             cvinf.Parse( cvinfopath );
 
-        //Then the MIDIs
+        vector<string> midpaths;
         for( size_t i = 0; i < m_pairs.size(); ++i )
+        {
+            Poco::Path fpath(destdir);
+            fpath.append( to_string(i) + "_" + m_pairs[i].first.metadata().fname).makeFile().setExtension("mid");
+            midpaths.push_back(fpath.toString());
+        }
+
+        //Then the MIDIs
+        const size_t nbfailed = RunBatchJobs( "Exporting MIDIs", midpaths, [&]( size_t i )
         {
             //Lookup cvinfo with the original filename from the game filesystem!
             auto itfound = cvinf.end();
@@ -2049,18 +2141,11 @@ namespace DSE
             if(! cvinf.empty() )
                 itfound = cvinf.FindConversionInfo( m_pairs[i].first.metadata().origfname );
 
-            Poco::Path fpath(destdir);
-            fpath.append( to_string(i) + "_" + m_pairs[i].first.metadata().fname).makeFile().setExtension("mid");
-
-            cout <<"<*>- Currently exporting smd to " <<fpath.toString() <<"\n";
-            if( utils::LibWide().isLogOn() )
-                clog <<"<*>- Currently exporting smd to " <<fpath.toString() <<"\n";
-
             if( itfound != cvinf.end() )
             {
                 if( utils::LibWide().isLogOn() )
-                    clog << "<*>- Got conversion info for this track! MIDI will be remapped accordingly!\n";
-                DSE::SequenceToMidi( fpath.toString(), 
+                    clog <<("<*>- " + midpaths[i] + ": Got conversion info for this track! MIDI will be remapped accordingly!\n");
+                DSE::SequenceToMidi( midpaths[i], 
                                      m_pairs[i].first, 
                                      itfound->second,
                                      nbloops,
@@ -2068,14 +2153,16 @@ namespace DSE
             }
             else
             {
-                if( utils::LibWide().isLogOn() )
-                    clog <<"<!>- Couldn't find a conversion info entry for this SMDL! Falling back to converting as-is..\n";
-                DSE::SequenceToMidi( fpath.toString(), 
+                if( utils::LibWide().isLogOn() && !cvinf.empty() )
+                    clog <<("<!>- " + midpaths[i] + ": Couldn't find a conversion info entry for this SMDL! Falling back to converting as-is..\n");
+                DSE::SequenceToMidi( midpaths[i], 
                                      m_pairs[i].first, 
                                      nbloops,
                                      DSE::eMIDIMode::GS );  //This will disable the drum channel, since we don't need it at all!
             }
-        }
+        });
+        if( nbfailed != 0 )
+            throw runtime_error("BatchAudioLoader::ExportMIDIs(): " + to_string(nbfailed) + " MIDI file(s) couldn't be exported!");
     }
 
 
@@ -2226,8 +2313,9 @@ namespace DSE
 //  Functions
 //===========================================================================================
     
-    void ExportPresetBank( const std::string & directory, const DSE::PresetBank & bnk, bool samplesonly, bool hexanumbers, bool noconvert )
+    void ExportPresetBank( const std::string & directory, const DSE::PresetBank & bnk, bool samplesonly, bool hexanumbers, bool noconvert, int resamplerate )
     {
+        UTILS_TRACE_ZONE("DSE Export Preset Bank");
         static const string _DeafaultSamplesSubDir = "samples";
         auto smplptr = bnk.smplbank().lock();
         
@@ -2323,7 +2411,8 @@ namespace DSE
                         outwave.GetSamples().resize(1);
                         outwave.SampleRate( ptrinfo->smplrate );
 
-                        switch( ConvertDSESample( static_cast<uint16_t>(ptrinfo->smplfmt), ptrinfo->loopbeg, *ptrdata, cvinf, outwave.GetSamples().front() ) )
+                        const eDSESmplFmt origfmt = ConvertDSESample( static_cast<uint16_t>(ptrinfo->smplfmt), ptrinfo->loopbeg, *ptrdata, cvinf, outwave.GetSamples().front() );
+                        switch( origfmt )
                         {
                             case eDSESmplFmt::ima_adpcm:
                             {
@@ -2351,6 +2440,22 @@ namespace DSE
                             }
                         }
 
+                        //Resample converted samples if needed
+                        const bool bconverted = (origfmt == eDSESmplFmt::ima_adpcm || origfmt == eDSESmplFmt::pcm8 || origfmt == eDSESmplFmt::pcm16);
+                        if( bconverted && resamplerate > 0 && ptrinfo->smplrate > 0 && static_cast<int>(ptrinfo->smplrate) != resamplerate )
+                        {
+                            auto presampler = utils::PolyphaseResampler::Get( ptrinfo->smplrate, static_cast<uint32_t>(resamplerate) );
+                            if( ptrinfo->smplloop != 0 )
+                                outwave.GetSamples().front() = presampler->Resample( outwave.GetSamples().front(), cvinf.loopbeg_, cvinf.loopend_ );
+                            else
+                            {
+                                cvinf.loopbeg_ = presampler->ConvertLength(cvinf.loopbeg_);
+                                cvinf.loopend_ = presampler->ConvertLength(cvinf.loopend_);
+                                outwave.GetSamples().front() = presampler->Resample( outwave.GetSamples().front() );
+                            }
+                            outwave.SampleRate( resamplerate );
+                        }
+
                         loopinfo.start_ = cvinf.loopbeg_;
                         loopinfo.end_   = cvinf.loopend_;
 
@@ -77,9 +77,9 @@ namespace DSE
             {
             }
 
-            DSE::ProgramInfo                    prginf;       //
-            std::vector< DSE::WavInfo >         splitsmplinf; //Modified sample info for a split's sample.
-            std::vector< std::vector<int16_t> > splitsamples; //Sample for each split of a preset.
+            DSE::ProgramInfo                                          prginf;       //
+            std::vector< DSE::WavInfo >                               splitsmplinf; //Modified sample info for a split's sample.
+            std::vector< std::shared_ptr<const std::vector<int16_t>> > splitsamples; //Sample for each split of a preset. Splits baking the same sample share it.
         };
 
         typedef std::map< int16_t, PresetEntry >::iterator       iterator;
@@ -105,6 +105,63 @@ namespace DSE
         std::map< int16_t, PresetEntry > m_smpldata;
     };
 
+    /*
+        BakedSampleCache
+            Keeps the samples baked by ProcessDSESamples, indexed on everything the baking depends on.
+            Splits that use the same sample, with the same envelope and volume, are only baked once, 
+            and share the resulting sample data.
+
+            Passing the same cache to several calls to ProcessDSESamples lets program banks sharing a 
+            sample bank reuse each other's samples. A cache must only ever be used with a single sample bank,
+            and the same resampling settings!
+    */
+    class BakedSampleCache
+    {
+    public:
+        struct key_t
+        {
+            uint16_t smplid  = 0;
+            uint8_t  envon   = 0;
+            uint8_t  prgvol  = 0;
+            uint8_t  smplvol = 0;
+            int8_t   envmulti= 0;
+            int8_t   atkvol  = 0;
+            int8_t   sustain = 0;
+            int16_t  attack  = 0;
+            int16_t  hold    = 0;
+            int16_t  decay   = 0;
+            int16_t  decay2  = 0;
+
+            bool operator<( const key_t & other )const;
+        };
+
+        struct BakedSample
+        {
+            std::shared_ptr<const std::vector<int16_t>> pcm;     //The baked sample
+            DSE::WavInfo                                smplinf; //The sample info, updated to match the baked sample
+        };
+
+        /*
+            MakeKey
+                Makes the key for the sample of the given split. Envelope and volume parameters are ignored
+                when the split's envelope is disabled, since they aren't baked into the sample then.
+        */
+        static key_t MakeKey( const DSE::SplitEntry & split, const DSE::ProgramInfo & prgm );
+
+        inline const BakedSample * Find( const key_t & key )const
+        {
+            auto itfound = m_baked.find(key);
+            return (itfound != m_baked.end())? &(itfound->second) : nullptr;
+        }
+
+        inline void   Insert( const key_t & key, BakedSample && smpl ) { m_baked.emplace( key, std::move(smpl) ); }
+        inline size_t size()const                                      { return m_baked.size(); }
+        inline void   clear()                                          { m_baked.clear(); }
+
+    private:
+        std::map<key_t, BakedSample> m_baked;
+    };
+
 //====================================================================================================
 //  Specialized Loaders/Exporters
 //====================================================================================================
@@ -131,6 +188,14 @@ namespace DSE
         */
         BatchAudioLoader( /*const std::string & mbank,*/ bool singleSF2 = true, bool lfofxenabled = true );
 
+        /*
+            SetResampleRate
+                Sets the sample rate in hertz that baked samples are resampled to when exporting a soundfont.
+                -1 disables resampling, and is the default.
+        */
+        inline void SetResampleRate( int smplrate ) { m_resamplerate = smplrate; }
+        inline int  GetResampleRate()const          { return m_resamplerate; }
+
     //-----------------------------
     // Loading Methods
     //-----------------------------
@@ -372,6 +437,7 @@ namespace DSE
         std::string               m_mbankpath;
         bool                      m_bSingleSF2;
         bool                      m_lfoeffects; //Whether lfo effects should be processed
+        int                       m_resamplerate; //Sample rate to resample baked samples to, or -1
 
         DSE::PresetBank           m_master;
         std::vector<smdswdpair_t> m_pairs;
@@ -454,13 +520,19 @@ namespace DSE
             * prestoproc      : The programbank containing all the program whose samples needs to be processed.
             * desiredsmplrate : The desired sample rate in hertz to resample all samples to! (-1 means no resampling)
             * bakeenv         : Whether the envelopes should be baked into the samples.
+            * pcache          : If not null, samples already in the cache aren't baked again, and newly baked 
+                                samples are added to it. The cache must only be used with "srcsmpl".
+
+            The samples are baked in parallel, and each unique combination of sample, envelope and volume 
+            is only baked once.
 
             Returns a ProcessedPresets object, contining the new program data, along with the new samples.
     */
     DSE::ProcessedPresets ProcessDSESamples( const DSE::SampleBank  & srcsmpl, 
                                              const DSE::ProgramBank & prestoproc, 
                                              int                      desiredsmplrate = -1, 
-                                             bool                     bakeenv         = true );
+                                             bool                     bakeenv         = true,
+                                             BakedSampleCache       * pcache          = nullptr );
 
     //-------------------
     //  Audio Loaders
@@ -499,8 +571,15 @@ namespace DSE
 
     /*
         Export the PresetBank to a directory as XML and WAV samples.
+        If "resamplerate" isn't -1, the samples converted to pcm16 are resampled to that sample rate in hertz, 
+        along with their loop points. Samples exported in their original format are never resampled.
     */
-    void ExportPresetBank( const std::string & directory, const DSE::PresetBank & bnk, bool samplesonly = true, bool hexanumbers = true, bool noconvert = true );
+    void ExportPresetBank( const std::string & directory, 
+                           const DSE::PresetBank & bnk, 
+                           bool samplesonly  = true, 
+                           bool hexanumbers  = true, 
+                           bool noconvert    = true, 
+                           int  resamplerate = -1 );
 
     /*
         To use the ExportSequence,
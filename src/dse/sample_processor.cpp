@@ -4,7 +4,13 @@
 #include <iostream>
 #include <iomanip>
 #include <deque>
-//#include <CDSPResampler.h>
+#include <cassert>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <tuple>
+#include <utils/parallel_tasks.hpp>
+#include <utils/audio_resampler.hpp>
 
 using namespace std;
 
@@ -24,6 +30,108 @@ namespace DSE
                                             ) );
     }
 
+//=========================================================================================
+//  Sample Kernels
+//=========================================================================================
+    /*
+        The kernels below work on raw blocks of PCM16 samples. They're written as plain loops over
+        fixed size blocks of 32 bits integers, without any branching, so the compiler is able to turn them 
+        into SIMD code on any platform.
+    */
+    const size_t SmplKernelBlockLen = 64;   //Nb of samples processed at once by the gain kernel
+    const int    GainFracBits       = 15;   //Gain applied to samples is fixed point 1.15
+    const int    GainRampFracBits   = 29;   //Gain ramps are computed in fixed point 2.29, to keep the rounding error low.
+                                            // The extra integer bit keeps gains close to 2, plus rounding, within 32 bits.
+    const double GainKernelMax      = 2.0;  //Gains must be in the [0, 2) range for the fixed point kernel
+
+    /*
+        ApplyGainRampBlock
+            Multiply "nbsmpls" samples by a gain going from "gainbeg" and increasing by "gainstep" after each sample,
+            both in fixed point 2.29. Results are rounded and saturated to 16 bits.
+    */
+    inline void ApplyGainRampBlock( int16_t * psmpl, size_t nbsmpls, int32_t gainbeg, int32_t gainstep )
+    {
+        const int32_t GainRound = 1 << (GainRampFracBits - GainFracBits - 1);
+        const int32_t SmplRound = 1 << (GainFracBits - 1);
+        for( size_t cntsmpl = 0; cntsmpl < nbsmpls; ++cntsmpl )
+        {
+            const int32_t gain   = (gainbeg + static_cast<int32_t>(cntsmpl) * gainstep + GainRound) >> (GainRampFracBits - GainFracBits);
+            int32_t       scaled = (static_cast<int32_t>(psmpl[cntsmpl]) * gain + SmplRound) >> GainFracBits;
+            scaled = (scaled > SHRT_MAX)? SHRT_MAX : scaled;
+            scaled = (scaled < SHRT_MIN)? SHRT_MIN : scaled;
+            psmpl[cntsmpl] = static_cast<int16_t>(scaled);
+        }
+    }
+
+    /*
+        ApplyGainRamp
+            Multiply "nbsmpls" samples by a gain going linearly from "gainbeg", and changing by "gainstep" after each sample.
+            The gain is recomputed from the starting gain at the beginning of each block, so the error doesn't accumulate
+            over long ramps. Gains outside of the range the fixed point kernel supports are applied in floating point.
+    */
+    void ApplyGainRamp( int16_t * psmpl, size_t nbsmpls, double gainbeg, double gainstep )
+    {
+        if( nbsmpls == 0 )
+            return;
+
+        const double gainend = gainbeg + gainstep * static_cast<double>(nbsmpls - 1);
+        if( gainbeg < 0.0 || gainbeg >= GainKernelMax || gainend < 0.0 || gainend >= GainKernelMax )
+        {
+            double curgain = gainbeg;
+            for( size_t cntsmpl = 0; cntsmpl < nbsmpls; ++cntsmpl, curgain += gainstep )
+            {
+                double scaledsmpl = lround( psmpl[cntsmpl] * curgain );
+                if( scaledsmpl > SHRT_MAX )
+                    scaledsmpl = SHRT_MAX;
+                else if( scaledsmpl < SHRT_MIN )
+                    scaledsmpl = SHRT_MIN;
+                psmpl[cntsmpl] = static_cast<int16_t>( scaledsmpl );
+            }
+            return;
+        }
+
+        const double  FixedOne   = static_cast<double>(1 << GainRampFracBits);
+        const int32_t fixedstep  = static_cast<int32_t>( lround(gainstep * FixedOne) );
+        for( size_t cntblk = 0; cntblk < nbsmpls; cntblk += SmplKernelBlockLen )
+        {
+            const size_t  blklen    = std::min( SmplKernelBlockLen, nbsmpls - cntblk );
+            const int32_t blkgain   = static_cast<int32_t>( lround( (gainbeg + gainstep * static_cast<double>(cntblk)) * FixedOne ) );
+            ApplyGainRampBlock( psmpl + cntblk, blklen, blkgain, fixedstep );
+        }
+    }
+
+    /*
+        ReplicateLoop
+            Append copies of the "looplen" samples beginning at "loopbeg" to the sample, until it's "destlen" samples long.
+            The copies are made in bulk, doubling the length of the copied block each time.
+            The source block may end past the original end of the sample, in which case it continues with the samples 
+            being appended, just like when copying samples one by one.
+    */
+    void ReplicateLoop( vector<int16_t> & smpl, size_t loopbeg, size_t looplen, size_t destlen )
+    {
+        const size_t origlen = smpl.size();
+        if( destlen <= origlen || looplen == 0 || loopbeg >= origlen )
+            return;
+
+        smpl.resize(destlen);
+        int16_t *    pdest   = smpl.data() + origlen;
+        const size_t nbtoadd = destlen - origlen;
+
+        //The first copy is made one sample at a time, since it may overlap the samples it appends
+        const size_t firstlen = std::min( looplen, nbtoadd );
+        for( size_t cntsmpl = 0; cntsmpl < firstlen; ++cntsmpl )
+            pdest[cntsmpl] = smpl[loopbeg + cntsmpl];
+
+        //Then, the samples appended so far are a whole number of loops that can be copied in bulk
+        size_t nbdone = firstlen;
+        while( nbdone < nbtoadd )
+        {
+            const size_t nbcpy = std::min( nbdone, nbtoadd - nbdone );
+            std::memcpy( pdest + nbdone, pdest, nbcpy * sizeof(int16_t) );
+            nbdone += nbcpy;
+        }
+    }
+
 
 
     /*
@@ -59,26 +167,104 @@ namespace DSE
 
         /*
             Based on a list of presets using this sample, the same ammount of baked samples will be returned.
+            Each unique split sample is baked as an independent job, in parallel. 
+            If a cache was specified, samples it already contains aren't baked again.
         */
-        ProcessedPresets Process( const ProgramBank & prestoproc )
+        ProcessedPresets Process( const ProgramBank & prestoproc, BakedSampleCache * pcache = nullptr )
         {
-            ProcessedPresets processed;
+            BakedSampleCache   localcache;
+            BakedSampleCache & cache = (pcache != nullptr)? *pcache : localcache;
+
+            //#1 - List the splits of every programs, and the unique samples to bake
+            vector<ProcessedPresets::PresetEntry>     entries;
+            vector<splitref_t>                        splitrefs;
+            vector<bakejob_t>                         bakejobs;
+            map<BakedSampleCache::key_t, size_t>      queuedbakes;
+
             for( const auto & inf : prestoproc.PrgmInfo() )
             {
                 if( inf != nullptr )
+                    ListPrgmSplits( *inf, entries, splitrefs, bakejobs, queuedbakes, cache );
+            }
+
+            //#2 - Bake the samples that aren't in the cache yet
+            vector<BakedSampleCache::BakedSample> baked(bakejobs.size());
+            utils::JobErrorList                   errors;
+            utils::RunIndexedJobs( bakejobs.size(), 
+                                   [&]( size_t cntjob )
+                                   {
+                                       const bakejob_t & job = bakejobs[cntjob];
+                                       baked[cntjob] = BakeSplit( *job.psplit, *job.psmpl, *job.psmplinf, *job.pprgm );
+                                   }, 
+                                   errors );
+            errors.ThrowIfAny("DSE::SampleProcessor::Process()");
+
+            for( const auto & queued : queuedbakes )
+                cache.Insert( queued.first, std::move(baked[queued.second]) );
+
+            //#3 - Assign the baked samples to their splits, in the original order
+            for( const auto & ref : splitrefs )
+            {
+                const BakedSampleCache::BakedSample * pbaked  = cache.Find(ref.key);
+                ProcessedPresets::PresetEntry       & entry   = entries[ref.entryindex];
+                const size_t                          curindex= entry.splitsamples.size(); //!#FIXME: Past me, what the fuck?
+                const DSE::SplitEntry               & split   = entry.prginf.m_splitstbl[ref.splitindex];
+                assert(pbaked != nullptr);
+
+                if( split.envon != 0 )
                 {
-                    ProcessAPrgm( *inf, processed );
+                    //Set envelope paramters to disabled, except the release, so we don't end up applying the SF2 envelope over the sample!
+                    entry.prginf.m_splitstbl[curindex].env.atkvol  = 0x00;
+                    entry.prginf.m_splitstbl[curindex].env.attack  = 0x00;
+                    entry.prginf.m_splitstbl[curindex].env.hold    = 0x00;
+                    entry.prginf.m_splitstbl[curindex].env.decay   = 0x00;
+                    entry.prginf.m_splitstbl[curindex].env.decay2  = 0x7F;
+                    entry.prginf.m_splitstbl[curindex].env.sustain = 0x7F;
                 }
+                else
+                {
+                    clog << "\nSampleID : " <<pbaked->smplinf.id <<" has its envelope disabled!\n";
+                }
+
+                entry.splitsamples.push_back( pbaked->pcm );
+                entry.splitsmplinf.push_back( pbaked->smplinf );
             }
+
+            ProcessedPresets processed;
+            for( auto & entry : entries )
+                processed.AddEntry( move(entry) );
             return move( processed );
         }
 
 
     private:
-        void ProcessAPrgm( const DSE::ProgramInfo & prgm, ProcessedPresets & processed )
+        //A split to fill with a baked sample once baking is done
+        struct splitref_t
+        {
+            size_t                  entryindex;
+            size_t                  splitindex;
+            BakedSampleCache::key_t key;
+        };
+
+        //A unique sample to bake
+        struct bakejob_t
+        {
+            const DSE::SplitEntry       * psplit;
+            const std::vector<uint8_t>  * psmpl;
+            const DSE::WavInfo          * psmplinf;
+            const DSE::ProgramInfo      * pprgm;
+        };
+
+        void ListPrgmSplits( const DSE::ProgramInfo                  & prgm, 
+                             vector<ProcessedPresets::PresetEntry>   & entries,
+                             vector<splitref_t>                      & splitrefs,
+                             vector<bakejob_t>                       & bakejobs,
+                             map<BakedSampleCache::key_t, size_t>    & queuedbakes,
+                             const BakedSampleCache                  & cache )
         {
-            ProcessedPresets::PresetEntry entry;
-            entry.prginf = prgm;
+            const size_t entryindex = entries.size();
+            entries.push_back( ProcessedPresets::PresetEntry() );
+            entries.back().prginf = prgm;
 
             int cntsplit = 0;
             for( const auto & split : prgm.m_splitstbl )
@@ -91,11 +277,22 @@ namespace DSE
 
                 if( psmpl != nullptr && psmplinf != nullptr )
                 {
-                    ProcessASplit2( entry, split, prgm.m_lfotbl, psmpl, psmplinf, prgm );
+                    splitref_t ref;
+                    ref.entryindex = entryindex;
+                    ref.splitindex = static_cast<size_t>(cntsplit);
+                    ref.key        = BakedSampleCache::MakeKey( split, prgm );
+
+                    if( cache.Find(ref.key) == nullptr && queuedbakes.find(ref.key) == queuedbakes.end() )
+                    {
+                        //The pointers refer to the program bank and sample bank, which outlive the bake jobs
+                        bakejob_t job{ &split, psmpl, psmplinf, &prgm };
+                        queuedbakes.emplace( ref.key, bakejobs.size() );
+                        bakejobs.push_back(job);
+                    }
+                    splitrefs.push_back(ref);
                 }
                 ++cntsplit;
             }
-            processed.AddEntry( move(entry) );
         }
 
         inline uint32_t CalcTotalEnveloppeDuration( const DSE::SplitEntry  & split )const
@@ -112,35 +309,33 @@ namespace DSE
         }
 
         /*
+            BakeSplit
+                Converts the sample used by a split, and bakes the split's envelope into it.
+                Only reads its parameters, so several splits can be baked at the same time.
+                Everything this reads from the split and program must be part of BakedSampleCache::key_t!
         */
-        void ProcessASplit2(ProcessedPresets::PresetEntry           & entry, 
-                            const DSE::SplitEntry                   & split, 
-                            const std::vector<DSE::LFOTblEntry>     & lfos,
-                            const std::vector<uint8_t>              * psmpl, 
-                            const DSE::WavInfo                      * psmplinf,
-                            const DSE::ProgramInfo                  & prgminf )
+        BakedSampleCache::BakedSample BakeSplit( const DSE::SplitEntry                   & split, 
+                                                 const std::vector<uint8_t>              & srcsmpl, 
+                                                 const DSE::WavInfo                      & srcsmplinf,
+                                                 const DSE::ProgramInfo                  & prgminf )
         {
-            const size_t    curindex               = entry.splitsamples.size(); //!#FIXME: Past me, what the fuck?
+            const DSE::WavInfo * psmplinf              = &srcsmplinf;
             const bool      IsSampleLooped         = psmplinf->smplloop != 0;
             const bool      ShouldUnloop           = ( split.env.sustain == 0 ) || ( split.env.decay2 != 0x7F );
-            const bool      ShouldRenderEnvAndLoop = !ShouldUnloop && IsSampleLooped;
             const uint32_t  envtotaldur            = CalcTotalEnveloppeDuration(split);
             const uint32_t  envtotaldursmpl        = MsecToNbSamples( psmplinf->smplrate, envtotaldur );
 
             // --- Convert Sample ----
             DSESampleConvertionInfo postconvloop; //The loop points after conversion
-            
-            //entry.splitsamples.push_back( move( ConvertAndLoopSample( *psmpl, static_cast<uint16_t>(psmplinf->smplfmt), psmplinf->loopbeg, psmplinf->looplen, 1, postconvloop ) ) );
-            entry.splitsamples.push_back( move( ConvertSample( *psmpl, static_cast<uint16_t>(psmplinf->smplfmt), psmplinf->loopbeg, postconvloop ) ) );
-            
-            entry.splitsmplinf.push_back( *psmplinf ); //Copy sample info #FIXME: maybe get a custom way to store the relevant data for loop points and sample rate instead ?
-            const size_t    SampleLenPreLengthen = entry.splitsamples[curindex].size();
+            vector<int16_t>         pcm     = ConvertSample( srcsmpl, static_cast<uint16_t>(psmplinf->smplfmt), psmplinf->loopbeg, postconvloop );
+            DSE::WavInfo            smplinf = *psmplinf; //Copy sample info #FIXME: maybe get a custom way to store the relevant data for loop points and sample rate instead ?
+            const size_t            SampleLenPreLengthen = pcm.size();
 
-            entry.splitsmplinf[curindex].smplfmt = eDSESmplFmt::pcm16;
+            smplinf.smplfmt = eDSESmplFmt::pcm16;
 
             //Update Loop info
-            entry.splitsmplinf[curindex].loopbeg  = postconvloop.loopbeg_;
-            entry.splitsmplinf[curindex].looplen  = postconvloop.loopend_ - postconvloop.loopbeg_;
+            smplinf.loopbeg  = postconvloop.loopbeg_;
+            smplinf.looplen  = postconvloop.loopend_ - postconvloop.loopbeg_;
 
             // ---- Handle Enveloppe ----
             if( split.envon != 0 )
@@ -154,138 +349,90 @@ namespace DSE
                     if( ShouldUnloop )
                     {
                         //Loop the sample a few times, so its as long as the envelope
-                        if( envtotaldursmpl > entry.splitsamples[curindex].size() )
-                            Lenghten( entry.splitsamples[curindex], envtotaldursmpl, postconvloop );
-
-            ////!###TEST####
-            //const bool bispcm16                   = (psmplinf->smplfmt == eDSESmplFmt::pcm16);
-            //uint32_t   presmplrate                = psmplinf->smplrate;
-            //uint32_t   Newsmplrate                = std::lround((static_cast<double>(entry.splitsamples[curindex].size()) / static_cast<double>(SampleLenPreLengthen)) / 100.0) * presmplrate;
-            //if( bispcm16 )
-            //    entry.splitsmplinf[curindex].smplrate = Newsmplrate;
-            ////!###TEST####
+                        if( envtotaldursmpl > pcm.size() )
+                            Lenghten( pcm, envtotaldursmpl, postconvloop );
 
                         //We render the envelope and disable looping
-                        ApplyEnveloppe( entry.splitsamples[curindex], split.env, psmplinf->smplrate, volumeFactor );
-                        entry.splitsmplinf[curindex].smplloop = 0;
+                        ApplyEnveloppe( pcm, split.env, psmplinf->smplrate, volumeFactor );
+                        smplinf.smplloop = 0;
                     }
                     else
                     {
                         //Loop the sample a few times, so its as long as the envelope
-                        if( envtotaldursmpl > entry.splitsamples[curindex].size() )
+                        if( envtotaldursmpl > pcm.size() )
                         {
                             int          nbextraloops = 0;
-                            const size_t durtoloop    = envtotaldursmpl - SampleLenPreLengthen; //entry.splitsmplinf[curindex].loopbeg;
-                            //const size_t resultinglength  = envtotaldursmpl + ( durofunloopedenv % entry.splitsmplinf[curindex].looplen );
+                            const size_t durtoloop    = envtotaldursmpl - SampleLenPreLengthen;
                             
-                            if( ( durtoloop % entry.splitsmplinf[curindex].looplen ) != 0 )
-                                nbextraloops = (durtoloop / entry.splitsmplinf[curindex].looplen) + 1;
+                            if( ( durtoloop % smplinf.looplen ) != 0 )
+                                nbextraloops = (durtoloop / smplinf.looplen) + 1;
                             else
-                                nbextraloops = (durtoloop / entry.splitsmplinf[curindex].looplen);
+                                nbextraloops = (durtoloop / smplinf.looplen);
 
-                            LenghtenByNbLoops( entry.splitsamples[curindex], nbextraloops, postconvloop );
+                            LenghtenByNbLoops( pcm, nbextraloops, postconvloop );
 
                             //Make sure the sample ends only after fully completing its last loop, this will keep 
                             // the sample from clicking/abruptly cutting to the loop.
                         }
 
                         //Save the length of the sample after making it longer, since it differ from "envtotaldursmpl"
-                        const size_t actualnewloopbeg = entry.splitsamples[curindex].size();
+                        const size_t actualnewloopbeg = pcm.size();
 
                         //We copy one loop to the end, render the envelope, Move the loop to the end past the decay phase, and keep looping on.
-                        LenghtenByNbLoops( entry.splitsamples[curindex], 1, postconvloop );
-                        ApplyEnveloppe( entry.splitsamples[curindex], split.env, psmplinf->smplrate, volumeFactor );
-
-
-                        ////!###Test release###
-                        //size_t    releasebeg     = entry.splitsamples[curindex].size();
-                        //size_t    nbreleaselp    = 0;
-                        //const int releasenbsmpls = MsecToNbSamples( psmplinf->smplrate,
-                        //                                            DSEEnveloppeDurationToMSec( static_cast<int8_t>(split.env.release), 
-                        //                                                                        static_cast<int8_t>(split.env.envmulti)));
-                        //if( ( releasenbsmpls % entry.splitsmplinf[curindex].looplen ) != 0 )
-                        //    nbreleaselp = (releasenbsmpls / entry.splitsmplinf[curindex].looplen) + 1;
-                        //else
-                        //    nbreleaselp = (releasenbsmpls / entry.splitsmplinf[curindex].looplen);
-                        //
-                        //LenghtenByNbLoops( entry.splitsamples[curindex], nbreleaselp, postconvloop );
-
-                        //const double sustainlvl   = ( ( (static_cast<double>(split.env.sustain) * 100.0 ) / 128.0 ) / 100.0) * split.env.envmulti;
-                        //if( split.env.decay2 == 0x7F )
-                        //    LerpVol( releasebeg, releasenbsmpls, sustainlvl, 0.0, entry.splitsamples[curindex] ); 
-                        ////!###Test release###
-
-
-            ////!###TEST####
-            //const bool bispcm16                   = (psmplinf->smplfmt == eDSESmplFmt::pcm16);
-            //uint32_t   presmplrate                = psmplinf->smplrate;
-            //double     oldratio                   = static_cast<double>(SampleLenPreLengthen)                / static_cast<double>(presmplrate);
-            //double     newratio                   = static_cast<double>(entry.splitsamples[curindex].size()) / static_cast<double>(presmplrate);
-            //uint32_t   Newsmplrate                = std::lround(( static_cast<double>(entry.splitsamples[curindex].size())) *  fabs( oldratio ) );
-            //if( bispcm16 )
-            //    entry.splitsmplinf[curindex].smplrate = Newsmplrate;
-            ////!###TEST####
+                        LenghtenByNbLoops( pcm, 1, postconvloop );
+                        ApplyEnveloppe( pcm, split.env, psmplinf->smplrate, volumeFactor );
 
                         //Move the loop to the end
-                        entry.splitsmplinf[curindex].loopbeg = (actualnewloopbeg > SampleLenPreLengthen)? actualnewloopbeg : SampleLenPreLengthen;
+                        smplinf.loopbeg = (actualnewloopbeg > SampleLenPreLengthen)? actualnewloopbeg : SampleLenPreLengthen;
                     }
                     }
                 }
                 else
                 {
                     //Render envelope only
-                    ApplyEnveloppe( entry.splitsamples[curindex], split.env, psmplinf->smplrate, volumeFactor );
+                    ApplyEnveloppe( pcm, split.env, psmplinf->smplrate, volumeFactor );
                 }
-
-                //Set envelope paramters to disabled, except the release, so we don't end up applying the SF2 envelope over the sample!
-                entry.prginf.m_splitstbl[curindex].env.atkvol  = 0x00;
-                entry.prginf.m_splitstbl[curindex].env.attack  = 0x00;
-                entry.prginf.m_splitstbl[curindex].env.hold    = 0x00;
-                entry.prginf.m_splitstbl[curindex].env.decay   = 0x00;
-                entry.prginf.m_splitstbl[curindex].env.decay2  = 0x7F;
-                entry.prginf.m_splitstbl[curindex].env.sustain = 0x7F;
-            }
-            else
-            {
-                clog << "\nSampleID : " <<psmplinf->id <<" has its envelope disabled!\n";
             }
 
             // ---- Extra Processing ----
             if( ShouldResample() && m_desiredsmplrate != psmplinf->smplrate )
             {
-                const size_t smplszbefresample = entry.splitsamples[curindex].size();
                 DSESampleConvertionInfo postresampleloop;
-                postresampleloop.loopbeg_ = entry.splitsmplinf[curindex].loopbeg;
-                postresampleloop.loopend_ = (entry.splitsmplinf[curindex].loopbeg + entry.splitsmplinf[curindex].looplen);
+                postresampleloop.loopbeg_ = smplinf.loopbeg;
+                postresampleloop.loopend_ = (smplinf.loopbeg + smplinf.looplen);
 
-                if( Resample( entry.splitsamples[curindex], psmplinf->smplrate, m_desiredsmplrate, postresampleloop ) )
+                if( Resample( pcm, psmplinf->smplrate, m_desiredsmplrate, (smplinf.smplloop != 0), postresampleloop ) )
                 {
                     //Update loop points
-                    entry.splitsmplinf[curindex].loopbeg = postresampleloop.loopbeg_;
+                    smplinf.loopbeg = postresampleloop.loopbeg_;
 
-                    if( postresampleloop.loopend_ > entry.splitsamples[curindex].size() )
-                        postresampleloop.loopend_ = entry.splitsamples[curindex].size();
+                    if( postresampleloop.loopend_ > pcm.size() )
+                        postresampleloop.loopend_ = pcm.size();
 
-                    entry.splitsmplinf[curindex].looplen = (postresampleloop.loopend_ - postresampleloop.loopbeg_);
-
-                    const size_t szafterfix = ( entry.splitsmplinf[curindex].looplen + entry.splitsmplinf[curindex].loopbeg );
+                    smplinf.looplen = (postresampleloop.loopend_ - postresampleloop.loopbeg_);
 
 #ifdef DEBUG
-                    assert( ( szafterfix < entry.splitsamples[curindex].size() ) );
+                    const size_t szafterfix = ( smplinf.looplen + smplinf.loopbeg );
+                    assert( ( szafterfix < pcm.size() ) );
 #endif
 
                     //Update sample rate info
-                    entry.splitsmplinf[curindex].smplrate = m_desiredsmplrate;
+                    smplinf.smplrate = m_desiredsmplrate;
                 }
             }
             if( ShouldApplyFilters() )
             {
-                ApplyFilters( entry.splitsamples[curindex], entry.splitsmplinf[curindex].smplrate );
+                ApplyFilters( pcm, smplinf.smplrate );
             }
             if( ShouldApplyFx() )
             {
-                ApplyFx( entry.splitsamples[curindex], entry.splitsmplinf[curindex].smplrate, lfos );
+                ApplyFx( pcm, smplinf.smplrate, prgminf.m_lfotbl );
             }
+
+            BakedSampleCache::BakedSample result;
+            result.pcm     = std::make_shared<const vector<int16_t>>( std::move(pcm) );
+            result.smplinf = smplinf;
+            return std::move(result);
         }
 
         /*
@@ -315,22 +462,10 @@ namespace DSE
         */
         void Lenghten( vector<int16_t> & smpl, size_t destlen, const DSESampleConvertionInfo & loopinf )
         {
-            //Pre-alloc
-            smpl.reserve( destlen );
-
-            //Copy samples from the loop, to the end of the entire sample, until we reach the desired amount of samples
-            size_t cntsrcsmpl = loopinf.loopbeg_;
-            for( size_t cntsmpltocpy = smpl.size(); cntsmpltocpy < destlen; ++cntsmpltocpy )
-            {
-                //Append sample to the end
-                smpl.push_back( smpl[cntsrcsmpl] );
-
-                //Loop our source when we get to the end of the loop 
-                if( cntsrcsmpl < loopinf.loopend_ )
-                    ++cntsrcsmpl;
-                else
-                    cntsrcsmpl = loopinf.loopbeg_;
-            }
+            //Copy samples from the loop, to the end of the entire sample, until we reach the desired amount of samples.
+            // The sample at "loopend_" is part of the copied loop.
+            const size_t looplen = (loopinf.loopend_ > loopinf.loopbeg_)? (loopinf.loopend_ - loopinf.loopbeg_ + 1) : 1;
+            ReplicateLoop( smpl, loopinf.loopbeg_, looplen, destlen );
 
             //Smooth the loop points #TODO
         }
@@ -340,18 +475,13 @@ namespace DSE
         */
         void LenghtenByNbLoops( vector<int16_t> & smpl, int nbloops, const DSESampleConvertionInfo & loopinf )
         {
-            const size_t looplen     = (loopinf.loopend_ - loopinf.loopbeg_);
-            const size_t targetlen   = loopinf.loopbeg_ + ( (nbloops+1) * looplen );
             const size_t origsmpllen = smpl.size();
+            if( nbloops <= 0 || loopinf.loopbeg_ >= origsmpllen )
+                return;
 
-            //Pre-alloc
-            smpl.reserve( targetlen );
-            
-            for( int cntloop = 0; cntloop < nbloops; ++cntloop )
-            {
-                for( size_t cntsmpls = loopinf.loopbeg_; cntsmpls < origsmpllen; ++cntsmpls )
-                    smpl.push_back( smpl[cntsmpls] );
-            }
+            //Everything from the loop start to the end of the sample is copied
+            const size_t looplen = origsmpllen - loopinf.loopbeg_;
+            ReplicateLoop( smpl, loopinf.loopbeg_, looplen, origsmpllen + (static_cast<size_t>(nbloops) * looplen) );
         }
         //{
         //    const size_t looplen   = (loopinf.loopend_ - loopinf.loopbeg_);
@@ -392,6 +522,7 @@ namespace DSE
             const int holdnbsmpls = MsecToNbSamples( smplrate, DSEEnveloppeDurationToMSec( static_cast<int8_t>(env.hold), 
                                                                                            static_cast<int8_t>(env.envmulti) ) );
             const int holdend     = holdbeg + holdnbsmpls;
+            LerpVol( holdbeg, holdend, MaxVol, MaxVol, smpl );
 
             //Decay
             const int    decaybeg     = holdend;
@@ -421,124 +552,45 @@ namespace DSE
             //Release is left to the sampler to process
         }
 
+        /*
+            Scale the volume of the samples in the [begsmpl, endsmpl) range, going linearly from "initvol" to "destvol".
+        */
         void LerpVol( size_t begsmpl, size_t endsmpl, double initvol, double destvol, vector<int16_t> & smpl )
         {
-            if( initvol != destvol )
-            {
-                //Lerp the volume between the two values
-                size_t dist        = endsmpl - begsmpl;
-                double rate        = (destvol - initvol) / dist;
-                double curvolratio = initvol;
-
-                for( size_t cntlerp = begsmpl; cntlerp < endsmpl && cntlerp < smpl.size(); ++cntlerp )
-                {
-                    double scaledsmpl = lround( smpl[cntlerp] * curvolratio );
+            const size_t lastsmpl = std::min( endsmpl, smpl.size() );
+            if( begsmpl >= lastsmpl )
+                return;
 
-                    //Clamp
-                    if( scaledsmpl > SHRT_MAX )
-                        scaledsmpl = SHRT_MAX;
-                    else if( scaledsmpl < SHRT_MIN )
-                        scaledsmpl = SHRT_MIN;
-
-                    smpl[cntlerp] = static_cast<int16_t>( scaledsmpl );
-                    curvolratio  += rate;
-                }
-            }
-            else
-            {
-                //If there's no differences, just set everything to the same volume
-                for( size_t cntlerp = begsmpl; cntlerp < endsmpl; ++cntlerp )
-                {
-                    double scaledsmpl = lround( smpl[cntlerp] * destvol );
-
-                    //Clamp
-                    if( scaledsmpl > SHRT_MAX )
-                        scaledsmpl = SHRT_MAX;
-                    else if( scaledsmpl < SHRT_MIN )
-                        scaledsmpl = SHRT_MIN;
-
-                    smpl[cntlerp] = static_cast<int16_t>( scaledsmpl );
-                }
-            }
+            const double rate = (initvol != destvol)? ((destvol - initvol) / (endsmpl - begsmpl)) : 0.0;
+            ApplyGainRamp( smpl.data() + begsmpl, lastsmpl - begsmpl, initvol, rate );
         }
 
         /*
             Resample the sample.
+            When the sample is looped, the loop is kept seamless, and the loop points in "inout_newloop" 
+            are moved to their position in the resampled sample.
         */
-        bool Resample( vector<int16_t> & smpl, int origsamplrte, int destsamplrte, DSESampleConvertionInfo & inout_newloop )
-        { return false; }
-    //        r8b::CDSPResampler16 resampler( origsamplrte, destsamplrte, smpl.size() );
-    //        vector<double>       tempbuf;
-    //        tempbuf.reserve( smpl.size() );
-
-    //        for( const auto sp : smpl )
-    //            tempbuf.push_back( sp );
-
-    //        double *ptrout = nullptr;
-    //        int     szresampled = 0;
-    //        
-    //        //#FIXME : Ugh, so I can't find any info on how to preserve loop points after resampling for some reasons(thanks google) 
-    //        //          so, I'll do this by doing some extra useless work here.
-    //        if( inout_newloop.loopbeg_ != 0 )
-    //        {
-    //            const uint32_t oldloopbeg = inout_newloop.loopbeg_;
-    //            const uint32_t oldlooplen = (inout_newloop.loopend_ - inout_newloop.loopbeg_);
-    //            vector<int16_t> asmsmplbuff;
-    //            auto            backins = std::back_inserter(asmsmplbuff);
-
-    //            //Loop beg
-    //            szresampled = resampler.process( tempbuf.data(), inout_newloop.loopbeg_, ptrout );
-    //            if( szresampled > 0 && ptrout != nullptr )
-    //            {
-    //                inout_newloop.loopbeg_ = szresampled;
-    //                std::copy_n( ptrout, szresampled, backins );
-    //            }
-    //            else
-    //                return false;
-
-    //            //Loop length
-    //            szresampled = resampler.process( (tempbuf.data() + oldloopbeg), 
-    //                                             oldlooplen, 
-    //                                             ptrout );
-    //            if( szresampled > 0 && ptrout != nullptr )
-    //            {
-    //                inout_newloop.loopend_ = inout_newloop.loopbeg_ + szresampled;
-    //                std::copy_n( ptrout, szresampled, backins );
-    //            }
-    //            else
-    //                return false;
-
-    //            //Reset everything 
-    //            //ptrout      = nullptr; //The resampler class owns the content pointed to, so we can safely set this to null
-    //            //szresampled = 0;
-
-    //            smpl = std::move(asmsmplbuff);
-    //            return true;
-    //        }
-    //        else
-    //        {
-    //            szresampled = resampler.process( tempbuf.data(), tempbuf.size(), ptrout );
-
-    //            if( szresampled > 0 && ptrout != nullptr )
-    //            {
-    //                smpl.resize(szresampled);
-
-    //                for( size_t i = 0; i < smpl.size(); ++i )
-    //                    smpl[i] = ptrout[i];
-
-    //                return true;
-    //            }
-    //            else
-    //            {
-    //                clog << "DSE::SampleProcessor::Resample(): Error, resampling failed! (" <<origsamplrte <<", " <<destsamplrte <<")\n";
-    //#ifdef DEBUG
-    //                assert(false);
-    //#endif
-    //                return false;
-    //            }
-    //        }
-    //    }
+        bool Resample( vector<int16_t> & smpl, int origsamplrte, int destsamplrte, bool bisloop, DSESampleConvertionInfo & inout_newloop )
+        {
+            if( origsamplrte <= 0 || destsamplrte <= 0 )
+            {
+                clog << "DSE::SampleProcessor::Resample(): Error, invalid sample rates! (" <<origsamplrte <<", " <<destsamplrte <<")\n";
+                return false;
+            }
+            if( origsamplrte == destsamplrte )
+                return true;
 
+            auto presampler = utils::PolyphaseResampler::Get( static_cast<uint32_t>(origsamplrte), static_cast<uint32_t>(destsamplrte) );
+            if( bisloop )
+                smpl = presampler->Resample( smpl, inout_newloop.loopbeg_, inout_newloop.loopend_ );
+            else
+            {
+                inout_newloop.loopbeg_ = presampler->ConvertLength( inout_newloop.loopbeg_ );
+                inout_newloop.loopend_ = presampler->ConvertLength( inout_newloop.loopend_ );
+                smpl = presampler->Resample( smpl );
+            }
+            return true;
+        }
 
         /*
         */
@@ -586,9 +638,37 @@ namespace DSE
 //  Functions
 //=========================================================================================
 
-    DSE::ProcessedPresets ProcessDSESamples( const DSE::SampleBank &srcsmpl, const DSE::ProgramBank & prestoproc, int desiredsmplrate, bool bakeenv )
+    bool BakedSampleCache::key_t::operator<( const key_t & other )const
+    {
+        return std::tie( smplid, envon, prgvol, smplvol, envmulti, atkvol, sustain, attack, hold, decay, decay2 ) <
+               std::tie( other.smplid, other.envon, other.prgvol, other.smplvol, other.envmulti, other.atkvol, other.sustain, 
+                         other.attack, other.hold, other.decay, other.decay2 );
+    }
+
+    BakedSampleCache::key_t BakedSampleCache::MakeKey( const DSE::SplitEntry & split, const DSE::ProgramInfo & prgm )
+    {
+        key_t key;
+        key.smplid = split.smplid;
+        key.envon  = split.envon;
+        if( split.envon != 0 )
+        {
+            //The release isn't baked, the sampler handles it
+            key.prgvol   = prgm.prgvol;
+            key.smplvol  = split.smplvol;
+            key.envmulti = split.env.envmulti;
+            key.atkvol   = split.env.atkvol;
+            key.sustain  = split.env.sustain;
+            key.attack   = split.env.attack;
+            key.hold     = split.env.hold;
+            key.decay    = split.env.decay;
+            key.decay2   = split.env.decay2;
+        }
+        return key;
+    }
+
+    DSE::ProcessedPresets ProcessDSESamples( const DSE::SampleBank &srcsmpl, const DSE::ProgramBank & prestoproc, int desiredsmplrate, bool bakeenv, BakedSampleCache * pcache )
     {
-        return move( SampleProcessor( srcsmpl, desiredsmplrate, bakeenv ).Process(prestoproc) );
+        return move( SampleProcessor( srcsmpl, desiredsmplrate, bakeenv ).Process(prestoproc, pcache) );
     }
 
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "midi_fmtrule.hpp"
 #include <cstdint>
 #include <utils/gbyteutils.hpp>
+#include <iterator>
 using namespace std;
 
 static const uint32_t MIDI_MagicNum = 0x4D546864;
@@ -62,6 +63,13 @@ static const uint32_t MIDI_MagicNum = 0x4D546864;
                 return (utils::ReadIntFromBytes<uint32_t>(itdatabeg, itdataend, false) == MIDI_MagicNum);
             }
 
+            virtual std::vector<uint8_t> getMagicNumber()const
+            {
+                std::vector<uint8_t> magic;
+                utils::WriteIntToBytes( MIDI_MagicNum, std::back_inserter(magic), false );
+                return std::move(magic);
+            }
+
         private:
             cntRID_t m_myID;
         };
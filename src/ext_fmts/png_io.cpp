@@ -3,8 +3,10 @@
 #include <ppmdu/pmd2/pmd2_palettes.hpp>
 #include <utils/library_wide.hpp>
 #include <utils/handymath.hpp>
+#include <utils/async_file_sink.hpp>
 #include <png++/png.hpp>
 #include <iostream>
+#include <mutex>
 using namespace std;
 
 namespace utils{ namespace io
@@ -45,6 +47,270 @@ namespace utils{ namespace io
         return std::move(palette);
     }
 
+//==============================================================================================
+//  Encoding Settings
+//==============================================================================================
+    namespace
+    {
+        //zlib's values, which libpng passes along as-is. zlib's header isn't in the include paths.
+        const int ZDefaultCompression = -1;
+        const int ZNoCompression      = 0;
+        const int ZBestSpeed          = 1;
+        const int ZBestCompression    = 9;
+        const int ZRLE                = 3;
+
+        std::mutex         s_mtxsettings;
+        PNG_EncodeSettings s_encsettings;
+    };
+
+    PNG_EncodeSettings PNG_EncodeSettings::Store()
+    {
+        PNG_EncodeSettings settings;
+        settings.complevel = ZNoCompression;
+        settings.filters   = eFilters::None;
+        return settings;
+    }
+
+    PNG_EncodeSettings PNG_EncodeSettings::Fast()
+    {
+        PNG_EncodeSettings settings;
+        settings.complevel = ZBestSpeed;
+        settings.filters   = eFilters::None;
+        settings.strategy  = eStrategy::RLE;
+        return settings;
+    }
+
+    PNG_EncodeSettings PNG_EncodeSettings::Default()
+    {
+        return PNG_EncodeSettings();
+    }
+
+    PNG_EncodeSettings PNG_EncodeSettings::Best()
+    {
+        PNG_EncodeSettings settings;
+        settings.complevel = ZBestCompression;
+        settings.filters   = eFilters::Adaptive;
+        return settings;
+    }
+
+    void SetPNGEncodeSettings( const PNG_EncodeSettings & settings )
+    {
+        std::lock_guard<std::mutex> lck(s_mtxsettings);
+        s_encsettings = settings;
+    }
+
+    PNG_EncodeSettings GetPNGEncodeSettings()
+    {
+        std::lock_guard<std::mutex> lck(s_mtxsettings);
+        return s_encsettings;
+    }
+
+    bool ParsePNGEncodeSettings( const std::string & str, PNG_EncodeSettings & out_settings )
+    {
+        if( str == "store" )
+            out_settings = PNG_EncodeSettings::Store();
+        else if( str == "fast" )
+            out_settings = PNG_EncodeSettings::Fast();
+        else if( str == "default" )
+            out_settings = PNG_EncodeSettings::Default();
+        else if( str == "best" )
+            out_settings = PNG_EncodeSettings::Best();
+        else if( str.size() == 1 && str.front() >= '0' && str.front() <= '9' )
+        {
+            out_settings           = PNG_EncodeSettings::Default();
+            out_settings.complevel = str.front() - '0';
+        }
+        else
+            return false;
+        return true;
+    }
+
+//==============================================================================================
+//  PNG Encoder
+//==============================================================================================
+    /*
+        PNGEncoder
+            Encodes PNGs into memory, row by row, with the current encoding settings.
+            There's one per thread, so the row and output buffers, and the last converted palette are reused
+            from one image to the next, instead of building a whole png::image for each export.
+    */
+    class PNGEncoder
+    {
+        //The minimal output stream interface png::writer needs, appending to a byte vector.
+        struct vecostream
+        {
+            std::vector<uint8_t> & out;
+            inline void write( const char * pdata, size_t len ) { out.insert( out.end(), pdata, pdata + len ); }
+            inline bool good()const { return true; }
+            inline void flush()     {}
+        };
+
+    public:
+        //Buffers bigger than this aren't kept around between images
+        static const size_t MaxKeptBufferLen = 4 * 1024 * 1024;
+
+        static PNGEncoder & ThreadInstance()
+        {
+            thread_local PNGEncoder encoder;
+            return encoder;
+        }
+
+        /*
+            Encode
+                Encodes a "width" x "height" image. "fillrow" is called with the index of each row, in order, and
+                a pointer to the buffer to fill with the row's packed pixels.
+                "ppal" is only used for paletted images.
+                The returned buffer is only valid until the next image encoded on this thread.
+        */
+        template<class _RowFillFn>
+            const std::vector<uint8_t> & Encode( unsigned int                          width,
+                                                 unsigned int                          height,
+                                                 png::color_type                       colortype,
+                                                 unsigned int                          bitdepth,
+                                                 const std::vector<gimg::colorRGB24> * ppal,
+                                                 _RowFillFn                         && fillrow )
+        {
+            ReleaseBigBuffers();
+            m_out.clear();
+            vecostream               outstr{m_out};
+            png::writer<vecostream>  wr(outstr);
+
+            wr.set_width     (width);
+            wr.set_height    (height);
+            wr.set_color_type(colortype);
+            wr.set_bit_depth (bitdepth);
+            if( ppal )
+                wr.get_info().set_palette( ConvertPalette(*ppal) );
+            ApplySettings( wr.get_png_struct(), GetPNGEncodeSettings() );
+            wr.write_info();
+
+            const size_t nbchannels = (colortype == png::color_type_rgba)? 4 : (colortype == png::color_type_rgb)? 3 : 1;
+            m_row.resize( (static_cast<size_t>(width) * nbchannels * bitdepth + 7) / 8 );
+            for( unsigned int y = 0; y < height; ++y )
+            {
+                fillrow( y, m_row.data() );
+                wr.write_row( m_row.data() );
+            }
+            wr.write_end_info();
+            return m_out;
+        }
+
+    private:
+        PNGEncoder(){}
+        PNGEncoder( const PNGEncoder & ) = delete;
+        PNGEncoder & operator=( const PNGEncoder & ) = delete;
+
+        //Most exports of a given set of images share the same palette, so the last one is kept.
+        const png::palette & ConvertPalette( const std::vector<gimg::colorRGB24> & srcpal )
+        {
+            bool bsame = (srcpal.size() == m_lastsrcpal.size());
+            for( size_t i = 0; bsame && i < srcpal.size(); ++i )
+            {
+                bsame = srcpal[i].red   == m_lastsrcpal[i].red   &&
+                        srcpal[i].green == m_lastsrcpal[i].green &&
+                        srcpal[i].blue  == m_lastsrcpal[i].blue;
+            }
+
+            if( !bsame )
+            {
+                m_lastsrcpal = srcpal;
+                m_lastpngpal = PalToPngPal(srcpal);
+            }
+            return m_lastpngpal;
+        }
+
+        static void ApplySettings( png_struct * ppng, const PNG_EncodeSettings & settings )
+        {
+            png_set_compression_level( ppng, (settings.complevel >= ZNoCompression && settings.complevel <= ZBestCompression)?
+                                                settings.complevel : ZDefaultCompression );
+            //Leave the strategy alone otherwise. libpng picks Z_FILTERED by itself when rows are filtered.
+            if( settings.strategy == PNG_EncodeSettings::eStrategy::RLE )
+                png_set_compression_strategy( ppng, ZRLE );
+
+            if( settings.filters == PNG_EncodeSettings::eFilters::None )
+                png_set_filter( ppng, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE );
+            else if( settings.filters == PNG_EncodeSettings::eFilters::Adaptive )
+                png_set_filter( ppng, PNG_FILTER_TYPE_BASE, PNG_ALL_FILTERS );
+        }
+
+        void ReleaseBigBuffers()
+        {
+            if( m_out.capacity() > MaxKeptBufferLen )
+                std::vector<uint8_t>().swap(m_out);
+            if( m_row.capacity() > MaxKeptBufferLen )
+                std::vector<uint8_t>().swap(m_row);
+        }
+
+    private:
+        std::vector<uint8_t>          m_out;
+        std::vector<uint8_t>          m_row;
+        std::vector<gimg::colorRGB24> m_lastsrcpal;
+        png::palette                  m_lastpngpal;
+    };
+
+    /*
+        EncodeAndWritePNG
+            Encodes the image on this thread's encoder, and hands the result to the active file sink if there's one,
+            or writes it right away otherwise.
+    */
+    template<class _RowFillFn>
+        bool EncodeAndWritePNG( const std::string                     & filepath,
+                                unsigned int                            width,
+                                unsigned int                            height,
+                                png::color_type                         colortype,
+                                unsigned int                            bitdepth,
+                                const std::vector<gimg::colorRGB24>   * ppal,
+                                _RowFillFn                           && fillrow )
+    {
+        try
+        {
+            const std::vector<uint8_t> & encoded = PNGEncoder::ThreadInstance().Encode( width, height, colortype, bitdepth, ppal, 
+                                                                                          std::forward<_RowFillFn>(fillrow) );
+            utils::WriteFileBehind( filepath, std::vector<uint8_t>( encoded.begin(), encoded.end() ) );
+        }
+        catch( const std::exception & e )
+        {
+            cerr << "<!>- Error outputing image : " << filepath <<"\n"
+                 << "     Exception details : \n"     
+                 << "        " <<e.what()  <<"\n";
+            return false;
+        }
+        return true;
+    }
+
+    /*
+        FillTiledImgRow
+            Packs the pixels of row "y" of a tiled image, from column "begX" to "begX + width", into a PNG row.
+            Reads the pixels tile by tile, instead of looking up the tile of every single pixel.
+    */
+    template<class _TImgTy>
+        void FillTiledImgRow( const _TImgTy & img, unsigned int y, unsigned int begX, unsigned int width, unsigned int bitdepth, uint8_t * prow )
+    {
+        typedef typename _TImgTy::tile_t tile_t;
+        const unsigned int tilerow = y / tile_t::HEIGHT;
+        const unsigned int tiley   = y % tile_t::HEIGHT;
+
+        for( unsigned int x = 0; x < width; )
+        {
+            const unsigned int srcx = begX + x;
+            const tile_t     & tile = img.getTile( srcx / tile_t::WIDTH, tilerow );
+
+            for( unsigned int tilex = srcx % tile_t::WIDTH; tilex < tile_t::WIDTH && x < width; ++tilex, ++x )
+            {
+                const uint8_t pixval = static_cast<uint8_t>( tile.getPixel( tilex, tiley ).getWholePixelData() );
+                if( bitdepth == 4 )
+                {
+                    if( (x & 1) == 0 )
+                        prow[x / 2] = static_cast<uint8_t>( (pixval & 0xF) << 4 );
+                    else
+                        prow[x / 2] |= (pixval & 0xF);
+                }
+                else
+                    prow[x] = pixval;
+            }
+        }
+    }
+
 //
 // Read an indexed png of a specific bitdepth
 //
@@ -179,46 +445,10 @@ namespace utils{ namespace io
     bool ExportTo4bppPNG( const gimg::tiled_image_i4bpp  & in_indexed,
                           const std::string              & filepath )
     {
-        png::image<png::index_pixel_4> output;
-        //png::palette                   palette(in_indexed.getNbColors());
-
-        ////copy palette
-        //for( unsigned int i = 0; i < palette.size(); ++i )
-        //{
-        //    palette[i].red   = in_indexed.getPalette()[i].red;
-        //    palette[i].green = in_indexed.getPalette()[i].green;
-        //    palette[i].blue  = in_indexed.getPalette()[i].blue;
-        //}
-        output.set_palette( PalToPngPal(in_indexed.getPalette()) );
-
-        //Copy image
-        output.resize( in_indexed.getNbPixelWidth(), in_indexed.getNbPixelHeight() );
-
-        for( unsigned int i = 0; i < output.get_width(); ++i )
-        {
-            for( unsigned int j = 0; j < output.get_height(); ++j )
-            {
-                auto &  refpixel = in_indexed.getPixel( i, j );
-                uint8_t temp     = static_cast<uint8_t>( refpixel.getWholePixelData() );
-                //output[j][i] = png::index_pixel_4( temp );
-                output.set_pixel( i,j, temp ); //If only one component returns the entire pixel data
-            }
-        }
-
-        try
-        {
-            output.write( filepath );
-        }
-        catch( const std::exception & e )
-        {
-            cerr << "<!>- Error outputing image : " << filepath <<"\n"
-                 << "     Exception details : \n"     
-                 << "        " <<e.what()  <<"\n";
-
-            assert(false);
-            return false;
-        }
-        return true;
+        const unsigned int width  = in_indexed.getNbPixelWidth();
+        const unsigned int height = in_indexed.getNbPixelHeight();
+        return EncodeAndWritePNG( filepath, width, height, png::color_type_palette, 4, &in_indexed.getPalette(),
+                                  [&]( unsigned int y, uint8_t * prow ){ FillTiledImgRow( in_indexed, y, 0, width, 4, prow ); } );
     }
 
 //==============================================================================================
@@ -251,32 +481,10 @@ namespace utils{ namespace io
     bool ExportTo8bppPNG( const gimg::tiled_image_i8bpp & in_indexed,
                           const std::string             & filepath )
     {
-        png::image<png::index_pixel> output;
-        output.set_palette( PalToPngPal(in_indexed.getPalette()) );
-
-        //Copy image
-        output.resize( in_indexed.getNbPixelWidth(), in_indexed.getNbPixelHeight() );
-
-        for( unsigned int i = 0; i < output.get_width(); ++i )
-        {
-            for( unsigned int j = 0; j < output.get_height(); ++j )
-                output.set_pixel( i,j, static_cast<uint8_t>( in_indexed.getPixel( i, j ).getWholePixelData() ) ); //If only one component returns the entire pixel data
-        }
-
-        try
-        {
-            output.write( filepath );
-        }
-        catch( const std::exception & e )
-        {
-            cerr << "<!>- Error outputing image : " << filepath <<"\n"
-                 << "     Exception details : \n"     
-                 << "        " <<e.what()  <<"\n";
-
-            assert(false);
-            return false;
-        }
-        return true;
+        const unsigned int width  = in_indexed.getNbPixelWidth();
+        const unsigned int height = in_indexed.getNbPixelHeight();
+        return EncodeAndWritePNG( filepath, width, height, png::color_type_palette, 8, &in_indexed.getPalette(),
+                                  [&]( unsigned int y, uint8_t * prow ){ FillTiledImgRow( in_indexed, y, 0, width, 8, prow ); } );
     }
 
     bool ExportTo8bppPNG( const gimg::tiled_image_i8bpp & in_indexed,
@@ -286,42 +494,12 @@ namespace utils{ namespace io
                           unsigned int                    endpixX,
                           unsigned int                    endpixY )
     {
-        png::image<png::index_pixel> output;
-        output.set_palette( PalToPngPal(in_indexed.getPalette()) );
-        const size_t srcMaxX = in_indexed.getNbPixelWidth()  - endpixX;
-        const size_t srcMaxY = in_indexed.getNbPixelHeight() - endpixY;
-
-        //Copy image
-        output.resize( (srcMaxX - begpixX), (srcMaxY - begpixY) );
-
-        for( unsigned int i = 0; i < output.get_width(); ++i )
-        {
-            for( unsigned int j = 0; j < output.get_height(); ++j )
-            {
-                size_t srcX = i + begpixX;
-                size_t srcY = j + begpixY;
-
-                if( srcX < srcMaxX && srcY < srcMaxY )
-                    output.set_pixel( i,j, static_cast<uint8_t>( in_indexed.getPixel( srcX, srcY ).getWholePixelData() ) );
-                else 
-                    break;
-            }
-        }
-
-        try
-        {
-            output.write( filepath );
-        }
-        catch( const std::exception & e )
-        {
-            cerr << "<!>- Error outputing image : " << filepath <<"\n"
-                 << "     Exception details : \n"     
-                 << "        " <<e.what()  <<"\n";
-
-            assert(false);
-            return false;
-        }
-        return true;
+        const unsigned int srcMaxX = in_indexed.getNbPixelWidth()  - endpixX;
+        const unsigned int srcMaxY = in_indexed.getNbPixelHeight() - endpixY;
+        const unsigned int width   = srcMaxX - begpixX;
+        const unsigned int height  = srcMaxY - begpixY;
+        return EncodeAndWritePNG( filepath, width, height, png::color_type_palette, 8, &in_indexed.getPalette(),
+                                  [&]( unsigned int y, uint8_t * prow ){ FillTiledImgRow( in_indexed, y + begpixY, begpixX, width, 8, prow ); } );
     }
 
 
@@ -469,50 +647,44 @@ namespace utils{ namespace io
                       unsigned int                      forcedheight,
                       bool                              erroronwrongres )
     {
-        png::image<png::rgba_pixel> output;
-
-        //Copy image
-        output.resize( forcedwidth, forcedheight );
-
-        auto itpixel = bitmap.begin();
-        for( unsigned int i = 0; i < output.get_width(); ++i )
+        //The bitmap is stored column by column. Missing pixels are white.
+        return EncodeAndWritePNG( filepath, forcedwidth, forcedheight, png::color_type_rgba, 8, nullptr,
+                                  [&]( unsigned int y, uint8_t * prow )
         {
-            for( unsigned int j = 0; j < output.get_height(); ++j )
+            for( unsigned int x = 0; x < forcedwidth; ++x, prow += 4 )
             {
-                png::rgba_pixel pix;
-                if( itpixel != bitmap.end() )
-                {
-                    pix.alpha = 255;
-                    pix.red   = itpixel->_red;
-                    pix.blue  = itpixel->_blue;
-                    pix.green = itpixel->_green;
-                    ++itpixel;
-                }
-                else //In case some pixels have no data
+                const size_t srcidx = static_cast<size_t>(x) * forcedheight + y;
+                if( srcidx < bitmap.size() )
                 {
-                    pix.alpha = 255;
-                    pix.red   = 255;
-                    pix.blue  = 255;
-                    pix.green = 255;
+                    prow[0] = bitmap[srcidx]._red;
+                    prow[1] = bitmap[srcidx]._green;
+                    prow[2] = bitmap[srcidx]._blue;
                 }
-                output.set_pixel( i,j,  pix ); //If only one component returns the entire pixel data
+                else
+                    prow[0] = prow[1] = prow[2] = 255;
+                prow[3] = 255;
             }
-        }
+        });
+    }
 
-        try
-        {
-            output.write( filepath );
-        }
-        catch( const std::exception & e )
+    /*
+        ExportRGBA32ToPNG
+    */
+    bool ExportRGBA32ToPNG( const std::vector<uint8_t> & rgba32,
+                            unsigned int                 width,
+                            unsigned int                 height,
+                            const std::string          & filepath )
+    {
+        static const size_t BytesPerPixel = 4;
+        if( rgba32.size() < (static_cast<size_t>(width) * height * BytesPerPixel) )
         {
-            cerr << "<!>- Error outputing image : " << filepath <<"\n"
-                 << "     Exception details : \n"     
-                 << "        " <<e.what()  <<"\n";
-
-            assert(false);
+            cerr << "<!>- ExportRGBA32ToPNG(): Bitmap for " <<filepath <<" is smaller than its " <<width <<"x" <<height <<" resolution!\n";
             return false;
         }
-        return true;
+
+        const size_t rowlen = static_cast<size_t>(width) * BytesPerPixel;
+        return EncodeAndWritePNG( filepath, width, height, png::color_type_rgba, 8, nullptr,
+                                  [&]( unsigned int y, uint8_t * prow ){ std::copy_n( rgba32.data() + (y * rowlen), rowlen, prow ); } );
     }
 
     /*
@@ -523,32 +695,9 @@ namespace utils{ namespace io
                       const std::string                         & filepath, 
                       bool                                        erroronwrongres)
     {
-        png::image<png::index_pixel> output;
-        output.set_palette( PalToPngPal(palette) );
-
-        //Copy image
-        output.resize( indexed8bpp.front().size(), indexed8bpp.size() );
-
-        for( unsigned int i = 0; i < output.get_width(); ++i )
-        {
-            for( unsigned int j = 0; j < output.get_height(); ++j )
-                output.set_pixel( i,j, indexed8bpp[j][i] );
-        }
-
-        try
-        {
-            output.write( filepath );
-        }
-        catch( const std::exception & e )
-        {
-            cerr << "<!>- Error outputing image : " << filepath <<"\n"
-                 << "     Exception details : \n"     
-                 << "        " <<e.what()  <<"\n";
-
-            assert(false);
-            return false;
-        }
-        return true;
+        const unsigned int width = indexed8bpp.front().size();
+        return EncodeAndWritePNG( filepath, width, indexed8bpp.size(), png::color_type_palette, 8, &palette,
+                                  [&]( unsigned int y, uint8_t * prow ){ std::copy_n( indexed8bpp[y].data(), width, prow ); } );
     }
 
 
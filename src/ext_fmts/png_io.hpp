@@ -23,6 +23,52 @@ namespace utils{ namespace io
         unsigned int nbcolorspal;
     };
 
+//==============================================================================================
+//  Encoding Settings
+//==============================================================================================
+    /*
+        PNG_EncodeSettings
+            How hard the PNG exports try to compress the images.
+            The images are small, indexed and full of flat areas, so most of the export time goes into zlib.
+            When the PNGs are only an intermediate step, "Fast" or "Store" save most of that time.
+    */
+    struct PNG_EncodeSettings
+    {
+        enum struct eFilters
+        {
+            LibDefault, //Let libpng pick. It doesn't filter paletted images.
+            None,
+            Adaptive,   //Try every filter on each row. Slowest.
+        };
+
+        enum struct eStrategy
+        {
+            Default,    //Let libpng pick.
+            RLE,        //Only match runs of identical bytes. Much faster, and nearly as good on pixel art.
+        };
+
+        int       complevel = -1;   //zlib compression level from 0 to 9. -1 is zlib's default.
+        eFilters  filters   = eFilters::LibDefault;
+        eStrategy strategy  = eStrategy::Default;
+
+        static PNG_EncodeSettings Store();      //No compression at all.
+        static PNG_EncodeSettings Fast();       //Lowest compression level, RLE matching.
+        static PNG_EncodeSettings Default();    //libpng's defaults.
+        static PNG_EncodeSettings Best();       //Highest compression level, adaptive filtering.
+    };
+
+    /*
+        Settings used by every PNG export function. Meant to be set once by the program, before exporting anything.
+    */
+    void               SetPNGEncodeSettings( const PNG_EncodeSettings & settings );
+    PNG_EncodeSettings GetPNGEncodeSettings();
+
+    /*
+        Parses either a preset name ("store", "fast", "default", "best"), or a compression level from 0 to 9.
+        Returns false if the string is neither.
+    */
+    bool ParsePNGEncodeSettings( const std::string & str, PNG_EncodeSettings & out_settings );
+
 //==============================================================================================
 //  Import/Export from/to 4bpp
 //==============================================================================================
@@ -99,6 +145,15 @@ namespace utils{ namespace io
                       const std::string                         & filepath, 
                       bool                                        erroronwrongres = false );
 
+    /*
+        ExportRGBA32ToPNG
+            Writes a 32 bits RGBA bitmap, with 4 bytes per pixel in R, G, B, A order, row by row.
+    */
+    bool ExportRGBA32ToPNG( const std::vector<uint8_t> & rgba32,
+                            unsigned int                 width,
+                            unsigned int                 height,
+                            const std::string          & filepath );
+
 };};
 
 #endif
\ No newline at end of file
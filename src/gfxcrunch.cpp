@@ -4,7 +4,11 @@
 //#include <ppmdu/pmd2/pmd2_sprites.hpp>
 #include <ppmdu/pmd2/pmd2_filetypes.hpp>
 #include <ppmdu/containers/sprite_data.hpp>
+#include <ppmdu/containers/sprite_compositor.hpp>
 #include <utils/multiple_task_handler.hpp>
+#include <utils/parallel_tasks.hpp>
+#include <utils/async_file_sink.hpp>
+#include <ext_fmts/png_io.hpp>
 #include <utils/library_wide.hpp>
 #include <ppmdu/fmts/wan.hpp>
 #include <ppmdu/fmts/pack_file.hpp>
@@ -170,6 +174,7 @@ namespace gfx_util
     {
         WAN_Parser parser( srcraw );
         auto       sprty = parser.getSpriteType();
+        parser.SetParallelImageParsing(true);
                 
         if( sprty == graphics::eSpriteImgType::spr4bpp )
         {
@@ -189,19 +194,48 @@ namespace gfx_util
         }
     }
 
+    const std::string AnimSheetsDirName = "animsheets";
+
+    /*
+        Renders the animations of a sprite into the "animsheets" sub-directory of its output directory.
+    */
+    void ExportSpriteAnimSheets( const graphics::BaseSprite & sprite, const std::string & sproutdir, bool bparallel )
+    {
+        graphics::ExportAnimationSheets( sprite, Poco::Path(sproutdir).makeDirectory().append(AnimSheetsDirName).toString(), bparallel );
+    }
+
+    /*
+        Prints how much space was saved by storing identical images and pixel strips only once.
+    */
+    void PrintWanDedupStats( const WAN_Writer & writer )
+    {
+        const auto & stats = writer.GetDedupStats();
+        cout << "Reused " <<stats.nbimgsreused <<" identical images and " <<stats.nbstripsreused 
+             <<" identical pixel strips, saving " <<stats.nbbytessaved <<" bytes.\n";
+    }
+
     /*
     */
     void TurnPackContentToSpriteData( CPack & srcpack, std::vector<std::unique_ptr<graphics::BaseSprite>> & out_table )
     {
         cout <<"Parsing sprites..\n";
         out_table.resize( srcpack.getNbSubFiles() );
+
+        //Identify all the sub-files at once, and keep the decompressed data of compressed ones
+        vector<ContentTreeNode> contents( srcpack.getNbSubFiles() );
+        utils::JobErrorList     errors;
+        utils::RunIndexedJobs( contents.size(), [&]( size_t cntsub )
+        {
+            contents[cntsub] = DetermineCntTree( srcpack.getSubFile(cntsub), "", false, true );
+        }, errors );
+        errors.ThrowIfAny("TurnPackContentToSpriteData()");
+
         for( unsigned int i = 0; i < srcpack.getNbSubFiles(); )
         {
-            auto & curSubFile = srcpack.getSubFile(i);
-            auto   cnttype    = DetermineCntTy( curSubFile.begin(), curSubFile.end() );
+            const ContentTreeNode & cnt = contents[i];
 
             //
-            if( cnttype._type == CnTy_WAN )
+            if( cnt._content._type == CnTy_WAN )
             {
                 if( utils::LibWide().isLogOn() )
                 {
@@ -210,19 +244,14 @@ namespace gfx_util
                          <<"============================\n";
                 }
                 //Convert directly
-                ParseASprite( curSubFile, out_table[i] );
+                ParseASprite( srcpack.getSubFile(i), out_table[i] );
             }
-            else if( cnttype._type == CnTy_PKDPX )
+            else if( cnt._content._type == CnTy_PKDPX && cnt._subcontent.size() == 1 )
             {
-                //Do decompress before converting!
-                vector<uint8_t> decompbuff;
-                DecompressPKDPX( curSubFile.begin(), curSubFile.end(), decompbuff );
-
-                //Do a check on the decompressed file
-                if( DetermineCntTy( decompbuff.begin(), decompbuff.end() )._type != CnTy_WAN )
-                    continue; //skip this file if not a wan sprite
-
-                ParseASprite( decompbuff, out_table[i] );
+                //Parse the decompressed data, if its a wan sprite
+                const ContentTreeNode & decomp = cnt._subcontent.front();
+                if( decomp._content._type == CnTy_WAN && decomp._decoded )
+                    ParseASprite( *decomp._decoded, out_table[i] );
             }
             //Skip anything else
 
@@ -455,6 +484,22 @@ namespace gfx_util
             "-noresfix",
             std::bind( &CGfxUtil::ParseOptionNoResFix,  &GetInstance(), placeholders::_1 ),
         },
+        //Export rendered animations
+        {
+            "sheets",
+            0,
+            "When unpacking sprites, also render every animation groups into sprite sheets, in an \"animsheets\" sub-directory.",
+            "-sheets",
+            std::bind( &CGfxUtil::ParseOptionAnimSheets,  &GetInstance(), placeholders::_1 ),
+        },
+        //PNG compression
+        {
+            "pngz",
+            1,
+            "Set how much exported PNG images are compressed. Either \"store\", \"fast\", \"default\", \"best\", or a zlib level from 0 to 9. Use \"fast\" or \"store\" when the images will be imported back right away.",
+            "-pngz fast",
+            std::bind( &CGfxUtil::ParseOptionPNGCompression,  &GetInstance(), placeholders::_1 ),
+        },
 
 
     //=====================
@@ -569,6 +614,7 @@ namespace gfx_util
         m_ImportByIndex = false;
         m_bRedirectClog = false;
         m_bNoResAutoFix = false;
+        m_bAnimSheets   = false;
         m_execMode      = eExecMode::INVALID_Mode;
         m_PrefOutFormat = utils::io::eSUPPORT_IMG_IO::PNG;
 
@@ -642,12 +688,15 @@ namespace gfx_util
         }
 
         auto sprty = parser.getSpriteType();
+        parser.SetParallelImageParsing(true);
         clog <<"Sprite is ";
         if( sprty == graphics::eSpriteImgType::spr4bpp )
         {
             clog <<"4 bpp\n";
             auto sprite = parser.ParseAs4bpp();
             graphics::ExportSpriteToDirectory( sprite, outpath.toString(), m_PrefOutFormat, false );
+            if( m_bAnimSheets )
+                ExportSpriteAnimSheets( sprite, outpath.toString(), true );
             
         }
         else if( sprty == graphics::eSpriteImgType::spr8bpp )
@@ -655,6 +704,8 @@ namespace gfx_util
             clog <<"8 bpp\n";
             auto sprite = parser.ParseAs8bpp();
             graphics::ExportSpriteToDirectory( sprite, outpath.toString(), m_PrefOutFormat, false );
+            if( m_bAnimSheets )
+                ExportSpriteAnimSheets( sprite, outpath.toString(), true );
         }
 
         //draw one last time
@@ -703,6 +754,9 @@ namespace gfx_util
             }
             else
                 writer.write( outpath.setExtension(WAN_FILEX).toString() );
+
+            if( ! m_bQuiet )
+                PrintWanDedupStats(writer);
             
         }
         else if( sprty == graphics::eSpriteImgType::spr8bpp )
@@ -720,6 +774,9 @@ namespace gfx_util
             }
             else
                 writer.write( outpath.setExtension(WAN_FILEX).toString() );
+
+            if( ! m_bQuiet )
+                PrintWanDedupStats(writer);
         }
 
 
@@ -752,12 +809,14 @@ namespace gfx_util
         auto lambdaExpSpriteWrap = [&]( const graphics::BaseSprite * srcspr, const std::string & outpath )->bool
         {
             graphics::ExportSpriteToDirectoryPtr(srcspr, outpath, m_PrefOutFormat);
+            if( m_bAnimSheets )
+                ExportSpriteAnimSheets( *srcspr, outpath, false ); //Sprites are already exported in parallel
             ++completed;
             return true;
         };
         auto lambdaWriteFileByVec = [&completed](const std::string & path, const std::vector<uint8_t> & filedata)->bool
         {
-            utils::io::WriteByteVectorToFile( path, filedata );
+            utils::WriteFileBehind( path, std::vector<uint8_t>(filedata) );
             ++completed;
             return true;
         };
@@ -801,6 +860,10 @@ namespace gfx_util
             //     Use the pokemon name list if its one of the 3 special files.
             cout<<"\nWriting sprites to directories..\n";
 
+            //Output files are handed to the sink's I/O threads, so the workers can move on to the next sprite
+            utils::AsyncFileSink        outsink;
+            utils::ScopedActiveFileSink activesink(outsink);
+
             for( unsigned int i = 0; i < mysprites.size(); )
             {
                 if( mysprites[i] == nullptr )
@@ -844,6 +907,7 @@ namespace gfx_util
             taskmanager.Execute();
             taskmanager.BlockUntilTaskQueueEmpty();
             taskmanager.StopExecute();
+            outsink.Finish();
 
             shouldUpdtProgress = false;
             if( updtProgress.valid() )
@@ -1088,6 +1152,8 @@ namespace gfx_util
 
         //Write it out
         graphics::ExportSpriteToDirectoryPtr( targetptr.get(), outpath.toString(), m_PrefOutFormat );
+        if( m_bAnimSheets )
+            ExportSpriteAnimSheets( *targetptr, outpath.toString(), true );
 
         //write output message
         if( ! m_bQuiet )
@@ -1535,6 +1601,25 @@ namespace gfx_util
         return m_bNoResAutoFix = true;
     }
 
+    bool CGfxUtil::ParseOptionAnimSheets( const std::vector<std::string> & optdata )
+    {
+        cout <<"<*>-sheets specified. Animation sheets will be rendered for unpacked sprites!\n";
+        return m_bAnimSheets = true;
+    }
+
+    bool CGfxUtil::ParseOptionPNGCompression( const std::vector<std::string> & optdata )
+    {
+        utils::io::PNG_EncodeSettings settings;
+        if( optdata.size() != 2 || !utils::io::ParsePNGEncodeSettings( optdata.back(), settings ) )
+        {
+            cerr <<"<!>- Invalid PNG compression \"" <<optdata.back() <<"\"! Expected \"store\", \"fast\", \"default\", \"best\", or a level from 0 to 9.\n";
+            return false;
+        }
+        cout <<"<*>-PNG compression set to \"" <<optdata.back() <<"\"!\n";
+        utils::io::SetPNGEncodeSettings(settings);
+        return true;
+    }
+
 
     //New System
     bool CGfxUtil::ParseOptionForceExport( const std::vector<std::string> & optdata )
@@ -1943,7 +2028,7 @@ namespace gfx_util
             };
             auto lambdaWriteFileByVec = [&completed](const std::string & path, const std::vector<uint8_t> & filedata)->bool
             {
-                utils::io::WriteByteVectorToFile( path, filedata );
+                utils::WriteFileBehind( path, std::vector<uint8_t>(filedata) );
                 ++completed;
                 return true;
             };
@@ -1953,6 +2038,10 @@ namespace gfx_util
             //     Use the pokemon name list if its one of the 3 special files.
             cout<<"\nWriting sprites to directories..\n";
 
+            //Output files are handed to the sink's I/O threads, so the workers can move on to the next sprite
+            utils::AsyncFileSink        outsink;
+            utils::ScopedActiveFileSink activesink(outsink);
+
             for( unsigned int i = 0; i < mysprites.size(); )
             {
                 if( mysprites[i] == nullptr )
@@ -1996,6 +2085,7 @@ namespace gfx_util
             taskmanager.Execute();
             taskmanager.BlockUntilTaskQueueEmpty();
             taskmanager.StopExecute();
+            outsink.Finish();
 
             shouldUpdtProgress = false;
             if( updtProgress.valid() )
@@ -2091,8 +2181,12 @@ namespace gfx_util
         else
             resfacenames = move( rawfacenames );
 
+        //The encoded portraits are handed to the sink's I/O threads, while the next ones are encoded
+        utils::AsyncFileSink        outsink;
+        utils::ScopedActiveFileSink activesink(outsink);
         KaoWriter mywriter( &respokenames, &resfacenames );
         mywriter( kao, outpath.toString(), m_PrefOutFormat );
+        outsink.Finish();
 
     }
 
@@ -73,6 +73,8 @@ namespace gfx_util
         bool ParseOptionLog             ( const std::vector<std::string> & optdata );
 
         bool ParseOptionNoResFix        ( const std::vector<std::string> & optdata );
+        bool ParseOptionAnimSheets      ( const std::vector<std::string> & optdata );
+        bool ParseOptionPNGCompression  ( const std::vector<std::string> & optdata );
 
         bool ParseOptionForceExport     ( const std::vector<std::string> & optdata );
         bool ParseOptionForceImport     ( const std::vector<std::string> & optdata );
@@ -174,6 +176,7 @@ namespace gfx_util
         bool                           m_bRedirectClog;   //Whether we should redirect clog to a file
         bool                           m_bNoResAutoFix;   //Whether in case of resolution mismatch between the sprite XML data and the images, the utility will autofix
                                                           // the content of meta-frames with the resolution of the corresponding image!
+        bool                           m_bAnimSheets;     //Whether rendered animation sheets should be exported along with unpacked sprites
         eExecMode                      m_execMode;        //This is set after reading the input path.
 
         std::string                    m_inputPath;      //This is the input path that was parsed 
@@ -228,6 +228,12 @@ using namespace ::std;
         utils::LibWide().StringValue(utils::lwData::eBasicValues::ProgramLogDir) = utils::getCWD();
     }
 
+    CMapNybbler::~CMapNybbler()
+    {
+        //Clear the logger before the output stream redirect is destroyed, so the last of the log makes it to the file!
+        utils::LibWide().Logger(nullptr);
+    }
+
     const vector<argumentparsing_t> & CMapNybbler::getArgumentsList   ()const { return Arguments_List;    }
     const vector<optionparsing_t>   & CMapNybbler::getOptionsList     ()const { return Options_List;      }
     const argumentparsing_t         * CMapNybbler::getExtraArg        ()const { return nullptr;           } //No extra args
@@ -534,7 +540,7 @@ using namespace ::std;
             //Now that the command line is parsed, do stuff with it
             if(utils::LibWide().isLogOn())
             {
-                utils::LibWide().Logger(new logging::SingleOutMTLogger);
+                utils::LibWide().Logger(new logging::AsyncLogger(&std::clog));
                 utils::LibWide().Logger() << "Logger initiated!\n";
             }
             DetermineOperation();
@@ -71,6 +71,7 @@ All wrongs reversed, no crappyrights :P
 
     private:
         CMapNybbler();
+        ~CMapNybbler();
 
         //Parse Arguments
         bool ParseInputPath  ( const std::string & path );
@@ -164,6 +164,8 @@ namespace pkao_util
         //List our options
         for( auto & anoption : MY_OPTIONS )
             cout <<"    -" <<left  <<setw(5) <<setfill(' ') <<anoption.optionsymbol <<right <<" : " <<anoption.description <<"\n";
+        for( auto & anoption : utils::cmdl::CommonOptions() )
+            cout <<"    -" <<left  <<setw(5) <<setfill(' ') <<anoption.optionsymbol <<right <<" : " <<anoption.description <<"\n";
 
         cout << "\n"
 		     << "Example:\n"
@@ -277,7 +279,7 @@ namespace pkao_util
 
     bool HandleArguments( int argc, const char* argv[], kao_params& parameters )
     {
-        CArgsParser parser( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ), argv, argc );
+        CArgsParser parser( utils::cmdl::WithCommonOptions( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ) ), argv, argc );
 
         //We have 2 parameters max, at least one, and possibly one option
         string      paramOne       = parser.getNextParam(),
@@ -287,6 +289,9 @@ namespace pkao_util
                     pokenamefile   = DEFAULT_POKENAMES_FILENAME;
         bool        bsuccess       = false;
 
+        if( !utils::cmdl::ParseCommonOptions( validoptsfound ) )
+            return false;
+
         //Handle evil backslash escaping the double quote
         if( has_suffix( paramOne, "\"" ) )
         {
@@ -322,6 +327,8 @@ namespace pkao_util
 
                 for( auto & anoption: validoptsfound )
                 {
+                    if( utils::cmdl::IsCommonOption(anoption) ) //Those were handled already
+                        continue;
                     if( !HandleAnOption(anoption, parameters, facenamefile, pokenamefile ) )
                         cerr << "<!>-WARNING: Invalid option \"" <<anoption.front() <<"\" detected!\n";
                 }
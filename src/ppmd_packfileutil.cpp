@@ -12,6 +12,7 @@ Description:
 #include <utils/utility.hpp>
 #include <utils/library_wide.hpp>
 #include <utils/cmdline_util.hpp>
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <fstream>
@@ -93,6 +94,8 @@ namespace ppmd_packfileutil
              << "      -" <<ALIGN_FIRST_OFFSET_SYMBOL <<" \"offset\" : Specifying this will make the program attempt to\n"
              << "                      align the first file to the specified offset\n"
              << "                      (offset is in heaxadecimal !) !\n"
+             << "      -trace \"path\" : Write a Chrome trace event file of where the\n"
+             << "                      time was spent, when built with tracing.\n"
              << "\n"
 		     << "Example:\n"
              << "---------\n"
@@ -151,13 +154,16 @@ namespace ppmd_packfileutil
 
     bool HandleArguments( int argc, const char * argv[], string & inputpath, string & outputpath, unsigned int & forcedoffset )
     {
-        CArgsParser parser( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ), argv, argc );
+        CArgsParser parser( utils::cmdl::WithCommonOptions( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ) ), argv, argc );
 
         //We have 2 parameters max, at least one, and possibly one option
         string paramOne       = parser.getNextParam(),
                paramTwo       = parser.getNextParam();
         auto   validoptsfound = parser.getAllFoundOptions();
 
+        if( !utils::cmdl::ParseCommonOptions( validoptsfound ) )
+            return false;
+
         if( !paramOne.empty() )
         {
             inputpath = paramOne;
@@ -171,13 +177,16 @@ namespace ppmd_packfileutil
             if( !paramTwo.empty() )
                 outputpath = paramTwo;
 
-            if( !validoptsfound.empty() && validoptsfound.front().size() == 2 )
+            auto italign = std::find_if( validoptsfound.begin(), validoptsfound.end(), 
+                                         []( const vector<string> & opt ){ return !opt.empty() && opt.front() == ALIGN_FIRST_OFFSET_SYMBOL; } );
+
+            if( italign != validoptsfound.end() && italign->size() == 2 )
             {
                 stringstream sstr;
                 unsigned int foffset = 0;
 
-                sstr << validoptsfound.front()[1];
-                if( validoptsfound.front()[1].find( "0x", 0 ) != string::npos )
+                sstr << (*italign)[1];
+                if( (*italign)[1].find( "0x", 0 ) != string::npos )
                     sstr >> hex >> foffset;
                 else
                     sstr >> foffset;
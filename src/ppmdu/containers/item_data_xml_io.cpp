@@ -3,6 +3,7 @@
 #include <utils/pugixml_utils.hpp>
 #include <utils/library_wide.hpp>
 #include <utils/utility.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <pugixml.hpp>
 #include <string>
 #include <iostream>
@@ -10,6 +11,7 @@
 #include <iomanip>
 #include <locale>
 #include <vector>
+#include <algorithm>
 #include <Poco/DirectoryIterator.h>
 #include <Poco/File.h>
 #include <Poco/Path.h>
@@ -101,47 +103,56 @@ namespace pmd2 { namespace stats
                 throw runtime_error( sstr.str() );
             }
             
-            const string dirprefix = utils::TryAppendSlash( destdir );
+            //Items are written in parallel, each worker thread has its own xml buffers
+            const string        dirprefix = utils::TryAppendSlash( destdir );
+            utils::JobErrorList errors;
+            utils::RunIndexedJobs( m_items.size(), 
+                                   XMLScratchBuffers(), 
+                                   [&]( XMLScratchBuffers & buf, size_t cntitem )
+                                   {
+                                       WriteAnItem( dirprefix, static_cast<unsigned int>(cntitem), buf );
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "ItemXMLWriter::Write()" );
+        }
+
+    private:
+
+        void WriteAnItem( const string & dirprefix, unsigned int cntitem, XMLScratchBuffers & buf )const
+        {
+            using namespace itemxml;
             stringstream fname;
+            xml_document doc;
+            xml_node     itemdata = doc.append_child( ROOT_Item.c_str() );
+            bool         isEoS    = m_items[cntitem].Get_EoTD_ItemData() == nullptr;
 
-            for( size_t cntitem = 0; cntitem < m_items.size(); ++cntitem )
+            if( isEoS )
             {
-                fname.str(string()); //Purge stringstream
-                xml_document doc;
-                xml_node     itemdata = doc.append_child( ROOT_Item.c_str() );
-                bool         isEoS    = m_items[cntitem].Get_EoTD_ItemData() == nullptr;
-
-                if( isEoS )
-                {
-                    AppendAttribute( itemdata, ATTR_GameVer, ATTR_GameVerEoS );
-                    WriteCommentNode( itemdata, CMT_EoS );
-                }
-                else
-                {
-                    AppendAttribute( itemdata, ATTR_GameVer, ATTR_GameVerEoTD );
-                    WriteCommentNode( itemdata, CMT_EoTD );
-                }
+                AppendAttribute( itemdata, ATTR_GameVer, ATTR_GameVerEoS );
+                WriteCommentNode( itemdata, CMT_EoS );
+            }
+            else
+            {
+                AppendAttribute( itemdata, ATTR_GameVer, ATTR_GameVerEoTD );
+                WriteCommentNode( itemdata, CMT_EoTD );
+            }
 
-                if(!m_bNoStrings)
-                    WriteStrings( itemdata, cntitem );
-                WriteCommentNode( itemdata, CMT_Data );
-                _WriteItemData( itemdata, m_items[cntitem] );
+            if(!m_bNoStrings)
+                WriteStrings( itemdata, cntitem );
+            WriteCommentNode( itemdata, CMT_Data );
+            _WriteItemData( itemdata, m_items[cntitem] );
 
-                MakeFilename( fname, dirprefix, cntitem );
+            MakeFilename( fname, dirprefix, cntitem );
 
-                if( ! doc.save_file( fname.str().c_str() ) )
-                {
-                    stringstream strerr;
-                    strerr << "ItemXMLWriter::Write(): Pugixml couldn't write file \"" <<fname.str() <<"\"!";
-                    throw runtime_error(strerr.str());
-                }
+            if( ! SaveDocumentWithBuffer( doc, fname.str(), buf.outbuf ) )
+            {
+                stringstream strerr;
+                strerr << "ItemXMLWriter::Write(): Pugixml couldn't write file \"" <<fname.str() <<"\"!";
+                throw runtime_error(strerr.str());
             }
-
         }
 
-    private:
-
-        stringstream & MakeFilename( stringstream & out_fname, const string & outpathpre, unsigned int cntitem )
+        stringstream & MakeFilename( stringstream & out_fname, const string & outpathpre, unsigned int cntitem )const
         {
             const std::string * pstr = nullptr;
             if( !m_bNoStrings && (pstr = m_pgametext->GetDefaultLanguage().GetStringIfBlockExists(eStringBlocks::ItemNames, cntitem)) )
@@ -172,7 +183,7 @@ namespace pmd2 { namespace stats
         //}
 
         template<class T>
-            inline string TurnIntToHexStr( T value )
+            inline string TurnIntToHexStr( T value )const
         {
             stringstream sstr;
             sstr << "0x" <<hex <<uppercase <<value;
@@ -180,25 +191,25 @@ namespace pmd2 { namespace stats
         }
 
         template<>
-            inline string TurnIntToHexStr( uint8_t value )
+            inline string TurnIntToHexStr( uint8_t value )const
         {
             stringstream sstr;
             sstr << "0x" <<hex <<uppercase <<static_cast<unsigned short>(value);
             return sstr.str();
         }
 
-        inline string PrepareItemFName( const string & name, eGameLanguages glang )
+        inline string PrepareItemFName( const string & name, eGameLanguages glang )const
         {
             return utils::CleanFilename( name.substr( 0, name.find("\\0",0 ) ), std::locale( *m_pgametext->GetLocaleString(glang)) ); //Remove ending "\0" and remove illegal characters for filesystem
         }
 
-        inline void WriteStringNode( xml_node & strnode, const string & nodename, const string * value )
+        inline void WriteStringNode( xml_node & strnode, const string & nodename, const string * value )const
         {
             if( value )
                 WriteNodeWithValue( strnode, nodename, utils::StrRemoveAfter( *value, "\\0" ) ); //remove ending \0
         }
 
-        void WriteStrings( xml_node & in, unsigned int cntitem )
+        void WriteStrings( xml_node & in, unsigned int cntitem )const
         {
             using namespace itemxml;
             WriteCommentNode( in, "In-game text" );
@@ -226,7 +237,7 @@ namespace pmd2 { namespace stats
         //    WriteNodeWithValue( strnode, PROP_LongDesc,  utils::StrRemoveAfter( longdesc,  "\\0" ).c_str() ); //remove trailling \0
         //}
 
-        void _WriteItemData( xml_node & pn, const stats::itemdata & item )
+        void _WriteItemData( xml_node & pn, const stats::itemdata & item )const
         {
             using namespace itemxml;
             xml_node datnode = pn.append_child( NODE_Data.c_str() );
@@ -309,34 +320,46 @@ namespace pmd2 { namespace stats
 
     private:
 
-        ItemsDB _ParseAllItems( const vector<string> filelst )
+        ItemsDB _ParseAllItems( vector<string> filelst )
         {
             using namespace itemxml;
-            ItemsDB resitems;
+            ItemsDB                    resitems;
+            vector<PendingStringEdits> itemstrings(filelst.size());
+            utils::JobErrorList        errors;
 
+            //Directory listing order depends on the filesystem, sort to get the same item order everywhere
+            std::sort( filelst.begin(), filelst.end() );
             resitems.resize(filelst.size());
-            auto ititem = resitems.begin();
 
-            for( auto & item : filelst )
+            //Each item is parsed into its own slot, so the files can be handled in parallel
+            utils::RunIndexedJobs( filelst.size(), 
+                                   XMLScratchBuffers(), 
+                                   [&]( XMLScratchBuffers & buf, size_t cntitem )
+                                   {
+                                       xml_document     doc;
+                                       xml_parse_result loadres = LoadDocumentWithBuffer( doc, filelst[cntitem], buf.inbuf );
+                                       if( ! loadres )
+                                       {
+                                           stringstream sstr;
+                                           sstr <<"Can't load XML document \"" <<filelst[cntitem] <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
+                                           throw std::runtime_error(sstr.str());
+                                       }
+                                       _ParseItem( doc.first_child(), resitems[cntitem], itemstrings[cntitem], filelst[cntitem] );
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "ItemXMLParser::_ParseAllItems()" );
+
+            //Strings are put in the GameText from this thread only, in file order
+            if( !m_bNoStrings )
             {
-                xml_document     doc;
-                xml_parse_result loadres = doc.load_file( item.c_str() );
-                if( ! loadres )
-                {
-                    stringstream sstr;
-                    sstr <<"Can't load XML document \"" <<filelst.front() <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
-                    throw std::runtime_error(sstr.str());
-                }
-
-                _ParseItem( doc.first_child(), *ititem, item );
-
-                ++ititem;
+                for( size_t cntitem = 0; cntitem < resitems.size(); ++cntitem )
+                    itemstrings[cntitem].Apply( *m_pgametext, resitems[cntitem].itemID );
             }
 
             return std::move( resitems );
         }
 
-        void ReadStrings( xml_node & strnode, uint32_t itemID )
+        void ReadStrings( const xml_node & strnode, PendingStringEdits & out_strings )
         {
             using namespace itemxml;
             for( auto & curnode : strnode.children() )
@@ -345,21 +368,20 @@ namespace pmd2 { namespace stats
                 if( glang != eGameLanguages::Invalid )
                 {
                     //Parse multi-language strings
-                    ReadLangStrings(curnode, glang, itemID);
+                    ReadLangStrings(curnode, glang, out_strings);
                 }
                 else
                 {
                     //If the game isn't multi-lingual, just parse the strings for english
                     clog<<"<!>- ItemXMLParser::ReadStrings() : Found a non language named node!\n";
-                    ReadLangStrings(curnode, eGameLanguages::english, itemID);
+                    ReadLangStrings(curnode, eGameLanguages::english, out_strings);
                 }
             }
         }
 
-        void ReadLangStrings( xml_node & langnode, eGameLanguages lang, uint32_t itemID )
+        void ReadLangStrings( const xml_node & langnode, eGameLanguages lang, PendingStringEdits & out_strings )
         {
-            auto langstr = m_pgametext->GetStrings(lang);
-            if( langstr == m_pgametext->end() )
+            if( !m_pgametext->IsLangLoaded(lang) )
             {
                 clog<<"<!>- ItemXMLParser::ReadLangStrings(): Found strings for " <<GetGameLangName(lang) <<", but the language was not loaded for editing! Skipping!\n";
                 return;
@@ -372,33 +394,24 @@ namespace pmd2 { namespace stats
                 {
                     string itemname = curnode.child_value();
                     itemname += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists(eStringBlocks::ItemNames, itemID);
-                    if(!pstr)
-                        throw std::runtime_error("ItemXMLParser::ReadLangStrings(): Couldn't access the item names string block!");
-                    *(pstr) = itemname;
+                    out_strings.Push( lang, eStringBlocks::ItemNames, std::move(itemname) );
                 }
                 else if( curnode.name() == PROP_ShortDesc )
                 {
                     string itemdescsh = curnode.child_value();
                     itemdescsh += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists(eStringBlocks::ItemDescS, itemID);
-                    if(!pstr)
-                        throw std::runtime_error("ItemXMLParser::ReadLangStrings(): Couldn't access the item short description string block!");
-                    *(pstr) = itemdescsh;
+                    out_strings.Push( lang, eStringBlocks::ItemDescS, std::move(itemdescsh) );
                 }
                 else if( curnode.name() == PROP_LongDesc )
                 {
                     string itemdescl = curnode.child_value();
                     itemdescl += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists(eStringBlocks::ItemDescL, itemID);
-                    if(!pstr)
-                        throw std::runtime_error("ItemXMLParser::ReadLangStrings(): Couldn't access the item long description string block!");
-                    *(pstr) = itemdescl;
+                    out_strings.Push( lang, eStringBlocks::ItemDescL, std::move(itemdescl) );
                 }
             }
         }
 
-        void _ParseItem( const pugi::xml_node & itemnode, stats::itemdata & item, const string & itemname )
+        void _ParseItem( const pugi::xml_node & itemnode, stats::itemdata & item, PendingStringEdits & out_strings, const string & itemname )
         {
             using namespace itemxml;
             //Check the game version of the data
@@ -409,11 +422,11 @@ namespace pmd2 { namespace stats
             {
                 if( gvs == ATTR_GameVerEoS )
                 {
-                    _ParseEoSData( itemnode, item );
+                    _ParseEoSData( itemnode, item, out_strings );
                 }
                 else if( gvs == ATTR_GameVerEoTD )
                 {
-                    _ParseEoTDData( itemnode, item );
+                    _ParseEoTDData( itemnode, item, out_strings );
                 }
                 else
                 {
@@ -430,7 +443,7 @@ namespace pmd2 { namespace stats
             }
         }
 
-        void _ParseEoSData( const pugi::xml_node & itemnode, stats::itemdata & item )
+        void _ParseEoSData( const pugi::xml_node & itemnode, stats::itemdata & item, PendingStringEdits & out_strings )
         {
             using namespace itemxml;
             //xml_node        strnode;
@@ -464,7 +477,7 @@ namespace pmd2 { namespace stats
             for( auto & curnode : itemnode.children() )
             {
                 if( curnode.name() == NODE_Strings )
-                    ReadStrings( curnode, item.itemID );
+                    ReadStrings( curnode, out_strings );
             }
         }
 
@@ -518,7 +531,7 @@ namespace pmd2 { namespace stats
             }
         }
 
-        void _ParseEoTDData( const pugi::xml_node & itemnode, stats::itemdata & item )
+        void _ParseEoTDData( const pugi::xml_node & itemnode, stats::itemdata & item, PendingStringEdits & out_strings )
         {
             //#TODO: Finish _ParseEoTDData !
             cerr <<"\nExplorers of Time and Darkness data parsing not implemented yet!!!\n";
@@ -540,7 +553,7 @@ namespace pmd2 { namespace stats
             }
 
             //
-            ReadStrings( strnode, item.itemID );
+            ReadStrings( strnode, out_strings );
         }
 
     private:
@@ -3,6 +3,7 @@
 #include <utils/pugixml_utils.hpp>
 #include <utils/library_wide.hpp>
 #include <utils/utility.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <pugixml.hpp>
 #include <string>
 #include <iostream>
@@ -12,6 +13,7 @@
 #include <vector>
 #include <utility>
 #include <functional>
+#include <algorithm>
 #include <Poco/DirectoryIterator.h>
 #include <Poco/File.h>
 #include <Poco/Path.h>
@@ -93,15 +95,28 @@ namespace pmd2 { namespace stats
                 throw runtime_error( sstr.str() );
             }
 
-            if( m_psrc2 )
-                WriteEoS( destdir );
-            else
-                WriteEoTD( destdir );
+            if( m_psrc2 && m_src1.size() != m_psrc2->size() )
+                throw runtime_error("Size mismatch between the two move data lists! One list of moves is longer than the other!");
+
+            //Moves are written in parallel, each worker thread has its own xml buffers
+            const string        dirprefix = utils::TryAppendSlash( destdir );
+            utils::JobErrorList errors;
+            utils::RunIndexedJobs( m_src1.size(), 
+                                   XMLScratchBuffers(), 
+                                   [&]( XMLScratchBuffers & buf, size_t cntmv )
+                                   {
+                                       if( m_psrc2 )
+                                           WriteAMoveEoS ( dirprefix, static_cast<unsigned int>(cntmv), buf );
+                                       else
+                                           WriteAMoveEoTD( dirprefix, static_cast<unsigned int>(cntmv), buf );
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "MoveDB_XMLWriter::Write()" );
         }
 
     private:
 
-        inline string PrepareMvNameFName( const string & name, eGameLanguages lang  )
+        inline string PrepareMvNameFName( const string & name, eGameLanguages lang  )const
         {
             const string * plocstr = m_pgametext->GetLocaleString(lang);
             if( plocstr )
@@ -110,7 +125,7 @@ namespace pmd2 { namespace stats
                 return utils::CleanFilename( name.substr( 0, name.find("\\0",0 ) ) );
         }
 
-        stringstream & MakeFilename( stringstream & out_fname, const string & outpathpre, unsigned int cntmv )
+        stringstream & MakeFilename( stringstream & out_fname, const string & outpathpre, unsigned int cntmv )const
         {
             const string * pfstr = nullptr;
             if( !m_bNoStrings && (pfstr = m_pgametext->GetDefaultLanguage().GetStringIfBlockExists( eStringBlocks::MvNames, cntmv )) )
@@ -125,76 +140,60 @@ namespace pmd2 { namespace stats
         }
 
 
-        void WriteEoS( const std::string & destdir )
+        void WriteAMoveEoS( const std::string & dirprefix, unsigned int cntmv, XMLScratchBuffers & buf )const
         {
             using namespace movesXML;
-            const string dirprefix = utils::TryAppendSlash( destdir );
             stringstream fname;
+            xml_document doc;
+            xml_node     movedata = doc.append_child( ROOT_Move.c_str() );
+            AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoS ) );
+            WriteCommentNode( movedata, "Pokemon Mystery Dungeon: Explorers of Sky move data" );
 
-            if( m_src1.size() != m_psrc2->size() )
-                throw runtime_error("Size mismatch between the two move data lists! One list of moves is longer than the other!");
+            if( !m_bNoStrings )
+                WriteStrings( movedata, cntmv );
 
-            for( unsigned int cntmv = 0; cntmv < m_src1.size(); ++cntmv/*, ++itcurname, ++itcurdesc*/ )
-            {
-                fname.str(string());
-                xml_document doc;
-                xml_node     movedata = doc.append_child( ROOT_Move.c_str() );
-                AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoS ) );
-                WriteCommentNode( movedata, "Pokemon Mystery Dungeon: Explorers of Sky move data" );
-
-                if( !m_bNoStrings )
-                    WriteStrings( movedata, cntmv );
+            WriteCommentNode( movedata, "Move data from waza_p.bin" );
+            WriteMove( movedata, m_src1[cntmv] );
+            WriteCommentNode( movedata, "Move data from waza_p2.bin" );
+            WriteMove( movedata, (*m_psrc2)[cntmv] );
 
-                WriteCommentNode( movedata, "Move data from waza_p.bin" );
-                WriteMove( movedata, m_src1[cntmv] );
-                WriteCommentNode( movedata, "Move data from waza_p2.bin" );
-                WriteMove( movedata, (*m_psrc2)[cntmv] );
+            MakeFilename(fname, dirprefix, cntmv);
 
-                MakeFilename(fname, dirprefix, cntmv);
-
-                if( ! doc.save_file( fname.str().c_str() ) )
-                {
-                    stringstream strerr;
-                    strerr << "Pugixml couldn't write file \"" <<fname.str() <<"\"!";
-                    throw runtime_error(strerr.str());
-                }
+            if( ! SaveDocumentWithBuffer( doc, fname.str(), buf.outbuf ) )
+            {
+                stringstream strerr;
+                strerr << "Pugixml couldn't write file \"" <<fname.str() <<"\"!";
+                throw runtime_error(strerr.str());
             }
         }
 
-        void WriteEoTD( const std::string & destdir )
+        void WriteAMoveEoTD( const std::string & dirprefix, unsigned int cntmv, XMLScratchBuffers & buf )const
         {
             using namespace movesXML;
-            const string dirprefix = utils::TryAppendSlash( destdir );
             stringstream fname;
+            xml_document doc;
+            xml_node     movedata = doc.append_child( ROOT_Move.c_str() );
+            AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoT ) );
+            AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoD ) );
+            WriteCommentNode( movedata, "Pokemon Mystery Dungeon: Explorers of Time/Darkness move data" );
 
-            for( unsigned int cntmv = 0; cntmv < m_src1.size(); ++cntmv/*, ++itcurname, ++itcurdesc*/ )
-            {
-                fname.str(string());
-                xml_document doc;
-                xml_node     movedata = doc.append_child( ROOT_Move.c_str() );
-                AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoT ) );
-                AppendAttribute( movedata, ATTR_GameVer, pmd2::GetGameVersionName( eGameVersion::EoD ) );
-                WriteCommentNode( movedata, "Pokemon Mystery Dungeon: Explorers of Time/Darkness move data" );
-
-                if( !m_bNoStrings )
-                    WriteStrings( movedata, cntmv );
+            if( !m_bNoStrings )
+                WriteStrings( movedata, cntmv );
 
-                WriteCommentNode( movedata, "Move data from waza_p.bin" );
-                WriteMove   ( movedata, m_src1[cntmv] );
+            WriteCommentNode( movedata, "Move data from waza_p.bin" );
+            WriteMove   ( movedata, m_src1[cntmv] );
 
-                MakeFilename(fname, dirprefix, cntmv);
-                //fname <<dirprefix <<setw(4) <<setfill('0') <<dec <<i <<"_" << PrepareMvNameFName(*itcurname) <<".xml";
+            MakeFilename(fname, dirprefix, cntmv);
 
-                if( ! doc.save_file( fname.str().c_str() ) )
-                {
-                    stringstream strerr;
-                    strerr << "Pugixml couldn't write file \"" <<fname.str() <<"\"!";
-                    throw runtime_error(strerr.str());
-                }
+            if( ! SaveDocumentWithBuffer( doc, fname.str(), buf.outbuf ) )
+            {
+                stringstream strerr;
+                strerr << "Pugixml couldn't write file \"" <<fname.str() <<"\"!";
+                throw runtime_error(strerr.str());
             }
         }
 
-        void WriteStrings( xml_node & mn, unsigned int cntmv )
+        void WriteStrings( xml_node & mn, unsigned int cntmv )const
         {
             using namespace movesXML;
             WriteCommentNode( mn, "In-game text" );
@@ -215,7 +214,7 @@ namespace pmd2 { namespace stats
             }
         }
 
-        void WriteMove( xml_node & pn, const MoveData & mvdata )
+        void WriteMove( xml_node & pn, const MoveData & mvdata )const
         {
             using namespace movesXML;
             xml_node datnode = pn.append_child( NODE_Data.c_str() );
@@ -257,6 +256,18 @@ namespace pmd2 { namespace stats
     public:
         typedef pair<vector<string>::iterator,vector<string>::iterator> range_t;
 
+        /*
+            Result of parsing a single move file on a worker thread.
+        */
+        struct moveparseres
+        {
+            moveparseres():gamever(eGameVersion::Invalid){}
+            eGameVersion       gamever;     //Stays invalid if the file was skipped
+            vector<MoveData>   data1;
+            vector<MoveData>   data2;
+            PendingStringEdits strings;     //Strings are put in the GameText once we know the final move id
+        };
+
         /*
         */
         MoveDB_XMLParser( MoveDB & out_mdb1, MoveDB * out_mdb2 = nullptr, GameText * pgtext = nullptr )
@@ -324,7 +335,7 @@ namespace pmd2 { namespace stats
 
         /*
         */
-        void ReadAllMoves( const vector<string> & files )
+        void ReadAllMoves( vector<string> & files )
         {
             using namespace movesXML;
             MoveDB result1;
@@ -335,39 +346,35 @@ namespace pmd2 { namespace stats
             if( !m_pout2 )
                 result2.reserve(files.size());
 
-            //Parse files
+            //Directory listing order depends on the filesystem, sort to get the same move order everywhere
+            std::sort( files.begin(), files.end() );
+
+            //Parse files in parallel, each into its own slot
+            vector<moveparseres> parsed(files.size());
+            utils::JobErrorList  errors;
+            utils::RunIndexedJobs( files.size(), 
+                                   XMLScratchBuffers(), 
+                                   [&]( XMLScratchBuffers & buf, size_t cntfile )
+                                   { 
+                                       ReadAMoveFile( files[cntfile], buf, parsed[cntfile] ); 
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "MoveDB_XML_Parser::ReadAllMoves()" );
+
+            //Assemble in file order
             uint32_t cntmv = 0;
-            for( auto & mv : files )
+            for( size_t cntfile = 0; cntfile < parsed.size(); ++cntfile )
             {
-                uint32_t         moveid = GetCurrentMoveId( mv, cntmv );
-                xml_document     doc;
-                xml_parse_result loadres = doc.load_file(mv.c_str());
-                if( ! loadres )
-                {
-                    stringstream sstr;
-                    sstr <<"Can't load XML document \"" <<mv <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
-                    throw std::runtime_error(sstr.str());
-                }
-
-                pugi::xml_node movenode  = doc.child(ROOT_Move.c_str());
-                if( !movenode )
-                {
-                    clog <<"<!>- MoveDB_XML_Parser::ReadAllMoves(): No move data found in XML file \"" <<mv <<"\". Skipping..\n";
-                    continue;
-                }
-
-                eGameVersion gamever = DetectGameVersion(movenode);
-
-                if( gamever == eGameVersion::EoS )
-                    HandleMoveEoS( movenode, moveid, result1, result2 );
-                else if( gamever == eGameVersion::EoT || gamever == eGameVersion::EoD )
-                    HandleMoveEoTD( movenode, moveid, result1 );
-                else
-                {
-                    clog <<"<!>- MoveDB_XML_Parser::ReadAllMoves(): Got move with invalid game version.. Skipping..\n";
+                moveparseres & entry = parsed[cntfile];
+                if( entry.gamever == eGameVersion::Invalid )
                     continue;
-                }
 
+                if( !m_bNoStrings )
+                    entry.strings.Apply( *m_pgametext, GetCurrentMoveId( files[cntfile], cntmv ) );
+                for( auto & mv : entry.data1 )
+                    result1.push_back(std::move(mv));
+                for( auto & mv : entry.data2 )
+                    result2.push_back(std::move(mv));
                 ++cntmv;
             }
 
@@ -380,6 +387,42 @@ namespace pmd2 { namespace stats
             }
         }
 
+        /*
+            Parses a single move file. Runs on a worker thread, so it must only write to "out_res".
+        */
+        void ReadAMoveFile( const string & mv, XMLScratchBuffers & buf, moveparseres & out_res )
+        {
+            using namespace movesXML;
+            xml_document     doc;
+            xml_parse_result loadres = LoadDocumentWithBuffer( doc, mv, buf.inbuf );
+            if( ! loadres )
+            {
+                stringstream sstr;
+                sstr <<"Can't load XML document \"" <<mv <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
+                throw std::runtime_error(sstr.str());
+            }
+
+            pugi::xml_node movenode  = doc.child(ROOT_Move.c_str());
+            if( !movenode )
+            {
+                clog <<"<!>- MoveDB_XML_Parser::ReadAllMoves(): No move data found in XML file \"" <<mv <<"\". Skipping..\n";
+                return;
+            }
+
+            eGameVersion gamever = DetectGameVersion(movenode);
+
+            if( gamever == eGameVersion::EoS )
+                HandleMoveEoS( movenode, out_res.strings, out_res.data1, out_res.data2 );
+            else if( gamever == eGameVersion::EoT || gamever == eGameVersion::EoD )
+                HandleMoveEoTD( movenode, out_res.strings, out_res.data1 );
+            else
+            {
+                clog <<"<!>- MoveDB_XML_Parser::ReadAllMoves(): Got move with invalid game version.. Skipping..\n";
+                return;
+            }
+            out_res.gamever = gamever;
+        }
+
         /*
         */
         eGameVersion DetectGameVersion( xml_node & movenode )
@@ -404,14 +447,14 @@ namespace pmd2 { namespace stats
 
         /*
         */
-        void HandleMoveEoS( xml_node & pn, uint32_t moveid, MoveDB & result1, MoveDB & result2 )
+        void HandleMoveEoS( xml_node & pn, PendingStringEdits & out_strings, vector<MoveData> & result1, vector<MoveData> & result2 )
         {
             using namespace movesXML;
             bool breadData1 = false; //This is to alternate between data entry 1 and 2
             for( auto & cnode : pn.children() )
             {
                 if( !m_bNoStrings && cnode.name() == NODE_Strings )
-                    ReadStrings( cnode, moveid );
+                    ReadStrings( cnode, out_strings );
                 else if( cnode.name() == NODE_Data )
                 {
                     if( !breadData1 )
@@ -430,13 +473,13 @@ namespace pmd2 { namespace stats
 
         /*
         */
-        void HandleMoveEoTD( xml_node & pn, uint32_t moveid, MoveDB & result1 )
+        void HandleMoveEoTD( xml_node & pn, PendingStringEdits & out_strings, vector<MoveData> & result1 )
         {
             using namespace movesXML;
             for( auto & cnode : pn.children() )
             {
                 if( !m_bNoStrings && cnode.name() == NODE_Strings )
-                    ReadStrings( cnode, moveid );
+                    ReadStrings( cnode, out_strings );
                 else if( cnode.name() == NODE_Data )
                     result1.push_back(ReadMoveData( cnode ));
             }
@@ -444,7 +487,7 @@ namespace pmd2 { namespace stats
 
         /*
         */
-        void ReadStrings( xml_node & pn, uint32_t moveid )
+        void ReadStrings( xml_node & pn, PendingStringEdits & out_strings )
         {
             using namespace movesXML;
             for( auto & curnode : pn.children() )
@@ -453,24 +496,23 @@ namespace pmd2 { namespace stats
                 if( glang != eGameLanguages::Invalid )
                 {
                     //Parse multi-language strings
-                    ReadLangStrings(curnode, glang, moveid);
+                    ReadLangStrings(curnode, glang, out_strings);
                 }
                 else
                 {
                     //If the game isn't multi-lingual, just parse the strings for english
                     clog<<"<!>- MoveDB_XML_Parser::ReadStrings() : Found a non language named node!\n";
-                    ReadLangStrings(curnode, eGameLanguages::english, moveid);
+                    ReadLangStrings(curnode, eGameLanguages::english, out_strings);
                 }
             }
         }
 
         /*
         */
-        void ReadLangStrings( xml_node & langnode, eGameLanguages lang, uint32_t moveid )
+        void ReadLangStrings( xml_node & langnode, eGameLanguages lang, PendingStringEdits & out_strings )
         {
             using namespace movesXML;
-            auto langstr = m_pgametext->GetStrings(lang);
-            if( langstr == m_pgametext->end() )
+            if( !m_pgametext->IsLangLoaded(lang) )
             {
                 clog<<"<!>- MoveDB_XML_Parser::ReadLangStrings(): Found strings for " <<GetGameLangName(lang) <<", but the language was not loaded for editing! Skipping!\n";
                 return;
@@ -482,19 +524,13 @@ namespace pmd2 { namespace stats
                 {
                     string name = curnode.child_value();
                     name += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists(eStringBlocks::MvNames, moveid);
-                    if(!pstr)
-                        throw std::runtime_error("MoveDB_XML_Parser::ReadLangStrings(): Couldn't access the move name string block!");
-                    *(pstr) = name;
+                    out_strings.Push( lang, eStringBlocks::MvNames, std::move(name) );
                 }
                 else if( curnode.name() == PROP_Desc )
                 {
                     string desc = curnode.child_value();
                     desc += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists(eStringBlocks::MvDesc, moveid);
-                    if(!pstr)
-                        throw std::runtime_error("MoveDB_XML_Parser::ReadLangStrings(): Couldn't access the move description string block!");
-                    *(pstr) = desc;
+                    out_strings.Push( lang, eStringBlocks::MvDesc, std::move(desc) );
                 }
             }
         }
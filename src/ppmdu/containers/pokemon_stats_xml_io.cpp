@@ -5,6 +5,7 @@
 #include "pokemon_stats.hpp"
 #include <utils/parse_utils.hpp>
 #include <utils/pugixml_utils.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <pugixml.hpp>
 #include <sstream>
 #include <iostream>
@@ -12,6 +13,7 @@
 #include <fstream>
 #include <memory>
 #include <functional>
+#include <algorithm>
 #include <Poco/DirectoryIterator.h>
 #include <Poco/File.h>
 #include <Poco/Path.h>
@@ -191,40 +193,42 @@ namespace pmd2 {namespace stats
             return out_fname;
         }
 
+        /*
+            Each worker thread gets its own copy of the writer, so the conversion buffers, and the xml buffers aren't shared.
+        */
         void WriteAllEntries( const string & outdir )
+        {
+            const string        outpathpre = utils::TryAppendSlash(outdir);
+            utils::JobErrorList errors;
+
+            utils::RunIndexedJobs( m_src.size(), 
+                                   *this, 
+                                   [&outpathpre]( PokemonDB_XMLWriter & wrtr, size_t cntpkmn )
+                                   { 
+                                       wrtr.WriteAnEntry( outpathpre, static_cast<unsigned int>(cntpkmn) ); 
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "PokemonDB_XMLWriter::WriteAllEntries()" );
+        }
+
+        void WriteAnEntry( const string & outpathpre, unsigned int cntpkmn )
         {
             using namespace pkmnXML;
             stringstream sstrfname;
-            const string outpathpre = utils::TryAppendSlash(outdir);
+            MakeFilename(sstrfname, outpathpre, cntpkmn);
 
-            for( unsigned int cntpkmn = 0; cntpkmn < m_src.size(); ++cntpkmn )
-            {
-                sstrfname.str(string());
-                MakeFilename(sstrfname, outpathpre, cntpkmn);
-                //if( !m_bNoStrings )
-                //{
-                //    const string * pfstr = m_pgametext->begin()->second.GetStringInBlock( eStringBlocks::PkmnNames, cntpkmn );
-                //    if( pfstr )
-                //        sstrfname <<outpathpre <<setw(4) <<setfill('0') <<cntpkmn <<"_" <<PreparePokeNameFName(*pfstr, m_pgametext->begin()->first) <<".xml";
-                //    else
-                //        sstrfname <<outpathpre <<setw(4) <<setfill('0') <<cntpkmn <<".xml";
-                //}
-                //else
-                //    sstrfname <<outpathpre <<setw(4) <<setfill('0') <<cntpkmn <<".xml";
-
-                xml_document doc;
-                xml_node     pknode = doc.append_child( ROOT_Pkmn.c_str() );
-
-                if( m_src.isEoSData() )
-                    AppendAttribute( pknode, ATTR_GameVer, GameVersion_EoS );
-                else
-                    AppendAttribute( pknode, ATTR_GameVer, GameVersion_EoTD );
+            xml_document doc;
+            xml_node     pknode = doc.append_child( ROOT_Pkmn.c_str() );
 
-                WriteAPokemon( m_src[cntpkmn], pknode, cntpkmn );
+            if( m_src.isEoSData() )
+                AppendAttribute( pknode, ATTR_GameVer, GameVersion_EoS );
+            else
+                AppendAttribute( pknode, ATTR_GameVer, GameVersion_EoTD );
 
-                if( ! doc.save_file( sstrfname.str().c_str() ) )
-                    throw std::runtime_error("Can't write xml file " + sstrfname.str());
-            }
+            WriteAPokemon( m_src[cntpkmn], pknode, cntpkmn );
+
+            if( ! SaveDocumentWithBuffer( doc, sstrfname.str(), m_xmlbuf.outbuf ) )
+                throw std::runtime_error("Can't write xml file " + sstrfname.str());
         }
 
         void WriteAPokemon( const CPokemon & pkmn, xml_node & pknode, unsigned int pkindex )
@@ -423,6 +427,7 @@ namespace pmd2 {namespace stats
         //Conversion buffers. Used for faster value conversion. (Don't need all the extra locale stuff from stringstream, as all values are raw data)
         array<char,CBuffSZ>                      m_convBuff;
         array<char,CBuffSZ>                      m_secConvbuffer;
+        XMLScratchBuffers                        m_xmlbuf;
 
         bool                                     m_bNoStrings; //If true, omit strings entirely, and don't write pokemon names for each files!
     };
@@ -456,7 +461,7 @@ namespace pmd2 {namespace stats
         /*
         */
         PokemonDB_XMLParser( PokemonDB & out_pkdb, GameText  * inout_gtext )
-            :m_out(out_pkdb), m_isEoS(false), m_pgametext(inout_gtext), m_bParsePokemonId(false)
+            :m_out(out_pkdb), m_isEoS(false), m_pgametext(inout_gtext), m_bNoStrings(false), m_bParsePokemonId(false)
         {
         }
         
@@ -507,6 +512,18 @@ namespace pmd2 {namespace stats
             return pkid;
         }
 
+        /*
+            Result of parsing a single pokemon file on a worker thread.
+        */
+        struct pkmnparseres
+        {
+            pkmnparseres():bhasdata(false),bhadEoSAttribute(false){}
+            bool               bhasdata;            //Whether the file had a pokemon node
+            bool               bhadEoSAttribute;
+            CPokemon           pkmn;
+            PendingStringEdits strings;             //Strings are put in the GameText once we know the final pokemon index
+        };
+
         vector<CPokemon> ReadAllPokemon( const string & srcdir )
         {
             using namespace pkmnXML;
@@ -522,35 +539,41 @@ namespace pmd2 {namespace stats
             if( filelst.empty() )
                 throw std::runtime_error( "PokemonDB_XMLParser::ReadAllPokemon(): Couldn't find any xml files under the path \"" + srcdir + "\"!" );
 
+            //Directory listing order depends on the filesystem, sort to get the same pokemon order everywhere
+            std::sort( filelst.begin(), filelst.end() );
+
+            //Parse all files in parallel. Each file's result goes into its own slot.
+            vector<pkmnparseres> parsed(filelst.size());
+            utils::JobErrorList  errors;
+            utils::RunIndexedJobs( filelst.size(), 
+                                   XMLScratchBuffers(), 
+                                   [&]( XMLScratchBuffers & buf, size_t cntfile )
+                                   { 
+                                       ReadAPokemonFile( filelst[cntfile], cntfile, buf, parsed[cntfile] ); 
+                                   },
+                                   errors );
+            errors.ThrowIfAny( "PokemonDB_XMLParser::ReadAllPokemon()" );
+
+            //Assemble the results in file order
             vector<CPokemon> result;
             result.reserve(filelst.size());
 
             uint32_t cntEoSPk = 0;
             uint32_t cntPkmn  = 0;
-            for( auto & pkmn : filelst )
+            for( auto & entry : parsed )
             {
-                uint32_t         pkid = GetCurrentPokemonID(pkmn,cntPkmn);
-                xml_document     doc;
-                xml_parse_result loadres = doc.load_file(pkmn.c_str());
-                if( ! loadres )
-                {
-                    stringstream sstr;
-                    sstr <<"Can't load XML document \"" <<pkmn <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
-                    throw std::runtime_error(sstr.str());
-                }
-
-                bool     hadEoSAttribute = false;
-                xml_node rootnode        = doc.child(ROOT_Pkmn.c_str());
-                if( rootnode )
-                    result.push_back( ReadPokemon( rootnode, cntPkmn, hadEoSAttribute ) );
-                else
+                if( !entry.bhasdata )
                 {
                     clog << "<!>- PokemonDB_XMLParser::ReadAllPokemon(): Skipping XML file with no pokemon data..\n";
                     continue;
                 }
 
+                if( !m_bNoStrings )
+                    entry.strings.Apply( *m_pgametext, cntPkmn );
+                result.push_back( std::move(entry.pkmn) );
+
                 //Count EoS pokes
-                if( hadEoSAttribute )
+                if( entry.bhadEoSAttribute )
                     ++cntEoSPk;
 
                 ++cntPkmn;
@@ -570,6 +593,29 @@ namespace pmd2 {namespace stats
             return std::move(result);
         }
 
+        /*
+            Parses a single file. Runs on a worker thread, so it must only write to "out_res".
+        */
+        void ReadAPokemonFile( const string & fpath, size_t cntfile, XMLScratchBuffers & buf, pkmnparseres & out_res )
+        {
+            using namespace pkmnXML;
+            xml_document     doc;
+            xml_parse_result loadres = LoadDocumentWithBuffer( doc, fpath, buf.inbuf );
+            if( ! loadres )
+            {
+                stringstream sstr;
+                sstr <<"Can't load XML document \"" <<fpath <<"\"! Pugixml returned an error : \"" << loadres.description() <<"\"";
+                throw std::runtime_error(sstr.str());
+            }
+
+            xml_node rootnode = doc.child(ROOT_Pkmn.c_str());
+            if( !rootnode )
+                return;
+
+            out_res.pkmn     = ReadPokemon( rootnode, static_cast<uint32_t>(cntfile), out_res.strings, out_res.bhadEoSAttribute );
+            out_res.bhasdata = true;
+        }
+
         ////Get pokemon name string reference
         //std::string & GetStringRefPkmn( uint32_t index )
         //{
@@ -598,7 +644,7 @@ namespace pmd2 {namespace stats
         //    }
         //}
 
-        CPokemon ReadPokemon( xml_node & pknode, uint32_t cntpokemon, bool & isEoS )
+        CPokemon ReadPokemon( xml_node & pknode, uint32_t cntpokemon, PendingStringEdits & out_strings, bool & isEoS )
         {
             using namespace pkmnXML;
             //CPokemon curpoke;
@@ -641,7 +687,7 @@ namespace pmd2 {namespace stats
             {
                 if( !m_bNoStrings && curnode.name() == NODE_Strings )
                 {
-                    ReadStrings(curnode,cntpokemon);
+                    ReadStrings(curnode,out_strings);
                 }
                 else if( curnode.name() == NODE_SGrowth )
                 {
@@ -687,7 +733,7 @@ namespace pmd2 {namespace stats
                 return CPokemon( move(gen1), move(sg), move(mvset1), move(mvset2) );
         }
 
-        void ReadStrings( xml_node & strnode, uint32_t cntpkmn )
+        void ReadStrings( xml_node & strnode, PendingStringEdits & out_strings )
         {
             using namespace pkmnXML;
             for( auto & curnode : strnode.children() )
@@ -696,21 +742,20 @@ namespace pmd2 {namespace stats
                 if( glang != eGameLanguages::Invalid )
                 {
                     //Parse multi-language strings
-                    ReadLangStrings(curnode, glang, cntpkmn);
+                    ReadLangStrings(curnode, glang, out_strings);
                 }
                 else
                 {
                     //If the game isn't multi-lingual, just parse the strings for english
                     clog<<"<!>- PokemonDB_XMLParser::ReadStrings() : Found a non language named node!\n";
-                    ReadLangStrings(curnode, eGameLanguages::english, cntpkmn);
+                    ReadLangStrings(curnode, eGameLanguages::english, out_strings);
                 }
             }
         }
 
-        void ReadLangStrings( xml_node & langnode, eGameLanguages lang, uint32_t cntpkmn )
+        void ReadLangStrings( xml_node & langnode, eGameLanguages lang, PendingStringEdits & out_strings )
         {
-            auto langstr = m_pgametext->GetStrings(lang);
-            if( langstr == m_pgametext->end() )
+            if( !m_pgametext->IsLangLoaded(lang) )
             {
                 clog<<"<!>- PokemonDB_XMLParser::ReadLangStrings(): Found strings for " <<GetGameLangName(lang) <<", but the language was not loaded for editing! Skipping!\n";
                 return;
@@ -723,19 +768,13 @@ namespace pmd2 {namespace stats
                 {
                     string pkname = curnode.child_value();
                     pkname += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists( eStringBlocks::PkmnNames, cntpkmn );
-                    if(!pstr)
-                        throw std::runtime_error("PokemonDB_XMLParser::ReadLangStrings(): Couldn't access the pokemon name string block!");
-                    *(pstr) = pkname;
+                    out_strings.Push( lang, eStringBlocks::PkmnNames, std::move(pkname) );
                 }
                 else if( curnode.name() == PROP_Category )
                 {
                     string pkcat = curnode.child_value();
                     pkcat += "\\0"; //put back the \0
-                    string * pstr = langstr->second.GetStringIfBlockExists( eStringBlocks::PkmnCats, cntpkmn );
-                    if(!pstr)
-                        throw std::runtime_error("PokemonDB_XMLParser::ReadLangStrings(): Couldn't access the pokemon category name string block!");
-                    *(pstr) = pkcat;
+                    out_strings.Push( lang, eStringBlocks::PkmnCats, std::move(pkcat) );
                 }
             }
         }
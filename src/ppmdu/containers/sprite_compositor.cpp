@@ -0,0 +1,349 @@
+#include "sprite_compositor.hpp"
+#include <ext_fmts/png_io.hpp>
+#include <utils/parallel_tasks.hpp>
+#include <utils/library_wide.hpp>
+#include <utils/poco_wrapper.hpp>
+#include <pugixml.hpp>
+#include <Poco/Path.h>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+using namespace std;
+
+namespace pmd2 { namespace graphics
+{
+//==============================================================================================
+//  Constants
+//==============================================================================================
+    const uint32_t    NbColorsPerPalRow     = 16;
+    const int32_t     MetaFrmOffsetXNbBits  = 9;   //Nb of bits of the x offset, once the flags and resolution are removed
+    const int32_t     MetaFrmOffsetYNbBits  = 10;  //Nb of bits of the y offset, once the flags and resolution are removed
+    const std::string AnimSheetsInfoFname   = "animsheets.xml";
+
+    namespace AnimSheetsXML
+    {
+        const std::string ROOT_AnimSheets = "AnimSheets";
+        const std::string NODE_Sheet      = "Sheet";
+        const std::string NODE_Sequence   = "Sequence";
+        const std::string NODE_Frame      = "Frame";
+        const std::string ATTR_Group      = "group";
+        const std::string ATTR_Name       = "name";
+        const std::string ATTR_File       = "file";
+        const std::string ATTR_CellWidth  = "cellwidth";
+        const std::string ATTR_CellHeight = "cellheight";
+        const std::string ATTR_OriginX    = "originx";
+        const std::string ATTR_OriginY    = "originy";
+        const std::string ATTR_Index      = "index";
+        const std::string ATTR_Duration   = "duration";
+    };
+
+//==============================================================================================
+//  Helpers
+//==============================================================================================
+    inline int32_t SignExtendOffset( int32_t value, int32_t nbbits )
+    {
+        const int32_t signbit = 1 << (nbbits - 1);
+        value &= (1 << nbbits) - 1;
+        return (value & signbit)? (value - (1 << nbbits)) : value;
+    }
+
+//==============================================================================================
+//  SpriteCompositor
+//==============================================================================================
+    void SpriteCompositor::bounds_t::Merge( const bounds_t & other )
+    {
+        if( other.empty() )
+            return;
+        if( empty() )
+        {
+            *this = other;
+            return;
+        }
+        left   = std::min( left,   other.left );
+        top    = std::min( top,    other.top );
+        right  = std::max( right,  other.right );
+        bottom = std::max( bottom, other.bottom );
+    }
+
+    SpriteCompositor::SpriteCompositor( const BaseSprite & sprite, bool bparallel )
+        :m_sprite(sprite), m_is8bpp(false)
+    {
+        if( sprite.getSpriteType() == eSpriteImgType::spr4bpp )
+        {
+            const SpriteData<gimg::tiled_image_i4bpp> * ptr = dynamic_cast<const SpriteData<gimg::tiled_image_i4bpp>*>(&sprite);
+            if( ptr )
+                DecodeImages( ptr->getFrames(), bparallel );
+        }
+        else if( sprite.getSpriteType() == eSpriteImgType::spr8bpp )
+        {
+            const SpriteData<gimg::tiled_image_i8bpp> * ptr = dynamic_cast<const SpriteData<gimg::tiled_image_i8bpp>*>(&sprite);
+            m_is8bpp = true;
+            if( ptr )
+                DecodeImages( ptr->getFrames(), bparallel );
+        }
+
+        const auto & srcpal = sprite.getPalette();
+        m_palette.resize( srcpal.size() * rgba_image::BytesPerPixel );
+        for( size_t cntcol = 0; cntcol < srcpal.size(); ++cntcol )
+        {
+            uint8_t * pcol = m_palette.data() + (cntcol * rgba_image::BytesPerPixel);
+            pcol[0] = srcpal[cntcol].red;
+            pcol[1] = srcpal[cntcol].green;
+            pcol[2] = srcpal[cntcol].blue;
+            pcol[3] = 255; //Color 0 of each row is never drawn
+        }
+    }
+
+    template<class _TImg_t>
+        void SpriteCompositor::DecodeImages( const std::vector<_TImg_t> & frames, bool bparallel )
+    {
+        m_imgs.resize( frames.size() );
+        auto lambdadecode = [&]( size_t cntimg )
+        {
+            const _TImg_t & src = frames[cntimg];
+            decodedimg_t  & dst = m_imgs[cntimg];
+            dst.width  = src.getNbPixelWidth();
+            dst.height = src.getNbPixelHeight();
+            dst.pixels.resize( static_cast<size_t>(dst.width) * dst.height );
+
+            for( uint32_t y = 0; y < dst.height; ++y )
+            {
+                uint8_t * prow = dst.pixels.data() + (static_cast<size_t>(y) * dst.width);
+                for( uint32_t x = 0; x < dst.width; ++x )
+                    prow[x] = static_cast<uint8_t>( src.getPixel(x,y).pixeldata );
+            }
+        };
+
+        if( bparallel )
+        {
+            utils::JobErrorList errors;
+            utils::RunIndexedJobs( frames.size(), lambdadecode, errors );
+            errors.ThrowIfAny("SpriteCompositor::DecodeImages()");
+        }
+        else
+        {
+            for( size_t cntimg = 0; cntimg < frames.size(); ++cntimg )
+                lambdadecode(cntimg);
+        }
+    }
+
+    uint32_t SpriteCompositor::GetPaletteBase( const MetaFrame & mf )const
+    {
+        if( m_is8bpp )
+            return 0;
+        //The palette row is in the upper nybble of the last byte of the meta-frame, like in a DS object's attributes
+        const uint32_t palbase = static_cast<uint32_t>(mf.unk1 >> 4) * NbColorsPerPalRow;
+        const uint32_t nbcols  = static_cast<uint32_t>( m_palette.size() / rgba_image::BytesPerPixel );
+        return ( (palbase + NbColorsPerPalRow) <= nbcols )? palbase : 0;
+    }
+
+    bool SpriteCompositor::GetMetaFrameBounds( const MetaFrame & mf, const AnimFrame & frm, bounds_t & out_bounds )const
+    {
+        if( !mf.HasValidImageIndex() || static_cast<size_t>(mf.imageIndex) >= m_imgs.size() )
+            return false;
+
+        const decodedimg_t & img = m_imgs[mf.imageIndex];
+        utils::Resolution    res = MetaFrame::eResToResolution( mf.resolution );
+        if( res.width == 0 || res.height == 0 )
+            res = utils::Resolution{ img.width, img.height };
+
+        out_bounds.left   = SignExtendOffset( mf.offsetX, MetaFrmOffsetXNbBits ) + frm.sprOffsetX;
+        out_bounds.top    = SignExtendOffset( mf.offsetY, MetaFrmOffsetYNbBits ) + frm.sprOffsetY;
+        out_bounds.right  = out_bounds.left + static_cast<int32_t>(res.width);
+        out_bounds.bottom = out_bounds.top  + static_cast<int32_t>(res.height);
+        return true;
+    }
+
+    SpriteCompositor::bounds_t SpriteCompositor::GetFrameBounds( const AnimFrame & frm )const
+    {
+        bounds_t result;
+        const auto & grps = m_sprite.getMetaFrmsGrps();
+        if( frm.metaFrmGrpIndex >= grps.size() )
+            return result;
+
+        const auto & mfrms = m_sprite.getMetaFrames();
+        for( size_t mfindex : grps[frm.metaFrmGrpIndex] )
+        {
+            bounds_t mfbounds;
+            if( mfindex < mfrms.size() && GetMetaFrameBounds( mfrms[mfindex], frm, mfbounds ) )
+                result.Merge(mfbounds);
+        }
+        return result;
+    }
+
+    SpriteCompositor::bounds_t SpriteCompositor::GetSequenceBounds( uint32_t seqindex )const
+    {
+        bounds_t result;
+        const AnimationSequence & seq = m_sprite.getAnimSequences().at(seqindex);
+        for( unsigned int cntfrm = 0; cntfrm < seq.getNbFrames(); ++cntfrm )
+            result.Merge( GetFrameBounds( seq.getFrame(cntfrm) ) );
+        return result;
+    }
+
+    SpriteCompositor::bounds_t SpriteCompositor::GetAnimGroupBounds( uint32_t grpindex )const
+    {
+        bounds_t result;
+        for( uint32_t seqindex : m_sprite.getAnimGroups().at(grpindex).seqsIndexes )
+            result.Merge( GetSequenceBounds(seqindex) );
+        return result;
+    }
+
+    void SpriteCompositor::RenderFrame( const AnimFrame & frm, rgba_image & dest, int32_t originx, int32_t originy )const
+    {
+        const auto & grps  = m_sprite.getMetaFrmsGrps();
+        const auto & mfrms = m_sprite.getMetaFrames();
+        if( frm.metaFrmGrpIndex >= grps.size() )
+            return;
+
+        //Draw the last meta-frames first, so the first ones end up on top
+        const MetaFrameGroup & grp = grps[frm.metaFrmGrpIndex];
+        for( size_t cntmf = grp.size(); cntmf-- > 0; )
+        {
+            if( grp[cntmf] >= mfrms.size() )
+                continue;
+            const MetaFrame & mf = mfrms[grp[cntmf]];
+            bounds_t          mfbounds;
+            if( !GetMetaFrameBounds( mf, frm, mfbounds ) )
+                continue;
+
+            const decodedimg_t & img     = m_imgs[mf.imageIndex];
+            const uint32_t       palbase = GetPaletteBase(mf);
+            const uint32_t       partw   = std::min( mfbounds.width(),  img.width );
+            const uint32_t       parth   = std::min( mfbounds.height(), img.height );
+            const int32_t        destx   = originx + mfbounds.left;
+            const int32_t        desty   = originy + mfbounds.top;
+
+            //Clip against the destination
+            const int32_t begx = std::max( 0, -destx );
+            const int32_t begy = std::max( 0, -desty );
+            const int32_t endx = std::min( static_cast<int32_t>(partw), static_cast<int32_t>(dest.width)  - destx );
+            const int32_t endy = std::min( static_cast<int32_t>(parth), static_cast<int32_t>(dest.height) - desty );
+
+            for( int32_t y = begy; y < endy; ++y )
+            {
+                const uint32_t  srcy  = mf.vFlip? (parth - 1 - y) : y;
+                const uint8_t * psrc  = img.pixels.data() + (static_cast<size_t>(srcy) * img.width);
+                uint8_t       * pdest = dest.pixels.data() + ( (static_cast<size_t>(desty + y) * dest.width) + (destx + begx) ) * rgba_image::BytesPerPixel;
+
+                for( int32_t x = begx; x < endx; ++x, pdest += rgba_image::BytesPerPixel )
+                {
+                    const uint8_t colindex = psrc[ mf.hFlip? (partw - 1 - x) : x ];
+                    const size_t  palindex = (palbase + colindex) * rgba_image::BytesPerPixel;
+                    if( colindex == 0 || (palindex + rgba_image::BytesPerPixel) > m_palette.size() )
+                        continue;
+                    std::copy_n( m_palette.data() + palindex, rgba_image::BytesPerPixel, pdest );
+                }
+            }
+        }
+    }
+
+    rgba_image SpriteCompositor::RenderAnimGroupSheet( uint32_t grpindex, bounds_t & out_cell )const
+    {
+        const SpriteAnimationGroup & grp = m_sprite.getAnimGroups().at(grpindex);
+        size_t nbcols = 0;
+        for( uint32_t seqindex : grp.seqsIndexes )
+            nbcols = std::max<size_t>( nbcols, m_sprite.getAnimSequences().at(seqindex).getNbFrames() );
+
+        out_cell = GetAnimGroupBounds(grpindex);
+        if( out_cell.empty() || nbcols == 0 )
+            return rgba_image();
+
+        const uint32_t cellw = out_cell.width();
+        const uint32_t cellh = out_cell.height();
+        rgba_image     sheet( cellw * static_cast<uint32_t>(nbcols), cellh * static_cast<uint32_t>(grp.seqsIndexes.size()) );
+
+        for( size_t cntrow = 0; cntrow < grp.seqsIndexes.size(); ++cntrow )
+        {
+            const AnimationSequence & seq = m_sprite.getAnimSequences()[grp.seqsIndexes[cntrow]];
+            for( unsigned int cntfrm = 0; cntfrm < seq.getNbFrames(); ++cntfrm )
+            {
+                const int32_t originx = static_cast<int32_t>(cntfrm * cellw) - out_cell.left;
+                const int32_t originy = static_cast<int32_t>(cntrow * cellh) - out_cell.top;
+                RenderFrame( seq.getFrame(cntfrm), sheet, originx, originy );
+            }
+        }
+        return std::move(sheet);
+    }
+
+//==============================================================================================
+//  Functions
+//==============================================================================================
+    uint32_t ExportAnimationSheets( const BaseSprite & sprite, const std::string & outdir, bool bparallel )
+    {
+        using namespace AnimSheetsXML;
+        const SpriteCompositor compositor( sprite, bparallel );
+        const auto           & groups = sprite.getAnimGroups();
+        vector<SpriteCompositor::bounds_t> cells( groups.size() );
+        vector<string>                     fnames( groups.size() );
+
+        if( !utils::isFolder(outdir) && !utils::DoCreateDirectory(outdir) )
+            throw runtime_error("ExportAnimationSheets(): Couldn't create output directory \"" + outdir + "\"!");
+
+        auto lambdaexport = [&]( size_t cntgrp )
+        {
+            rgba_image sheet = compositor.RenderAnimGroupSheet( static_cast<uint32_t>(cntgrp), cells[cntgrp] );
+            if( sheet.pixels.empty() )
+                return;
+
+            stringstream sstrfname;
+            sstrfname <<"anim_" <<setfill('0') <<setw(3) <<cntgrp;
+            if( !groups[cntgrp].group_name.empty() )
+                sstrfname <<"_" <<groups[cntgrp].group_name;
+            sstrfname <<"." <<utils::io::PNG_FileExtension;
+
+            const string fpath = Poco::Path(outdir).append(sstrfname.str()).toString();
+            if( !utils::io::ExportRGBA32ToPNG( sheet.pixels, sheet.width, sheet.height, fpath ) )
+                throw runtime_error("ExportAnimationSheets(): Couldn't write sheet \"" + fpath + "\"!");
+            fnames[cntgrp] = sstrfname.str();
+        };
+
+        utils::JobErrorList errors;
+        if( bparallel )
+            utils::RunIndexedJobs( groups.size(), lambdaexport, errors );
+        else
+        {
+            for( size_t cntgrp = 0; cntgrp < groups.size(); ++cntgrp )
+                lambdaexport(cntgrp);
+        }
+        errors.ThrowIfAny("ExportAnimationSheets()");
+
+        //Write the sheets info
+        pugi::xml_document doc;
+        pugi::xml_node     rootnode = doc.append_child( ROOT_AnimSheets.c_str() );
+        uint32_t           nbsheets = 0;
+        for( size_t cntgrp = 0; cntgrp < groups.size(); ++cntgrp )
+        {
+            if( fnames[cntgrp].empty() )
+                continue;
+            ++nbsheets;
+            pugi::xml_node sheetnode = rootnode.append_child( NODE_Sheet.c_str() );
+            sheetnode.append_attribute( ATTR_Group.c_str() )      = static_cast<unsigned int>(cntgrp);
+            sheetnode.append_attribute( ATTR_Name.c_str() )       = groups[cntgrp].group_name.c_str();
+            sheetnode.append_attribute( ATTR_File.c_str() )       = fnames[cntgrp].c_str();
+            sheetnode.append_attribute( ATTR_CellWidth.c_str() )  = cells[cntgrp].width();
+            sheetnode.append_attribute( ATTR_CellHeight.c_str() ) = cells[cntgrp].height();
+            sheetnode.append_attribute( ATTR_OriginX.c_str() )    = -cells[cntgrp].left;
+            sheetnode.append_attribute( ATTR_OriginY.c_str() )    = -cells[cntgrp].top;
+
+            for( uint32_t seqindex : groups[cntgrp].seqsIndexes )
+            {
+                const AnimationSequence & seq     = sprite.getAnimSequences()[seqindex];
+                pugi::xml_node            seqnode = sheetnode.append_child( NODE_Sequence.c_str() );
+                seqnode.append_attribute( ATTR_Index.c_str() ) = seqindex;
+                for( unsigned int cntfrm = 0; cntfrm < seq.getNbFrames(); ++cntfrm )
+                    seqnode.append_child( NODE_Frame.c_str() ).append_attribute( ATTR_Duration.c_str() ) = seq.getFrame(cntfrm).frameDuration;
+            }
+        }
+
+        const string infopath = Poco::Path(outdir).append(AnimSheetsInfoFname).toString();
+        if( !doc.save_file( infopath.c_str() ) )
+            throw runtime_error("ExportAnimationSheets(): Couldn't write \"" + infopath + "\"!");
+
+        if( utils::LibWide().isLogOn() )
+            clog <<"ExportAnimationSheets(): Wrote " <<nbsheets <<" animation sheets to \"" <<outdir <<"\".\n";
+        return nbsheets;
+    }
+
+};};
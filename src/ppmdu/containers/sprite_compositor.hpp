@@ -0,0 +1,130 @@
+#ifndef SPRITE_COMPOSITOR_HPP
+#define SPRITE_COMPOSITOR_HPP
+/*
+sprite_compositor.hpp
+2016/10/25
+psycommando@gmail.com
+Description:
+    Assembles the meta-frames of a sprite into rendered RGBA animation frames, and lays whole animation
+    groups out into sprite sheets, for previewing animations.
+*/
+#include <ppmdu/containers/sprite_data.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace pmd2 { namespace graphics
+{
+    /*
+        rgba_image
+            A plain 32 bits RGBA bitmap. 4 bytes per pixel, in R, G, B, A order, row by row.
+    */
+    struct rgba_image
+    {
+        static const uint32_t BytesPerPixel = 4;
+
+        rgba_image( uint32_t w = 0, uint32_t h = 0 )
+            :width(w), height(h), pixels( static_cast<size_t>(w) * h * BytesPerPixel, 0 )
+        {}
+
+        uint32_t             width;
+        uint32_t             height;
+        std::vector<uint8_t> pixels;
+    };
+
+    /************************************************************************************************
+        SpriteCompositor
+            Renders animation frames, by drawing the images of every meta-frames of the frame's
+            meta-frame group at their offset, with their flips and palette.
+
+            All the images of the sprite are turned into linear 8 bits palette indices once, when
+            the compositor is built, and are then reused by every frames refering to them. Once built,
+            the compositor is read-only, and can render from several threads at once.
+
+            Positions are relative to the sprite's origin. Meta-frames offsets are read as
+            signed values of the same bit width as in the file, like the DS does when placing objects
+            on screen, and the animation frame's offset is added to them. Earlier meta-frames in a
+            group are drawn over later ones, like objects on the DS. Meta-frames with a -1 image
+            index are skipped, as they refer to tiles loaded by an earlier meta-frame.
+    ************************************************************************************************/
+    class SpriteCompositor
+    {
+    public:
+        //A rectangle in sprite coordinates. right and bottom are excluded.
+        struct bounds_t
+        {
+            int32_t left   = 0;
+            int32_t top    = 0;
+            int32_t right  = 0;
+            int32_t bottom = 0;
+
+            inline bool     empty ()const { return left >= right || top >= bottom; }
+            inline uint32_t width ()const { return empty()? 0 : static_cast<uint32_t>(right - left); }
+            inline uint32_t height()const { return empty()? 0 : static_cast<uint32_t>(bottom - top); }
+            void            Merge( const bounds_t & other );
+        };
+
+        //bparallel : Decode the sprite's images over the library-wide thread budget.
+        explicit SpriteCompositor( const BaseSprite & sprite, bool bparallel = true );
+
+        /*
+            Returns the area covered by the images of a frame, or by all the frames of a sequence/group.
+        */
+        bounds_t GetFrameBounds    ( const AnimFrame & frm )const;
+        bounds_t GetSequenceBounds ( uint32_t seqindex )const;
+        bounds_t GetAnimGroupBounds( uint32_t grpindex )const;
+
+        /*
+            RenderFrame
+                Draws an animation frame into "dest", with the sprite's origin at "originx", "originy".
+                Transparent pixels leave "dest" untouched. Parts outside of "dest" are clipped.
+        */
+        void RenderFrame( const AnimFrame & frm, rgba_image & dest, int32_t originx, int32_t originy )const;
+
+        /*
+            RenderAnimGroupSheet
+                Renders all the frames of the sequences in an animation group into a single sheet.
+                Each sequence is a row, and each of its frames a column. All cells are the size
+                of the bounds of the whole group, so frames line up from one row to the next.
+                - out_cell : Receives the bounds of a cell, relative to the sprite's origin.
+                Returns an empty image if the group has no frames to draw.
+        */
+        rgba_image RenderAnimGroupSheet( uint32_t grpindex, bounds_t & out_cell )const;
+
+        inline const BaseSprite & getSprite()const { return m_sprite; }
+
+    private:
+        //An image of the sprite, as linear 8 bits palette indices
+        struct decodedimg_t
+        {
+            uint32_t             width  = 0;
+            uint32_t             height = 0;
+            std::vector<uint8_t> pixels;
+        };
+
+        template<class _TImg_t>
+            void DecodeImages( const std::vector<_TImg_t> & frames, bool bparallel );
+
+        bool     GetMetaFrameBounds( const MetaFrame & mf, const AnimFrame & frm, bounds_t & out_bounds )const;
+        uint32_t GetPaletteBase    ( const MetaFrame & mf )const;
+
+    private:
+        const BaseSprite        & m_sprite;
+        std::vector<decodedimg_t> m_imgs;
+        std::vector<uint8_t>      m_palette; //4 bytes per color, RGBA. Color 0 of each palette row is transparent.
+        bool                      m_is8bpp;
+    };
+
+    /*
+        ExportAnimationSheets
+            Renders every animation groups of a sprite into a sheet, and writes them as PNG files into "outdir",
+            along with an XML file listing the sheets, cell sizes, and frame durations.
+            - bparallel : Render groups over the library-wide thread budget. Turn it off when the caller
+                          already exports several sprites at once.
+            Returns the nb of sheets written.
+    */
+    uint32_t ExportAnimationSheets( const BaseSprite & sprite, const std::string & outdir, bool bparallel = true );
+
+};};
+
+#endif
@@ -3,6 +3,7 @@
 */
 #include "sprite_io.hpp"
 #include <utils/poco_wrapper.hpp>
+#include <utils/pugixml_utils.hpp>
 #include <ppmdu/containers/sprite_data.hpp>
 #include <vector>
 #include <fstream>
@@ -818,7 +819,7 @@ namespace pmd2 { namespace graphics
             writeComment( rootnode, SprInfo::DESC_Unk12 );
             WriteNodeWithValue( rootnode, XML_PROP_UNK12, FastTurnIntToHexCStr( m_pInSprite->getSprInfo().Unk12 ) );
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write sprite info xml file!");
         }
 
@@ -849,7 +850,7 @@ namespace pmd2 { namespace graphics
                 WriteNodeWithValue( curcolor, XML_PROP_BLUE, FastTurnIntToCStr( acolor.blue ) );
             }
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write palette xml file!");
         }
 
@@ -982,7 +983,7 @@ namespace pmd2 { namespace graphics
             }
 
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write animation xml file!");
         }
 
@@ -1022,7 +1023,7 @@ namespace pmd2 { namespace graphics
                 //    m_pProgresscnt->store( saveprogress + ( proportionofwork * i ) / m_pInSprite->getMetaFrmsGrps().size() );
             }
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write meta-frames xml file!");
         }
 
@@ -1118,7 +1119,7 @@ namespace pmd2 { namespace graphics
                 }
             }
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write offset list xml file!");
         }
 
@@ -1149,7 +1150,7 @@ namespace pmd2 { namespace graphics
                 //    m_pProgresscnt->store( saveprogress + ( proportionofwork * cpt ) / m_pInSprite->getImgsInfo().size() );
             }
 
-            if( ! doc.save_file( outpath.c_str() ) )
+            if( ! pugixmlutils::SaveDocumentWithBuffer( doc, outpath, m_xmlbuf ) )
                 throw std::runtime_error("Error, can't write image info xml file!");
         }
 
@@ -1164,6 +1165,7 @@ namespace pmd2 { namespace graphics
         std::array<char,CBuffSZ> m_convBuff;           //A buffer for executing convertions to c-strings. Pretty ugly, but less constructor calls, for simple, non-localised integer convertions.
         std::array<char,CBuffSZ> m_secConvbuffer;      //A Secondary convertion buffer
         std::stringstream        m_strs;               //Instance-wide stringstream to handle conversions. Reduces overhead a little bit.
+        std::string              m_xmlbuf;             //Serialized xml documents, before they're written out
     };
 
 //=============================================================================================
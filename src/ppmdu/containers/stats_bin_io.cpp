@@ -0,0 +1,1102 @@
+#include "stats_bin_io.hpp"
+#include <utils/gbyteutils.hpp>
+#include <utils/utility.hpp>
+#include <utils/library_wide.hpp>
+#include <Poco/File.h>
+#include <Poco/SharedMemory.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+using namespace std;
+
+namespace pmd2 { namespace stats
+{
+//==================================================================================
+//  Constants
+//==================================================================================
+    namespace statsbin
+    {
+        static const array<char,8> Magic           = {'P','M','D','2','S','T','A','T'};
+        static const size_t        HeaderLen       = 32;
+        static const size_t        TableEntryLen   = 16;
+        static const size_t        ColumnEntryLen  = 16;
+        static const size_t        DataAlignment   = 4;
+        static const uint16_t      FlagEoSPkmnData = 0x1;
+
+        //Table IDs
+        static const array<char,4> TBL_Pokemon     = {'P','K','M','N'}; //One row per pokemon
+        static const array<char,4> TBL_MonsterData = {'M','D','A','T'}; //One row per gender entry
+        static const array<char,4> TBL_Growth      = {'G','R','O','W'}; //One row per pokemon per level
+        static const array<char,4> TBL_Learnsets   = {'L','R','N','S'}; //One row per move in a learnset
+        static const array<char,4> TBL_Moves       = {'M','O','V','E'}; //One row per move per move set
+        static const array<char,4> TBL_Items       = {'I','T','E','M'}; //One row per item
+        static const array<char,4> TBL_Text        = {'T','E','X','T'}; //One row per string
+
+        //Column names that aren't part of a field list
+        static const char * COL_PkmnIndex   = "pkmnindex";
+        static const char * COL_Has2Genders = "has2genders";
+        static const char * COL_GenderSlot  = "genderslot";
+        static const char * COL_Exp         = "exp";
+        static const char * COL_HP          = "hp";
+        static const char * COL_Atk         = "atk";
+        static const char * COL_SpAtk       = "spatk";
+        static const char * COL_Def         = "def";
+        static const char * COL_SpDef       = "spdef";
+        static const char * COL_MoveSet     = "moveset";
+        static const char * COL_LearnKind   = "kind";
+        static const char * COL_Level       = "level";
+        static const char * COL_MoveID      = "moveid";
+        static const char * COL_EoTDFormat  = "eotdformat";
+        static const char * COL_HasExData   = "hasexdata";
+        static const char * COL_ExType      = "extype";
+        static const char * COL_ExParam     = "exparam";
+        static const char * COL_Lang        = "lang";
+        static const char * COL_Block       = "block";
+        static const char * COL_StrIndex    = "index";
+        static const char * COL_String      = "str";
+
+        //Values for COL_LearnKind
+        static const uint8_t LearnLevelUp   = 0;
+        static const uint8_t LearnHMTM      = 1;
+        static const uint8_t LearnEgg       = 2;
+
+        //The string blocks exported along the stats
+        static const array<eStringBlocks,7> TextBlocks =
+        {
+            eStringBlocks::PkmnNames,
+            eStringBlocks::PkmnCats,
+            eStringBlocks::MvNames,
+            eStringBlocks::MvDesc,
+            eStringBlocks::ItemNames,
+            eStringBlocks::ItemDescS,
+            eStringBlocks::ItemDescL,
+        };
+    };
+
+//==================================================================================
+//  Field Lists
+//==================================================================================
+    /*
+        fielddesc
+            Describes how a struct's field is put into, and taken out of a column.
+    */
+    template<class _StructTy>
+        struct fielddesc
+    {
+        const char                                  * name;
+        eStatsBinColTy                                ty;
+        std::function<int64_t(const _StructTy &)>     get;
+        std::function<void(_StructTy &, int64_t)>     set;
+    };
+
+    template<class T> struct ColTyOf;
+    template<> struct ColTyOf<uint8_t>  { static const eStatsBinColTy value = eStatsBinColTy::U8;  };
+    template<> struct ColTyOf<int8_t>   { static const eStatsBinColTy value = eStatsBinColTy::I8;  };
+    template<> struct ColTyOf<uint16_t> { static const eStatsBinColTy value = eStatsBinColTy::U16; };
+    template<> struct ColTyOf<int16_t>  { static const eStatsBinColTy value = eStatsBinColTy::I16; };
+    template<> struct ColTyOf<uint32_t> { static const eStatsBinColTy value = eStatsBinColTy::U32; };
+    template<> struct ColTyOf<int32_t>  { static const eStatsBinColTy value = eStatsBinColTy::I32; };
+
+    template<class _StructTy, class _FieldTy>
+        fielddesc<_StructTy> MakeField( const char * name, _FieldTy _StructTy::* pmember )
+    {
+        return fielddesc<_StructTy>
+        {
+            name,
+            ColTyOf<_FieldTy>::value,
+            [pmember]( const _StructTy & s )->int64_t { return static_cast<int64_t>(s.*pmember); },
+            [pmember]( _StructTy & s, int64_t val )   { s.*pmember = static_cast<_FieldTy>(val); },
+        };
+    }
+
+    template<class _StructTy, class _SubStructTy, class _FieldTy>
+        fielddesc<_StructTy> MakeSubField( const char * name, _SubStructTy _StructTy::* psub, _FieldTy _SubStructTy::* pmember )
+    {
+        return fielddesc<_StructTy>
+        {
+            name,
+            ColTyOf<_FieldTy>::value,
+            [psub,pmember]( const _StructTy & s )->int64_t { return static_cast<int64_t>((s.*psub).*pmember); },
+            [psub,pmember]( _StructTy & s, int64_t val )   { (s.*psub).*pmember = static_cast<_FieldTy>(val); },
+        };
+    }
+
+    template<class _StructTy, size_t _NbElems, class _FieldTy>
+        fielddesc<_StructTy> MakeArrayField( const char * name, std::array<_FieldTy,_NbElems> _StructTy::* parray, size_t index )
+    {
+        return fielddesc<_StructTy>
+        {
+            name,
+            ColTyOf<_FieldTy>::value,
+            [parray,index]( const _StructTy & s )->int64_t { return static_cast<int64_t>((s.*parray)[index]); },
+            [parray,index]( _StructTy & s, int64_t val )   { (s.*parray)[index] = static_cast<_FieldTy>(val); },
+        };
+    }
+
+    const vector<fielddesc<PokeMonsterData>> & MonsterDataFields()
+    {
+        typedef PokeMonsterData md;
+        static const vector<fielddesc<md>> fields =
+        {
+            MakeField   ( "pokeid",       &md::pokeID       ),
+            MakeField   ( "mdunk31",      &md::mdunk31      ),
+            MakeField   ( "natpkdexnb",   &md::natPkdexNb   ),
+            MakeField   ( "mdunk1",       &md::mdunk1       ),
+            MakeSubField( "preevoindex",  &md::evoData, &PokeEvolution::preEvoIndex ),
+            MakeSubField( "evomethod",    &md::evoData, &PokeEvolution::evoMethod   ),
+            MakeSubField( "evoparam1",    &md::evoData, &PokeEvolution::evoParam1   ),
+            MakeSubField( "evoparam2",    &md::evoData, &PokeEvolution::evoParam2   ),
+            MakeField   ( "spriteindex",  &md::spriteIndex  ),
+            MakeField   ( "gender",       &md::gender       ),
+            MakeField   ( "bodysize",     &md::bodySize     ),
+            MakeField   ( "primaryty",    &md::primaryTy    ),
+            MakeField   ( "secondaryty",  &md::secondaryTy  ),
+            MakeField   ( "movety",       &md::moveTy       ),
+            MakeField   ( "iqgrp",        &md::IQGrp        ),
+            MakeField   ( "primability",  &md::primAbility  ),
+            MakeField   ( "secability",   &md::secAbility   ),
+            MakeField   ( "bitflags1",    &md::bitflags1    ),
+            MakeField   ( "expyield",     &md::expYield     ),
+            MakeField   ( "recruitrate1", &md::recruitRate1 ),
+            MakeField   ( "basehp",       &md::baseHP       ),
+            MakeField   ( "recruitrate2", &md::recruitRate2 ),
+            MakeField   ( "baseatk",      &md::baseAtk      ),
+            MakeField   ( "basespatk",    &md::baseSpAtk    ),
+            MakeField   ( "basedef",      &md::baseDef      ),
+            MakeField   ( "basespdef",    &md::baseSpDef    ),
+            MakeField   ( "weight",       &md::weight       ),
+            MakeField   ( "size",         &md::size         ),
+            MakeField   ( "mdunk17",      &md::mdunk17      ),
+            MakeField   ( "mdunk18",      &md::mdunk18      ),
+            MakeField   ( "mdunk19",      &md::mdunk19      ),
+            MakeField   ( "mdunk20",      &md::mdunk20      ),
+            MakeField   ( "mdunk21",      &md::mdunk21      ),
+            MakeField   ( "basepkmn",     &md::BasePkmn     ),
+            MakeArrayField( "exclusiveitem1", &md::exclusiveItems, 0 ),
+            MakeArrayField( "exclusiveitem2", &md::exclusiveItems, 1 ),
+            MakeArrayField( "exclusiveitem3", &md::exclusiveItems, 2 ),
+            MakeArrayField( "exclusiveitem4", &md::exclusiveItems, 3 ),
+            MakeField   ( "unk27",        &md::unk27        ),
+            MakeField   ( "unk28",        &md::unk28        ),
+            MakeField   ( "unk29",        &md::unk29        ),
+            MakeField   ( "unk30",        &md::unk30        ),
+        };
+        return fields;
+    }
+
+    const vector<fielddesc<MoveData>> & MoveDataFields()
+    {
+        typedef MoveData mv;
+        static const vector<fielddesc<mv>> fields =
+        {
+            MakeField( "basepower", &mv::basePower ),
+            MakeField( "type",      &mv::type      ),
+            MakeField( "category",  &mv::category  ),
+            MakeField( "unk4",      &mv::unk4      ),
+            MakeField( "unk5",      &mv::unk5      ),
+            MakeField( "basepp",    &mv::basePP    ),
+            MakeField( "unk6",      &mv::unk6      ),
+            MakeField( "unk7",      &mv::unk7      ),
+            MakeField( "accuracy",  &mv::accuracy  ),
+            MakeField( "unk9",      &mv::unk9      ),
+            MakeField( "unk10",     &mv::unk10     ),
+            MakeField( "unk11",     &mv::unk11     ),
+            MakeField( "unk12",     &mv::unk12     ),
+            MakeField( "unk13",     &mv::unk13     ),
+            MakeField( "unk14",     &mv::unk14     ),
+            MakeField( "unk15",     &mv::unk15     ),
+            MakeField( "unk16",     &mv::unk16     ),
+            MakeField( "unk17",     &mv::unk17     ),
+            MakeField( "unk18",     &mv::unk18     ),
+            MakeField( "moveid",    &mv::moveID    ),
+            MakeField( "unk19",     &mv::unk19     ),
+        };
+        return fields;
+    }
+
+    const vector<fielddesc<itemdata>> & ItemDataFields()
+    {
+        typedef itemdata it;
+        static const vector<fielddesc<it>> fields =
+        {
+            MakeField( "buyprice",  &it::buyPrice  ),
+            MakeField( "sellprice", &it::sellPrice ),
+            MakeField( "category",  &it::category  ),
+            MakeField( "spriteid",  &it::spriteID  ),
+            MakeField( "itemid",    &it::itemID    ),
+            MakeField( "param1",    &it::param1    ),
+            MakeField( "param2",    &it::param2    ),
+            MakeField( "param3",    &it::param3    ),
+            MakeField( "unk1",      &it::unk1      ),
+            MakeField( "unk2",      &it::unk2      ),
+            MakeField( "unk3",      &it::unk3      ),
+            MakeField( "unk4",      &it::unk4      ),
+        };
+        return fields;
+    }
+
+//==================================================================================
+//  StatsBinWriter
+//==================================================================================
+    class StatsBinWriter
+    {
+        struct column
+        {
+            uint32_t        nameidx;
+            eStatsBinColTy  ty;
+            vector<uint8_t> data;
+        };
+
+        struct table
+        {
+            array<char,4>  id;
+            uint32_t       nbrows;
+            vector<column> cols;
+        };
+
+    public:
+        StatsBinWriter( const statsbinrefs & src, eGameVersion gvers, eGameRegion greg )
+            :m_src(src), m_gvers(gvers), m_greg(greg)
+        {}
+
+        void Write( const string & destfile )
+        {
+            if( m_src.ppkmn && !m_src.ppkmn->empty() )
+                MakePokemonTables();
+            if( m_src.pmoves1 && !m_src.pmoves1->empty() )
+                MakeMovesTable();
+            if( m_src.pitems && !m_src.pitems->empty() )
+                MakeItemsTable();
+            if( m_src.pgametext && m_src.pgametext->AreStringsLoaded() )
+                MakeTextTable();
+
+            if( m_tables.empty() )
+                throw runtime_error("StatsBinWriter::Write(): No data to write!");
+
+            vector<uint8_t> outdata;
+            Assemble(outdata);
+
+            ofstream outf( destfile, ios::out | ios::binary | ios::trunc );
+            if( !outf.is_open() || outf.bad() )
+                throw runtime_error("StatsBinWriter::Write(): Couldn't open file \"" + destfile + "\" for writing!");
+            outf.write( reinterpret_cast<const char*>(outdata.data()), outdata.size() );
+            if( outf.bad() )
+                throw runtime_error("StatsBinWriter::Write(): Error writing to file \"" + destfile + "\"!");
+        }
+
+    private:
+        //
+        //  Tables
+        //
+        void MakePokemonTables()
+        {
+            using namespace statsbin;
+            const vector<CPokemon> & pkmn = m_src.ppkmn->Pkmn();
+
+            table tblpkmn = MakeTable( TBL_Pokemon, pkmn.size() );
+            AddColumn( tblpkmn, COL_Has2Genders, eStatsBinColTy::U8, [&]( size_t i )->int64_t{ return pkmn[i].Has2GenderEntries()? 1 : 0; } );
+            m_tables.push_back( std::move(tblpkmn) );
+
+            //Monster data, one row for each gender entries
+            struct mdrow { uint16_t pkmn; uint8_t slot; const PokeMonsterData * pdata; };
+            vector<mdrow> mdrows;
+            mdrows.reserve( pkmn.size() * 2 );
+            for( size_t i = 0; i < pkmn.size(); ++i )
+            {
+                mdrows.push_back( mdrow{ static_cast<uint16_t>(i), 0, &pkmn[i].MonsterDataGender1() } );
+                if( pkmn[i].Has2GenderEntries() )
+                    mdrows.push_back( mdrow{ static_cast<uint16_t>(i), 1, &pkmn[i].MonsterDataGender2() } );
+            }
+            table tblmd = MakeTable( TBL_MonsterData, mdrows.size() );
+            AddColumn( tblmd, COL_PkmnIndex,  eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return mdrows[i].pkmn; } );
+            AddColumn( tblmd, COL_GenderSlot, eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return mdrows[i].slot; } );
+            AddFieldColumns( tblmd, MonsterDataFields(), [&]( size_t i )->const PokeMonsterData &{ return *(mdrows[i].pdata); } );
+            m_tables.push_back( std::move(tblmd) );
+
+            //Stats growth, one row per levels
+            struct growrow { uint16_t pkmn; const PokeStatsGrowth::growthlvl_t * plvl; };
+            vector<growrow> growrows;
+            growrows.reserve( pkmn.size() * PkmnMaxLevel );
+            for( size_t i = 0; i < pkmn.size(); ++i )
+            {
+                for( const auto & lvl : pkmn[i].StatsGrowth().statsgrowth )
+                    growrows.push_back( growrow{ static_cast<uint16_t>(i), &lvl } );
+            }
+            table tblgrow = MakeTable( TBL_Growth, growrows.size() );
+            AddColumn( tblgrow, COL_PkmnIndex, eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return growrows[i].pkmn; } );
+            AddColumn( tblgrow, COL_Exp,       eStatsBinColTy::U32, [&]( size_t i )->int64_t{ return growrows[i].plvl->first; } );
+            AddColumn( tblgrow, COL_HP,        eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return growrows[i].plvl->second.HP; } );
+            AddColumn( tblgrow, COL_Atk,       eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return growrows[i].plvl->second.Atk; } );
+            AddColumn( tblgrow, COL_SpAtk,     eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return growrows[i].plvl->second.SpA; } );
+            AddColumn( tblgrow, COL_Def,       eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return growrows[i].plvl->second.Def; } );
+            AddColumn( tblgrow, COL_SpDef,     eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return growrows[i].plvl->second.SpD; } );
+            m_tables.push_back( std::move(tblgrow) );
+
+            //Learnsets, one row per move
+            struct lrnrow { uint16_t pkmn; uint8_t set; uint8_t kind; uint16_t level; uint16_t move; };
+            vector<lrnrow> lrnrows;
+            for( size_t i = 0; i < pkmn.size(); ++i )
+            {
+                const PokeMoveSet * sets[2] = { &pkmn[i].MoveSet1(), &pkmn[i].MoveSet2() };
+                for( uint8_t cntset = 0; cntset < 2; ++cntset )
+                {
+                    const uint16_t pkindex = static_cast<uint16_t>(i);
+                    for( const auto & lvlmv : sets[cntset]->lvlUpMoveSet )
+                        lrnrows.push_back( lrnrow{ pkindex, static_cast<uint8_t>(cntset + 1), LearnLevelUp, lvlmv.first, lvlmv.second } );
+                    for( const auto & mv : sets[cntset]->teachableHMTMs )
+                        lrnrows.push_back( lrnrow{ pkindex, static_cast<uint8_t>(cntset + 1), LearnHMTM, 0, mv } );
+                    for( const auto & mv : sets[cntset]->eggmoves )
+                        lrnrows.push_back( lrnrow{ pkindex, static_cast<uint8_t>(cntset + 1), LearnEgg, 0, mv } );
+                }
+            }
+            table tbllrn = MakeTable( TBL_Learnsets, lrnrows.size() );
+            AddColumn( tbllrn, COL_PkmnIndex, eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return lrnrows[i].pkmn; } );
+            AddColumn( tbllrn, COL_MoveSet,   eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return lrnrows[i].set; } );
+            AddColumn( tbllrn, COL_LearnKind, eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return lrnrows[i].kind; } );
+            AddColumn( tbllrn, COL_Level,     eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return lrnrows[i].level; } );
+            AddColumn( tbllrn, COL_MoveID,    eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return lrnrows[i].move; } );
+            m_tables.push_back( std::move(tbllrn) );
+        }
+
+        void MakeMovesTable()
+        {
+            using namespace statsbin;
+            struct mvrow { uint8_t set; const MoveData * pdata; };
+            vector<mvrow> mvrows;
+            const MoveDB * sets[2] = { m_src.pmoves1, m_src.pmoves2 };
+            for( uint8_t cntset = 0; cntset < 2; ++cntset )
+            {
+                if( !sets[cntset] )
+                    continue;
+                for( size_t i = 0; i < sets[cntset]->size(); ++i )
+                    mvrows.push_back( mvrow{ static_cast<uint8_t>(cntset + 1), &(*sets[cntset])[static_cast<uint16_t>(i)] } );
+            }
+            table tblmv = MakeTable( TBL_Moves, mvrows.size() );
+            AddColumn( tblmv, COL_MoveSet, eStatsBinColTy::U8, [&]( size_t i )->int64_t{ return mvrows[i].set; } );
+            AddFieldColumns( tblmv, MoveDataFields(), [&]( size_t i )->const MoveData &{ return *(mvrows[i].pdata); } );
+            m_tables.push_back( std::move(tblmv) );
+        }
+
+        void MakeItemsTable()
+        {
+            using namespace statsbin;
+            const ItemsDB & items = *m_src.pitems;
+            auto lambdaex = [&]( size_t i ){ return items[static_cast<uint16_t>(i)].GetExclusiveItemData(); };
+
+            table tblit = MakeTable( TBL_Items, items.size() );
+            AddFieldColumns( tblit, ItemDataFields(), [&]( size_t i )->const itemdata &{ return items[static_cast<uint16_t>(i)]; } );
+            AddColumn( tblit, COL_EoTDFormat, eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return (items[static_cast<uint16_t>(i)].Get_EoTD_ItemData() != nullptr)? 1 : 0; } );
+            AddColumn( tblit, COL_HasExData,  eStatsBinColTy::U8,  [&]( size_t i )->int64_t{ return (lambdaex(i) != nullptr)? 1 : 0; } );
+            AddColumn( tblit, COL_ExType,     eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return (lambdaex(i) != nullptr)? lambdaex(i)->type  : 0; } );
+            AddColumn( tblit, COL_ExParam,    eStatsBinColTy::U16, [&]( size_t i )->int64_t{ return (lambdaex(i) != nullptr)? lambdaex(i)->param : 0; } );
+            m_tables.push_back( std::move(tblit) );
+        }
+
+        void MakeTextTable()
+        {
+            using namespace statsbin;
+            struct txtrow { uint8_t lang; uint8_t blk; uint16_t index; uint32_t stridx; };
+            vector<txtrow> txtrows;
+
+            //Sort languages, so the output doesn't depend on the hash table's order
+            vector<eGameLanguages> langs = m_src.pgametext->GetLoadedLanguagesIDs();
+            std::sort( langs.begin(), langs.end() );
+
+            for( eGameLanguages lang : langs )
+            {
+                const StringAccessor & strs = m_src.pgametext->GetStrings(lang)->second;
+                for( eStringBlocks blk : TextBlocks )
+                {
+                    if( !strs.IsBlockLoaded(blk) )
+                        continue;
+                    const size_t nbstr = strs.GetNbStringsInBlock(blk);
+                    for( size_t i = 0; i < nbstr; ++i )
+                    {
+                        const string * pstr = strs.GetStringIfBlockExists( blk, i );
+                        if(pstr)
+                            txtrows.push_back( txtrow{ static_cast<uint8_t>(lang), static_cast<uint8_t>(blk), static_cast<uint16_t>(i), AddString(*pstr) } );
+                    }
+                }
+            }
+            table tbltxt = MakeTable( TBL_Text, txtrows.size() );
+            AddColumn( tbltxt, COL_Lang,     eStatsBinColTy::U8,     [&]( size_t i )->int64_t{ return txtrows[i].lang;   } );
+            AddColumn( tbltxt, COL_Block,    eStatsBinColTy::U8,     [&]( size_t i )->int64_t{ return txtrows[i].blk;    } );
+            AddColumn( tbltxt, COL_StrIndex, eStatsBinColTy::U16,    [&]( size_t i )->int64_t{ return txtrows[i].index;  } );
+            AddColumn( tbltxt, COL_String,   eStatsBinColTy::StrIdx, [&]( size_t i )->int64_t{ return txtrows[i].stridx; } );
+            m_tables.push_back( std::move(tbltxt) );
+        }
+
+        //
+        //  Columns
+        //
+        inline table MakeTable( const array<char,4> & id, size_t nbrows )
+        {
+            table tbl;
+            tbl.id     = id;
+            tbl.nbrows = static_cast<uint32_t>(nbrows);
+            return std::move(tbl);
+        }
+
+        template<class _ValTy, class _RowFun>
+            static void EncodeValues( size_t nbrows, _RowFun & fun, vector<uint8_t> & out_data )
+        {
+            out_data.reserve( nbrows * sizeof(_ValTy) );
+            auto itout = std::back_inserter(out_data);
+            for( size_t i = 0; i < nbrows; ++i )
+                itout = utils::WriteIntToBytes( static_cast<_ValTy>(fun(i)), itout );
+        }
+
+        template<class _RowFun>
+            void AddColumn( table & tbl, const char * name, eStatsBinColTy ty, _RowFun fun )
+        {
+            column col;
+            col.nameidx = AddString(name);
+            col.ty      = ty;
+            switch(ty)
+            {
+                case eStatsBinColTy::U8:     { EncodeValues<uint8_t> ( tbl.nbrows, fun, col.data ); break; }
+                case eStatsBinColTy::I8:     { EncodeValues<int8_t>  ( tbl.nbrows, fun, col.data ); break; }
+                case eStatsBinColTy::U16:    { EncodeValues<uint16_t>( tbl.nbrows, fun, col.data ); break; }
+                case eStatsBinColTy::I16:    { EncodeValues<int16_t> ( tbl.nbrows, fun, col.data ); break; }
+                case eStatsBinColTy::U32:
+                case eStatsBinColTy::StrIdx: { EncodeValues<uint32_t>( tbl.nbrows, fun, col.data ); break; }
+                case eStatsBinColTy::I32:    { EncodeValues<int32_t> ( tbl.nbrows, fun, col.data ); break; }
+                default:
+                    throw std::logic_error("StatsBinWriter::AddColumn(): Invalid column type!");
+            };
+            tbl.cols.push_back( std::move(col) );
+        }
+
+        template<class _StructTy, class _GetRowFun>
+            void AddFieldColumns( table & tbl, const vector<fielddesc<_StructTy>> & fields, _GetRowFun getrow )
+        {
+            for( const auto & field : fields )
+                AddColumn( tbl, field.name, field.ty, [&]( size_t i )->int64_t{ return field.get( getrow(i) ); } );
+        }
+
+        uint32_t AddString( const string & str )
+        {
+            auto itf = m_strlut.find(str);
+            if( itf != m_strlut.end() )
+                return itf->second;
+            const uint32_t newidx = static_cast<uint32_t>(m_strings.size());
+            m_strings.push_back(str);
+            m_strlut.emplace( str, newidx );
+            return newidx;
+        }
+
+        //
+        //  Output
+        //
+        static inline size_t AlignOffset( size_t off )
+        {
+            using namespace statsbin;
+            return (off % DataAlignment != 0)? off + (DataAlignment - (off % DataAlignment)) : off;
+        }
+
+        static void PadOutput( vector<uint8_t> & out_data )
+        {
+            out_data.resize( AlignOffset(out_data.size()), 0 );
+        }
+
+        void Assemble( vector<uint8_t> & out_data )
+        {
+            using namespace statsbin;
+            //Compute where everything goes
+            size_t nbcols = 0;
+            for( const auto & tbl : m_tables )
+                nbcols += tbl.cols.size();
+
+            const size_t ptrtables = HeaderLen;
+            const size_t ptrcols   = ptrtables + (m_tables.size() * TableEntryLen);
+            size_t       ptrdata   = AlignOffset( ptrcols + (nbcols * ColumnEntryLen) );
+
+            vector<size_t> coldataptrs;
+            coldataptrs.reserve(nbcols);
+            for( const auto & tbl : m_tables )
+            {
+                for( const auto & col : tbl.cols )
+                {
+                    coldataptrs.push_back(ptrdata);
+                    ptrdata = AlignOffset( ptrdata + col.data.size() );
+                }
+            }
+            const size_t ptrstrings = ptrdata;
+            size_t       strdatalen = 0;
+            for( const auto & str : m_strings )
+                strdatalen += str.size() + 1;
+            const size_t filelen = AlignOffset( ptrstrings + sizeof(uint32_t) + ((m_strings.size() + 1) * sizeof(uint32_t)) + strdatalen );
+
+            out_data.reserve(filelen);
+            auto itout = std::back_inserter(out_data);
+
+            //Header
+            itout = std::copy( Magic.begin(), Magic.end(), itout );
+            itout = utils::WriteIntToBytes( StatsBinVersionMajor,                  itout );
+            itout = utils::WriteIntToBytes( StatsBinVersionMinor,                  itout );
+            itout = utils::WriteIntToBytes( static_cast<uint8_t>(m_gvers),         itout );
+            itout = utils::WriteIntToBytes( static_cast<uint8_t>(m_greg),          itout );
+            itout = utils::WriteIntToBytes( MakeFlags(),                           itout );
+            itout = utils::WriteIntToBytes( static_cast<uint32_t>(m_tables.size()),itout );
+            itout = utils::WriteIntToBytes( static_cast<uint32_t>(ptrtables),      itout );
+            itout = utils::WriteIntToBytes( static_cast<uint32_t>(ptrstrings),     itout );
+            itout = utils::WriteIntToBytes( static_cast<uint32_t>(filelen),        itout );
+
+            //Table directory
+            size_t curcolptr = ptrcols;
+            for( const auto & tbl : m_tables )
+            {
+                itout = std::copy( tbl.id.begin(), tbl.id.end(), itout );
+                itout = utils::WriteIntToBytes( tbl.nbrows,                             itout );
+                itout = utils::WriteIntToBytes( static_cast<uint32_t>(tbl.cols.size()), itout );
+                itout = utils::WriteIntToBytes( static_cast<uint32_t>(curcolptr),       itout );
+                curcolptr += tbl.cols.size() * ColumnEntryLen;
+            }
+
+            //Column descriptors
+            size_t cntcol = 0;
+            for( const auto & tbl : m_tables )
+            {
+                for( const auto & col : tbl.cols )
+                {
+                    itout = utils::WriteIntToBytes( col.nameidx,                                      itout );
+                    itout = utils::WriteIntToBytes( static_cast<uint8_t>(col.ty),                     itout );
+                    itout = utils::WriteIntToBytes( static_cast<uint8_t>(ColTyLen(col.ty)),           itout );
+                    itout = utils::WriteIntToBytes( static_cast<uint16_t>(0),                         itout );
+                    itout = utils::WriteIntToBytes( static_cast<uint32_t>(coldataptrs[cntcol]),       itout );
+                    itout = utils::WriteIntToBytes( static_cast<uint32_t>(col.data.size()),           itout );
+                    ++cntcol;
+                }
+            }
+            PadOutput(out_data);
+
+            //Columns data
+            for( const auto & tbl : m_tables )
+            {
+                for( const auto & col : tbl.cols )
+                {
+                    out_data.insert( out_data.end(), col.data.begin(), col.data.end() );
+                    PadOutput(out_data);
+                }
+            }
+
+            //String table
+            itout = utils::WriteIntToBytes( static_cast<uint32_t>(m_strings.size()), std::back_inserter(out_data) );
+            uint32_t curstroff = 0;
+            for( const auto & str : m_strings )
+            {
+                itout = utils::WriteIntToBytes( curstroff, itout );
+                curstroff += static_cast<uint32_t>(str.size() + 1);
+            }
+            itout = utils::WriteIntToBytes( curstroff, itout );
+            for( const auto & str : m_strings )
+            {
+                out_data.insert( out_data.end(), str.begin(), str.end() );
+                out_data.push_back(0);
+            }
+            PadOutput(out_data);
+            assert( out_data.size() == filelen );
+        }
+
+        uint16_t MakeFlags()const
+        {
+            uint16_t flags = 0;
+            if( m_src.ppkmn && m_src.ppkmn->isEoSData() )
+                flags |= statsbin::FlagEoSPkmnData;
+            return flags;
+        }
+
+    public:
+        static size_t ColTyLen( eStatsBinColTy ty )
+        {
+            switch(ty)
+            {
+                case eStatsBinColTy::U8:
+                case eStatsBinColTy::I8:
+                    return sizeof(uint8_t);
+                case eStatsBinColTy::U16:
+                case eStatsBinColTy::I16:
+                    return sizeof(uint16_t);
+                case eStatsBinColTy::U32:
+                case eStatsBinColTy::I32:
+                case eStatsBinColTy::StrIdx:
+                    return sizeof(uint32_t);
+                default:
+                    return 0;
+            };
+        }
+
+    private:
+        const statsbinrefs             & m_src;
+        eGameVersion                     m_gvers;
+        eGameRegion                      m_greg;
+        vector<table>                    m_tables;
+        vector<string>                   m_strings;
+        unordered_map<string,uint32_t>   m_strlut;
+    };
+
+//==================================================================================
+//  StatsBinReader
+//==================================================================================
+    /*
+        Maps the file in memory, and reads the columns in place.
+    */
+    class StatsBinReader
+    {
+        struct coldesc
+        {
+            eStatsBinColTy  ty;
+            uint8_t         valuelen;
+            const uint8_t * pdata;
+            uint32_t        datalen;
+        };
+
+        struct tableview
+        {
+            uint32_t                        nbrows;
+            unordered_map<string, coldesc>  cols;
+        };
+
+    public:
+        StatsBinReader( const string & srcfile, statsbinrefs & dest, eGameVersion expectedgvers )
+            :m_srcfile(srcfile), m_dest(dest), m_expectedgvers(expectedgvers), m_pbeg(nullptr), m_pend(nullptr),
+             m_gvers(eGameVersion::Invalid), m_greg(eGameRegion::Invalid), m_flags(0), m_nbstrings(0), m_pstroffs(nullptr), m_pstrdata(nullptr)
+        {}
+
+        void Read()
+        {
+            Poco::File infile(m_srcfile);
+            if( !infile.exists() || !infile.isFile() )
+                throw runtime_error("StatsBinReader::Read(): File \"" + m_srcfile + "\" doesn't exist!");
+            if( infile.getSize() < statsbin::HeaderLen )
+                throw runtime_error("StatsBinReader::Read(): File \"" + m_srcfile + "\" is too small to be a stats file!");
+
+            //Map the whole file, everything is read in place from there
+            Poco::SharedMemory mapping( infile, Poco::SharedMemory::AM_READ );
+            m_pbeg = reinterpret_cast<const uint8_t*>(mapping.begin());
+            m_pend = reinterpret_cast<const uint8_t*>(mapping.end());
+
+            ParseHeader();
+            ParseStringTable();
+            ParseTables();
+
+            if( m_dest.ppkmn )
+                ReadPokemon();
+            if( m_dest.pmoves1 )
+                ReadMoves();
+            if( m_dest.pitems )
+                ReadItems();
+            if( m_dest.pgametext )
+                ReadText();
+
+            m_pbeg = nullptr;
+            m_pend = nullptr;
+        }
+
+    private:
+        //
+        //  File structure
+        //
+        void ParseHeader()
+        {
+            using namespace statsbin;
+            if( !std::equal( Magic.begin(), Magic.end(), reinterpret_cast<const char*>(m_pbeg) ) )
+                throw runtime_error("StatsBinReader::ParseHeader(): File \"" + m_srcfile + "\" is not a stats file!");
+
+            const uint8_t * itread = m_pbeg + Magic.size();
+            uint16_t vermajor = utils::ReadIntFromBytes<uint16_t>( itread, m_pend );
+            uint16_t verminor = utils::ReadIntFromBytes<uint16_t>( itread, m_pend );
+            m_gvers           = static_cast<eGameVersion>(utils::ReadIntFromBytes<uint8_t>( itread, m_pend ));
+            m_greg            = static_cast<eGameRegion> (utils::ReadIntFromBytes<uint8_t>( itread, m_pend ));
+            m_flags           = utils::ReadIntFromBytes<uint16_t>( itread, m_pend );
+            m_nbtables        = utils::ReadIntFromBytes<uint32_t>( itread, m_pend );
+            m_ptrtables       = utils::ReadIntFromBytes<uint32_t>( itread, m_pend );
+            m_ptrstrings      = utils::ReadIntFromBytes<uint32_t>( itread, m_pend );
+            uint32_t filelen  = utils::ReadIntFromBytes<uint32_t>( itread, m_pend );
+
+            if( vermajor != StatsBinVersionMajor )
+            {
+                stringstream sstr;
+                sstr <<"StatsBinReader::ParseHeader(): Unsupported file version " <<vermajor <<"." <<verminor
+                     <<". Expected version " <<StatsBinVersionMajor <<".x!";
+                throw runtime_error(sstr.str());
+            }
+            if( filelen > static_cast<size_t>(m_pend - m_pbeg) )
+                throw runtime_error("StatsBinReader::ParseHeader(): File \"" + m_srcfile + "\" is truncated!");
+
+            //The data layout differs between Explorers of Sky and Time/Darkness
+            if( m_expectedgvers != eGameVersion::Invalid && m_gvers != eGameVersion::Invalid &&
+                ((m_expectedgvers == eGameVersion::EoS) != (m_gvers == eGameVersion::EoS)) )
+            {
+                stringstream sstr;
+                sstr <<"StatsBinReader::ParseHeader(): The stats file is for " <<GetGameVersionName(m_gvers)
+                     <<", but the target game is " <<GetGameVersionName(m_expectedgvers) <<"!";
+                throw runtime_error(sstr.str());
+            }
+        }
+
+        void ParseStringTable()
+        {
+            const uint8_t * itread = GetPtr( m_ptrstrings, sizeof(uint32_t) );
+            m_nbstrings  = utils::ReadIntFromBytes<uint32_t>( itread, m_pend );
+
+            //The offset table has an extra entry at the end for the length of the string data. Check the count before using it.
+            const uint64_t offstbllen = (static_cast<uint64_t>(m_nbstrings) + 1) * sizeof(uint32_t);
+            if( offstbllen > static_cast<uint64_t>(m_pend - itread) )
+                throw runtime_error("StatsBinReader::ParseStringTable(): String count " + to_string(m_nbstrings) + " is larger than the file can hold!");
+            m_pstroffs   = itread;
+            m_pstrdata   = m_pstroffs + static_cast<size_t>(offstbllen);
+            const uint8_t * itlast = m_pstrdata - sizeof(uint32_t);
+            uint32_t strdatalen = utils::ReadIntFromBytes<uint32_t>( itlast, m_pend );
+            if( strdatalen > static_cast<size_t>(m_pend - m_pstrdata) )
+                throw runtime_error("StatsBinReader::ParseStringTable(): String table is out of the file's bounds!");
+        }
+
+        void ParseTables()
+        {
+            using namespace statsbin;
+            const uint8_t * ittbl = GetPtr( m_ptrtables, static_cast<uint64_t>(m_nbtables) * TableEntryLen );
+            for( uint32_t cnttbl = 0; cnttbl < m_nbtables; ++cnttbl )
+            {
+                string   tblid( reinterpret_cast<const char*>(ittbl), 4 );
+                ittbl += 4;
+                tableview tbl;
+                tbl.nbrows       = utils::ReadIntFromBytes<uint32_t>( ittbl, m_pend );
+                uint32_t nbcols  = utils::ReadIntFromBytes<uint32_t>( ittbl, m_pend );
+                uint32_t ptrcols = utils::ReadIntFromBytes<uint32_t>( ittbl, m_pend );
+
+                const uint8_t * itcol = GetPtr( ptrcols, static_cast<uint64_t>(nbcols) * ColumnEntryLen );
+                for( uint32_t cntcol = 0; cntcol < nbcols; ++cntcol )
+                {
+                    coldesc  col;
+                    uint32_t nameidx = utils::ReadIntFromBytes<uint32_t>( itcol, m_pend );
+                    col.ty           = static_cast<eStatsBinColTy>(utils::ReadIntFromBytes<uint8_t>( itcol, m_pend ));
+                    col.valuelen     = utils::ReadIntFromBytes<uint8_t> ( itcol, m_pend );
+                    itcol += sizeof(uint16_t); //unused
+                    uint32_t ptrdata = utils::ReadIntFromBytes<uint32_t>( itcol, m_pend );
+                    col.datalen      = utils::ReadIntFromBytes<uint32_t>( itcol, m_pend );
+                    col.pdata        = GetPtr( ptrdata, col.datalen );
+
+                    //Skip columns we can't decode
+                    if( col.valuelen == 0 || col.valuelen != StatsBinWriter::ColTyLen(col.ty) ||
+                        (static_cast<size_t>(col.valuelen) * tbl.nbrows) > col.datalen )
+                    {
+                        if( utils::LibWide().isLogOn() )
+                            clog <<"<!>- StatsBinReader::ParseTables(): Skipping undecodable column \"" <<GetString(nameidx) <<"\" in table " <<tblid <<"!\n";
+                        continue;
+                    }
+                    tbl.cols.emplace( GetString(nameidx), col );
+                }
+                m_tables.emplace( std::move(tblid), std::move(tbl) );
+            }
+        }
+
+        inline const uint8_t * GetPtr( uint64_t offset, uint64_t len )const
+        {
+            const uint64_t filelen = static_cast<uint64_t>(m_pend - m_pbeg);
+            if( offset > filelen || len > (filelen - offset) )
+                throw runtime_error("StatsBinReader::GetPtr(): Offset is out of the file's bounds!");
+            return m_pbeg + static_cast<size_t>(offset);
+        }
+
+        string GetString( uint32_t index )const
+        {
+            if( index >= m_nbstrings )
+                throw runtime_error("StatsBinReader::GetString(): String index is out of range!");
+            const uint8_t * itoff = m_pstroffs + (index * sizeof(uint32_t));
+            uint32_t beg = utils::ReadIntFromBytes<uint32_t>( itoff, m_pend );
+            uint32_t end = utils::ReadIntFromBytes<uint32_t>( itoff, m_pend );
+            if( end <= beg || end > static_cast<size_t>(m_pend - m_pstrdata) )
+                throw runtime_error("StatsBinReader::GetString(): Invalid string offsets!");
+            return string( reinterpret_cast<const char*>(m_pstrdata + beg), (end - beg) - 1 );
+        }
+
+        inline const tableview * GetTable( const array<char,4> & id )const
+        {
+            auto itf = m_tables.find( string( id.begin(), id.end() ) );
+            return (itf != m_tables.end())? &(itf->second) : nullptr;
+        }
+
+        //
+        //  Columns
+        //
+        template<class _ValTy, class _ValFun>
+            static void DecodeValues( const coldesc & col, uint32_t nbrows, _ValFun & fun )
+        {
+            const uint8_t * itread = col.pdata;
+            const uint8_t * itend  = col.pdata + col.datalen;
+            for( uint32_t i = 0; i < nbrows; ++i )
+                fun( i, static_cast<int64_t>( utils::ReadIntFromBytes<_ValTy>( itread, itend ) ) );
+        }
+
+        /*
+            Calls fun(row, value) for every values in the column. Returns false if the column doesn't exist.
+        */
+        template<class _ValFun>
+            static bool ForEachValue( const tableview & tbl, const char * name, _ValFun fun )
+        {
+            auto itf = tbl.cols.find(name);
+            if( itf == tbl.cols.end() )
+                return false;
+            const coldesc & col = itf->second;
+            switch(col.ty)
+            {
+                case eStatsBinColTy::U8:     { DecodeValues<uint8_t> ( col, tbl.nbrows, fun ); break; }
+                case eStatsBinColTy::I8:     { DecodeValues<int8_t>  ( col, tbl.nbrows, fun ); break; }
+                case eStatsBinColTy::U16:    { DecodeValues<uint16_t>( col, tbl.nbrows, fun ); break; }
+                case eStatsBinColTy::I16:    { DecodeValues<int16_t> ( col, tbl.nbrows, fun ); break; }
+                case eStatsBinColTy::U32:
+                case eStatsBinColTy::StrIdx: { DecodeValues<uint32_t>( col, tbl.nbrows, fun ); break; }
+                case eStatsBinColTy::I32:    { DecodeValues<int32_t> ( col, tbl.nbrows, fun ); break; }
+                default:
+                    return false;
+            };
+            return true;
+        }
+
+        template<class _IntTy>
+            static vector<_IntTy> ReadColumn( const tableview & tbl, const char * name, bool bmandatory )
+        {
+            vector<_IntTy> values(tbl.nbrows, 0);
+            if( !ForEachValue( tbl, name, [&]( size_t i, int64_t val ){ values[i] = static_cast<_IntTy>(val); } ) && bmandatory )
+                throw runtime_error( string("StatsBinReader::ReadColumn(): Mandatory column \"") + name + "\" is missing!" );
+            return std::move(values);
+        }
+
+        /*
+            Fills the fields of the structs returned by getrow(rowindex), for every field the table has a column for.
+        */
+        template<class _StructTy, class _GetRowFun>
+            static void ReadFieldColumns( const tableview & tbl, const vector<fielddesc<_StructTy>> & fields, _GetRowFun getrow )
+        {
+            for( const auto & field : fields )
+                ForEachValue( tbl, field.name, [&]( size_t i, int64_t val ){ field.set( getrow(i), val ); } );
+        }
+
+        //
+        //  Content
+        //
+        void ReadPokemon()
+        {
+            using namespace statsbin;
+            const tableview * ptblpkmn = GetTable(TBL_Pokemon);
+            if( !ptblpkmn )
+                return;
+
+            vector<CPokemon> pkmn(ptblpkmn->nbrows);
+            ForEachValue( *ptblpkmn, COL_Has2Genders, [&]( size_t i, int64_t val ){ pkmn[i].Has2GenderEntries( val != 0 ); } );
+            auto lambdacheckpk = [&]( uint16_t pkindex )
+            {
+                if( pkindex >= pkmn.size() )
+                    throw runtime_error("StatsBinReader::ReadPokemon(): Pokemon index out of range!");
+            };
+
+            //Monster data
+            const tableview * ptblmd = GetTable(TBL_MonsterData);
+            if( ptblmd )
+            {
+                vector<uint16_t>          pkindices = ReadColumn<uint16_t>( *ptblmd, COL_PkmnIndex,  true  );
+                vector<uint8_t>           slots     = ReadColumn<uint8_t> ( *ptblmd, COL_GenderSlot, false );
+                vector<PokeMonsterData*>  rows(ptblmd->nbrows, nullptr);
+                for( size_t i = 0; i < rows.size(); ++i )
+                {
+                    lambdacheckpk(pkindices[i]);
+                    CPokemon & curpk = pkmn[pkindices[i]];
+                    rows[i] = (slots[i] == 0)? &curpk.MonsterDataGender1() : &curpk.MonsterDataGender2();
+                }
+                ReadFieldColumns( *ptblmd, MonsterDataFields(), [&]( size_t i )->PokeMonsterData &{ return *(rows[i]); } );
+            }
+
+            //Stats growth
+            const tableview * ptblgrow = GetTable(TBL_Growth);
+            if( ptblgrow )
+            {
+                vector<uint16_t>                       pkindices = ReadColumn<uint16_t>( *ptblgrow, COL_PkmnIndex, true );
+                vector<PokeStatsGrowth::growthlvl_t*>  rows(ptblgrow->nbrows, nullptr);
+                for( size_t i = 0; i < rows.size(); ++i )
+                {
+                    lambdacheckpk(pkindices[i]);
+                    pkmn[pkindices[i]].StatsGrowth().statsgrowth.push_back( PokeStatsGrowth::growthlvl_t() );
+                }
+                //Take the pointers only once all the vectors stopped growing
+                vector<size_t> cntperpk(pkmn.size(), 0);
+                for( size_t i = 0; i < rows.size(); ++i )
+                    rows[i] = &(pkmn[pkindices[i]].StatsGrowth().statsgrowth[cntperpk[pkindices[i]]++]);
+
+                ForEachValue( *ptblgrow, COL_Exp,   [&]( size_t i, int64_t val ){ rows[i]->first      = static_cast<uint32_t>(val); } );
+                ForEachValue( *ptblgrow, COL_HP,    [&]( size_t i, int64_t val ){ rows[i]->second.HP  = static_cast<uint16_t>(val); } );
+                ForEachValue( *ptblgrow, COL_Atk,   [&]( size_t i, int64_t val ){ rows[i]->second.Atk = static_cast<uint8_t> (val); } );
+                ForEachValue( *ptblgrow, COL_SpAtk, [&]( size_t i, int64_t val ){ rows[i]->second.SpA = static_cast<uint8_t> (val); } );
+                ForEachValue( *ptblgrow, COL_Def,   [&]( size_t i, int64_t val ){ rows[i]->second.Def = static_cast<uint8_t> (val); } );
+                ForEachValue( *ptblgrow, COL_SpDef, [&]( size_t i, int64_t val ){ rows[i]->second.SpD = static_cast<uint8_t> (val); } );
+            }
+
+            //Learnsets
+            const tableview * ptbllrn = GetTable(TBL_Learnsets);
+            if( ptbllrn )
+            {
+                vector<uint16_t> pkindices = ReadColumn<uint16_t>( *ptbllrn, COL_PkmnIndex, true  );
+                vector<uint8_t>  sets      = ReadColumn<uint8_t> ( *ptbllrn, COL_MoveSet,   true  );
+                vector<uint8_t>  kinds     = ReadColumn<uint8_t> ( *ptbllrn, COL_LearnKind, true  );
+                vector<uint16_t> levels    = ReadColumn<uint16_t>( *ptbllrn, COL_Level,     false );
+                vector<uint16_t> moves     = ReadColumn<uint16_t>( *ptbllrn, COL_MoveID,    true  );
+                for( size_t i = 0; i < pkindices.size(); ++i )
+                {
+                    lambdacheckpk(pkindices[i]);
+                    PokeMoveSet & mvset = (sets[i] == 2)? pkmn[pkindices[i]].MoveSet2() : pkmn[pkindices[i]].MoveSet1();
+                    if( kinds[i] == LearnLevelUp )
+                        mvset.lvlUpMoveSet.emplace( levels[i], moves[i] );
+                    else if( kinds[i] == LearnHMTM )
+                        mvset.teachableHMTMs.push_back( moves[i] );
+                    else if( kinds[i] == LearnEgg )
+                        mvset.eggmoves.push_back( moves[i] );
+                }
+            }
+
+            m_dest.ppkmn->Pkmn() = std::move(pkmn);
+            m_dest.ppkmn->isEoSData( (m_flags & FlagEoSPkmnData) != 0 );
+        }
+
+        void ReadMoves()
+        {
+            using namespace statsbin;
+            const tableview * ptblmv = GetTable(TBL_Moves);
+            if( !ptblmv )
+                return;
+
+            vector<uint8_t>  sets = ReadColumn<uint8_t>( *ptblmv, COL_MoveSet, false );
+            vector<MoveData> rows(ptblmv->nbrows);
+            ReadFieldColumns( *ptblmv, MoveDataFields(), [&]( size_t i )->MoveData &{ return rows[i]; } );
+
+            MoveDB newmv1;
+            MoveDB newmv2;
+            for( size_t i = 0; i < rows.size(); ++i )
+            {
+                if( sets[i] == 2 )
+                    newmv2.push_back( std::move(rows[i]) );
+                else
+                    newmv1.push_back( std::move(rows[i]) );
+            }
+            *m_dest.pmoves1 = std::move(newmv1);
+            if( m_dest.pmoves2 )
+                *m_dest.pmoves2 = std::move(newmv2);
+        }
+
+        void ReadItems()
+        {
+            using namespace statsbin;
+            const tableview * ptblit = GetTable(TBL_Items);
+            if( !ptblit )
+                return;
+
+            ItemsDB newitems;
+            newitems.resize(ptblit->nbrows);
+            ReadFieldColumns( *ptblit, ItemDataFields(), [&]( size_t i )->itemdata &{ return newitems[static_cast<uint16_t>(i)]; } );
+            ForEachValue( *ptblit, COL_EoTDFormat, [&]( size_t i, int64_t val )
+            {
+                if( val != 0 )
+                    newitems[static_cast<uint16_t>(i)].MakeEoTDData();
+            });
+
+            vector<uint8_t>  hasex    = ReadColumn<uint8_t> ( *ptblit, COL_HasExData, false );
+            vector<uint16_t> extypes  = ReadColumn<uint16_t>( *ptblit, COL_ExType,    false );
+            vector<uint16_t> exparams = ReadColumn<uint16_t>( *ptblit, COL_ExParam,   false );
+            for( size_t i = 0; i < hasex.size(); ++i )
+            {
+                if( hasex[i] != 0 )
+                    newitems[static_cast<uint16_t>(i)].SetExclusiveData( exclusiveitemdata( extypes[i], exparams[i] ) );
+            }
+            *m_dest.pitems = std::move(newitems);
+        }
+
+        void ReadText()
+        {
+            using namespace statsbin;
+            const tableview * ptbltxt = GetTable(TBL_Text);
+            if( !ptbltxt )
+                return;
+
+            vector<uint8_t>  langs   = ReadColumn<uint8_t> ( *ptbltxt, COL_Lang,     true );
+            vector<uint8_t>  blocks  = ReadColumn<uint8_t> ( *ptbltxt, COL_Block,    true );
+            vector<uint16_t> indices = ReadColumn<uint16_t>( *ptbltxt, COL_StrIndex, true );
+            vector<uint32_t> strids  = ReadColumn<uint32_t>( *ptbltxt, COL_String,   true );
+            size_t           nbskipped = 0;
+
+            for( size_t i = 0; i < langs.size(); ++i )
+            {
+                const eGameLanguages lang = static_cast<eGameLanguages>(langs[i]);
+                const eStringBlocks  blk  = static_cast<eStringBlocks>(blocks[i]);
+                if( lang >= eGameLanguages::NbLang || blk >= eStringBlocks::NBEntries )
+                    throw runtime_error("StatsBinReader::ReadText(): Invalid language or string block id!");
+
+                auto itlang = m_dest.pgametext->GetStrings(lang);
+                if( itlang == m_dest.pgametext->end() )
+                    continue; //Language not loaded
+                string * pstr = itlang->second.GetStringIfBlockExists( blk, indices[i] );
+                if( pstr )
+                    *pstr = GetString(strids[i]);
+                else
+                    ++nbskipped;
+            }
+
+            if( nbskipped != 0 )
+            {
+                cout <<"\n <!>- " <<nbskipped <<" string(s) from the stats file don't exist in the target game's text, and were skipped!\n";
+                if( utils::LibWide().isLogOn() )
+                    clog <<"<!>- StatsBinReader::ReadText(): " <<nbskipped <<" string(s) were out of the string blocks' bounds, and were skipped!\n";
+            }
+        }
+
+    private:
+        string                              m_srcfile;
+        statsbinrefs                      & m_dest;
+        eGameVersion                        m_expectedgvers;
+
+        const uint8_t                     * m_pbeg;
+        const uint8_t                     * m_pend;
+
+        eGameVersion                        m_gvers;
+        eGameRegion                         m_greg;
+        uint16_t                            m_flags;
+        uint32_t                            m_nbtables;
+        uint32_t                            m_ptrtables;
+        uint32_t                            m_ptrstrings;
+
+        uint32_t                            m_nbstrings;
+        const uint8_t                     * m_pstroffs;
+        const uint8_t                     * m_pstrdata;
+
+        unordered_map<string, tableview>    m_tables;
+    };
+
+//==================================================================================
+//  Functions
+//==================================================================================
+    void ExportStatsToBin( const std::string & destfile, const statsbinrefs & src, eGameVersion gvers, eGameRegion greg )
+    {
+        StatsBinWriter(src, gvers, greg).Write(destfile);
+    }
+
+    void ImportStatsFromBin( const std::string & srcfile, statsbinrefs & dest, eGameVersion expectedgvers )
+    {
+        StatsBinReader(srcfile, dest, expectedgvers).Read();
+    }
+
+    bool IsStatsBinFile( const std::string & fpath )
+    {
+        ifstream infile( fpath, ios::in | ios::binary );
+        array<char,8> magic;
+        if( !infile.is_open() || !infile.read( magic.data(), magic.size() ) )
+            return false;
+        return magic == statsbin::Magic;
+    }
+
+};};
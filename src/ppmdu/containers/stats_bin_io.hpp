@@ -0,0 +1,132 @@
+#ifndef STATS_BIN_IO_HPP
+#define STATS_BIN_IO_HPP
+/*
+stats_bin_io.hpp
+2016/10/19
+psycommando@gmail.com
+Description:
+    Single file binary interchange format for the game stats. This is meant as a fast alternative to the
+    XML files for tools exchanging data with each others, while the XML stays the human editable format.
+
+    The file is made to be memory mapped and read in place:
+        - All values are little endian, and every offset is absolute from the start of the file.
+        - The file is made of tables. Each tables contains a list of columns, and each columns is a
+          contiguous, 4 bytes aligned, array with one value per row of the table.
+        - Tables and columns are described by the file itself, using their names. So readers
+          can skip tables/columns they don't know about, and default the ones that are missing.
+        - All strings, both the column names and the game text, are stored into a single string table.
+
+    Layout:
+        [Header]
+            char[8]  magic     : "PMD2STAT"
+            uint16   vermajor  : Readers should refuse files with a different major version.
+            uint16   verminor  : Bumped for backward compatible additions.
+            uint8    gamever   : eGameVersion the data was taken from.
+            uint8    gamereg   : eGameRegion the data was taken from.
+            uint16   flags     : bit 0 is set when the pokemon data is from Explorers of Sky.
+            uint32   nbtables  : Nb of entries in the table directory.
+            uint32   ptrtables : Offset of the table directory.
+            uint32   ptrstrings: Offset of the string table.
+            uint32   filelen   : Total length of the file.
+        [Table Directory]   (nbtables entries)
+            char[4]  id        : The table's 4CC.
+            uint32   nbrows    : Nb of rows/values in each of its columns.
+            uint32   nbcols    : Nb of column descriptors.
+            uint32   ptrcols   : Offset of the first column descriptor.
+        [Column Descriptors]
+            uint32   nameidx   : Index of the column's name in the string table.
+            uint8    type      : eStatsBinColTy
+            uint8    valuelen  : Length in bytes of a single value.
+            uint16   unused
+            uint32   ptrdata   : Offset of the column's data.
+            uint32   datalen   : Length of the column's data in bytes.
+        [Columns Data]
+        [String Table]
+            uint32   nbstrings
+            uint32   stroffsets[nbstrings + 1] : Offsets relative to the start of the string data.
+            char     strdata[]                 : Strings, each followed by a 0.
+
+License: Creative Common 0 ( Public Domain ) https://creativecommons.org/publicdomain/zero/1.0/
+All wrongs reversed, no crappyrights :P
+*/
+#include <ppmdu/containers/pokemon_stats.hpp>
+#include <ppmdu/containers/move_data.hpp>
+#include <ppmdu/containers/item_data.hpp>
+#include <ppmdu/pmd2/pmd2_text.hpp>
+#include <cstdint>
+#include <string>
+
+namespace pmd2 { namespace stats
+{
+//==================================================================================
+//  Constants
+//==================================================================================
+    static const uint16_t StatsBinVersionMajor = 1;
+    static const uint16_t StatsBinVersionMinor = 0;
+
+    /*
+        eStatsBinColTy
+            The encoding of the values in a column.
+    */
+    enum struct eStatsBinColTy : uint8_t
+    {
+        U8     = 0,
+        I8,
+        U16,
+        I16,
+        U32,
+        I32,
+        StrIdx,     //uint32 index into the file's string table
+    };
+
+//==================================================================================
+//  Content
+//==================================================================================
+    /*
+        statsbinrefs
+            The data to read/write from/to a stats binary file.
+            Any of the pointers can be null, and the matching tables will be skipped.
+            - pmoves2 is only used for Explorers of Sky.
+            - pgametext is used for the names and descriptions of pokemon, moves and items.
+    */
+    struct statsbinrefs
+    {
+        PokemonDB  * ppkmn     = nullptr;
+        MoveDB     * pmoves1   = nullptr;
+        MoveDB     * pmoves2   = nullptr;
+        ItemsDB    * pitems    = nullptr;
+        GameText   * pgametext = nullptr;
+    };
+
+//==================================================================================
+//  Functions
+//==================================================================================
+    /*
+        ExportStatsToBin
+            Write all the non-null containers in "src" into a single binary file.
+            Only the strings for the blocks related to pokemon, moves and items are written.
+    */
+    void ExportStatsToBin( const std::string  & destfile,
+                           const statsbinrefs & src,
+                           eGameVersion         gvers,
+                           eGameRegion          greg );
+
+    /*
+        ImportStatsFromBin
+            Reads the tables from the binary file into the non-null containers in "dest".
+            Containers for which the file has no table are left untouched.
+            Strings are only written into blocks and languages already loaded in the GameText.
+    */
+    void ImportStatsFromBin( const std::string  & srcfile,
+                             statsbinrefs       & dest,
+                             eGameVersion         expectedgvers );
+
+    /*
+        IsStatsBinFile
+            Returns whether the file begins with the stats binary file's magic number.
+    */
+    bool IsStatsBinFile( const std::string & fpath );
+
+};};
+
+#endif
@@ -0,0 +1,142 @@
+#include "tileset_builder.hpp"
+#include <utils/fnv_hash.hpp>
+#include <stdexcept>
+#include <sstream>
+#include <algorithm>
+using namespace std;
+
+namespace pmd2
+{
+//============================================================================================
+//  Helpers
+//============================================================================================
+    typedef array<uint32_t, TilesetBuilder::TileHeight> packedtile_t;
+
+    enum struct eTileOrient : uint8_t
+    {
+        Normal = 0,
+        HFlip  = 1,
+        VFlip  = 2,
+        HVFlip = 3,
+    };
+
+    //Reverse the order of the 8 nybbles in a row
+    static inline uint32_t FlipRowH( uint32_t row )
+    {
+        row = ((row & 0x0F0F0F0F) << 4)  | ((row & 0xF0F0F0F0) >> 4);
+        row = ((row & 0x00FF00FF) << 8)  | ((row & 0xFF00FF00) >> 8);
+        row = ((row & 0x0000FFFF) << 16) | ((row & 0xFFFF0000) >> 16);
+        return row;
+    }
+
+    static packedtile_t OrientTile( const packedtile_t & tile, eTileOrient orient )
+    {
+        const bool   bhflip = (static_cast<uint8_t>(orient) & static_cast<uint8_t>(eTileOrient::HFlip)) != 0;
+        const bool   bvflip = (static_cast<uint8_t>(orient) & static_cast<uint8_t>(eTileOrient::VFlip)) != 0;
+        packedtile_t out;
+        for( size_t cntrow = 0; cntrow < TilesetBuilder::TileHeight; ++cntrow )
+        {
+            const uint32_t row = tile[ bvflip? (TilesetBuilder::TileHeight - 1 - cntrow) : cntrow ];
+            out[cntrow]        = bhflip? FlipRowH(row) : row;
+        }
+        return out;
+    }
+
+//============================================================================================
+//  TilesetBuilder
+//============================================================================================
+    size_t TilesetBuilder::packedtilehash::operator()( const packedtile_t & tile )const
+    {
+        return static_cast<size_t>( utils::HashFNV1a( tile.data(), sizeof(packedtile_t) ) );
+    }
+
+    TilesetBuilder::TilesetBuilder( bool breservenulltile, size_t maxnbtiles )
+        :m_maxnbtiles( (maxnbtiles < MaxNbTiles)? maxnbtiles : static_cast<size_t>(MaxNbTiles) )
+    {
+        if( breservenulltile )
+            InsertUniqueTile( packedtile_t{{0}}, nullptr );
+    }
+
+    tileproperties TilesetBuilder::AddTile( const tile_t & tile, uint8_t palindex )
+    {
+        if( tile.size() != NbPixelsPerTile )
+        {
+            stringstream sstr;
+            sstr <<"TilesetBuilder::AddTile(): Got a tile with " <<tile.size() <<" pixels, expected " <<NbPixelsPerTile <<"!";
+            throw std::runtime_error(sstr.str());
+        }
+
+        packedtile_t packed;
+        for( size_t cntrow = 0; cntrow < TileHeight; ++cntrow )
+        {
+            uint32_t row = 0;
+            for( size_t cntcol = 0; cntcol < TileWidth; ++cntcol )
+                row |= static_cast<uint32_t>(tile[(cntrow * TileWidth) + cntcol].pixeldata & 0x0F) << (cntcol * 4);
+            packed[cntrow] = row;
+        }
+
+        tileproperties tprop;
+        tprop.palindex = palindex;
+
+        //If the tile flipped in one way matches a stored tile, the stored tile flipped the same way gives our tile
+        for( uint8_t orient = 0; orient <= static_cast<uint8_t>(eTileOrient::HVFlip); ++orient )
+        {
+            auto itfound = m_lookup.find( OrientTile(packed, static_cast<eTileOrient>(orient)) );
+            if( itfound != m_lookup.end() )
+            {
+                tprop.tileindex = itfound->second;
+                tprop.hflip     = (orient & static_cast<uint8_t>(eTileOrient::HFlip)) != 0;
+                tprop.vflip     = (orient & static_cast<uint8_t>(eTileOrient::VFlip)) != 0;
+                return tprop;
+            }
+        }
+
+        tprop.tileindex = InsertUniqueTile(packed, &tile);
+        return tprop;
+    }
+
+    tileproperties TilesetBuilder::AddTileFrom8bpp( const uint8_t * pixels )
+    {
+        static const uint8_t NoPalette = 0xFF;
+        uint8_t palindex = NoPalette;
+        tile_t  tile(NbPixelsPerTile);
+
+        for( size_t cntpix = 0; cntpix < NbPixelsPerTile; ++cntpix )
+        {
+            const uint8_t colindex = pixels[cntpix] % NbColorsPerPal;
+            const uint8_t curpal   = static_cast<uint8_t>(pixels[cntpix] / NbColorsPerPal);
+            tile[cntpix].pixeldata = colindex;
+
+            if( colindex == 0 ) //Transparent pixels can be part of any palette
+                continue;
+            if( palindex == NoPalette )
+                palindex = curpal;
+            else if( palindex != curpal )
+            {
+                stringstream sstr;
+                sstr <<"TilesetBuilder::AddTileFrom8bpp(): A tile uses colors from both palette " <<static_cast<int>(palindex)
+                     <<" and palette " <<static_cast<int>(curpal) <<"! A tile can only use colors from a single 16 colors palette!";
+                throw std::runtime_error(sstr.str());
+            }
+        }
+        return AddTile( tile, (palindex != NoPalette)? palindex : 0 );
+    }
+
+    uint16_t TilesetBuilder::InsertUniqueTile( const packedtile_t & packed, const tile_t * ptile )
+    {
+        if( m_tiles.size() >= m_maxnbtiles )
+        {
+            stringstream sstr;
+            sstr <<"TilesetBuilder::InsertUniqueTile(): The image has more than " <<m_maxnbtiles <<" unique tiles!";
+            throw std::runtime_error(sstr.str());
+        }
+
+        const uint16_t tindex = static_cast<uint16_t>(m_tiles.size());
+        if( ptile )
+            m_tiles.push_back(*ptile);
+        else
+            m_tiles.push_back(tile_t(NbPixelsPerTile));
+        m_lookup.emplace( packed, tindex );
+        return tindex;
+    }
+};
@@ -0,0 +1,92 @@
+#ifndef TILESET_BUILDER_HPP
+#define TILESET_BUILDER_HPP
+/*
+tileset_builder.hpp
+2016/10/20
+psycommando@gmail.com
+Description: Builds minimal sets of 8x8 4bpp tiles, along with the tile mapping entries to reassemble the
+             original image, for formats using tile mapping tables, like BPC and BGP.
+*/
+#include <ppmdu/containers/level_tileset.hpp>
+#include <ppmdu/containers/img_pixel.hpp>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+namespace pmd2
+{
+    /************************************************************************************************
+        TilesetBuilder
+            Collects 8x8 4bpp tiles, and only keeps a single copy of tiles that are identical, or
+            identical once flipped horizontally and/or vertically.
+            Each added tile is turned into a tile mapping entry referring to the unique tile, with the
+            flip bits set accordingly.
+
+            Tiles are packed into 8 rows of 8 nybbles, and looked up in a hash table in all 4
+            orientations, so building a tileset is linear in the nb of tiles.
+    ************************************************************************************************/
+    class TilesetBuilder
+    {
+    public:
+        typedef std::vector<gimg::pixel_indexed_4bpp> tile_t;
+
+        static const size_t TileWidth         = 8;
+        static const size_t TileHeight        = 8;
+        static const size_t NbPixelsPerTile   = TileWidth * TileHeight;
+        static const size_t NbColorsPerPal    = 16;
+        static const size_t MaxNbTiles        = 1024;   //Tile mapping entries have 10 bits for the tile index
+
+        /*
+            - breservenulltile: When true, an empty tile is placed at index 0, and empty tiles are mapped to it.
+            - maxnbtiles      : The nb of unique tiles after which adding a new unique tile throws.
+        */
+        TilesetBuilder( bool breservenulltile = false, size_t maxnbtiles = MaxNbTiles );
+
+        /*
+            AddTile
+                Adds a 64 pixels 4bpp tile to the set, and returns the tile mapping entry to use for it.
+                "palindex" is copied as-is to the returned entry.
+        */
+        tileproperties AddTile( const tile_t & tile, uint8_t palindex = 0 );
+
+        /*
+            AddTileFrom8bpp
+                Adds a tile made of 64 8bpp pixels, indexing a palette of up to 16 palettes of 16 colors.
+                The palette index of the entry is determined by the pixels, and the tile is stored as 4bpp.
+                Throws if the tile uses colors from more than one palette. The first color of every
+                palette is transparent, and is allowed in any tile.
+        */
+        tileproperties AddTileFrom8bpp( const uint8_t * pixels );
+
+        template<class _tile8bpp_t>
+            inline tileproperties AddTile8bpp( const _tile8bpp_t & tile )
+        {
+            std::array<uint8_t, NbPixelsPerTile> pixels;
+            for( size_t cntpix = 0; cntpix < NbPixelsPerTile; ++cntpix )
+                pixels[cntpix] = static_cast<uint8_t>(tile[cntpix]);
+            return AddTileFrom8bpp( pixels.data() );
+        }
+
+        inline const std::vector<tile_t> & Tiles()const   { return m_tiles; }
+        inline std::vector<tile_t>       & Tiles()        { return m_tiles; }
+        inline size_t                      NbTiles()const { return m_tiles.size(); }
+
+    private:
+        typedef std::array<uint32_t, TileHeight> packedtile_t; //A row of 8 nybbles per uint32
+
+        struct packedtilehash
+        {
+            size_t operator()( const packedtile_t & tile )const;
+        };
+
+        uint16_t InsertUniqueTile( const packedtile_t & packed, const tile_t * ptile );
+
+    private:
+        std::unordered_map<packedtile_t, uint16_t, packedtilehash> m_lookup;
+        std::vector<tile_t>                                        m_tiles;
+        size_t                                                     m_maxnbtiles;
+    };
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <ppmdu/fmts/at4px.hpp>
 #include <ppmdu/containers/tiled_image.hpp>
 #include <ppmdu/containers/linear_image.hpp>
+#include <ppmdu/containers/tileset_builder.hpp>
 #include <ext_fmts/png_io.hpp>
 #include <ext_fmts/bmp_io.hpp>
 #include <ext_fmts/supported_io.hpp>
@@ -163,12 +164,68 @@ namespace filetypes
             :m_img(img)
         {}
 
-        void Write(const string & filepath)
+        void Write(const string & filepath, bool islittleendian = true)
         {
-            assert(false);
+            vector<uint8_t> rawdata;
+            MakeRawBGP(rawdata, islittleendian);
+
+            vector<uint8_t> compressed;
+            CompressToAT4PX( rawdata.begin(), rawdata.end(), compressed );
+            utils::io::WriteByteVectorToFile( filepath, compressed );
         }
 
     private:
+        static uint16_t EncodeTileMappingData( const BGP::tilemapdata & entry )
+        {
+            return static_cast<uint16_t>( (entry.tileindex & 0x3FF)                                    |   //0000 0011 1111 1111, tile index
+                                          ((static_cast<uint16_t>(entry.palindex) & 0xF) << 12)        |   //1111 0000 0000 0000, pal index
+                                          (entry.vflip? 0x800 : 0)                                     |   //0000 1000 0000 0000, vflip
+                                          (entry.hflip? 0x400 : 0) );                                      //0000 0100 0000 0000, hflip
+        }
+
+        //Lays out the data like the game's files do. The palettes, then the tile mapping table, then the tiles.
+        void MakeRawBGP( vector<uint8_t> & out_data, bool islittleendian )
+        {
+            bgp_header hdr;
+            hdr.palbeg     = bgp_header::LENGTH;
+            hdr.pallen     = static_cast<uint32_t>(m_img.m_palettes.size() * PaletteByteLength);
+            hdr.tmapdatptr = hdr.palbeg + hdr.pallen;
+            hdr.tmapdatlen = static_cast<uint32_t>(m_img.m_mappingdat.size() * sizeof(uint16_t));
+            hdr.tilesptr   = hdr.tmapdatptr + hdr.tmapdatlen;
+            hdr.tileslen   = static_cast<uint32_t>(m_img.m_tiles.size() * BGPTileNbBytes);
+            hdr.bgpunk3    = 0;
+            hdr.bgpunk4    = 0;
+
+            out_data.reserve( hdr.tilesptr + hdr.tileslen );
+            auto itw = std::back_inserter(out_data);
+            hdr.WriteToContainer(itw);
+
+            for( const auto & apal : m_img.m_palettes )
+            {
+                if( apal.size() != PaletteNbColors )
+                    throw runtime_error( "BGPWriter::MakeRawBGP(): A palette doesn't have exactly 16 colors !" );
+                for( const auto & acol : apal )
+                    itw = acol.WriteAsRawByte(itw);
+            }
+
+            for( const auto & entry : m_img.m_mappingdat )
+                itw = utils::WriteIntToBytes( EncodeTileMappingData(entry), itw );
+
+            for( const auto & atile : m_img.m_tiles )
+            {
+                if( atile.size() != BGPTileNbPix )
+                    throw runtime_error( "BGPWriter::MakeRawBGP(): A tile doesn't have exactly 64 pixels !" );
+                for( size_t cntpix = 0; cntpix < BGPTileNbPix; cntpix += 2 )
+                {
+                    const uint8_t pix1 = atile[cntpix].pixeldata     & 0x0F;
+                    const uint8_t pix2 = atile[cntpix + 1].pixeldata & 0x0F;
+                    if( islittleendian )
+                        out_data.push_back( static_cast<uint8_t>( pix1 | (pix2 << 4) ) );
+                    else
+                        out_data.push_back( static_cast<uint8_t>( (pix1 << 4) | pix2 ) );
+                }
+            }
+        }
 
     private:
         const BGP & m_img;
@@ -216,7 +273,10 @@ namespace filetypes
         for( const auto & tilemapdat : bgpimg.m_mappingdat )
         {
             if( tilemapdat.tileindex == 0 )
-                break;  //When we hit a tile using the first null tile, that means nothing is left to copy !
+            {
+                ++cntouttiles;  //Tiles using the first null tile are left blank, and the image is already zeroed
+                continue;
+            }
 
             const auto & curtile = bgpimg.m_tiles   [tilemapdat.tileindex];
             auto       & outtile = target.getTile( cntouttiles );
@@ -288,24 +348,23 @@ namespace filetypes
         };
 
         BGP target;
-        target.m_palettes.resize(BGPDefPalNbCol, vector<colorRGBX32>(PaletteNbColors));
+        target.m_palettes.resize( BGPDefPalNbCol / PaletteNbColors, vector<colorRGBX32>(PaletteNbColors) );
+        for( size_t cntcol = 0; cntcol < img.getNbColors() && cntcol < BGPDefPalNbCol; ++cntcol )
+            target.m_palettes[cntcol / PaletteNbColors][cntcol % PaletteNbColors].setFromRGB24( img.getColor(cntcol) );
+
+        //Split the image into unique 4bpp tiles, each tile refering to a single 16 colors palette.
+        // The first tile is always the empty tile.
+        pmd2::TilesetBuilder builder(true);
+        const size_t nbtiles = (BGP_RES.width / pmd2::TilesetBuilder::TileWidth) * (BGP_RES.height / pmd2::TilesetBuilder::TileHeight);
         target.m_mappingdat.resize(BGPDefTileMapNbEntries, {0,0,0,0} );
-        target.m_tiles.resize(BGPDefTilesNB, vector<pixel_indexed_4bpp>(BGPTileNbPix) );
-
-
-        //#TODO: Need to find a way to sort colors so that each tiles refers to exactly one 16 colors palette..
 
-        //#1 - look at every 64 pixels tile, and make sure each has no more than 16 colors in use. 
-        //     if there are any extra colors, try to replace them with the closest within a certain limit.
-        //     If no closest color can be found, error out!
-        //
-
-        //for( size_t cntcol = 0; cntcol < img.getNbColors(); ++cntcol )
-        //{
-        //    target.m_palettes[cntcol / PaletteNbColors][cntcol % PaletteNbColors].setFromRGB24( img.getColor(cntcol) );
-        //}
+        for( size_t cnttile = 0; cnttile < nbtiles; ++cnttile )
+        {
+            const pmd2::tileproperties tprop = builder.AddTile8bpp( img.getTile(cnttile) );
+            target.m_mappingdat[cnttile] = BGP::tilemapdata{ tprop.tileindex, tprop.palindex, tprop.vflip, tprop.hflip };
+        }
+        target.m_tiles = std::move(builder.Tiles());
 
-        assert(false);
         return move(target);
     }
 
@@ -356,6 +415,11 @@ namespace filetypes
             return utils::CompareStrIgnoreCase(filext, BGP_FileExt);
         }
 
+        virtual std::string getFileExtension()const
+        {
+            return BGP_FileExt;
+        }
+
     private:
         cntRID_t m_myID;
     };
@@ -112,6 +112,11 @@ namespace filetypes
             return utils::CompareStrIgnoreCase(filext, BMA_FileExt);
         }
 
+        virtual std::string getFileExtension()const
+        {
+            return BMA_FileExt;
+        }
+
     private:
         cntRID_t m_myID;
     };
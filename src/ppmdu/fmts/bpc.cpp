@@ -1,13 +1,21 @@
 #include "bpc.hpp"
 #include <ppmdu/fmts/bpc_compression.hpp>
+#include <ppmdu/containers/tileset_builder.hpp>
 #include <types/contentid_generator.hpp>
+#include <utils/library_wide.hpp>
 #include <cassert>
+#include <algorithm>
+#include <limits>
 using namespace std;
 
 namespace filetypes
 {
     static const ContentTy CnTy_BPC{BPC_FileExt}; //Content ID handle
 
+    static const size_t NbBytesPerTilesRaw    = 32; //In 4bpp we output 32 bytes per tile!
+    static const size_t NbPixelsPerTile       = 64;
+    static const size_t NbTMapEntriesPerChunk = 9;  //The tile mapping table is made of 3x3 tiles chunks
+
 //============================================================================================
 //  BPCParser
 //============================================================================================
@@ -33,7 +41,8 @@ namespace filetypes
 
             //!TODO: Figure out if there can be more than 2 layers!
             int actualnblayers = (hdr.offsuprscr - bpc_header::LEN) / bpc_header::indexentry::LEN;
-            clog <<"<D>- BPCParser::operator(): Actual nb of layers vs expected determined to be ~" <<actualnblayers <<"/" <<hdr.tilesetsinfo.size() <<"\n";
+            if( utils::LibWide().isLogOn() )
+                clog <<"<D>- BPCParser::operator(): Actual nb of layers vs expected determined to be ~" <<actualnblayers <<"/" <<hdr.tilesetsinfo.size() <<"\n";
 
             CopyLayerAsmTable(layers, hdr);
             layers.layers.resize(hdr.tilesetsinfo.size());
@@ -70,22 +79,14 @@ namespace filetypes
 
         void ParseALayer( pmd2::TilesetLayer & layer, init_t itbeg, const bpc_header::indexentry & entry )
         {
-            static const size_t NbBytesPerTilesRaw = 32; //In 4bpp we output 32 bytes per tile!
-            static const size_t NbPixelsPerTile    = 64;
             //Parse image first
             const size_t BytesToWrite = (entry.nbtiles-1) * NbBytesPerTilesRaw;
             std::vector<uint8_t> decout4bppbuff;
-            auto itbackins = back_inserter(decout4bppbuff);//tset.Tiles());
-
-            //
-            //First, put 16 bytes of zeros since the first tile is always empty
-            //
-            //std::fill_n(itbackins,64,0);
 
             //
             //Decompress the image
             //
-            bpc_compression::BPCImgDecompressor<init_t,decltype(itbackins)>(itbeg, m_itend, BytesToWrite).operator()(itbackins);
+            itbeg = bpc_compression::DecompressBPCImage( itbeg, m_itend, BytesToWrite, decout4bppbuff );
 
             //
             //Move the decompressed data to our tiles
@@ -93,17 +94,18 @@ namespace filetypes
             size_t nbtiles = (decout4bppbuff.size() % NbBytesPerTilesRaw != 0)? 1 : 0;
             nbtiles += (decout4bppbuff.size() / NbBytesPerTilesRaw);
             layer.Tiles().resize(nbtiles);
-            //layer.Tiles().resize(nbtiles + 1);
-            //layer.Tiles().front().resize(NbPixelsPerTile); //Resize the first empty tile
 
-            size_t cntdestpixel = 0; //NbPixelsPerTile; //Start placing pixels after the first empty tile!
-            for( size_t cntpixel = 0; cntpixel < decout4bppbuff.size(); ++cntpixel )
+            for( size_t cnttile = 0; cnttile < nbtiles; ++cnttile )
             {
-                auto & curtile = layer.Tiles()[cntdestpixel/NbPixelsPerTile];
+                auto        & curtile  = layer.Tiles()[cnttile];
+                const size_t  bybeg    = cnttile * NbBytesPerTilesRaw;
+                const size_t  byend    = std::min( bybeg + NbBytesPerTilesRaw, decout4bppbuff.size() );
                 curtile.resize(NbPixelsPerTile);
-                curtile[cntdestpixel % NbPixelsPerTile]       = (decout4bppbuff[cntpixel] & 0x0F);
-                curtile[(cntdestpixel % NbPixelsPerTile) + 1] = (decout4bppbuff[cntpixel] & 0xF0) >> 4;
-                cntdestpixel+=2;
+                for( size_t cntby = bybeg, cntpix = 0; cntby < byend; ++cntby, cntpix += 2 )
+                {
+                    curtile[cntpix]     = (decout4bppbuff[cntby] & 0x0F);
+                    curtile[cntpix + 1] = (decout4bppbuff[cntby] & 0xF0) >> 4;
+                }
             }
 
             //
@@ -112,16 +114,16 @@ namespace filetypes
             //if( entry.unk2 != 0 || entry.unk3 != 0 || entry.unk4 != 0 || entry.unk5 != 0 )
             //    HandleBPAs(layer, tset, itbeg,entry);
 
-            const size_t Tmaplen = ((entry.tmapdeclen-1) * 9) * 2;
+            const size_t Tmaplen = (entry.tmapdeclen-1) * NbTMapEntriesPerChunk;
             
             //Then parse the tile mapping table
-            vector<uint8_t> tmaptemp( std::move( bpc_compression::BPC_TileMapDecompressor<init_t, vector<uint8_t>>(itbeg, m_itend, Tmaplen)() ));
+            std::vector<uint16_t> tmaptemp;
+            bpc_compression::DecompressBPCTileMap( itbeg, m_itend, Tmaplen, tmaptemp );
 
             //Convert to tiles data
-            for( auto itby = tmaptemp.begin(); itby != tmaptemp.end(); )
-            {
-                layer.TileMap().push_back( pmd2::tileproperties(utils::ReadIntFromBytes<uint16_t>(itby,tmaptemp.end())) );
-            }
+            layer.TileMap().reserve(tmaptemp.size());
+            for( uint16_t entry : tmaptemp )
+                layer.TileMap().push_back( pmd2::tileproperties(entry) );
         }
 
         //void HandleBPAs( pmd2::TilesetLayer & layer, pmd2::Tileset & tset, init_t itbeg, const bpc_header::indexentry & entry )
@@ -140,15 +142,140 @@ namespace filetypes
 
     /*
         BPCWriter
+            Compress and write the layers of a tileset into the BPC format.
+            Tiles that are identical, or identical once flipped, are only written once.
     */
     class BPCWriter
     {
     public:
-        BPCWriter()
+        BPCWriter( const pmd2::TilesetLayers & layers )
+            :m_layers(layers)
+        {}
+
+        std::vector<uint8_t> operator()()
+        {
+            if( m_layers.size() > 2 )
+                throw std::runtime_error("BPCWriter::operator()(): BPC files can't contain more than 2 layers!");
+
+            //Compress the layers first, so we can fill the header
+            bpc_header hdr;
+            hdr.offsuprscr  = 0;
+            hdr.offslowrscr = 0;
+            hdr.tilesetsinfo.resize(m_layers.size());
+
+            std::vector<uint8_t> layersdata;
+            std::vector<size_t>  layersoffsets;
+            for( size_t cntlayer = 0; cntlayer < m_layers.size(); ++cntlayer )
+            {
+                layersoffsets.push_back(layersdata.size());
+                WriteALayer( DedupLayerTiles(m_layers[cntlayer]), cntlayer, hdr.tilesetsinfo[cntlayer], layersdata );
+            }
+
+            const size_t hdrlen = hdr.rawsize();
+            if( !layersoffsets.empty() )
+                hdr.offsuprscr  = CheckOffset(hdrlen + layersoffsets[0]);
+            if( layersoffsets.size() > 1 )
+                hdr.offslowrscr = CheckOffset(hdrlen + layersoffsets[1]);
+
+            std::vector<uint8_t> out;
+            out.reserve( hdrlen + layersdata.size() );
+            hdr.Write( std::back_inserter(out) );
+            out.insert( out.end(), layersdata.begin(), layersdata.end() );
+            return std::move(out);
+        }
+
+    private:
+        /*
+            Rebuilds the tiles of a layer with the TilesetBuilder, and points the tile mapping entries at the new tiles.
+            The first tile of a layer is the empty tile, which isn't stored. Entries past the layer's own tiles refer to
+            the BPA animated tiles that come right after them, so they're moved back by the nb of tiles removed.
+        */
+        static pmd2::TilesetLayer DedupLayerTiles( const pmd2::TilesetLayer & layer )
         {
+            pmd2::TilesetBuilder              builder(true);
+            std::vector<pmd2::tileproperties> remap;    //The new entry for each old tile index, empty tile included
+            remap.reserve( layer.Tiles().size() + 1 );
+            remap.push_back( pmd2::tileproperties() );
+            for( const auto & tile : layer.Tiles() )
+                remap.push_back( builder.AddTile(tile) );
+
+            const size_t       oldnbtiles = remap.size();
+            const size_t       newnbtiles = builder.NbTiles();
+            pmd2::TilesetLayer out;
+            out.ImgAsmDat() = layer.ImgAsmDat();
+            out.Tiles().assign( std::next(builder.Tiles().begin()), builder.Tiles().end() );
+            out.TileMap().reserve( layer.TileMap().size() );
+
+            for( const auto & tprop : layer.TileMap() )
+            {
+                pmd2::tileproperties newprop(tprop);
+                if( tprop.tileindex < oldnbtiles )
+                {
+                    //Flipping the new tile the way it was added, then the way the entry wants it, gives the old tile flipped as wanted
+                    const pmd2::tileproperties & mapped = remap[tprop.tileindex];
+                    newprop.tileindex = mapped.tileindex;
+                    newprop.hflip     = (tprop.hflip != mapped.hflip);
+                    newprop.vflip     = (tprop.vflip != mapped.vflip);
+                }
+                else
+                    newprop.tileindex = static_cast<uint16_t>( tprop.tileindex - (oldnbtiles - newnbtiles) );
+                out.TileMap().push_back(newprop);
+            }
+            return std::move(out);
+        }
+
+        void WriteALayer( const pmd2::TilesetLayer & layer, size_t layerid, bpc_header::indexentry & entry, std::vector<uint8_t> & out )
+        {
+            if( (layer.TileMap().size() % NbTMapEntriesPerChunk) != 0 )
+                throw std::runtime_error("BPCWriter::WriteALayer(): The tile mapping table's length must be divisible by 9!");
+
+            entry.nbtiles    = static_cast<uint16_t>(layer.Tiles().size() + 1);     //The first empty tile isn't stored
+            entry.tmapdeclen = static_cast<uint16_t>((layer.TileMap().size() / NbTMapEntriesPerChunk) + 1);
+            entry.unk2       = 0;
+            entry.unk3       = 0;
+            entry.unk4       = 0;
+            entry.unk5       = 0;
+            if( layerid < m_layers.layerasmdata.size() )
+            {
+                const auto & asmdat = m_layers.layerasmdata[layerid];
+                entry.unk2 = asmdat.unk2;
+                entry.unk3 = asmdat.unk3;
+                entry.unk4 = asmdat.unk4;
+                entry.unk5 = asmdat.unk5;
+            }
+
+            //Pack the pixels to 4bpp
+            std::vector<uint8_t> img4bpp(layer.Tiles().size() * NbBytesPerTilesRaw, 0);
+            for( size_t cnttile = 0; cnttile < layer.Tiles().size(); ++cnttile )
+            {
+                const auto & curtile = layer.Tiles()[cnttile];
+                const size_t nbpix   = std::min(curtile.size(), NbPixelsPerTile);
+                uint8_t    * pdest   = img4bpp.data() + (cnttile * NbBytesPerTilesRaw);
+                for( size_t cntpix = 0; cntpix < nbpix; ++cntpix )
+                    pdest[cntpix / 2] |= (static_cast<uint8_t>(curtile[cntpix]) & 0x0F) << ((cntpix % 2) * 4);
+            }
+            bpc_compression::CompressBPCImage( img4bpp.data(), img4bpp.data() + img4bpp.size(), out );
+
+            std::vector<uint16_t> tmap;
+            tmap.reserve(layer.TileMap().size());
+            for( const auto & tprop : layer.TileMap() )
+                tmap.push_back(tprop);
+            bpc_compression::CompressBPCTileMap( tmap.data(), tmap.data() + tmap.size(), out );
+
+            //Keep the next layer 2 bytes aligned
+            if( (out.size() % 2) != 0 )
+                out.push_back(0);
+        }
+
+        uint16_t CheckOffset( size_t off )const
+        {
+            if( off > std::numeric_limits<uint16_t>::max() )
+                throw std::runtime_error("BPCWriter::CheckOffset(): The compressed layers are too large for the BPC header's offsets!");
+            return static_cast<uint16_t>(off);
         }
 
     private:
+        const pmd2::TilesetLayers & m_layers;
     };
 
 //============================================================================================
@@ -163,11 +290,13 @@ namespace filetypes
     pmd2::TilesetLayers ParseBPC(const std::string & fpath)
     {
         auto data = utils::io::ReadFileToByteVector(fpath);
-        return std::move(BPCParser<decltype(data.begin())>(data.begin(), data.end())());
+        const uint8_t * pdata = data.data();
+        return std::move(BPCParser<const uint8_t*>(pdata, pdata + data.size())());
     }
 
-    void WriteBPC(const std::string & destfpath, const pmd2::Tileset & srcupscr, const pmd2::Tileset & srcbotscr)
+    void WriteBPC(const std::string & destfpath, const pmd2::TilesetLayers & layers)
     {
+        utils::io::WriteByteVectorToFile( destfpath, BPCWriter(layers)() );
     }
 
 
@@ -217,6 +346,11 @@ namespace filetypes
             return utils::CompareStrIgnoreCase(filext, BPC_FileExt);
         }
 
+        virtual std::string getFileExtension()const
+        {
+            return BPC_FileExt;
+        }
+
     private:
         cntRID_t m_myID;
     };
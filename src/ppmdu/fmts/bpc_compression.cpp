@@ -0,0 +1,386 @@
+#include "bpc_compression.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+namespace bpc_compression
+{
+//============================================================================================
+//  Constants
+//============================================================================================
+    //Image commands
+    static const uint8_t CMD_Img_CopyBytes                      = 0x00; //Up to 0x7D
+    static const uint8_t CMD_Img_CopyBytes_NbCpNextByte         = 0x7E;
+    static const uint8_t CMD_Img_CopyBytes_NbCpNextWord         = 0x7F;
+    static const uint8_t CMD_Img_LoadByteAsPatternAndCp         = 0x80;
+    static const uint8_t CMD_Img_LoadByteAsPatternAndCp_NbCpNextByte = 0xBF;
+    static const uint8_t CMD_Img_UseLastPatternAndCp            = 0xC0;
+    static const uint8_t CMD_Img_UseLastPatternAndCp_NbCpNextByte = 0xDF;
+    static const uint8_t CMD_Img_CyclePatternAndCp              = 0xE0;
+    static const uint8_t CMD_Img_CyclePatternAndCp_NbCpNextByte = 0xFF;
+
+    static const size_t  Img_MaxCopyLen         = 0x10000;  //The longest sequence a single copy command can handle
+    static const size_t  Img_MaxPatternLen      = 0x100;    //The longest run a single pattern command can handle
+    static const size_t  Img_MaxShortCopyLen    = CMD_Img_CopyBytes_NbCpNextByte;   //Longest copy with the length in the command byte
+    static const size_t  Img_MaxShortLoadLen    = (CMD_Img_LoadByteAsPatternAndCp_NbCpNextByte - CMD_Img_LoadByteAsPatternAndCp);
+    static const size_t  Img_MaxShortPatternLen = (CMD_Img_UseLastPatternAndCp_NbCpNextByte - CMD_Img_UseLastPatternAndCp);
+
+    //Tile mapping table commands
+    static const uint8_t CMD_TMap_ZeroOut       = 0x00; //Write/leave null bytes
+    static const uint8_t CMD_TMap_FillOut       = 0x80; //Write the byte following the command
+    static const uint8_t CMD_TMap_CopyBytes     = 0xC0; //Write the sequence of bytes following the command
+
+    static const size_t  TMap_MaxZeroLen        = (CMD_TMap_FillOut   - CMD_TMap_ZeroOut);
+    static const size_t  TMap_MaxFillLen        = (CMD_TMap_CopyBytes - CMD_TMap_FillOut);
+    static const size_t  TMap_MaxCopyLen        = (0x100              - CMD_TMap_CopyBytes);
+
+//============================================================================================
+//  Image Decompression
+//============================================================================================
+    const uint8_t * DecompressBPCImage( const uint8_t * pbeg, const uint8_t * pend, size_t decomplen, std::vector<uint8_t> & out )
+    {
+        const uint8_t * pcur      = pbeg;
+        uint8_t         hbyte     = 0;  //Current pattern byte
+        uint8_t         cachedhby = 0;  //Last pattern byte
+        size_t          outpos    = 0;
+
+        //Commands output at most Img_MaxCopyLen bytes, so we only need to grow the buffer once in a while
+        out.resize(decomplen + 1);
+
+        //The game writes words, so a trailing odd byte is never output
+        while( (outpos & ~static_cast<size_t>(1)) < decomplen && pcur != pend )
+        {
+            const uint8_t cmd    = *(pcur++);
+            size_t        nbtocp = 0;
+
+            //Determine the length
+            if( cmd == CMD_Img_CopyBytes_NbCpNextWord )
+            {
+                if( (pend - pcur) < 2 )
+                    throw std::runtime_error("DecompressBPCImage(): Unexpectedly reached end of input data!");
+                nbtocp = pcur[0] | (pcur[1] << 8);
+                pcur  += 2;
+            }
+            else if( cmd == CMD_Img_CopyBytes_NbCpNextByte                  ||
+                     cmd == CMD_Img_LoadByteAsPatternAndCp_NbCpNextByte     ||
+                     cmd == CMD_Img_UseLastPatternAndCp_NbCpNextByte        ||
+                     cmd == CMD_Img_CyclePatternAndCp_NbCpNextByte )
+            {
+                if( pcur == pend )
+                    throw std::runtime_error("DecompressBPCImage(): Unexpectedly reached end of input data!");
+                nbtocp = *(pcur++);
+            }
+            else if( cmd >= CMD_Img_CyclePatternAndCp )
+                nbtocp = cmd - CMD_Img_CyclePatternAndCp;
+            else if( cmd >= CMD_Img_UseLastPatternAndCp )
+                nbtocp = cmd - CMD_Img_UseLastPatternAndCp;
+            else if( cmd >= CMD_Img_LoadByteAsPatternAndCp )
+                nbtocp = cmd - CMD_Img_LoadByteAsPatternAndCp;
+            else
+                nbtocp = cmd;
+            ++nbtocp; //Commands always output one more byte than their length
+
+            if( outpos + nbtocp > out.size() )
+                out.resize( outpos + nbtocp );
+            uint8_t * pout = out.data() + outpos;
+
+            if( cmd >= CMD_Img_LoadByteAsPatternAndCp )
+            {
+                //Handle the pattern bytes
+                if( cmd < CMD_Img_UseLastPatternAndCp )
+                {
+                    if( pcur == pend )
+                        throw std::runtime_error("DecompressBPCImage(): Unexpectedly reached end of input data!");
+                    cachedhby = hbyte;
+                    hbyte     = *(pcur++);
+                }
+                else if( cmd >= CMD_Img_CyclePatternAndCp )
+                    std::swap(hbyte, cachedhby);
+                std::memset( pout, hbyte, nbtocp );
+            }
+            else
+            {
+                if( static_cast<size_t>(pend - pcur) < nbtocp )
+                    throw std::runtime_error("DecompressBPCImage(): Unexpectedly reached end of input data!");
+                std::memcpy( pout, pcur, nbtocp );
+                pcur += nbtocp;
+            }
+            outpos += nbtocp;
+        }
+
+        outpos &= ~static_cast<size_t>(1);
+        if( outpos < decomplen )
+            throw std::runtime_error("DecompressBPCImage(): Reached the end of input data unexpectedly!");
+        out.resize(outpos);
+
+        //Skip the alignment byte
+        if( ((pcur - pbeg) % 2) != 0 && pcur != pend )
+            ++pcur;
+        return pcur;
+    }
+
+//============================================================================================
+//  Image Compression
+//============================================================================================
+    /*
+        BPCImgCompressor
+            Greedy encoder. Runs of the same byte are turned into pattern commands whenever that's
+            shorter than copying them, and everything else is grouped into copy commands.
+            The current and last pattern bytes are tracked, so alternating between two common bytes
+            doesn't need to reload them.
+    */
+    class BPCImgCompressor
+    {
+    public:
+        BPCImgCompressor( const uint8_t * pbeg, const uint8_t * pend, std::vector<uint8_t> & out )
+            :m_pbeg(pbeg), m_pend(pend), m_out(out), m_hbyte(0), m_cachedhby(0)
+        {}
+
+        void operator()()
+        {
+            if( ((m_pend - m_pbeg) % 2) != 0 )
+                throw std::runtime_error("BPCImgCompressor::operator()(): The image data's length must be divisible by 2!");
+
+            const size_t    outbeg  = m_out.size();
+            const uint8_t * pcur    = m_pbeg;
+            const uint8_t * pcpbeg  = m_pbeg; //Beginning of the bytes waiting to be copied
+            m_out.reserve( outbeg + (m_pend - m_pbeg) / 2 );
+
+            while( pcur != m_pend )
+            {
+                const size_t runlen = CountRun(pcur);
+                //Stopping a pending copy to insert a pattern costs an extra command byte later on
+                const size_t mincost = GetPatternCost(*pcur, runlen) + ((pcpbeg != pcur)? 2 : 1);
+
+                if( runlen >= mincost )
+                {
+                    WriteCopy( pcpbeg, pcur );
+                    WritePattern( *pcur, runlen );
+                    pcur  += runlen;
+                    pcpbeg = pcur;
+                }
+                else
+                    pcur += runlen;
+            }
+            WriteCopy( pcpbeg, pcur );
+
+            //Pad to a length divisible by 2
+            if( ((m_out.size() - outbeg) % 2) != 0 )
+                m_out.push_back(0);
+        }
+
+    private:
+        inline size_t CountRun( const uint8_t * pcur )const
+        {
+            const uint8_t * pend = pcur + std::min<size_t>( Img_MaxPatternLen, (m_pend - pcur) );
+            const uint8_t   val  = *pcur;
+            const uint8_t * prun = pcur + 1;
+            for( ; prun != pend && *prun == val; ++prun );
+            return prun - pcur;
+        }
+
+        //The nb of bytes a pattern command would take
+        inline size_t GetPatternCost( uint8_t val, size_t runlen )const
+        {
+            if( val == m_hbyte || val == m_cachedhby )
+                return (runlen <= (Img_MaxShortPatternLen))? 1 : 2;
+            else
+                return (runlen <= (Img_MaxShortLoadLen))? 2 : 3;
+        }
+
+        void WritePattern( uint8_t val, size_t runlen )
+        {
+            const uint8_t nbtocp = static_cast<uint8_t>(runlen - 1);
+            if( val == m_hbyte )
+                WriteCmd( CMD_Img_UseLastPatternAndCp, CMD_Img_UseLastPatternAndCp_NbCpNextByte, Img_MaxShortPatternLen, nbtocp );
+            else if( val == m_cachedhby )
+            {
+                std::swap( m_hbyte, m_cachedhby );
+                WriteCmd( CMD_Img_CyclePatternAndCp, CMD_Img_CyclePatternAndCp_NbCpNextByte, Img_MaxShortPatternLen, nbtocp );
+            }
+            else
+            {
+                m_cachedhby = m_hbyte;
+                m_hbyte     = val;
+                WriteCmd( CMD_Img_LoadByteAsPatternAndCp, CMD_Img_LoadByteAsPatternAndCp_NbCpNextByte, Img_MaxShortLoadLen, nbtocp );
+                m_out.push_back(val);
+            }
+        }
+
+        inline void WriteCmd( uint8_t cmdbase, uint8_t cmdnextbyte, size_t maxshortlen, uint8_t nbtocp )
+        {
+            if( nbtocp < maxshortlen )
+                m_out.push_back( cmdbase + nbtocp );
+            else
+            {
+                m_out.push_back( cmdnextbyte );
+                m_out.push_back( nbtocp );
+            }
+        }
+
+        void WriteCopy( const uint8_t * pbeg, const uint8_t * pend )
+        {
+            while( pbeg != pend )
+            {
+                const size_t len    = std::min<size_t>( Img_MaxCopyLen, (pend - pbeg) );
+                const size_t nbtocp = len - 1;
+                if( nbtocp < Img_MaxShortCopyLen )
+                    m_out.push_back( static_cast<uint8_t>(CMD_Img_CopyBytes + nbtocp) );
+                else if( nbtocp <= 0xFF )
+                {
+                    m_out.push_back( CMD_Img_CopyBytes_NbCpNextByte );
+                    m_out.push_back( static_cast<uint8_t>(nbtocp) );
+                }
+                else
+                {
+                    m_out.push_back( CMD_Img_CopyBytes_NbCpNextWord );
+                    m_out.push_back( static_cast<uint8_t>(nbtocp & 0xFF) );
+                    m_out.push_back( static_cast<uint8_t>(nbtocp >> 8) );
+                }
+                m_out.insert( m_out.end(), pbeg, pbeg + len );
+                pbeg += len;
+            }
+        }
+
+    private:
+        const uint8_t        * m_pbeg;
+        const uint8_t        * m_pend;
+        std::vector<uint8_t> & m_out;
+        uint8_t                m_hbyte;     //Current pattern byte
+        uint8_t                m_cachedhby; //Last pattern byte
+    };
+
+    void CompressBPCImage( const uint8_t * pbeg, const uint8_t * pend, std::vector<uint8_t> & out )
+    {
+        BPCImgCompressor(pbeg, pend, out)();
+    }
+
+//============================================================================================
+//  Tile Map Decompression
+//============================================================================================
+    /*
+        Runs a single pass of the tile mapping table decompression, and write the bytes decompressed
+        at "shift" bits into the entries.
+        When "bcanoverrun" is true, the last command may go past the end of the table, and the table is grown.
+    */
+    static const uint8_t * DecompressBPCTileMapPass( const uint8_t         * pcur,
+                                                     const uint8_t         * pend,
+                                                     size_t                  nbentries,
+                                                     unsigned int            shift,
+                                                     bool                    bcanoverrun,
+                                                     std::vector<uint16_t> & out )
+    {
+        size_t cntentry = 0;
+        while( cntentry < nbentries && pcur != pend )
+        {
+            const uint8_t cmd   = *(pcur++);
+            size_t        nbout = 0;
+            if( cmd >= CMD_TMap_CopyBytes )
+                nbout = (cmd - CMD_TMap_CopyBytes) + 1;
+            else if( cmd >= CMD_TMap_FillOut )
+                nbout = (cmd - CMD_TMap_FillOut) + 1;
+            else
+                nbout = (cmd - CMD_TMap_ZeroOut) + 1;
+
+            if( cntentry + nbout > out.size() )
+            {
+                if(!bcanoverrun)
+                    throw std::runtime_error("DecompressBPCTileMap(): Output data shorter than expected, or input data corrupted.");
+                out.resize(cntentry + nbout, 0);
+            }
+            uint16_t * pout = out.data() + cntentry;
+
+            if( cmd >= CMD_TMap_CopyBytes )
+            {
+                if( static_cast<size_t>(pend - pcur) < nbout )
+                    throw std::runtime_error("DecompressBPCTileMap(): Input data shorter than expected.");
+                for( size_t i = 0; i < nbout; ++i )
+                    pout[i] |= static_cast<uint16_t>(pcur[i]) << shift;
+                pcur += nbout;
+            }
+            else if( cmd >= CMD_TMap_FillOut )
+            {
+                if( pcur == pend )
+                    throw std::runtime_error("DecompressBPCTileMap(): Input data shorter than expected.");
+                const uint16_t val = static_cast<uint16_t>(*(pcur++)) << shift;
+                for( size_t i = 0; i < nbout; ++i )
+                    pout[i] |= val;
+            }
+            //Zeroing out the entries does nothing, since they begin at 0
+            cntentry += nbout;
+        }
+        return pcur;
+    }
+
+    const uint8_t * DecompressBPCTileMap( const uint8_t * pbeg, const uint8_t * pend, size_t nbentries, std::vector<uint16_t> & out )
+    {
+        out.assign(nbentries, 0);
+
+        //Pass#1: Write the high bytes of the entries.
+        const uint8_t * pcur = DecompressBPCTileMapPass( pbeg, pend, nbentries, 8, true, out );
+        if( pcur == pend )
+            throw std::runtime_error("DecompressBPCTileMap(): Input data ended unexpectedly.");
+
+        //Pass#2: Write the low bytes of the entries.
+        return DecompressBPCTileMapPass( pcur, pend, out.size(), 0, false, out );
+    }
+
+//============================================================================================
+//  Tile Map Compression
+//============================================================================================
+    /*
+        Compress a single pass of the tile mapping table, using the bytes at "shift" bits of the entries.
+    */
+    static void CompressBPCTileMapPass( const uint16_t * pbeg, const uint16_t * pend, unsigned int shift, std::vector<uint8_t> & out )
+    {
+        auto lambdaget = [shift]( const uint16_t * pentry )->uint8_t { return static_cast<uint8_t>((*pentry) >> shift); };
+
+        auto lambdawritecopy = [&]( const uint16_t * pcpbeg, const uint16_t * pcpend )
+        {
+            while( pcpbeg != pcpend )
+            {
+                const size_t len = std::min<size_t>( TMap_MaxCopyLen, (pcpend - pcpbeg) );
+                out.push_back( static_cast<uint8_t>(CMD_TMap_CopyBytes + (len - 1)) );
+                for( size_t i = 0; i < len; ++i, ++pcpbeg )
+                    out.push_back( lambdaget(pcpbeg) );
+            }
+        };
+
+        const uint16_t * pcur   = pbeg;
+        const uint16_t * pcpbeg = pbeg; //Beginning of the entries waiting to be copied
+        while( pcur != pend )
+        {
+            const uint8_t    val    = lambdaget(pcur);
+            const uint16_t * prun   = pcur + 1;
+            const uint16_t * prunend= pcur + std::min<size_t>( (val == 0)? TMap_MaxZeroLen : TMap_MaxFillLen, (pend - pcur) );
+            for( ; prun != prunend && lambdaget(prun) == val; ++prun );
+            const size_t     runlen = prun - pcur;
+
+            //Zero runs take a single byte, fill runs take 2. Stopping a pending copy costs an extra byte later on.
+            const size_t     mincost= ((val == 0)? 1 : 2) + ((pcpbeg != pcur)? 1 : 0);
+            if( runlen > mincost || (val == 0 && pcpbeg == pcur) )
+            {
+                lambdawritecopy( pcpbeg, pcur );
+                if( val == 0 )
+                    out.push_back( static_cast<uint8_t>(CMD_TMap_ZeroOut + (runlen - 1)) );
+                else
+                {
+                    out.push_back( static_cast<uint8_t>(CMD_TMap_FillOut + (runlen - 1)) );
+                    out.push_back( val );
+                }
+                pcur  += runlen;
+                pcpbeg = pcur;
+            }
+            else
+                pcur += runlen;
+        }
+        lambdawritecopy( pcpbeg, pcur );
+    }
+
+    void CompressBPCTileMap( const uint16_t * pbeg, const uint16_t * pend, std::vector<uint8_t> & out )
+    {
+        CompressBPCTileMapPass( pbeg, pend, 8, out );
+        CompressBPCTileMapPass( pbeg, pend, 0, out );
+    }
+};
@@ -0,0 +1,479 @@
+/*
+bpc_compression_bench.cpp
+2016/10/02
+psycommando@gmail.com
+Description:
+    Stand-alone round trip test and benchmark for the BPC image and tile mapping table compression.
+
+    Generated layers are compressed with bpc_compression, then decompressed both with bpc_compression and
+    with the former iterator-based decoders, which are kept below as the reference. All 3 must match the
+    original data, and both decoders must stop at the same spot in the compressed data.
+    Then the time spent encoding and decoding with each is printed.
+
+    Build from the repository root, for example:
+        g++ -std=c++14 -O2 -Isrc src/ppmdu/fmts/bpc_compression_bench.cpp src/ppmdu/fmts/bpc_compression.cpp -o bpc_compression_bench
+
+    Returns 0 if every check passed.
+*/
+#include <ppmdu/fmts/bpc_compression.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+namespace
+{
+//============================================================================================
+//  Reference Decoders
+//============================================================================================
+    /*
+        The decoders bpc_compression replaced, with the same logic, minus the output iterator templates.
+        They mirror the game's code closely, and work on 16 bits words with a leftover byte carried over
+        between commands.
+    */
+    namespace old_bpc
+    {
+        class BPCImgDecompressor
+        {
+            static const uint8_t CMD_CyclePatternAndCp                      = 0xE0;
+            static const uint8_t CMD_CyclePatternAndCp_NbCpNextByte         = 0xFF;
+            static const uint8_t CMD_UseLastPatternAndCp                    = 0xC0;
+            static const uint8_t CMD_UseLastPatternAndCp_NbCpNextByte       = 0xDF;
+            static const uint8_t CMD_LoadByteAsPatternAndCp                 = 0x80;
+            static const uint8_t CMD_LoadByteAsPatternAndCp_NbCpNextByte    = 0xBF;
+            static const uint8_t CMD_LoadNextByteAsNbToCopy                 = 0x7E;
+            static const uint8_t CMD_LoadNextWordAsNbToCopy                 = 0x7F;
+
+        public:
+            BPCImgDecompressor( const uint8_t *& itbeg, const uint8_t * itend, size_t decomplen )
+                :m_itcur(itbeg), m_itend(itend), m_decomplen(decomplen), m_bytesread(0),
+                 m_bhasleftover(false), m_wordbuf(0), m_hbyte(0), m_cachedhby(0)
+            {}
+
+            void operator()( vector<uint8_t> & out )
+            {
+                m_pout = &out;
+                while( m_itcur != m_itend && out.size() < m_decomplen )
+                    Process();
+
+                if( m_itcur == m_itend )
+                    throw runtime_error("BPCImgDecompressor::operator()(): Reached the end of input data unexpectedly!");
+                if( (m_bytesread % 2) != 0 )
+                    ++m_itcur;
+            }
+
+        private:
+            inline uint8_t ReadByteFromSrc()
+            {
+                if( m_itcur == m_itend )
+                    throw runtime_error("BPCImgDecompressor::ReadByteFromSrc(): Unexpectedly reached end of input data!");
+                ++m_bytesread;
+                return *(m_itcur++);
+            }
+
+            inline void WriteWord( uint16_t w )
+            {
+                m_pout->push_back( static_cast<uint8_t>(w & 0xFF) );
+                m_pout->push_back( static_cast<uint8_t>(w >> 8) );
+            }
+
+            inline bool IsBufferedPatternOp( uint8_t cmdby )const          { return cmdby >= CMD_LoadByteAsPatternAndCp; }
+            inline bool IsLoadingPatternFromNextByte( uint8_t cmdby )const { return cmdby >= CMD_LoadByteAsPatternAndCp && cmdby < CMD_UseLastPatternAndCp; }
+
+            int DetermineLenToOutput( uint8_t cmdbyte )
+            {
+                int nbtocp = 0;
+                switch(cmdbyte)
+                {
+                    case CMD_CyclePatternAndCp_NbCpNextByte:
+                    case CMD_UseLastPatternAndCp_NbCpNextByte:
+                    case CMD_LoadByteAsPatternAndCp_NbCpNextByte:
+                    case CMD_LoadNextByteAsNbToCopy:
+                    {
+                        nbtocp = ReadByteFromSrc();
+                        break;
+                    }
+                    case CMD_LoadNextWordAsNbToCopy:
+                    {
+                        uint8_t lowbyte = ReadByteFromSrc();
+                        nbtocp = lowbyte | (ReadByteFromSrc() << 8);
+                        break;
+                    }
+                    default:
+                    {
+                        nbtocp = cmdbyte;
+                        if(cmdbyte >= CMD_CyclePatternAndCp)
+                            nbtocp -= CMD_CyclePatternAndCp;
+                        else if(cmdbyte >= CMD_UseLastPatternAndCp)
+                            nbtocp -= CMD_UseLastPatternAndCp;
+                        else if(cmdbyte >= CMD_LoadByteAsPatternAndCp)
+                            nbtocp -= CMD_LoadByteAsPatternAndCp;
+                    }
+                };
+
+                //when we have a leftover word, we subtract one word automatically
+                if(m_bhasleftover)
+                    nbtocp -= 1;
+                return nbtocp;
+            }
+
+            void Process()
+            {
+                uint8_t cmd        = ReadByteFromSrc();
+                int     nbwordsout = DetermineLenToOutput(cmd);
+
+                //Cycle the pattern bytes and or load a new pattern byte if needed, before the leftover byte
+                if( IsLoadingPatternFromNextByte(cmd) || cmd >= CMD_CyclePatternAndCp )
+                    std::swap( m_hbyte, m_cachedhby );
+                if( IsLoadingPatternFromNextByte(cmd) )
+                    m_hbyte = ReadByteFromSrc();
+
+                //Then check for leftover bytes patterns to add
+                if(m_bhasleftover)
+                {
+                    if(IsBufferedPatternOp(cmd))
+                        WriteWord( m_wordbuf | (m_hbyte << 8) );
+                    else
+                        WriteWord( m_wordbuf | (ReadByteFromSrc() << 8) );
+                    m_bhasleftover = false;
+                }
+
+                if( nbwordsout >= 0 )
+                    HandleMainOp( cmd, static_cast<size_t>(nbwordsout) );
+            }
+
+            void HandleMainOp( uint8_t cmd, size_t nbtocopy )
+            {
+                size_t cntcopy = 0;
+                if(IsBufferedPatternOp(cmd))
+                {
+                    const uint16_t pattern = m_hbyte | (m_hbyte << 8);
+                    for( ; cntcopy < nbtocopy; cntcopy += 2 )
+                        WriteWord(pattern);
+                }
+                else
+                {
+                    for( ; cntcopy < nbtocopy; cntcopy += 2 )
+                    {
+                        uint16_t value = ReadByteFromSrc();
+                        value |= (ReadByteFromSrc() << 8);
+                        WriteWord(value);
+                    }
+                }
+
+                //If the ammount copied was even, the last byte is completed by the next command
+                if( cntcopy == nbtocopy )
+                {
+                    m_bhasleftover = true;
+                    m_wordbuf      = IsBufferedPatternOp(cmd)? m_hbyte : ReadByteFromSrc();
+                }
+            }
+
+        private:
+            const uint8_t  *& m_itcur;
+            const uint8_t   * m_itend;
+            vector<uint8_t> * m_pout;
+            size_t            m_decomplen;
+            size_t            m_bytesread;
+            bool              m_bhasleftover;
+            uint16_t          m_wordbuf;
+            uint8_t           m_hbyte;
+            uint8_t           m_cachedhby;
+        };
+
+        /*
+            The tile mapping table decoder works on the bytes of the entries, little endian.
+        */
+        vector<uint16_t> DecompressTileMap( const uint8_t *& itcur, const uint8_t * itend, size_t nbentries )
+        {
+            auto lambdaread = [&]()->uint8_t
+            {
+                if( itcur == itend )
+                    throw runtime_error("BPC_TileMapDecompressor::ReadSrcByte(): Input data shorter than expected.");
+                return *(itcur++);
+            };
+
+            //Step#1: Write the words, with their high bytes.
+            const size_t    decomplen = nbentries * sizeof(uint16_t);
+            vector<uint8_t> outbuf;
+            outbuf.reserve(decomplen);
+            while( outbuf.size() < decomplen && itcur != itend )
+            {
+                const uint8_t cmdby = lambdaread();
+                if( cmdby < 0x80 )
+                {
+                    for( size_t cnt = 0; cnt <= cmdby; ++cnt )
+                    {
+                        outbuf.push_back(0);
+                        outbuf.push_back(0);
+                    }
+                }
+                else if( cmdby < 0xC0 )
+                {
+                    const uint8_t param = lambdaread();
+                    for( size_t cntw = 0x80; cntw <= cmdby; ++cntw )
+                    {
+                        outbuf.push_back(0);
+                        outbuf.push_back(param);
+                    }
+                }
+                else
+                {
+                    for( size_t cntw = 0xC0; cntw <= cmdby; ++cntw )
+                    {
+                        outbuf.push_back(0);
+                        outbuf.push_back(lambdaread());
+                    }
+                }
+            }
+            if( itcur == itend || outbuf.size() < decomplen )
+                throw runtime_error("BPC_TileMapDecompressor::operator()(): Input data ended unexpectedly.");
+
+            //Step#2: Write the low bytes of the specified words.
+            size_t pos = 0;
+            while( pos < outbuf.size() && itcur != itend )
+            {
+                const uint8_t cmdby = lambdaread();
+                if( cmdby < 0x80 )
+                {
+                    const size_t skiplen = (cmdby + 1) * sizeof(int16_t);
+                    if( pos + skiplen > outbuf.size() )
+                        throw runtime_error("BPC_TileMapDecompressor::HandleCmdTableB(): Output data shorter than expected, or input data corrupted.");
+                    pos += skiplen;
+                }
+                else if( cmdby < 0xC0 )
+                {
+                    const uint8_t lbyte = lambdaread();
+                    for( size_t cntw = 0x80; cntw <= cmdby; ++cntw, pos += 2 )
+                    {
+                        if( pos >= outbuf.size() )
+                            throw runtime_error("BPC_TileMapDecompressor::HandleCmdTableB(): Output data shorter than expected, or input data corrupted.");
+                        outbuf[pos] |= lbyte;
+                    }
+                }
+                else
+                {
+                    for( size_t cntw = 0xC0; cntw <= cmdby; ++cntw, pos += 2 )
+                    {
+                        if( pos >= outbuf.size() )
+                            throw runtime_error("BPC_TileMapDecompressor::HandleCmdTableB(): Output data shorter than expected, or input data corrupted.");
+                        outbuf[pos] |= lambdaread();
+                    }
+                }
+            }
+
+            vector<uint16_t> entries(nbentries);
+            for( size_t cnt = 0; cnt < nbentries; ++cnt )
+                entries[cnt] = outbuf[cnt * 2] | (outbuf[cnt * 2 + 1] << 8);
+            return entries;
+        }
+    };
+
+//============================================================================================
+//  Test Data
+//============================================================================================
+    const size_t   TileLen          = 32;   //4bpp 8x8 tiles
+    const size_t   NbEntriesPerTile = 9;    //Tile mapping entries come in groups of 3x3
+    const uint32_t RandSeed         = 1;
+
+    /*
+        Makes 4bpp image data resembling different kinds of layers: noise, flat areas with a few details,
+        a handful of solid colors, and long alternating runs.
+    */
+    vector<uint8_t> MakeImage( mt19937 & rng, size_t nbtiles, int kind )
+    {
+        vector<uint8_t> img(nbtiles * TileLen);
+        const size_t runlen = 1 + rng() % 300;
+        for( size_t i = 0; i < img.size(); ++i )
+        {
+            switch(kind)
+            {
+                case 0:  img[i] = static_cast<uint8_t>(rng()); break;
+                case 1:  img[i] = (rng() % 8 == 0)? static_cast<uint8_t>(rng()) : static_cast<uint8_t>((i / 37) % 3); break;
+                case 2:  img[i] = static_cast<uint8_t>((rng() % 3) * 0x11); break;
+                default: img[i] = ((i / runlen) & 1)? 0x22 : 0; break;
+            };
+        }
+        return img;
+    }
+
+    vector<uint16_t> MakeTileMap( mt19937 & rng, size_t nbentries )
+    {
+        vector<uint16_t> tmap(nbentries);
+        for( auto & entry : tmap )
+        {
+            switch( rng() % 4 )
+            {
+                case 0:  entry = 0; break;
+                case 1:  entry = static_cast<uint16_t>(rng()); break;
+                case 2:  entry = static_cast<uint16_t>(0x1000 | (rng() % 4)); break;
+                default: entry = 0x2003; break;
+            };
+        }
+        return tmap;
+    }
+
+    typedef chrono::high_resolution_clock clock_t;
+
+    inline double ElapsedMs( clock_t::time_point beg )
+    {
+        return chrono::duration<double, milli>( clock_t::now() - beg ).count();
+    }
+
+//============================================================================================
+//  Checks
+//============================================================================================
+    struct benchtimes
+    {
+        double encode    = 0.0;
+        double decode    = 0.0;
+        double olddecode = 0.0;
+        size_t nbbytes   = 0;
+    };
+
+    unsigned int CheckImages( mt19937 & rng, size_t nbimages, benchtimes & times )
+    {
+        unsigned int nbfails = 0;
+        for( size_t cntimg = 0; cntimg < nbimages; ++cntimg )
+        {
+            const vector<uint8_t> img = MakeImage( rng, 1 + rng() % 200, static_cast<int>(cntimg % 4) );
+            times.nbbytes += img.size();
+
+            //Put data around the compressed image, to check alignment and where the decoders stop
+            vector<uint8_t> comp(1, 0xAA);
+            const size_t    compbeg = comp.size();
+            auto            tbeg    = clock_t::now();
+            bpc_compression::CompressBPCImage( img.data(), img.data() + img.size(), comp );
+            times.encode += ElapsedMs(tbeg);
+            comp.push_back(0x55);
+            comp.push_back(0x66);
+
+            const uint8_t * pcompbeg = comp.data() + compbeg;
+            const uint8_t * pcompend = comp.data() + comp.size();
+            vector<uint8_t> decoded;
+            tbeg = clock_t::now();
+            const uint8_t * pnewend = bpc_compression::DecompressBPCImage( pcompbeg, pcompend, img.size(), decoded );
+            times.decode += ElapsedMs(tbeg);
+            if( decoded != img )
+            {
+                printf( "<!>- Image #%u: Round trip mismatch!\n", static_cast<unsigned int>(cntimg) );
+                ++nbfails;
+                continue;
+            }
+
+            try
+            {
+                vector<uint8_t> olddecoded;
+                olddecoded.reserve(img.size());
+                const uint8_t * poldcur = pcompbeg;
+                tbeg = clock_t::now();
+                old_bpc::BPCImgDecompressor( poldcur, pcompend, img.size() )(olddecoded);
+                times.olddecode += ElapsedMs(tbeg);
+                if( olddecoded != img )
+                {
+                    printf( "<!>- Image #%u: Reference decoder output mismatch!\n", static_cast<unsigned int>(cntimg) );
+                    ++nbfails;
+                }
+                else if( poldcur != pnewend )
+                {
+                    printf( "<!>- Image #%u: Decoders ended at different offsets!\n", static_cast<unsigned int>(cntimg) );
+                    ++nbfails;
+                }
+            }
+            catch( const exception & e )
+            {
+                printf( "<!>- Image #%u: Reference decoder failed: %s\n", static_cast<unsigned int>(cntimg), e.what() );
+                ++nbfails;
+            }
+        }
+        return nbfails;
+    }
+
+    unsigned int CheckTileMaps( mt19937 & rng, size_t nbtmaps, benchtimes & times )
+    {
+        unsigned int nbfails = 0;
+        for( size_t cnttmap = 0; cnttmap < nbtmaps; ++cnttmap )
+        {
+            const vector<uint16_t> tmap = MakeTileMap( rng, NbEntriesPerTile * (1 + rng() % 300) );
+            times.nbbytes += tmap.size() * sizeof(uint16_t);
+
+            vector<uint8_t> comp;
+            auto            tbeg = clock_t::now();
+            bpc_compression::CompressBPCTileMap( tmap.data(), tmap.data() + tmap.size(), comp );
+            times.encode += ElapsedMs(tbeg);
+            comp.push_back(0x12);
+
+            const uint8_t *  pcompend = comp.data() + comp.size();
+            vector<uint16_t> decoded;
+            tbeg = clock_t::now();
+            const uint8_t *  pnewend = bpc_compression::DecompressBPCTileMap( comp.data(), pcompend, tmap.size(), decoded );
+            times.decode += ElapsedMs(tbeg);
+            if( decoded != tmap )
+            {
+                printf( "<!>- Tile map #%u: Round trip mismatch!\n", static_cast<unsigned int>(cnttmap) );
+                ++nbfails;
+                continue;
+            }
+
+            try
+            {
+                const uint8_t * poldcur = comp.data();
+                tbeg = clock_t::now();
+                vector<uint16_t> olddecoded = old_bpc::DecompressTileMap( poldcur, pcompend, tmap.size() );
+                times.olddecode += ElapsedMs(tbeg);
+                if( olddecoded != tmap )
+                {
+                    printf( "<!>- Tile map #%u: Reference decoder output mismatch!\n", static_cast<unsigned int>(cnttmap) );
+                    ++nbfails;
+                }
+                else if( poldcur != pnewend )
+                {
+                    printf( "<!>- Tile map #%u: Decoders ended at different offsets!\n", static_cast<unsigned int>(cnttmap) );
+                    ++nbfails;
+                }
+            }
+            catch( const exception & e )
+            {
+                printf( "<!>- Tile map #%u: Reference decoder failed: %s\n", static_cast<unsigned int>(cnttmap), e.what() );
+                ++nbfails;
+            }
+        }
+        return nbfails;
+    }
+
+    void PrintTimes( const char * what, const benchtimes & times )
+    {
+        const double mb = static_cast<double>(times.nbbytes) / (1024.0 * 1024.0);
+        printf( "<*>- %s: %.2f MB\n", what, mb );
+        printf( "     Encoding           : %8.2f ms (%.1f MB/s)\n", times.encode,    mb / (times.encode    / 1000.0) );
+        printf( "     Decoding           : %8.2f ms (%.1f MB/s)\n", times.decode,    mb / (times.decode    / 1000.0) );
+        printf( "     Reference decoding : %8.2f ms (%.1f MB/s)\n", times.olddecode, mb / (times.olddecode / 1000.0) );
+    }
+};
+
+int main()
+{
+    const size_t NbImages   = 3000;
+    const size_t NbTileMaps = 3000;
+    mt19937      rng(RandSeed);
+    benchtimes   imgtimes;
+    benchtimes   tmaptimes;
+
+    unsigned int nbfails = CheckImages( rng, NbImages, imgtimes );
+    nbfails += CheckTileMaps( rng, NbTileMaps, tmaptimes );
+
+    PrintTimes( "Images", imgtimes );
+    PrintTimes( "Tile maps", tmaptimes );
+
+    if( nbfails != 0 )
+    {
+        printf( "<!>- %u check(s) failed!\n", nbfails );
+        return 1;
+    }
+    printf( "<*>- All checks passed!\n" );
+    return 0;
+}
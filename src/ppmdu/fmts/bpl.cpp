@@ -145,6 +145,11 @@ namespace filetypes
             return utils::CompareStrIgnoreCase(filext, BPL_FileExt);
         }
 
+        virtual std::string getFileExtension()const
+        {
+            return BPL_FileExt;
+        }
+
     private:
         cntRID_t m_myID;
     };
@@ -15,6 +15,7 @@
 #include <Poco/File.h>
 #include <Poco/Path.h>
 #include <utils/gbyteutils.hpp>
+#include <utils/trace.hpp>
 using namespace std;
 using namespace gimg;
 using namespace pmd2;
@@ -82,6 +83,7 @@ namespace filetypes
     
     void KaoParser::ParseKaomado()
     {
+        UTILS_TRACE_ZONE("KAO Parse");
         m_itInBeg  = m_kaomadoBuff.begin();
         std::vector<uint8_t>::const_iterator itend = m_kaomadoBuff.end();
 
@@ -228,6 +230,7 @@ namespace filetypes
 
     void KaoParser::ImportFromFolders()
     {
+        UTILS_TRACE_ZONE("KAO Import Folders");
         auto & toc    =  m_pImportTo->m_tableofcontent;
         auto & imgdat =  m_pImportTo->m_imgdata;
 
@@ -449,6 +452,7 @@ namespace filetypes
 
     void KaoWriter::ExportToFolders()
     {
+        UTILS_TRACE_ZONE("KAO Export Folders");
         //#1 - Go through the ToC, and make a sub-folder for each ToC entry
         //     with its index as name.
 
@@ -551,6 +555,7 @@ namespace filetypes
 
     vector<uint8_t> KaoWriter::WriteToKaomado()
     {
+        UTILS_TRACE_ZONE("KAO Write");
         if( m_pExportFrom->m_imgdata.empty() || m_pExportFrom->m_tableofcontent.empty() )
         {
             cerr << "<!>-WARNING: KaoWriter::WriteKaomado() : Nothing to write in the output kaomado file!\n";
@@ -300,14 +300,8 @@ namespace filetypes
             {
                 const size_t nbfloors = (begpkspwndat - m_subhdr.ptrFloorDataBlock) / DungeonFloorDataEntry::SIZE;
                 auto         itfloor  = m_itbegin + m_subhdr.ptrFloorDataBlock;
-                m_floordatatbl.reserve(nbfloors);
-
-                for( size_t cntfloor = 0; cntfloor < nbfloors && itfloor != itfloordataend; ++cntfloor )
-                {
-                    DungeonFloorDataEntry curfloor;
-                    itfloor = curfloor.ReadFromContainer( itfloor, itfloordataend );
-                    m_floordatatbl.push_back(curfloor);
-                }
+                m_floordatatbl.resize(nbfloors);
+                utils::ReadArrayFromContainer( m_floordatatbl, itfloor, itfloordataend );
             }
         }
 
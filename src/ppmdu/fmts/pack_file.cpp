@@ -446,6 +446,9 @@ namespace filetypes
                                std::vector<uint8_t>::const_iterator itdataend,
                                const std::string                  & filext);
 
+        //Each non-empty sub-file is a sub-content.
+        virtual void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt );
+
     private:
         cntRID_t m_myID;
     };
@@ -508,6 +511,26 @@ namespace filetypes
         return (headr._zeros == 0) && (headr._nbfiles > 0) && (nextint != 0);  //TODO: improve this, it fails and recognize files that aren't pack files !!
     }
 
+    void packfile_rule::ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt )
+    {
+        pfheader     headr;
+        const size_t datalen = static_cast<size_t>( std::distance( parameters._itdatabeg, parameters._itdataend ) );
+        auto         itentry = headr.ReadFromContainer( parameters._itdatabeg, parameters._itdataend );
+
+        //Since the rule isn't very strict, don't trust the nb of entries too much
+        if( OFFSET_TBL_FIRST_ENTRY + ( static_cast<size_t>(headr._nbfiles) * SZ_OFFSET_TBL_ENTRY ) > datalen )
+            return;
+
+        out_subcnt.reserve( headr._nbfiles );
+        for( uint32_t cntentry = 0; cntentry < headr._nbfiles; ++cntentry )
+        {
+            fileIndex entry;
+            itentry = entry.ReadFromContainer( itentry, parameters._itdataend );
+            if( entry._fileLength != 0 && (static_cast<size_t>(entry._fileOffset) + entry._fileLength) <= datalen )
+                out_subcnt.push_back( SubContent( entry._fileOffset, static_cast<size_t>(entry._fileOffset) + entry._fileLength ) );
+        }
+    }
+
 //========================================================================================================
 //  at4px_rule_registrator
 //========================================================================================================
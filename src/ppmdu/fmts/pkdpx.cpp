@@ -380,6 +380,14 @@ namespace filetypes
                                vector<uint8_t>::const_iterator   itdataend,
                                const std::string    & filext );
 
+        virtual std::vector<uint8_t> getMagicNumber()const 
+        { 
+            return std::vector<uint8_t>( MagicNumber_PKDPX.begin(), MagicNumber_PKDPX.end() ); 
+        }
+
+        //The decompressed data is the only sub-content.
+        virtual void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt );
+
     private:
         cntRID_t m_myID;
     };
@@ -436,6 +444,16 @@ namespace filetypes
         return std::equal( MagicNumber_PKDPX.begin(), MagicNumber_PKDPX.end(), itdatabeg );
     }
 
+    void pkdpx_rule::ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt )
+    {
+        auto pdecomp = std::make_shared<std::vector<uint8_t>>();
+        DecompressPKDPX( parameters._itdatabeg, parameters._itdataend, *pdecomp );
+
+        SubContent decompressed( 0, static_cast<size_t>( std::distance( parameters._itdatabeg, parameters._itdataend ) ) );
+        decompressed._decoded = pdecomp;
+        out_subcnt.push_back( std::move(decompressed) );
+    }
+
 
     /*
         sir0pkdpx_rule
@@ -517,6 +535,20 @@ namespace filetypes
             return false;
         }
 
+        //The decompressed data is the only sub-content.
+        virtual void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt )
+        {
+            sir0_header sir0hdr;
+            sir0hdr.ReadFromContainer( parameters._itdatabeg, parameters._itdataend );
+
+            auto pdecomp = std::make_shared<std::vector<uint8_t>>();
+            DecompressPKDPX( parameters._itdatabeg + sir0hdr.subheaderptr, parameters._itdataend, *pdecomp );
+
+            SubContent decompressed( sir0hdr.subheaderptr, static_cast<size_t>( std::distance( parameters._itdatabeg, parameters._itdataend ) ) );
+            decompressed._decoded = pdecomp;
+            out_subcnt.push_back( std::move(decompressed) );
+        }
+
     private:
         cntRID_t m_myID;
     };
@@ -18,6 +18,7 @@
 #include <numeric>
 #include <Poco/File.h>
 #include <utils/utility.hpp>
+#include <utils/trace.hpp>
 using namespace std;
 using namespace utils;
 
@@ -451,6 +452,8 @@ namespace compression
     template<class _init, class _outit>
         void px_decompressor<_init,_outit>::DecompressPX()
     {
+        UTILS_TRACE_ZONE("PX Decompress");
+        UTILS_TRACE_COUNTER("PX Bytes Decompressed", pxinfo.decompressedsz);
         //Iterate through all bytes
         while( itdatacur != itdataend )
         {
@@ -733,8 +736,10 @@ namespace compression
     template<class _inRandit, class _outRandit>
         px_info_header px_compressor<_inRandit,_outRandit>::Compress(ePXCompLevel compressionlvl, bool shouldsearchfirst, multistep_completion<2> * pTotalBytesHandled)
     {
+        UTILS_TRACE_ZONE("PX Compress");
         //Caluclate the size of the input
         m_inputSize = std::distance( m_itInBeg, m_itInEnd );
+        UTILS_TRACE_COUNTER("PX Bytes Compressed", m_inputSize);
 
         //Verify if we overflow
         if( m_inputSize > static_cast<decltype(m_inputSize)>(std::numeric_limits<uint32_t>::max()) )
@@ -773,22 +778,27 @@ namespace compression
 
         //Do compression
         uint64_t nbBytesHandled=0;
-
-        while( HandleABlock( compressionlvl, &nbBytesHandled, shouldsearchfirst ) )
         {
-            //Update progress
-            if( pTotalBytesHandled != nullptr )
-                pTotalBytesHandled->steps[0] = static_cast<uint8_t>((nbBytesHandled * 100ul) / m_inputSize);
+            UTILS_TRACE_ZONE("PX Find Operations");
+            while( HandleABlock( compressionlvl, &nbBytesHandled, shouldsearchfirst ) )
+            {
+                //Update progress
+                if( pTotalBytesHandled != nullptr )
+                    pTotalBytesHandled->steps[0] = static_cast<uint8_t>((nbBytesHandled * 100ul) / m_inputSize);
+            }
         }
 
-        //Build control flag table, now that we determined all our string search lengths !
-        BuildCtrlFlagsList();
+        {
+            UTILS_TRACE_ZONE("PX Output Operations");
+            //Build control flag table, now that we determined all our string search lengths !
+            BuildCtrlFlagsList();
 
-        //Execute all operations from our queue
-        if( pTotalBytesHandled != nullptr )
-            OutputAllOperations(&(pTotalBytesHandled->steps[1]));
-        else
-            OutputAllOperations(nullptr);
+            //Execute all operations from our queue
+            if( pTotalBytesHandled != nullptr )
+                OutputAllOperations(&(pTotalBytesHandled->steps[1]));
+            else
+                OutputAllOperations(nullptr);
+        }
 
         //Compute compressed size
         //unsigned int compressedsz = ( m_pCompressedData != nullptr )? m_pCompressedData->size() : std::distance(m_itOutBeg, m_itOutCur); 
@@ -1,4 +1,5 @@
 #include "sedl.hpp"
+#include <iterator>
 using namespace std;
 
 namespace DSE
@@ -68,6 +69,13 @@ namespace DSE
                 return (utils::ReadIntFromBytes<uint32_t>(itdatabeg, itdataend, false) == DSE::SEDL_MagicNumber);
             }
 
+            virtual std::vector<uint8_t> getMagicNumber()const
+            {
+                std::vector<uint8_t> magic;
+                utils::WriteIntToBytes( DSE::SEDL_MagicNumber, std::back_inserter(magic), false );
+                return std::move(magic);
+            }
+
         private:
             cntRID_t m_myID;
         };
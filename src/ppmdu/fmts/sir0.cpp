@@ -17,6 +17,7 @@ No crappyrights. All wrongs reversed !
 #include <sstream>
 #include <iomanip>
 #include <array>
+#include <iterator>
 using namespace std;
 using namespace utils;
 
@@ -279,6 +280,13 @@ namespace filetypes
         return contentdetails;
     }
 
+    void SIR0DerivHandler::ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt )
+    {
+        auto itfound = m_rules.find( cnt._rule_id_that_matched );
+        if( itfound != m_rules.end() && itfound->second->getContentType() == cnt._type )
+            itfound->second->ListSubContent( parameters, cnt, out_subcnt );
+    }
+
 
 //========================================================================================================
 //  sir0_rule
@@ -318,6 +326,11 @@ namespace filetypes
                                vector<uint8_t>::const_iterator   itdataend,
                                const std::string    & filext);
 
+        virtual std::vector<uint8_t> getMagicNumber()const;
+
+        //The sub-content is whatever the SIR0 derivative that matched lists.
+        virtual void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt );
+
     private:
         cntRID_t m_myID;
     };
@@ -384,6 +397,26 @@ namespace filetypes
         return ReadIntFromBytes<uint32_t>(itdatabeg,itdataend,false) == MagicNumber_SIR0;
     }
 
+    std::vector<uint8_t> sir0_rule::getMagicNumber()const
+    {
+        std::vector<uint8_t> magic;
+        WriteIntToBytes( MagicNumber_SIR0, std::back_inserter(magic), false );
+        return std::move(magic);
+    }
+
+    void sir0_rule::ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt )
+    {
+        if( cnt._type == CnTy_SIR0 )
+            return; //Plain SIR0 content, nothing to look into
+
+        //Same parameters as the derivatives got in Analyse
+        analysis_parameter paramtopass( parameters._itparentbeg,
+                                        parameters._itparentend, 
+                                        parameters._itparentbeg, 
+                                        parameters._itparentend );
+        SIR0DerivHandler::GetInstance().ListSubContent( paramtopass, cnt, out_subcnt );
+    }
+
 //========================================================================================================
 //  sir0_rule_rule_registrator
 //========================================================================================================
@@ -14,6 +14,7 @@ No crappyrights. All wrongs reversed !
 //#include <ppmdu/pmd2/pmd2_filetypes.hpp>
 #include <types/content_type_analyser.hpp>
 #include <utils/utility.hpp>
+#include <utils/byte_cursor.hpp>
 //#include <map>
 #include <deque>
 
@@ -50,28 +51,38 @@ namespace filetypes
             :magic(magicnumber), subheaderptr(subhdroffset), ptrPtrOffsetLst(offptrlst)
         {}
 
+        void Write( utils::ByteWriter & wr )const
+        {
+            wr.Require(HEADER_LEN);
+            wr.WriteUncheckedBE( MAGIC_NUMBER );  //Force this, to avoid bad surprises
+            wr.WriteUnchecked  ( subheaderptr );
+            wr.WriteUnchecked  ( ptrPtrOffsetLst );
+            wr.WriteUnchecked  ( uint32_t(0) );   //Force this, to avoid bad surprises
+        }
+
+        //Reading the magic number, and endzero value is solely for validating on read.
+        void Read( utils::ByteCursor & cur )
+        {
+            cur.Require(HEADER_LEN);
+            cur.ReadUncheckedBE( magic );
+            cur.ReadUnchecked  ( subheaderptr );
+            cur.ReadUnchecked  ( ptrPtrOffsetLst );
+            if( cur.ReadUnchecked<uint32_t>() != 0 )
+                throw std::logic_error("sir0_header::Read(): The ending zero dword for the header was not 0!!");
+        }
+
         //Implementations specific to sir0_header
         template<class _outit>
             _outit WriteToContainer( _outit itw )const    //! #TODO: Shorten name to "Write"
         {
-            itw = utils::WriteIntToBytes( MAGIC_NUMBER,    itw, false ); //Force this, to avoid bad surprises
-            itw = utils::WriteIntToBytes( subheaderptr,    itw );
-            itw = utils::WriteIntToBytes( ptrPtrOffsetLst, itw );
-            itw = utils::WriteIntToBytes( uint32_t(0),     itw ); //Force this, to avoid bad surprises
-            return itw;
+            return utils::WriteWithWriter<HEADER_LEN>( *this, itw );
         }
 
-        //Reading the magic number, and endzero value is solely for validating on read. iterator past the end is just to avoid catastrophic overflow.
+        //iterator past the end is just to avoid catastrophic overflow.
         template<class _init>
             _init ReadFromContainer( _init itr, _init itpastend ) //! #TODO: Shorten name to "Read"
         {
-            magic           = utils::ReadIntFromBytes<decltype(magic)>          (itr, itpastend, false ); //iterator is incremented
-            subheaderptr    = utils::ReadIntFromBytes<decltype(subheaderptr)>   (itr, itpastend ); //iterator is incremented
-            ptrPtrOffsetLst = utils::ReadIntFromBytes<decltype(ptrPtrOffsetLst)>(itr, itpastend ); //iterator is incremented
-            uint32_t endzero= utils::ReadIntFromBytes<decltype(endzero)>        (itr, itpastend ); //iterator is incremented
-            if(endzero != 0)
-                throw std::logic_error("sir0_header::Read(): The ending zero dword for the header was not 0!!");
-            return itr;
+            return utils::ReadWithCursor<HEADER_LEN>( *this, itr, itpastend );
         }
     };
 
@@ -338,6 +349,9 @@ namespace filetypes
 
         ContentBlock AnalyseContent( const analysis_parameter & parameters );
 
+        //Lets the rule that identified "cnt" list its sub-content. Does nothing if "cnt" wasn't identified by one of the rules here.
+        void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt );
+
     private:
         typedef std::map<cntRID_t,std::unique_ptr<IContentHandlingRule>> container_t;
         cntRID_t    m_currentRID;
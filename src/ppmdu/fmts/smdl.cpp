@@ -802,6 +802,13 @@ namespace DSE
                 return (utils::ReadIntFromBytes<uint32_t>(itdatabeg, itdataend, false) == DSE::SMDL_MagicNumber);
             }
 
+            virtual std::vector<uint8_t> getMagicNumber()const
+            {
+                std::vector<uint8_t> magic;
+                utils::WriteIntToBytes( DSE::SMDL_MagicNumber, std::back_inserter(magic), false );
+                return std::move(magic);
+            }
+
         private:
             cntRID_t m_myID;
         };
@@ -4,6 +4,7 @@
 #include <ppmdu/pmd2/pmd2_text.hpp>
 #include <utils/utility.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/trace.hpp>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -1514,6 +1515,7 @@ namespace filetypes
     */
     pmd2::Script ParseScript(const std::string & scriptfile, eGameRegion gloc, eGameVersion gvers, const LanguageFilesDB & langdat, bool escapeforxml, bool bscriptdebug )
     {
+        UTILS_TRACE_ZONE("SSB Parse");
         vector<uint8_t> fdata( std::move(utils::io::ReadFileToByteVector(scriptfile)) );
         eOpCodeVersion opvers = GameVersionToOpCodeVersion(gvers);
 
@@ -1534,6 +1536,7 @@ namespace filetypes
     */
     void WriteScript( const std::string & scriptfile, const pmd2::Script & scrdat, eGameRegion gloc, eGameVersion gvers, const LanguageFilesDB & langdata )
     {
+        UTILS_TRACE_ZONE("SSB Compile");
         eOpCodeVersion opvers = GameVersionToOpCodeVersion(gvers);
         if( opvers == eOpCodeVersion::Invalid )
             throw std::runtime_error("ParseScript(): Wrong game version!!");
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <iterator>
 using namespace std;
 
 namespace DSE
@@ -1202,8 +1203,7 @@ namespace DSE
             m_lfotbl   .resize(m_hdr.nblfos);
             m_splitstbl.resize(m_hdr.nbsplits);
 
-            for( auto & entry : m_lfotbl )
-                itReadfrom = entry.ReadFromContainer(itReadfrom, itpastend);
+            itReadfrom = utils::ReadArrayFromContainer( m_lfotbl, itReadfrom, itpastend );
 
             //16 bytes of padding
             itReadfrom = utils::advAsMuchAsPossible( itReadfrom, itpastend, 16 );
@@ -1704,8 +1704,7 @@ namespace DSE
                 itReadfrom = entry.ReadFromContainer(itReadfrom, itpastend);
 
             //Read lfo table
-            for( auto & entry : m_lfotbl )
-                itReadfrom = entry.ReadFromContainer(itReadfrom, itpastend);
+            itReadfrom = utils::ReadArrayFromContainer( m_lfotbl, itReadfrom, itpastend );
 
             //Read splits table
             for( auto & smpl : m_splitstbl )
@@ -2010,13 +2009,12 @@ namespace DSE
             vector<KeyGroup> keygroups(kgrphdr.datlen / KeyGroup::size());
             
             //Read all keygroups
-            for( auto & grp : keygroups )
-            {
-                itkgrp = grp.ReadFromContainer(itkgrp, m_itend);
+            itkgrp = utils::ReadArrayFromContainer( keygroups, itkgrp, m_itend );
 
-                if( utils::LibWide().isLogOn() && utils::LibWide().isVerboseOn() )
+            if( utils::LibWide().isLogOn() && utils::LibWide().isVerboseOn() )
+            {
+                for( const auto & grp : keygroups )
                     clog <<"Keygroup ID#" <<grp.id <<":\n" <<grp <<"\n";
-                
             }
 
             if( utils::LibWide().isLogOn() )
@@ -2900,6 +2898,13 @@ namespace DSE
                 return (utils::ReadIntFromBytes<uint32_t>(itdatabeg, itdataend, false) == DSE::SWDL_MagicNumber);
             }
 
+            virtual std::vector<uint8_t> getMagicNumber()const
+            {
+                std::vector<uint8_t> magic;
+                utils::WriteIntToBytes( DSE::SWDL_MagicNumber, std::back_inserter(magic), false );
+                return std::move(magic);
+            }
+
         private:
             cntRID_t m_myID;
         };
@@ -15,6 +15,7 @@ All wrongs reversed, no crappyrights :P
 #include <dse/dse_common.hpp>
 #include <dse/dse_containers.hpp>
 #include <utils/utility.hpp>
+#include <utils/byte_cursor.hpp>
 #include <cstdint>
 #include <vector>
 #include <array>
@@ -273,6 +274,7 @@ namespace DSE
     struct SWDL_Header_v415
     {
         static const uint32_t Size     = 80;
+        static const uint32_t FieldsLen= 78; //Nb of bytes read and written. The fields end 2 bytes before the end of the header.
         static const uint32_t FNameLen = 16;
 
         static const uint16_t DefVersion = SWDL_Version415;
@@ -316,75 +318,84 @@ namespace DSE
         uint16_t wavilen         = 0;
 
 
-        template<class _outit>
-            _outit WriteToContainer( _outit itwriteto )const
+        void Write( utils::ByteWriter & wr )const
         {
-            itwriteto = utils::WriteIntToBytes   ( SWDL_MagicNumber, itwriteto, false ); //Write constant magic number, to avoid bad surprises
-            itwriteto = utils::WriteIntToBytes   ( unk18,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( flen,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( version,          itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk1,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk2,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk3,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk4,             itwriteto );
-
-            itwriteto = utils::WriteIntToBytes   ( year,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( month,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( day,              itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( hour,             itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( minute,           itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( second,           itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( centisec,         itwriteto );
-
-            itwriteto = utils::WriteStrToByteContainer( itwriteto,   fname.data(), fname.size() );
+            wr.Require(FieldsLen);
+            wr.WriteUncheckedBE( SWDL_MagicNumber ); //Write constant magic number, to avoid bad surprises
+            wr.WriteUnchecked  ( unk18 );
+            wr.WriteUnchecked  ( flen );
+            wr.WriteUnchecked  ( version );
+            wr.WriteUnchecked  ( unk1 );
+            wr.WriteUnchecked  ( unk2 );
+            wr.WriteUnchecked  ( unk3 );
+            wr.WriteUnchecked  ( unk4 );
+
+            wr.WriteUnchecked  ( year );
+            wr.WriteUnchecked  ( month );
+            wr.WriteUnchecked  ( day );
+            wr.WriteUnchecked  ( hour );
+            wr.WriteUnchecked  ( minute );
+            wr.WriteUnchecked  ( second );
+            wr.WriteUnchecked  ( centisec );
+
+            wr.WriteBytesUnchecked( fname.data(), fname.size() );
+
+            wr.WriteUnchecked  ( unk10 );
+            wr.WriteUnchecked  ( unk11 );
+            wr.WriteUnchecked  ( unk12 );
+            wr.WriteUnchecked  ( unk13 );
+            wr.WriteUnchecked  ( pcmdlen );
+            wr.WriteUnchecked  ( unk14 );
+            wr.WriteUnchecked  ( nbwavislots );
+            wr.WriteUnchecked  ( nbprgislots );
+            wr.WriteUnchecked  ( unk17 );
+            wr.WriteUnchecked  ( wavilen );
+        }
 
-            itwriteto = utils::WriteIntToBytes   ( unk10,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk11,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk12,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk13,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( pcmdlen,          itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk14,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( nbwavislots,      itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( nbprgislots,      itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( unk17,            itwriteto );
-            itwriteto = utils::WriteIntToBytes   ( wavilen,          itwriteto );
-            return itwriteto;
+        void Read( utils::ByteCursor & cur )
+        {
+            cur.Require(FieldsLen);
+            cur.ReadUncheckedBE( magicn );
+            cur.ReadUnchecked  ( unk18 );
+            cur.ReadUnchecked  ( flen );
+            cur.ReadUnchecked  ( version );
+            cur.ReadUnchecked  ( unk1 );
+            cur.ReadUnchecked  ( unk2 );
+            cur.ReadUnchecked  ( unk3 );
+            cur.ReadUnchecked  ( unk4 );
+
+            cur.ReadUnchecked  ( year );
+            cur.ReadUnchecked  ( month );
+            cur.ReadUnchecked  ( day );
+            cur.ReadUnchecked  ( hour );
+            cur.ReadUnchecked  ( minute );
+            cur.ReadUnchecked  ( second );
+            cur.ReadUnchecked  ( centisec );
+
+            cur.ReadBytesUnchecked( fname.data(), FNameLen );
+
+            cur.ReadUnchecked  ( unk10 );
+            cur.ReadUnchecked  ( unk11 );
+            cur.ReadUnchecked  ( unk12 );
+            cur.ReadUnchecked  ( unk13 );
+            cur.ReadUnchecked  ( pcmdlen );
+            cur.ReadUnchecked  ( unk14 );
+            cur.ReadUnchecked  ( nbwavislots );
+            cur.ReadUnchecked  ( nbprgislots );
+            cur.ReadUnchecked  ( unk17 );
+            cur.ReadUnchecked  ( wavilen );
         }
 
+        template<class _outit>
+            _outit WriteToContainer( _outit itwriteto )const
+        {
+            return utils::WriteWithWriter<FieldsLen>( *this, itwriteto );
+        }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( magicn,       itReadfrom, itEnd, false ); //iterator is incremented
-            itReadfrom = utils::ReadIntFromBytes( unk18,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( flen,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( version,      itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk1,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk2,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk3,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk4,         itReadfrom, itEnd );
-
-            itReadfrom = utils::ReadIntFromBytes( year,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( month,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( day,          itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( hour,         itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( minute,       itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( second,       itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( centisec,     itReadfrom, itEnd );
-
-            itReadfrom  = utils::ReadStrFromByteContainer( itReadfrom, fname.data(), FNameLen );
-
-            itReadfrom = utils::ReadIntFromBytes( unk10,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk11,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk12,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk13,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( pcmdlen,      itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk14,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( nbwavislots,  itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( nbprgislots,  itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( unk17,        itReadfrom, itEnd );
-            itReadfrom = utils::ReadIntFromBytes( wavilen,      itReadfrom, itEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<FieldsLen>( *this, itReadfrom, itEnd );
         }
 
         //#DEPRECATED
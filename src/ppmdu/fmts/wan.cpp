@@ -5,6 +5,7 @@
 #include <utils/utility.hpp>
 #include <ppmdu/containers/index_iterator.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/trace.hpp>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
@@ -131,14 +132,14 @@ namespace filetypes
     /**************************************************************
     **************************************************************/
     WAN_Parser::WAN_Parser( std::vector<uint8_t> && rawdata, const animnamelst_t * animnames )
-        :m_rawdata(rawdata), m_pANameList(animnames), m_pProgress(nullptr)
+        :m_rawdata(rawdata), m_pANameList(animnames), m_pProgress(nullptr), m_bParallelImgs(false)
     {
     }
 
     /**************************************************************
     **************************************************************/
     WAN_Parser::WAN_Parser( const std::vector<uint8_t> &rawdata, const animnamelst_t * animnames )
-        :m_rawdata(rawdata), m_pANameList(animnames), m_pProgress(nullptr)
+        :m_rawdata(rawdata), m_pANameList(animnames), m_pProgress(nullptr), m_bParallelImgs(false)
     {
     }
 
@@ -166,6 +167,70 @@ namespace filetypes
             return eSpriteImgType::sprnoimg;
     }
 
+    /**************************************************************
+    **************************************************************/
+    uint32_t WAN_Parser::AssembleZeroStrippedImg( uint32_t tbloffset, std::vector<uint8_t> & out_bytes )const
+    {
+        UTILS_TRACE_ZONE("WAN Assemble Image");
+        const bool   blogon  = utils::LibWide().isLogOn();
+        const size_t filelen = m_rawdata.size();
+        uint32_t     zindex  = 0;
+        bool         bfirst  = true;
+        out_bytes.resize(0);
+
+        if( blogon )
+            clog << "Assembly Table:\n";
+
+        //Walk the table with a single cursor, instead of an iterator per entry
+        utils::ByteCursor cur( m_rawdata );
+        if( tbloffset <= filelen )
+            cur.Seek(tbloffset);
+
+        for(;;)
+        {
+            if( tbloffset > filelen || cur.Remaining() < ImgAsmTblEntry::LENGTH )
+            {
+                stringstream sstr;
+                sstr <<"WAN_Parser::AssembleZeroStrippedImg(): Assembly table at offset 0x" <<hex <<tbloffset <<dec <<" runs past the end of the file!";
+                throw runtime_error(sstr.str());
+            }
+
+            ImgAsmTblEntry entry;
+            ImgAsmTblEntry::layout_t::ReadUnchecked( cur, entry );
+            if( entry.isNull() )
+                break;
+
+            if( bfirst )
+            {
+                zindex = entry.zIndex;
+                bfirst = false;
+            }
+
+            if( blogon )
+            {
+                clog << "-> " <<setfill(' ') <<setw(6) <<entry.pixelsrc <<", " <<setw(4) 
+                     <<entry.pixamt <<", " <<setw(4) <<entry.unk14 <<", " <<setw(4) <<entry.zIndex <<"\n";
+            }
+
+            if( entry.pixelsrc == 0 )
+                out_bytes.resize( out_bytes.size() + entry.pixamt, 0 );
+            else
+            {
+                if( (static_cast<size_t>(entry.pixelsrc) + entry.pixamt) > filelen )
+                {
+                    stringstream sstr;
+                    sstr <<"WAN_Parser::AssembleZeroStrippedImg(): Strip at offset 0x" <<hex <<entry.pixelsrc <<dec <<" runs past the end of the file!";
+                    throw runtime_error(sstr.str());
+                }
+                out_bytes.insert( out_bytes.end(), m_rawdata.begin() + entry.pixelsrc, m_rawdata.begin() + (entry.pixelsrc + entry.pixamt) );
+            }
+        }
+
+        if( blogon )
+            clog << "\n";
+        return zindex;
+    }
+
     /**************************************************************
     **************************************************************/
     void WAN_Parser::DoParse( vector<gimg::colorRGB24>     & out_pal, 
@@ -176,6 +241,7 @@ namespace filetypes
                              vector<AnimationSequence>     & out_animseqs,
                              vector<sprOffParticle>        & out_offsets )
     {
+        UTILS_TRACE_ZONE("WAN Parse");
         ReadSir0Header();
         ReadWanHeader();
 
@@ -9,6 +9,8 @@ Description: Utilities for reading ".wan" sprite files, and its derivatives.
 #include <ppmdu/fmts/sir0.hpp>
 #include <types/content_type_analyser.hpp>
 #include <utils/utility.hpp>
+#include <utils/byte_cursor.hpp>
+#include <utils/struct_layout.hpp>
 #include <utils/handymath.hpp>
 #include <ppmdu/containers/sprite_data.hpp>
 #include <ppmdu/containers/sprite_io.hpp>
@@ -17,9 +19,11 @@ Description: Utilities for reading ".wan" sprite files, and its derivatives.
 #include <ppmdu/containers/tiled_image.hpp>
 #include <ppmdu/pmd2/pmd2_image_formats.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <utils/handymath.hpp>
 #include <atomic>
 #include <algorithm>
+#include <unordered_map>
 #include <type_traits>
 #include <iomanip>
 #include <functional>
@@ -57,24 +61,26 @@ namespace filetypes
         unsigned int    size()const   { return LENGTH; }
         bool            isNull()const { return (!pixelsrc && !pixamt && !zIndex); } //Whether its a null entry or not 
 
+        typedef utils::StructLayout<ImgAsmTblEntry,
+                                    UTILS_LAYOUT_FIELD(ImgAsmTblEntry, pixelsrc),
+                                    UTILS_LAYOUT_FIELD(ImgAsmTblEntry, pixamt),
+                                    UTILS_LAYOUT_FIELD(ImgAsmTblEntry, unk14),
+                                    UTILS_LAYOUT_FIELD(ImgAsmTblEntry, zIndex)> layout_t;
+        static_assert( layout_t::Size == LENGTH, "ImgAsmTblEntry: Layout doesn't match the entry's length!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( pixelsrc, itwriteto );
-            itwriteto = utils::WriteIntToBytes( pixamt,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk14,    itwriteto );
-            itwriteto = utils::WriteIntToBytes( zIndex,   itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<LENGTH>( *this, itwriteto );
         }
         
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            pixelsrc = utils::ReadIntFromBytes<decltype(pixelsrc)>(itReadfrom, itPastEnd);
-            pixamt   = utils::ReadIntFromBytes<decltype(pixamt)>  (itReadfrom, itPastEnd);
-            unk14    = utils::ReadIntFromBytes<decltype(unk14)>   (itReadfrom, itPastEnd);
-            zIndex   = utils::ReadIntFromBytes<decltype(zIndex)>  (itReadfrom, itPastEnd);
-            return itReadfrom;
+            return utils::ReadWithCursor<LENGTH>( *this, itReadfrom, itPastEnd );
         }
     };
 
@@ -93,14 +99,20 @@ namespace filetypes
         static const unsigned int DATA_LEN = 12u;
         unsigned int size()const{return DATA_LEN;}
 
+        typedef utils::StructLayout<wan_sub_header,
+                                    UTILS_LAYOUT_FIELD(wan_sub_header, ptr_animinfo),
+                                    UTILS_LAYOUT_FIELD(wan_sub_header, ptr_imginfo),
+                                    UTILS_LAYOUT_FIELD(wan_sub_header, spriteType),
+                                    UTILS_LAYOUT_FIELD(wan_sub_header, unk12)> layout_t;
+        static_assert( layout_t::Size == DATA_LEN, "wan_sub_header: Layout doesn't match the header's length!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outIt>
             _outIt WriteToContainer( _outIt itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( ptr_animinfo, itwriteto );
-            itwriteto = utils::WriteIntToBytes( ptr_imginfo,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( spriteType,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk12,        itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<DATA_LEN>( *this, itwriteto );
         }
 
         /*
@@ -130,11 +142,7 @@ namespace filetypes
         template<class _inIt>
             _inIt ReadFromContainer( _inIt itReadfrom, _inIt itEnd )
         {
-            ptr_animinfo = utils::ReadIntFromBytes<decltype(ptr_animinfo)>(itReadfrom, itEnd);
-            ptr_imginfo  = utils::ReadIntFromBytes<decltype(ptr_imginfo)> (itReadfrom, itEnd);
-            spriteType   = utils::ReadIntFromBytes<decltype(spriteType)>  (itReadfrom, itEnd);
-            unk12        = utils::ReadIntFromBytes<decltype(unk12)>       (itReadfrom, itEnd);
-            return itReadfrom;
+            return utils::ReadWithCursor<DATA_LEN>( *this, itReadfrom, itEnd );
         }
 
         void FillFromSprite( pmd2::graphics::BaseSprite * sprite )
@@ -477,6 +485,45 @@ namespace filetypes
         return std::move(asmtbl);
     }
 
+    /**********************************************************************
+        ---------------------------
+            UnpackTiledImgBytes
+        ---------------------------
+            Writes the bytes of an image, once its assembly table was 
+            applied, into a tiled image, one whole tile at a time.
+            The pixels end up in the same order "ParseZeroStrippedTImg" 
+            puts them in. Bytes past the end of the image are ignored.
+    **********************************************************************/
+    template<class _TIMG_t>
+        void UnpackTiledImgBytes( const std::vector<uint8_t> & imgbytes, _TIMG_t & out_img )
+    {
+        typedef typename _TIMG_t::tile_t tile_t;
+        const bool     is4bpp   = _TIMG_t::pixel_t::GetBitsPerPixel() == 4;
+        const size_t   nbpixels = std::min<size_t>( imgbytes.size() * (is4bpp? 2 : 1), out_img.getTotalNbPixels() );
+        const uint8_t *psrc     = imgbytes.data();
+
+        for( size_t pixbeg = 0, cnttile = 0; pixbeg < nbpixels; pixbeg += tile_t::NB_PIXELS, ++cnttile )
+        {
+            tile_t     & curtile   = out_img.getTile( static_cast<unsigned int>(cnttile) );
+            const size_t nbtilepix = std::min<size_t>( tile_t::NB_PIXELS, nbpixels - pixbeg );
+
+            if( is4bpp )
+            {
+                //Lowest nybble first
+                for( size_t cntpix = 0; cntpix < nbtilepix; ++cntpix )
+                {
+                    const size_t pixpos = pixbeg + cntpix;
+                    curtile[cntpix].pixeldata = ( (pixpos & 1) != 0 )? (psrc[pixpos >> 1] >> 4) : (psrc[pixpos >> 1] & 0x0F);
+                }
+            }
+            else
+            {
+                for( size_t cntpix = 0; cntpix < nbtilepix; ++cntpix )
+                    curtile[cntpix].pixeldata = psrc[pixbeg + cntpix];
+            }
+        }
+    }
+
     /**********************************************************************
         ----------------
             WAN_Parser
@@ -498,6 +545,10 @@ namespace filetypes
         //Use this to determine which parsing method to use!
         pmd2::graphics::eSpriteImgType getSpriteType()const;
 
+        //When set, the images of the sprite are decoded on several threads. Ignored while logging is on.
+        inline void SetParallelImageParsing( bool bparallel ) { m_bParallelImgs = bparallel; }
+        inline bool IsParallelImageParsing()const             { return m_bParallelImgs; }
+
         template<class TIMG_t>
             pmd2::graphics::SpriteData<TIMG_t> Parse( std::atomic<uint32_t> * pProgress = nullptr )
         {
@@ -569,71 +620,75 @@ namespace filetypes
                              std::vector<pmd2::graphics::ImageInfo>        & out_imginfo )
         {
             using namespace std;
-            vector<uint8_t>::const_iterator itfrmptr       = (m_rawdata.begin() + m_wanImgDataInfo.ptrImgsTbl); //Make iterator to frame pointer table
-            //uint32_t                        progressBefore = 0; 
-            //ensure capacity
-            out_imgs.resize( m_wanImgDataInfo.nbImgsTblPtr ); 
+            const size_t                    nbimgs   = m_wanImgDataInfo.nbImgsTblPtr;
+            const size_t                    infobeg  = out_imginfo.size();
+            vector<uint8_t>::const_iterator itfrmptr = (m_rawdata.begin() + m_wanImgDataInfo.ptrImgsTbl); //Make iterator to frame pointer table
+            vector<uint32_t>                imgptrs(nbimgs);
+            vector<int32_t>                 imgtometa(nbimgs, -1); //Index of the first meta-frame refering to each image, or -1
 
-            //Save a little snapshot of the progress this far
-            //if(m_pProgress != nullptr)
-            //    progressBefore = m_pProgress->load(); 
+            //ensure capacity
+            out_imgs.resize( nbimgs ); 
+            out_imginfo.resize( infobeg + nbimgs );
 
             //Read all ptrs in the raw data!
-            for( unsigned int i = 0; i < m_wanImgDataInfo.nbImgsTblPtr; ++i )
-            {
-                uint32_t ptrtoimg = utils::ReadIntFromBytes<uint32_t>( itfrmptr, static_cast<vector<uint8_t>::const_iterator>(m_rawdata.end()) ); //iter is incremented automatically
+            for( auto & ptrtoimg : imgptrs )
+                ptrtoimg = utils::ReadIntFromBytes<uint32_t>( itfrmptr, static_cast<vector<uint8_t>::const_iterator>(m_rawdata.end()) ); //iter is incremented automatically
 
-                if( utils::LibWide().isLogOn() )
-                    std::clog <<"== Frame #" <<i <<" ==\n";
-
-                ReadImage( m_rawdata.begin() + ptrtoimg, metafrms, metarefs, pal, out_imgs[i], i, out_imginfo );
-                
-                //if( m_pProgress != nullptr )
-                //    m_pProgress->store( progressBefore + ( (ProgressProp_Frames * (i+1)) / m_wanImgDataInfo.nbImgsTblPtr ) );
+            //Flatten the meta-frame references once, instead of looking them up for every images
+            for( const auto & ref : metarefs )
+            {
+                if( ref.first < nbimgs && imgtometa[ref.first] == -1 )
+                    imgtometa[ref.first] = static_cast<int32_t>(ref.second);
             }
-        }
-
-        template<class TIMG_t>
-            void ReadImage( std::vector<uint8_t>::iterator             itwhere, 
-                               const std::vector<pmd2::graphics::MetaFrame>  & metafrms,
-                               const std::multimap<uint32_t,uint32_t>  & metarefs,
-                               const std::vector<gimg::colorRGB24>     & pal,
-                               TIMG_t                                  & cur_img,
-                               uint32_t                                  curfrmindex,
-                               std::vector<pmd2::graphics::ImageInfo>        & out_imginfo )
-        {
-            auto              itfound    = metarefs.find( curfrmindex ); //Find if we have a meta-frame pointing to that frame
-            utils::Resolution myres      = RES_64x64_SPRITE;
-            uint32_t          totalbyamt = 0;
 
-            //Read the assembly table
-            auto asmtable = FillAsmTable( itwhere, m_rawdata.end() );
+            auto lambdaread = [&]( vector<uint8_t> & imgbytes, size_t cntimg )
+            {
+                ReadImage( imgptrs[cntimg], metafrms, imgtometa[cntimg], pal, out_imgs[cntimg], static_cast<uint32_t>(cntimg), out_imginfo[infobeg + cntimg], imgbytes );
+            };
 
-            //Log the asm table if logging is on
-            if( utils::LibWide().isLogOn() )
+            //The log is written one image at a time, so don't interleave images when its on
+            if( m_bParallelImgs && !utils::LibWide().isLogOn() )
+            {
+                utils::JobErrorList errors;
+                utils::RunIndexedJobs( nbimgs, vector<uint8_t>(), lambdaread, errors );
+                errors.ThrowIfAny("WAN_Parser::ReadImages()");
+            }
+            else
             {
-                std::clog << "Assembly Table:\n";
-                for( unsigned int i = 0; i < asmtable.size(); ++i )
+                vector<uint8_t> imgbytes;
+                for( size_t i = 0; i < nbimgs; ++i )
                 {
-                    std::clog << "-> " <<std::setfill(' ') <<std::setw(6) <<asmtable[i].pixelsrc <<", " <<std::setw(4) 
-                              <<asmtable[i].pixamt <<", " <<std::setw(4) <<asmtable[i].unk14 <<", " <<std::setw(4) <<asmtable[i].zIndex <<"\n";
+                    if( utils::LibWide().isLogOn() )
+                        std::clog <<"== Frame #" <<i <<" ==\n";
+                    lambdaread( imgbytes, i );
                 }
-                std::clog << "\n";
             }
+        }
 
-            //Count the total size of the resulting image
-            for( const auto & entry : asmtable )
-                totalbyamt += entry.pixamt;
+        /*
+            Reads a single image. "imgbytes" is a scratch buffer, reused between images.
+            "metafrmindex" is the index of the first meta-frame refering to the image, or -1 if there are none.
+        */
+        template<class TIMG_t>
+            void ReadImage( uint32_t                                        imgoffset, 
+                            const std::vector<pmd2::graphics::MetaFrame>  & metafrms,
+                            int32_t                                         metafrmindex,
+                            const std::vector<gimg::colorRGB24>           & pal,
+                            TIMG_t                                        & cur_img,
+                            uint32_t                                        curfrmindex,
+                            pmd2::graphics::ImageInfo                     & out_imginf,
+                            std::vector<uint8_t>                          & imgbytes )
+        {
+            utils::Resolution myres = RES_64x64_SPRITE;
 
-            //Keep track of the z index
-            ImageInfo imginf;
-            imginf.zindex = asmtable.front().zIndex;
-            out_imginfo.push_back(imginf);
+            //Put the strips back together, and keep track of the z index
+            out_imginf.zindex = AssembleZeroStrippedImg( imgoffset, imgbytes );
+            const uint32_t totalbyamt = static_cast<uint32_t>(imgbytes.size());
 
-            if( itfound != metarefs.end() )
+            if( metafrmindex >= 0 )
             {
                 //If we have a meta-frame for this image, take the resolution from it.
-                myres = MetaFrame::eResToResolution( metafrms[itfound->second].resolution );
+                myres = MetaFrame::eResToResolution( metafrms[metafrmindex].resolution );
             }
             else
             {
@@ -724,20 +779,20 @@ namespace filetypes
 
             //Parse the image with the best resolution we could find!
             cur_img.setPixelResolution( myres.width, myres.height );
-            gimg::PxlReadIter<TIMG_t> myPixelReader(cur_img); 
 
             //Build the image
-            uint32_t byteshandled = ParseZeroStrippedTImg<TIMG_t>(  itwhere, 
-                                                                    m_rawdata.begin(), 
-                                                                    m_rawdata.end(), 
-                                                                    myres,
-                                                                    myPixelReader );
+            UnpackTiledImgBytes( imgbytes, cur_img );
 
             //Copy the palette!
             cur_img.getPalette() = pal;
         }
 
 
+        /*
+            Applies the assembly table at "tbloffset" into "out_bytes", and returns the z index of the image.
+        */
+        uint32_t                                    AssembleZeroStrippedImg( uint32_t tbloffset, std::vector<uint8_t> & out_bytes )const;
+
         void                                        ReadSir0Header();
         void                                        ReadWanHeader();
         std::vector<gimg::colorRGB24>               ReadPalette();
@@ -785,6 +840,7 @@ namespace filetypes
         std::vector<uint8_t>   m_rawdata;
         const animnamelst_t   *m_pANameList; //List of names to give animation groups and its sequences! The first name in the sub-vector is the name of the group! The others are the names of the sequences for that group!
         std::atomic<uint32_t> *m_pProgress;
+        bool                   m_bParallelImgs;
 
         //static const unsigned int       ProgressProp_Frames     = 40; //% of the job
         //static const unsigned int       ProgressProp_MetaFrames = 20; //% of the job
@@ -809,6 +865,20 @@ namespace filetypes
         std::vector<uint8_t> write( std::atomic<uint32_t> * pProgress = nullptr );
         void                 write( const std::string     & outputpath, std::atomic<uint32_t> * pProgress = nullptr );
 
+        /*
+            Space saved by storing identical images and pixel strips only once, in the last file written.
+        */
+        struct dedupstats
+        {
+            uint32_t nbimgsreused   = 0; //Nb of images pointing to the assembly table of an identical image
+            uint32_t nbstripsreused = 0; //Nb of assembly table entries pointing to an identical pixel strip written earlier
+            uint32_t nbbytessaved   = 0; //Nb of bytes that didn't have to be written thanks to the above
+        };
+
+        //Whether identical images and pixel strips are written only once. On by default.
+        inline void               SetDeduplication( bool bdedup ) { m_bDedup = bdedup; }
+        inline const dedupstats & GetDedupStats()const            { return m_dedupstats; }
+
     private:
         /*
             Specialization of ImgAsmTblEntry to add an extra bool to make encoding easier !
@@ -952,6 +1022,22 @@ namespace filetypes
         std::vector<uint32_t>  m_CompImagesTblOffsets;    //The places where the zero-strip table for each compressed image is at
 
         std::vector<uint32_t>  m_ptrOffsetTblToEncode;      //List of all the pointers offsets in the resulting raw file !
+
+        //Deduplication
+        struct writtenimg_t
+        {
+            std::vector<uint8_t> pixels;
+            uint32_t             zindex;
+            bool                 bnostrip;   //Whether the image was written without stripping zeros, which gives a different assembly table
+            uint32_t             tbloffset;  //Offset of the image's assembly table
+            uint32_t             encodedlen; //Nb of bytes written for the image's strips and assembly table
+        };
+        typedef std::pair<uint32_t,uint32_t>                             stripref_t; //Offset and length of a strip in m_outBuffer
+        std::unordered_map<uint64_t, std::vector<stripref_t>> m_writtenStrips;  //Content hash -> non-zero pixel strips written so far
+        std::unordered_map<uint64_t, std::vector<size_t>>     m_writtenImgLUT;  //Content hash -> indices in m_writtenImgs
+        std::vector<writtenimg_t>                             m_writtenImgs;
+        dedupstats                                            m_dedupstats;
+        bool                                                  m_bDedup;
     };
 
 
@@ -11,6 +11,9 @@
 #include <string>
 #include <iostream>
 #include <Poco/Path.h>
+#include <utils/library_wide.hpp>
+#include <utils/trace.hpp>
+#include <utils/fnv_hash.hpp>
 using namespace std;
 using namespace pmd2::graphics;
 using namespace pmd2::filetypes;
@@ -25,14 +28,19 @@ namespace filetypes
     /**************************************************************
     **************************************************************/
     WAN_Writer::WAN_Writer( BaseSprite * pSprite )
-        :m_pSprite(pSprite), m_itbackins(m_outBuffer)
+        :m_pSprite(pSprite), m_itbackins(m_outBuffer), m_bDedup(true)
     {}
 
     std::vector<uint8_t> WAN_Writer::write( std::atomic<uint32_t> * pProgress )
     {
+        UTILS_TRACE_ZONE("WAN Write");
         //Don't forget to build the SIR0 pointer offset table !
         // We must gather the offset of ALL pointers!
         m_pProgress = pProgress;
+        m_dedupstats = dedupstats();
+        m_writtenStrips.clear();
+        m_writtenImgLUT.clear();
+        m_writtenImgs.clear();
 
         //Fill Structures
         FillFileInfoStructures(); //Fill up the structs
@@ -70,6 +78,12 @@ namespace filetypes
         WriteSIR0HeaderAndEncodedPtrList();
         WritePaddingBytes(16); //Add end of file padding bytes !
 
+        if( utils::LibWide().isLogOn() && m_bDedup )
+        {
+            clog << "WAN_Writer: Reused " <<m_dedupstats.nbimgsreused <<" identical images, and " <<m_dedupstats.nbstripsreused 
+                 <<" identical pixel strips. Saved " <<m_dedupstats.nbbytessaved <<" bytes.\n";
+        }
+
 
         vector<uint8_t> swaped;
         std::swap( swaped, m_outBuffer );//do this to avoid screwing up our internal state
@@ -414,7 +428,29 @@ namespace filetypes
     **************************************************************/
     void WAN_Writer::WriteACompressedFrm( const std::vector<uint8_t> & frm, uint32_t imgZIndex, bool dontStripZeros )
     {
-        uint32_t imgbegoffset = m_outBuffer.size(); //Keep the offset before to offset the entries in the assembly table !
+        UTILS_TRACE_ZONE("WAN Write Image");
+        uint32_t       imgbegoffset = m_outBuffer.size(); //Keep the offset before to offset the entries in the assembly table !
+        const uint64_t imghash      = utils::HashFNV1a( frm.data(), frm.size() );
+
+        //Identical images written the same way can share the same assembly table
+        if( m_bDedup )
+        {
+            auto itfound = m_writtenImgLUT.find(imghash);
+            if( itfound != m_writtenImgLUT.end() )
+            {
+                for( size_t imgindex : itfound->second )
+                {
+                    const writtenimg_t & other = m_writtenImgs[imgindex];
+                    if( other.zindex == imgZIndex && other.bnostrip == dontStripZeros && other.pixels == frm )
+                    {
+                        m_CompImagesTblOffsets.push_back( other.tbloffset );
+                        ++m_dedupstats.nbimgsreused;
+                        m_dedupstats.nbbytessaved += other.encodedlen;
+                        return;
+                    }
+                }
+            }
+        }
 
         vector<uint8_t>                 pixelstrips;
         vector<ImgAsmTbl_WithOpTy>      asmtable;
@@ -433,27 +469,72 @@ namespace filetypes
                 asmtable.push_back( MakeImgAsmTableEntry( itCurPos, itEnd, pixelstrips, totalbytecnt, imgZIndex ) );
         }
 
-        //Write pixel strips
-        std::copy( pixelstrips.begin(), pixelstrips.end(), m_itbackins );
+        //Write pixel strips, and point entries at an identical strip written earlier when there's one
+        for( auto & entry : asmtable )
+        {
+            if( entry.isZeroEntry )
+                continue;
+
+            const uint8_t * pstrip    = pixelstrips.data() + entry.pixelsrc;
+            const uint64_t  striphash = utils::HashFNV1a( pstrip, entry.pixamt );
+            bool            bfound    = false;
+
+            if( m_bDedup )
+            {
+                auto itfound = m_writtenStrips.find(striphash);
+                if( itfound != m_writtenStrips.end() )
+                {
+                    for( const auto & strip : itfound->second )
+                    {
+                        if( strip.second == entry.pixamt && std::equal( pstrip, pstrip + entry.pixamt, m_outBuffer.begin() + strip.first ) )
+                        {
+                            entry.pixelsrc = strip.first;
+                            bfound         = true;
+                            ++m_dedupstats.nbstripsreused;
+                            m_dedupstats.nbbytessaved += entry.pixamt;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if( !bfound )
+            {
+                entry.pixelsrc = m_outBuffer.size();
+                std::copy( pstrip, pstrip + entry.pixamt, m_itbackins );
+                if( m_bDedup )
+                    m_writtenStrips[striphash].push_back( stripref_t( entry.pixelsrc, entry.pixamt ) );
+            }
+        }
 
         //Save the offset of the upcoming assembly table
-        m_CompImagesTblOffsets.push_back( m_outBuffer.size() );
+        const uint32_t tbloffset = m_outBuffer.size();
+        m_CompImagesTblOffsets.push_back( tbloffset );
 
         //Write table
         for( auto & entry : asmtable )
         {
-            //Offset the pointers correctly + Register ptr if non-zero
+            //Register ptr if non-zero. The offset was set when writing the strips.
             if( !entry.isZeroEntry )
-            {
-                entry.pixelsrc += imgbegoffset;
                 m_ptrOffsetTblToEncode.push_back( m_outBuffer.size() );
-            }
             //Write entry
             entry.WriteToContainer( m_itbackins );
         }
 
         //Write a final null entry
         ImgAsmTbl_WithOpTy().WriteToContainer( m_itbackins );
+
+        if( m_bDedup )
+        {
+            writtenimg_t written;
+            written.pixels     = frm;
+            written.zindex     = imgZIndex;
+            written.bnostrip   = dontStripZeros;
+            written.tbloffset  = tbloffset;
+            written.encodedlen = m_outBuffer.size() - imgbegoffset;
+            m_writtenImgLUT[imghash].push_back( m_writtenImgs.size() );
+            m_writtenImgs.push_back( std::move(written) );
+        }
     }
 
 
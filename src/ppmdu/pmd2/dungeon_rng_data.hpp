@@ -7,6 +7,8 @@ psycommando@gmail.com
 Description: Utilities for handling and manipulating dungeon data used for generating dungeons floors in PMD2.
 */
 #include <ppmdu/pmd2/pmd2.hpp>
+#include <utils/byte_cursor.hpp>
+#include <utils/struct_layout.hpp>
 #include <vector>
 #include <deque>
 #include <string>
@@ -77,80 +79,55 @@ namespace pmd2
         uint8_t  unk19              = 0;
 
 
+        typedef utils::StructLayout<DungeonFloorDataEntry,
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, floorshape),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk4),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, tilesetid),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, musicid),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, defaultweather),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk5),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, pkmndensity),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, shopratio),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, mhouseratio),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk6),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk7),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk8),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk9),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk10),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk11),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, itemdensity),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, trapdensity),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, floorcnt),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk13),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk12),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, burieditemdensity),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, waterratio),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, darklvl),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, maxcoin),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk14),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk15),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk16),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk17),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, enemyiq),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk18),
+                                    UTILS_LAYOUT_FIELD(DungeonFloorDataEntry, unk19)> layout_t;
+        static_assert( layout_t::Size == SIZE, "DungeonFloorDataEntry: Layout doesn't match the entry's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         //Write the structure using an iterator to a byte container
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( floorshape,        itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk4,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( tilesetid,         itwriteto );
-            itwriteto = utils::WriteIntToBytes( musicid,           itwriteto );
-            itwriteto = utils::WriteIntToBytes( defaultweather,    itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk5,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( pkmndensity,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( shopratio,         itwriteto );
-            itwriteto = utils::WriteIntToBytes( mhouseratio,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk6,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk7,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk8,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk9,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk10,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk11,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( itemdensity,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( trapdensity,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( floorcnt,          itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk13,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk12,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( burieditemdensity, itwriteto );
-            itwriteto = utils::WriteIntToBytes( waterratio,        itwriteto );
-            itwriteto = utils::WriteIntToBytes( darklvl,           itwriteto );
-            itwriteto = utils::WriteIntToBytes( maxcoin,           itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk14,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk15,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk16,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk17,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( enemyiq,           itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk18,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unk19,             itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<SIZE>( *this, itwriteto );
         }
 
         //Read the structure from an iterator on a byte container
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itend )
         {
-            itReadfrom = utils::ReadIntFromBytes( floorshape,        itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk4,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( tilesetid,         itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( musicid,           itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( defaultweather,    itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk5,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( pkmndensity,       itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( shopratio,         itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( mhouseratio,       itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk6,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk7,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk8,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk9,              itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk10,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk11,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( itemdensity,       itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( trapdensity,       itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( floorcnt,          itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk13,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk12,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( burieditemdensity, itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( waterratio,        itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( darklvl,           itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( maxcoin,           itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk14,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk15,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk16,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk17,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( enemyiq,           itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk18,             itReadfrom, itend );
-            itReadfrom = utils::ReadIntFromBytes( unk19,             itReadfrom, itend );
-            return itReadfrom;
+            return utils::ReadWithCursor<SIZE>( *this, itReadfrom, itend );
         }
     };
 
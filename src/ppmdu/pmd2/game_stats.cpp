@@ -31,6 +31,7 @@ namespace pmd2
     const string GameStats::DefStrFExt    = ".txt";
     const string GameStats::DefItemsDir   = "item_data";
     const string GameStats::DefDungeonDir = "dungeon_data";
+    const string GameStats::DefStatsBinFile = "game_stats.bin";
 
 //==========================================================================================
 //  Utilities
@@ -652,6 +653,45 @@ namespace pmd2
         cout<<"-- Import complete! --\n";
     }
 
+    void GameStats::ExportAllBinary( const std::string & file )
+    {
+        if( m_pokemonStats.empty() && m_moveData1.empty() && m_itemsData.empty() )
+            throw runtime_error( "GameStats::ExportAllBinary(): No data to export!" );
+
+        _EnsureStringsLoaded();
+
+        statsbinrefs src;
+        src.ppkmn     = &m_pokemonStats;
+        src.pmoves1   = &m_moveData1;
+        src.pmoves2   = (m_gameVersion == eGameVersion::EoS)? &m_moveData2 : nullptr;
+        src.pitems    = &m_itemsData;
+        src.pgametext = m_gameStrings.get();
+
+        cout<<" <*>- Writing stats to binary file \"" <<file <<"\"..";
+        stats::ExportStatsToBin( file, src, m_gameVersion, m_gameRegion );
+        cout<<" Done!\n";
+    }
+
+    void GameStats::ImportAllBinary( const std::string & file )
+    {
+        //Need game strings loaded for this !
+        _EnsureStringsLoaded();
+
+        if( m_gameVersion == eGameVersion::Invalid )
+            throw runtime_error("GameStats::ImportAllBinary(): Game version is invalid, or could not be determined!");
+
+        statsbinrefs dest;
+        dest.ppkmn     = &m_pokemonStats;
+        dest.pmoves1   = &m_moveData1;
+        dest.pmoves2   = (m_gameVersion == eGameVersion::EoS)? &m_moveData2 : nullptr;
+        dest.pitems    = &m_itemsData;
+        dest.pgametext = m_gameStrings.get();
+
+        cout<<" <*>- Reading stats from binary file \"" <<file <<"\"..";
+        stats::ImportStatsFromBin( file, dest, m_gameVersion );
+        cout<<" Done!\n";
+    }
+
 //--------------------------------------------------------------
 //  Text Strings Access
 //--------------------------------------------------------------
@@ -16,6 +16,7 @@ All wrongs reversed, no crappyrights :P
 #include <ppmdu/containers/pokemon_stats.hpp>
 #include <ppmdu/containers/item_data.hpp>
 #include <ppmdu/containers/move_data.hpp>
+#include <ppmdu/containers/stats_bin_io.hpp>
 #include <ppmdu/pmd2/pmd2_text.hpp>
 #include <string>
 #include <vector>
@@ -79,6 +80,7 @@ namespace pmd2
         static const std::string DefStrFExt;            //The default file extension of the strings exported
         static const std::string DefItemsDir;           //The default dirname the item data will be exported into.
         static const std::string DefDungeonDir;         //The default dirname the dungeon data will be exported into.
+        static const std::string DefStatsBinFile;       //The default filename of the single file binary export.
 
         /*
             Pass the game language loader that contains all the known locale strings depending on the game's text_*.str file name.
@@ -154,6 +156,15 @@ namespace pmd2
         void ImportText ( const std::string & directory );
         void ImportItems( const std::string & directory );
 
+        //Binary Export/Import
+        /*
+            Export or import all the pokemon, moves and items data, along with their strings, 
+            to/from a single binary file. This is much faster than the XML, and is meant for 
+            exchanging data between tools. See stats_bin_io.hpp for the format.
+        */
+        void ExportAllBinary( const std::string & file );
+        void ImportAllBinary( const std::string & file );
+
         /*
             Analyze the current data folder to find out what game, and language it is, 
             and where are the correct strings located at.
@@ -0,0 +1,383 @@
+#include "pmd2_assetcatalog.hpp"
+#include <types/content_type_analyser.hpp>
+#include <utils/parallel_tasks.hpp>
+#include <utils/library_wide.hpp>
+#include <utils/gbyteutils.hpp>
+#include <utils/fnv_hash.hpp>
+#include <utils/gfileio.hpp>
+#include <utils/poco_wrapper.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <iterator>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <Poco/Path.h>
+#include <Poco/File.h>
+#include <Poco/DirectoryIterator.h>
+using namespace std;
+
+namespace pmd2
+{
+//======================================================================================
+//  Constants
+//======================================================================================
+    const std::string AssetCatalog::DefaultFileName = "ppmdu_assets.cat";
+
+    const std::string          CatalogDataDir  = "data";
+    const std::array<char,4>   CatalogMagic    {{ 'P', 'A', 'C', 'T' }};
+    const uint32_t             CatalogVersion  = 1;
+
+//======================================================================================
+//  Helpers
+//======================================================================================
+    //64 bits values are stored as two little endian 32 bits halves, low half first
+    template<class _init>
+        inline uint64_t ReadUInt64( _init & itread, _init itend )
+    {
+        const uint64_t lo = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+        const uint64_t hi = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+        return lo | (hi << 32);
+    }
+
+    template<class _outit>
+        inline _outit WriteUInt64( uint64_t val, _outit itw )
+    {
+        itw = utils::WriteIntToBytes( static_cast<uint32_t>(val & 0xFFFFFFFFULL), itw );
+        return utils::WriteIntToBytes( static_cast<uint32_t>(val >> 32), itw );
+    }
+
+    inline std::string LowerFileExt( const std::string & path )
+    {
+        std::string ext = Poco::Path(path).getExtension();
+        std::transform( ext.begin(), ext.end(), ext.begin(), []( char c ){ return static_cast<char>( std::tolower( static_cast<unsigned char>(c) ) ); } );
+        return ext;
+    }
+
+    inline std::string ContentTypeName( filetypes::cnt_t type, const std::string & deftype )
+    {
+        if( type != filetypes::CnTy_Invalid )
+        {
+            const filetypes::ContentTy * pcnt = filetypes::ContentIDManager::GetInstance().FindMatchingCnt(type);
+            if( pcnt != nullptr )
+                return pcnt->name();
+        }
+        return deftype;
+    }
+
+    /*
+        Turns a content tree into a flat list, in depth-first order.
+        "pdata" and "datalen" are the data of the parent the node's range refers to.
+    */
+    void FlattenContentTree( const filetypes::ContentTreeNode & node,
+                             const uint8_t                    * pdata,
+                             size_t                             datalen,
+                             uint32_t                           parent,
+                             const std::string                & deftype,
+                             std::vector<AssetContent>        & out_content )
+    {
+        AssetContent cnt;
+        cnt.parent = parent;
+        cnt.type   = ContentTypeName( node._content._type, deftype );
+        cnt.offset = static_cast<uint32_t>(node._startoffset);
+        cnt.length = static_cast<uint32_t>( (node._endoffset > node._startoffset)? node._endoffset - node._startoffset : 0 );
+
+        const uint8_t * pcnt   = nullptr;
+        size_t          cntlen = 0;
+        if( node._decoded )
+        {
+            pcnt           = node._decoded->data();
+            cntlen         = node._decoded->size();
+            cnt.decodedlen = static_cast<uint32_t>(cntlen);
+        }
+        else if( node._endoffset <= datalen )
+        {
+            pcnt   = pdata + node._startoffset;
+            cntlen = cnt.length;
+        }
+        cnt.hash = utils::HashFNV1a( pcnt, cntlen );
+
+        const uint32_t myindex = static_cast<uint32_t>(out_content.size());
+        out_content.push_back( std::move(cnt) );
+        for( const auto & sub : node._subcontent )
+            FlattenContentTree( sub, pcnt, cntlen, myindex, "", out_content );
+    }
+
+    struct fileonfs_t
+    {
+        std::string relpath;
+        std::string abspath;
+        int64_t     mtime;
+        uint64_t    size;
+    };
+
+    void ListFilesRecursive( const Poco::File & dir, const std::string & relpath, std::vector<fileonfs_t> & out_files )
+    {
+        for( Poco::DirectoryIterator itdir(dir), itend; itdir != itend; ++itdir )
+        {
+            const std::string currel = relpath + "/" + itdir.name();
+            if( itdir->isDirectory() )
+                ListFilesRecursive( *itdir, currel, out_files );
+            else if( itdir->isFile() )
+            {
+                fileonfs_t entry;
+                entry.relpath = currel;
+                entry.abspath = itdir->path();
+                entry.mtime   = itdir->getLastModified().epochMicroseconds();
+                entry.size    = itdir->getSize();
+                out_files.push_back( std::move(entry) );
+            }
+        }
+    }
+
+//======================================================================================
+//  AssetCatalog
+//======================================================================================
+    bool AssetCatalog::Load( const std::string & catalogpath )
+    {
+        if( !utils::isFile(catalogpath) )
+            return false;
+
+        vector<uint8_t> data;
+        utils::io::ReadFileToByteVector( catalogpath, data );
+        auto       itread = data.cbegin();
+        const auto itend  = data.cend();
+
+        if( data.size() < (CatalogMagic.size() + sizeof(uint32_t)) || !std::equal( CatalogMagic.begin(), CatalogMagic.end(), itread ) )
+            throw std::runtime_error("AssetCatalog::Load(): \"" + catalogpath + "\" is not an asset catalog file!");
+        std::advance( itread, CatalogMagic.size() );
+
+        const uint32_t version = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+        if( version != CatalogVersion )
+        {
+            stringstream sstr;
+            sstr <<"AssetCatalog::Load(): Unsupported catalog version " <<version <<" in \"" <<catalogpath <<"\"!";
+            throw std::runtime_error(sstr.str());
+        }
+
+        auto lambdareadstr = [&]( size_t len )->std::string
+        {
+            if( static_cast<size_t>( std::distance( itread, itend ) ) < len )
+                throw std::runtime_error("AssetCatalog::Load(): Unexpected end of file in \"" + catalogpath + "\"!");
+            std::string str( itread, itread + len );
+            std::advance( itread, len );
+            return std::move(str);
+        };
+
+        //Type name table
+        vector<std::string> types( utils::ReadIntFromBytes<uint16_t>( itread, itend ) );
+        for( auto & type : types )
+            type = lambdareadstr( utils::ReadIntFromBytes<uint8_t>( itread, itend ) );
+
+        //Files
+        std::map<std::string, AssetFile> files;
+        const uint32_t                   nbfiles = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+        for( uint32_t cntf = 0; cntf < nbfiles; ++cntf )
+        {
+            AssetFile af;
+            af.path  = lambdareadstr( utils::ReadIntFromBytes<uint16_t>( itread, itend ) );
+            af.mtime = static_cast<int64_t>( ReadUInt64( itread, itend ) );
+            af.size  = ReadUInt64( itread, itend );
+            af.hash  = ReadUInt64( itread, itend );
+            af.content.resize( utils::ReadIntFromBytes<uint32_t>( itread, itend ) );
+            for( auto & cnt : af.content )
+            {
+                cnt.parent = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+                const uint16_t typeidx = utils::ReadIntFromBytes<uint16_t>( itread, itend );
+                if( typeidx >= types.size() )
+                    throw std::runtime_error("AssetCatalog::Load(): Invalid content type index in \"" + catalogpath + "\"!");
+                cnt.type       = types[typeidx];
+                cnt.offset     = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+                cnt.length     = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+                cnt.decodedlen = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+                cnt.hash       = ReadUInt64( itread, itend );
+            }
+            const std::string path = af.path;
+            files.emplace( path, std::move(af) );
+        }
+
+        m_files = std::move(files);
+        return true;
+    }
+
+    void AssetCatalog::Write( const std::string & catalogpath )const
+    {
+        //Gather content type names, so each entry only stores an index
+        vector<std::string>                     types;
+        std::unordered_map<std::string,uint16_t> typeidx;
+        for( const auto & file : m_files )
+        {
+            for( const auto & cnt : file.second.content )
+            {
+                if( typeidx.emplace( cnt.type, static_cast<uint16_t>(types.size()) ).second )
+                    types.push_back( cnt.type );
+            }
+        }
+
+        vector<uint8_t> data;
+        auto            itw = std::back_inserter(data);
+        std::copy( CatalogMagic.begin(), CatalogMagic.end(), itw );
+        itw = utils::WriteIntToBytes( CatalogVersion, itw );
+
+        itw = utils::WriteIntToBytes( static_cast<uint16_t>(types.size()), itw );
+        for( const auto & type : types )
+        {
+            itw = utils::WriteIntToBytes( static_cast<uint8_t>(type.size()), itw );
+            std::copy( type.begin(), type.end(), itw );
+        }
+
+        itw = utils::WriteIntToBytes( static_cast<uint32_t>(m_files.size()), itw );
+        for( const auto & file : m_files )
+        {
+            const AssetFile & af = file.second;
+            itw = utils::WriteIntToBytes( static_cast<uint16_t>(af.path.size()), itw );
+            std::copy( af.path.begin(), af.path.end(), itw );
+            itw = WriteUInt64( static_cast<uint64_t>(af.mtime), itw );
+            itw = WriteUInt64( af.size, itw );
+            itw = WriteUInt64( af.hash, itw );
+            itw = utils::WriteIntToBytes( static_cast<uint32_t>(af.content.size()), itw );
+            for( const auto & cnt : af.content )
+            {
+                itw = utils::WriteIntToBytes( cnt.parent,            itw );
+                itw = utils::WriteIntToBytes( typeidx.at(cnt.type), itw );
+                itw = utils::WriteIntToBytes( cnt.offset,            itw );
+                itw = utils::WriteIntToBytes( cnt.length,            itw );
+                itw = utils::WriteIntToBytes( cnt.decodedlen,        itw );
+                itw = WriteUInt64( cnt.hash, itw );
+            }
+        }
+
+        utils::io::WriteByteVectorToFile( catalogpath, data );
+    }
+
+    AssetCatalog::updatestats AssetCatalog::Update( const std::string & romroot )
+    {
+        Poco::Path datadir = Poco::Path(romroot).makeAbsolute().makeDirectory();
+        datadir.pushDirectory(CatalogDataDir);
+        if( !utils::isFolder( datadir.toString() ) )
+            throw std::runtime_error("AssetCatalog::Update(): \"" + datadir.toString() + "\" doesn't exist, or isn't a directory!");
+
+        //1. List everything on disk
+        vector<fileonfs_t> onfs;
+        ListFilesRecursive( Poco::File(datadir), CatalogDataDir, onfs );
+
+        //2. Keep files that weren't modified, and pick those to read again
+        updatestats                      stats;
+        std::map<std::string, AssetFile> updated;
+        vector<const fileonfs_t*>        toread;
+        vector<const AssetFile*>         previous;
+        size_t                           nbfoundprev = 0;
+        for( const auto & fsentry : onfs )
+        {
+            auto itprev = m_files.find( fsentry.relpath );
+            if( itprev != m_files.end() )
+                ++nbfoundprev;
+
+            if( itprev != m_files.end() && itprev->second.size == fsentry.size && itprev->second.mtime == fsentry.mtime )
+            {
+                updated.emplace( fsentry.relpath, itprev->second );
+                ++stats.nbunchanged;
+            }
+            else
+            {
+                toread.push_back( &fsentry );
+                previous.push_back( (itprev != m_files.end())? &(itprev->second) : nullptr );
+            }
+        }
+        stats.nbremoved = static_cast<uint32_t>( m_files.size() - nbfoundprev );
+
+        //3. Read and analyse the rest. Each file is analysed by a single thread.
+        vector<AssetFile>        results( toread.size() );
+        vector<uint8_t>          banalysed( toread.size(), 0 );
+        utils::JobErrorList      errors;
+        utils::ProgressReporter  progress( "Indexing ROM files", static_cast<uint32_t>(toread.size()) );
+        progress.Start();
+        utils::RunIndexedJobs( toread.size(),
+                               vector<uint8_t>(),
+                               [&]( vector<uint8_t> & filedata, size_t cntf )
+                               {
+                                   const fileonfs_t & fsentry = *toread[cntf];
+                                   AssetFile        & result  = results[cntf];
+                                   utils::io::ReadFileToByteVector( fsentry.abspath, filedata );
+
+                                   const uint64_t hash = utils::HashFNV1a( filedata.data(), filedata.size() );
+                                   if( previous[cntf] != nullptr && previous[cntf]->hash == hash && previous[cntf]->size == filedata.size() )
+                                   {
+                                       result       = *previous[cntf];
+                                       result.mtime = fsentry.mtime;
+                                       return;
+                                   }
+
+                                   const std::string          filext = LowerFileExt( fsentry.relpath );
+                                   filetypes::ContentTreeNode tree;
+                                   try
+                                   {
+                                       tree = filetypes::DetermineCntTree( filedata, filext, false, true );
+                                   }
+                                   catch( const std::exception & e )
+                                   {
+                                       //Rules may choke on files too small for their headers. Keep the file as unidentified.
+                                       tree = filetypes::ContentTreeNode();
+                                       if( utils::LibWide().isLogOn() )
+                                           clog <<"AssetCatalog::Update(): Couldn't analyse \"" <<fsentry.relpath <<"\" : " <<e.what() <<"\n";
+                                   }
+                                   tree._startoffset = 0;
+                                   tree._endoffset   = filedata.size();
+
+                                   result.path  = fsentry.relpath;
+                                   result.mtime = fsentry.mtime;
+                                   result.size  = filedata.size();
+                                   result.hash  = hash;
+                                   FlattenContentTree( tree, filedata.data(), filedata.size(), AssetContent::NoParent, filext, result.content );
+                                   banalysed[cntf] = 1;
+                               },
+                               errors,
+                               &progress.Completed() );
+        progress.Stop();
+        errors.ThrowIfAny( "AssetCatalog::Update()" );
+
+        for( size_t cntf = 0; cntf < results.size(); ++cntf )
+        {
+            if( banalysed[cntf] != 0 )
+                ++stats.nbanalysed;
+            else
+                ++stats.nbtouched;
+            updated[toread[cntf]->relpath] = std::move(results[cntf]);
+        }
+
+        m_files       = std::move(updated);
+        stats.nbfiles = static_cast<uint32_t>(m_files.size());
+
+        if( utils::LibWide().isLogOn() )
+        {
+            clog <<"AssetCatalog::Update(): " <<stats.nbfiles <<" files, " <<stats.nbunchanged <<" unchanged, " <<stats.nbtouched
+                 <<" touched, " <<stats.nbanalysed <<" analysed, " <<stats.nbremoved <<" removed.\n";
+        }
+        return stats;
+    }
+
+    const AssetFile * AssetCatalog::Find( const std::string & relpath )const
+    {
+        auto itfound = m_files.find(relpath);
+        if( itfound != m_files.end() )
+            return &(itfound->second);
+        return nullptr;
+    }
+
+    std::vector<std::pair<const AssetFile*, size_t>> AssetCatalog::FindContentOfType( const std::string & type )const
+    {
+        std::vector<std::pair<const AssetFile*, size_t>> found;
+        for( const auto & file : m_files )
+        {
+            for( size_t cntc = 0; cntc < file.second.content.size(); ++cntc )
+            {
+                if( file.second.content[cntc].type == type )
+                    found.push_back( std::make_pair( &(file.second), cntc ) );
+            }
+        }
+        return std::move(found);
+    }
+
+};
@@ -0,0 +1,113 @@
+#ifndef PMD2_ASSET_CATALOG_HPP
+#define PMD2_ASSET_CATALOG_HPP
+/*
+pmd2_assetcatalog.hpp
+2016/10/26
+psycommando@gmail.com
+Description:
+    An index of every files in an extracted ROM's "data" directory, and of the content nested in them.
+    It's written to disk, and only the files that changed since the last run are analysed again when it's updated.
+*/
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace pmd2
+{
+//======================================================================================
+//  Structs
+//======================================================================================
+    /*
+        AssetContent
+            A piece of content, within a file or within another piece of content.
+    */
+    struct AssetContent
+    {
+        static const uint32_t NoParent = UINT32_MAX;
+
+        uint32_t    parent     = NoParent; //Index of the containing content within the file's content list. NoParent for the file itself.
+        std::string type;                  //Name of the content type. For files the analyser doesn't know, the file's extension.
+        uint32_t    offset     = 0;        //Position of the content within its parent's data.
+        uint32_t    length     = 0;        //Length of the content within its parent's data.
+        uint32_t    decodedlen = 0;        //For compressed content, the length of the decompressed data. 0 otherwise.
+        uint64_t    hash       = 0;        //Hash of the content's data. For compressed content, of the decompressed data.
+    };
+
+    /*
+        AssetFile
+            A file from the ROM, and the content found in it, in depth-first order.
+            The first content entry is always the file itself.
+    */
+    struct AssetFile
+    {
+        std::string               path;      //Relative to the ROM root, with '/' as separator.
+        int64_t                   mtime = 0; //Last modification time, in microseconds since epoch.
+        uint64_t                  size  = 0;
+        uint64_t                  hash  = 0;
+        std::vector<AssetContent> content;
+    };
+
+//======================================================================================
+//  AssetCatalog
+//======================================================================================
+    /*
+        AssetCatalog
+            Identifies every files of an extracted ROM's "data" directory with the content analyser, along with all
+            the content nested in them, like the sub-files of pack files, or the data inside compressed files.
+
+            The catalog is kept in a compact binary file. On update, files whose size and modification time didn't
+            change are kept as-is without being read. Files that were touched, but whose content hash didn't change,
+            only get their modification time updated. Everything else is analysed again, over the library-wide thread budget.
+    */
+    class AssetCatalog
+    {
+    public:
+        static const std::string DefaultFileName;
+
+        struct updatestats
+        {
+            uint32_t nbfiles     = 0; //Total nb of files in the catalog after the update
+            uint32_t nbunchanged = 0; //Files with the same size and modification time
+            uint32_t nbtouched   = 0; //Files that were read again, but whose content didn't change
+            uint32_t nbanalysed  = 0; //New or modified files that were analysed
+            uint32_t nbremoved   = 0; //Files that don't exist anymore
+        };
+
+        /*
+            Load
+                Reads a catalog file. Returns false if the file doesn't exist.
+                Throws if the file is not a valid catalog.
+        */
+        bool Load ( const std::string & catalogpath );
+        void Write( const std::string & catalogpath )const;
+
+        /*
+            Update
+                Walks the "data" directory of the ROM at "romroot", and brings the catalog up to date.
+        */
+        updatestats Update( const std::string & romroot );
+
+        /*
+            Find
+                Returns the file with the given path relative to the ROM root, or null if it isn't in the catalog.
+        */
+        const AssetFile * Find( const std::string & relpath )const;
+
+        /*
+            FindContentOfType
+                Returns every files containing content of the given type, with the index of each matching content entry.
+        */
+        std::vector<std::pair<const AssetFile*, size_t>> FindContentOfType( const std::string & type )const;
+
+        inline const std::map<std::string, AssetFile> & Files()const { return m_files; }
+        inline size_t                                   size ()const { return m_files.size(); }
+        inline bool                                     empty()const { return m_files.empty(); }
+
+    private:
+        std::map<std::string, AssetFile> m_files; //By relative path, so the catalog is written in a stable order
+    };
+
+};
+
+#endif
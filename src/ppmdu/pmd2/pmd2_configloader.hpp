@@ -769,6 +769,7 @@ namespace pmd2
         void ReloadConfig();
 
         inline const GameVersionInfo    & GetGameVersion         ()const {return m_versioninfo;}
+        inline const std::string        & GetConfigFilePath      ()const {return m_conffile;}
         inline const LanguageFilesDB    & GetLanguageFilesDB     ()const {return m_langdb;}
         inline const GameASMPatchData   & GetASMPatchData()const        {return m_asmpatchdata;}
         inline const std::string        & GetGameConstantAsString( eGameConstants gconst )const {return m_constants.GetConstAsString(gconst);}
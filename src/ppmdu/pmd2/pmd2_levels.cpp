@@ -6,6 +6,7 @@
 #include <ppmdu/fmts/bma.hpp>
 #include <ppmdu/fmts/bg_list_data.hpp>
 #include <ppmdu/containers/level_tileset.hpp>
+#include <utils/parallel_tasks.hpp>
 using namespace std;
 
 
@@ -71,20 +72,12 @@ namespace pmd2
             filetypes::lvlbglist_t bglist(filetypes::LoadLevelList( sstrbglist.str() ));
             cout <<"Loaded " <<filetypes::FName_BGListFile <<"file..\n";
 
-            //3. Iterate level list, export each levels matching the index of the name in the BG list
+            //3. Check the level list against the BG list, before starting any work
+            vector<const pmd2::level_info*> lvlstoexport;
+            lvlstoexport.reserve(lvlinf.size());
             for( const pmd2::level_info & lvl : lvlinf )
             {
-                if( lvl.mapid < bglist.size() )
-                {
-                    stringstream sstrtsetpath;
-                    sstrtsetpath << utils::TryAppendSlash(destdir) <<lvl.name;
-                    string tsetpath = sstrtsetpath.str();
-
-                    cout <<"\rExporting " <<left <<setw(10) <<setfill(' ') <<lvl.name <<"..";
-                    utils::DoCreateDirectory(tsetpath);
-                    ExportATileset( lvl, bglist[lvl.mapid], tsetpath );
-                }
-                else
+                if( lvl.mapid >= bglist.size() )
                 {
                     //The map id refers to a map out of bound!
                     stringstream sstrer;
@@ -93,8 +86,27 @@ namespace pmd2
                     assert(false);
                     throw std::runtime_error(sstrer.str());
                 }
+                lvlstoexport.push_back(&lvl);
             }
 
+            //4. Export each levels matching the index of the name in the BG list. Levels don't share anything, so run them in parallel.
+            utils::DoCreateDirectory(destdir);
+            const string             destprefix = utils::TryAppendSlash(destdir);
+            utils::JobErrorList      errors;
+            utils::ProgressReporter  progress( "Exporting tilesets", static_cast<uint32_t>(lvlstoexport.size()) );
+            progress.Start();
+            utils::RunIndexedJobs( lvlstoexport.size(), 
+                                   [&]( size_t cntlvl )
+                                   {
+                                       const pmd2::level_info & lvl      = *lvlstoexport[cntlvl];
+                                       const string             tsetpath = destprefix + lvl.name;
+                                       utils::DoCreateDirectory(tsetpath);
+                                       ExportATileset( lvl, bglist[lvl.mapid], tsetpath );
+                                   }, 
+                                   errors, 
+                                   &progress.Completed() );
+            progress.Stop();
+            errors.ThrowIfAny( "GameLevelsHandler::ExportTilesets()" );
         }
 
         void ExportATileset( const pmd2::level_info & lvlinf, const filetypes::LevelBgEntry & entry, const std::string & destdir )
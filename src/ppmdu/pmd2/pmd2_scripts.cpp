@@ -6,6 +6,8 @@
 #include <utils/poco_wrapper.hpp>
 #include <utils/utility.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/trace.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <Poco/Path.h>
 #include <Poco/File.h>
 #include <Poco/DirectoryIterator.h>
@@ -14,6 +16,7 @@
 #include <sstream>
 #include <iomanip>
 #include <functional>
+#include <limits>
 using namespace std;
 using utils::logutil::slog;
 
@@ -26,27 +29,162 @@ namespace pmd2
     //}
 
 //==============================================================================
-//  
+//  Script File Classification
 //==============================================================================
-    //Used to identify all the files of the script engine
-    const std::regex MatchScriptFileTypes( ".*\\.(("s + filetypes::SSS_FileExt + 
-                                           ")|("s + filetypes::SSA_FileExt + 
-                                           ")|("s + filetypes::SSE_FileExt + 
-                                           ")|("s + filetypes::SSB_FileExt + 
-                                           ")|("s + filetypes::LSD_FileExt + "))"s );
+    scriptfileinfo ClassifyScriptFile( const std::string & filename )
+    {
+        static const std::pair<const std::string*, eScriptFileType> KnownExts[] =
+        {
+            { &filetypes::SSB_FileExt, eScriptFileType::SSB },
+            { &filetypes::SSA_FileExt, eScriptFileType::SSA },
+            { &filetypes::SSS_FileExt, eScriptFileType::SSS },
+            { &filetypes::SSE_FileExt, eScriptFileType::SSE },
+            { &filetypes::LSD_FileExt, eScriptFileType::LSD },
+        };
+        scriptfileinfo info{ eScriptFileType::Invalid, std::string(), std::string(), -1 };
+
+        const size_t posdot = filename.find_last_of('.');
+        if( posdot == std::string::npos )
+            return info;
+
+        const size_t extlen = filename.size() - (posdot + 1);
+        for( const auto & ext : KnownExts )
+        {
+            if( ext.first->size() == extlen && filename.compare( posdot + 1, extlen, *ext.first ) == 0 )
+            {
+                info.type = ext.second;
+                break;
+            }
+        }
+        if( info.type == eScriptFileType::Invalid )
+            return info;
 
-    const std::string ScriptRegExNameNumSSBSuff = "(\\d\\d)\\."s + filetypes::SSB_FileExt;
+        info.basename.assign( filename, 0, posdot );
 
+        //Numbered ssbs are tied to the data file named like them, minus the 2 digits
+        if( info.type == eScriptFileType::SSB && posdot > 2 )
+        {
+            const char tens  = filename[posdot - 2];
+            const char units = filename[posdot - 1];
+            if( tens >= '0' && tens <= '9' && units >= '0' && units <= '9' )
+            {
+                info.numprefix.assign( filename, 0, posdot - 2 );
+                info.number = (tens - '0') * 10 + (units - '0');
+            }
+        }
+        return info;
+    }
 
+//==============================================================================
+//  LevelFileIndex
+//==============================================================================
     /*
-        isNumberedSSB
-            -subname  : base name. Aka the name of the data file tied to this. "m01a02" for example.
-            -filename : the filename to verify. "m01a0201.ssb" for example.
-    */ 
-    inline bool isNumberedSSB( std::string subname, const std::string & filename )
+        LevelFileIndex
+            Lists the script files of a single level directory once, and indexes them by file name, 
+            and by the data file numbered ssbs are tied to.
+            Files are "taken" as they're loaded, and whatever wasn't taken is reported as ignored.
+    */
+    class LevelFileIndex
     {
-        return std::regex_match(filename, std::regex(subname.append(ScriptRegExNameNumSSBSuff) ) );
-    }
+    public:
+        static const size_t npos = std::numeric_limits<size_t>::max();
+
+        struct entry_t
+        {
+            std::string    path;
+            std::string    fname;
+            scriptfileinfo info;
+            bool           btaken;
+        };
+
+        explicit LevelFileIndex( const Poco::Path & dir )
+        {
+            Poco::DirectoryIterator itdir(dir);
+            Poco::DirectoryIterator itdirend;
+            for( ; itdir != itdirend; ++itdir )
+            {
+                if( !itdir->isFile() || itdir->isHidden() )
+                    continue;
+                const std::string fname = itdir.path().getFileName();
+                scriptfileinfo    info  = ClassifyScriptFile(fname);
+                if( info.type == eScriptFileType::Invalid )
+                    continue;
+
+                const size_t index = m_entries.size();
+                m_byname.emplace( fname, index );
+                if( !info.numprefix.empty() )
+                    m_numbered[info.numprefix].push_back(index);
+                m_entries.push_back( entry_t{ itdir.path().toString(), fname, std::move(info), false } );
+            }
+        }
+
+        inline const entry_t & operator[]( size_t index )const { return m_entries[index]; }
+
+        /*
+            Returns the index of the file with this exact name, if it wasn't taken yet. Otherwise, npos.
+        */
+        size_t Find( const std::string & fname )const
+        {
+            auto itfound = m_byname.find(fname);
+            return ( itfound != m_byname.end() && !m_entries[itfound->second].btaken )? itfound->second : npos;
+        }
+
+        /*
+            Returns the index of the first file not taken yet, for which pred returns true. Otherwise, npos.
+        */
+        template<class _PredTy>
+            size_t FindFirst( _PredTy pred )const
+        {
+            for( size_t cnt = 0; cnt < m_entries.size(); ++cnt )
+            {
+                if( !m_entries[cnt].btaken && pred(m_entries[cnt]) )
+                    return cnt;
+            }
+            return npos;
+        }
+
+        /*
+            Marks the file as taken, and returns its path.
+        */
+        const std::string & Take( size_t index )
+        {
+            m_entries[index].btaken = true;
+            return m_entries[index].path;
+        }
+
+        /*
+            Takes all the numbered ssbs tied to "prefix" not taken yet, and returns their paths, in directory order.
+        */
+        std::vector<std::string> TakeNumberedSSBs( const std::string & prefix )
+        {
+            std::vector<std::string> paths;
+            auto itfound = m_numbered.find(prefix);
+            if( itfound == m_numbered.end() )
+                return paths;
+            for( size_t index : itfound->second )
+            {
+                if( !m_entries[index].btaken )
+                    paths.push_back( Take(index) );
+            }
+            return paths;
+        }
+
+        std::vector<std::string> ListNotTaken()const
+        {
+            std::vector<std::string> fnames;
+            for( const auto & entry : m_entries )
+            {
+                if( !entry.btaken )
+                    fnames.push_back(entry.fname);
+            }
+            return fnames;
+        }
+
+    private:
+        std::vector<entry_t>                                      m_entries;
+        std::unordered_map<std::string, size_t>                   m_byname;
+        std::unordered_map<std::string, std::vector<size_t>>      m_numbered;
+    };
 
 //==============================================================================
 //  GameScriptsHandler
@@ -90,14 +228,13 @@ namespace pmd2
         void      WriteDirectory(const LevelScript   & set, const std::string & path );
 
     private:
-        void LoadGrpEnter     ( std::deque<Poco::Path> & fqueue, LevelScript & out_scrset );
-        void LoadSub          ( const Poco::Path & datafpath, std::deque<Poco::Path> & fqueue, LevelScript & out_scrset );
-        void LoadGrpLSDContent( const Poco::Path & curdir, std::deque<Poco::Path> & fqueue, LevelScript & out_scrset );
+        void LoadGrpEnter     ( LevelFileIndex & files, LevelScript & out_scrset );
+        void LoadSub          ( size_t dataindex, LevelFileIndex & files, LevelScript & out_scrset );
+        void LoadGrpLSDContent( const Poco::Path & curdir, LevelFileIndex & files, LevelScript & out_scrset );
         void LoadLSD   ( LevelScript   & curset, const std::string & fpath );
         void LoadSSB   ( ScriptSet & tgtgrp, const std::string & fpath );
         void LoadSSData( ScriptSet & tgtgrp, const std::string & fpath );
-        void LoadScrDataAndMatchedNumberedSSBs( const std::string & prefix, const std::string & fext, eScriptSetType grpty, std::deque<Poco::Path> & fqueue, LevelScript & out_scrset  );
-        void LoadNumberedSSBForPrefix( std::deque<Poco::Path> & fqueue, const std::string & prefix, ScriptSet & tgtgrp );
+        void LoadNumberedSSBForPrefix( LevelFileIndex & files, const std::string & prefix, ScriptSet & tgtgrp );
 
         void WriteLSD   ( const LevelScript & curset, const std::string & fpath );
         void WriteGroups( const LevelScript & curset, const std::string & dirpath );
@@ -119,8 +256,7 @@ namespace pmd2
         try 
         {
             string basename = Poco::Path(fpath).getBaseName();
-            if(utils::LibWide().isLogOn())
-                slog() <<"\t*" <<basename <<".ssb\n";
+            UTILS_LOG_DEBUG("\t*{}.ssb\n", basename);
             auto script = std::move( filetypes::ParseScript(fpath, 
                                                             m_parent.Region(), 
                                                             m_parent.Version(), 
@@ -145,8 +281,7 @@ namespace pmd2
         {
             Poco::Path myp(fpath);
             string basename = myp.getBaseName();
-            if(utils::LibWide().isLogOn())
-                slog() <<"\t*" <<myp.getFileName() <<"\n";
+            UTILS_LOG_DEBUG("\t*{}\n", myp.getFileName());
             tgtgrp.SetData( std::forward<ScriptData>(filetypes::ParseScriptData(fpath)) );
         }
         catch(const std::exception &)
@@ -158,118 +293,40 @@ namespace pmd2
     }
 
 
-    void GameScriptsHandler::LoadNumberedSSBForPrefix( std::deque<Poco::Path> & fqueue, const std::string & prefix, ScriptSet & tgtgrp )
+    void GameScriptsHandler::LoadNumberedSSBForPrefix( LevelFileIndex & files, const std::string & prefix, ScriptSet & tgtgrp )
     {
-        auto itfound = fqueue.end();
-
-        do
-        {
-            itfound = std::find_if( fqueue.begin(), fqueue.end(), [&]( const Poco::Path & ap )->bool
-            {
-                return isNumberedSSB( prefix, ap.getFileName() );
-            } ); 
-
-            if( itfound != fqueue.end() )
-            {
-                string curbasename = itfound->toString();
-                LoadSSB( tgtgrp, curbasename );
-                fqueue.erase(itfound);
-                itfound = fqueue.begin(); //Re-assign here, because the iterator got invalidated
-            }
-
-        }while( itfound != fqueue.end() );
+        for( const auto & ssbpath : files.TakeNumberedSSBs(prefix) )
+            LoadSSB( tgtgrp, ssbpath );
     }
 
-
-
-
-    void GameScriptsHandler::LoadScrDataAndMatchedNumberedSSBs( const std::string      & prefix, 
-                                                                const std::string      & fext, 
-                                                                eScriptSetType         grpty, 
-                                                                std::deque<Poco::Path> & fqueue,
-                                                                LevelScript              & out_scrset )
+    void GameScriptsHandler::LoadGrpEnter( LevelFileIndex & files, LevelScript & out_scrset )
     {
-        auto itfounddata = fqueue.end();
-        //#1 - Find if we have a data file!
-
-        for( auto itqueue = fqueue.begin(); itqueue != fqueue.end(); ++itqueue )
+        const size_t indexenter = files.Find( ScriptPrefix_enter + "." + filetypes::SSE_FileExt );
+        if( indexenter != LevelFileIndex::npos )
         {
-            if( itqueue->getExtension() == fext && itqueue->getBaseName() == prefix )
-            {
-                itfounddata = itqueue; 
-                break;
-            }
-        }
-
-        //#2 - If we don't return early!
-        if( itfounddata == fqueue.end() )
-        {
-            if( utils::LibWide().isLogOn() )
-                slog() << "\tNo " <<prefix <<" data found!\n";
-            return;
-        }
-        else
-        {
-            if( utils::LibWide().isLogOn() )
-                slog() <<"\tLoading " <<prefix <<"." <<fext <<" and its dependencies..";
+            UTILS_LOG_DEBUG(" -- Parsing enter set.. --\n");
+            const string & basename = files[indexenter].info.basename;
+            ScriptSet grp( basename, eScriptSetType::UNK_enter );
+            UTILS_LOG_DEBUG(" ->Parsing \"Enter\" {}\n", files[indexenter].fname);
+            LoadSSData( grp, files.Take(indexenter) );
+            LoadNumberedSSBForPrefix( files, basename, grp );
+            out_scrset.Components().push_back(std::move(grp));
         }
-
-        //#3 - Otherwise keep going and load the data first ###
-        ScriptSet grp( prefix, grpty );
-        LoadSSData( grp, itfounddata->toString() );
-        fqueue.erase(itfounddata); //Remove it from the queue so we don't process it again
-
-        //#4 - Then load the matched ssb
-        LoadNumberedSSBForPrefix( fqueue, prefix, grp );
-
-        //#5 - Add the group to the set
-        out_scrset.Components().push_back(std::move(grp));
     }
 
-    void GameScriptsHandler::LoadGrpEnter(  std::deque<Poco::Path> & fqueue, LevelScript & out_scrset )
+    void GameScriptsHandler::LoadSub( size_t dataindex, LevelFileIndex & files, LevelScript & out_scrset )
     {
-        if( fqueue.empty() ) 
-            return;
-        
-        const static auto lambdafindsse = [](const Poco::Path & p)->bool{return p.getExtension() == filetypes::SSE_FileExt && p.getBaseName() == ScriptPrefix_enter;};
-        auto itcur         =  std::find_if( fqueue.begin(), fqueue.end(), lambdafindsse);
-        if(itcur != fqueue.end())
-        {
-            if(utils::LibWide().isLogOn())
-                slog() <<" -- Parsing enter set.. --\n";
-            //do
-            //{
-                Poco::Path p = *itcur;
-                fqueue.erase(itcur); //Delete here, because we invalidate the iterator in the LoadSub method
-
-                string basename( std::move(p.getBaseName()));
-                ScriptSet grp( basename, eScriptSetType::UNK_enter );
-                if(utils::LibWide().isLogOn())
-                    slog() <<" ->Parsing \"Enter\" " <<p.getFileName() <<"\n";
-                LoadSSData( grp, p.toString() );
-                LoadNumberedSSBForPrefix( fqueue, basename, grp );
-                out_scrset.Components().push_back(std::move(grp));
-            //}
-            //while( (itcur = std::find_if( fqueue.begin(), fqueue.end(), lambdafindsse)) != fqueue.end() );
-            /*LoadScrDataAndMatchedNumberedSSBs( ScriptPrefix_enter, filetypes::SSE_FileExt, eScriptSetType::UNK_enter, fqueue, out_scrset );*/
-        }
-    }
-
-    void GameScriptsHandler::LoadSub( const Poco::Path & datafpath, std::deque<Poco::Path> & fqueue, LevelScript & out_scrset )
-    {
-        string basename( std::move(datafpath.getBaseName()));
+        const string & basename = files[dataindex].info.basename;
         ScriptSet grp( basename, eScriptSetType::UNK_station );
-        if(utils::LibWide().isLogOn())
-            slog() <<" ->Parsing \"Station\" " <<datafpath.getFileName() <<"\n";
-        LoadSSData( grp, datafpath.toString() );
-        LoadNumberedSSBForPrefix( fqueue, basename, grp );
+        UTILS_LOG_DEBUG(" ->Parsing \"Station\" {}\n", files[dataindex].fname);
+        LoadSSData( grp, files.Take(dataindex) );
+        LoadNumberedSSBForPrefix( files, basename, grp );
         out_scrset.Components().push_back(std::move(grp));
     }
 
-    void GameScriptsHandler::LoadGrpLSDContent( const Poco::Path & curdir, std::deque<Poco::Path> & fqueue, LevelScript & out_scrset )
+    void GameScriptsHandler::LoadGrpLSDContent( const Poco::Path & curdir, LevelFileIndex & files, LevelScript & out_scrset )
     {
-        if(utils::LibWide().isLogOn())
-            slog() <<" -- Parsing references from the LSD.. --\n";
+        UTILS_LOG_DEBUG(" -- Parsing references from the LSD.. --\n");
         //Load files by name in the lsd table!
 
         for( const auto & afile : out_scrset.LSDTable() )
@@ -288,30 +345,21 @@ namespace pmd2
             ssbpath.append(fname).setExtension(filetypes::SSB_FileExt);
             ssapath.append(fname).setExtension(filetypes::SSA_FileExt);
 
-            //#2 - Pop those out of the queue + verify if they exist at the same time
-            auto itfoundssb = std::find_if( fqueue.begin(), fqueue.end(), [&ssbpath]( const Poco::Path & path )->bool
-            {
-                return (ssbpath.toString() == path.toString());
-            } );
-
-            if( itfoundssb != fqueue.end() )
-                fqueue.erase(itfoundssb);
+            //#2 - Take those from the index + verify if they exist at the same time
+            const size_t indexssb = files.Find( ssbpath.getFileName() );
+            if( indexssb != LevelFileIndex::npos )
+                files.Take(indexssb);
             else
                 slog()<< "GameScriptsHandler::LoadGrpLSDContent(): Expected SSB file named" << ssbpath.toString() << ", but couldn't find it.. Possibly a duplicate entry!\n";
 
-            auto itfoundssa = std::find_if( fqueue.begin(), fqueue.end(), [&ssapath]( const Poco::Path & path )->bool
-            {
-                return (ssapath.toString() == path.toString());
-            } );
-
-            if( itfoundssa != fqueue.end() )
-                fqueue.erase(itfoundssa);
+            const size_t indexssa = files.Find( ssapath.getFileName() );
+            if( indexssa != LevelFileIndex::npos )
+                files.Take(indexssa);
             else
                 slog()<<"GameScriptsHandler::LoadGrpLSDContent(): Expected SSA file named" << ssapath.toString() << ", but couldn't find it.. Possibly a duplicate entry!\n";
 
             //#3 - Handle the files
-            if(utils::LibWide().isLogOn())
-                slog() <<" ->Parsing \"Acting\" " <<ssapath.getFileName() <<"\n";
+            UTILS_LOG_DEBUG(" ->Parsing \"Acting\" {}\n", ssapath.getFileName());
             ScriptSet scrpair( string( std::begin(afile), std::end(afile) ), eScriptSetType::UNK_acting );
             LoadSSB   ( scrpair, ssbpath.toString() );
             LoadSSData( scrpair, ssapath.toString() );
@@ -325,93 +373,69 @@ namespace pmd2
 
     LevelScript GameScriptsHandler::LoadDirectory(const std::string & path)
     {
+        UTILS_TRACE_ZONE("Scripts Load Level");
         //m_escapeasxml = escapeasxml;
         using namespace Poco;
         Path curdir(path);
 
-        if( utils::LibWide().isLogOn() )
-            slog() << "#Loading Level Directory " <<curdir.getBaseName() <<"/\n";
+        UTILS_LOG_INFO("#Loading Level Directory {}/\n", curdir.getBaseName());
 
-        //#0 Fetch file list
-        DirectoryIterator  itdir(curdir);
-        DirectoryIterator  itdirend;
-        deque<Path>        processqueue;
-        LevelScript        curset(curdir.getBaseName());
-        
-
-        while( itdir != itdirend )
-        {
-            if(itdir->isFile() && !itdir->isHidden() && std::regex_match( itdir->path(), MatchScriptFileTypes ) )
-                processqueue.push_back(itdir.path());
-            ++itdir;
-        }
+        //#0 Index the directory's script files
+        LevelFileIndex files(curdir);
+        LevelScript    curset(curdir.getBaseName());
 
         //#1 Check for unionall.ssb
         {
-            auto itfoundunion= std::find_if( processqueue.begin(), processqueue.end(), [&](const Path & entry)->bool
+            const size_t indexunion = files.FindFirst( [](const LevelFileIndex::entry_t & entry)->bool
             {
-                return utils::CompareStrIgnoreCase(entry.getFileName(),  ScriptNames_unionall );
+                return utils::CompareStrIgnoreCase(entry.fname, ScriptNames_unionall);
             });
-            if( itfoundunion != processqueue.end() )
+            if( indexunion != LevelFileIndex::npos )
             {
-                if(utils::LibWide().isLogOn())
-                    slog() << " -- Parsing unionall.ssb.. --\n";
+                UTILS_LOG_DEBUG(" -- Parsing unionall.ssb.. --\n");
                 ScriptSet unionall( "unionall", eScriptSetType::UNK_unionall );
-                LoadSSB( unionall, itfoundunion->toString() );
+                LoadSSB( unionall, files.Take(indexunion) );
                 curset.Components().push_back( std::move(unionall) );
-                processqueue.erase(itfoundunion);
-                //slog() <<"\n";
             }
         }
 
         //#2 Load LSD, if its there
         {
-            auto itfoundlsd = std::find_if( processqueue.begin(), processqueue.end(), [&](const Path & entry)->bool
+            const size_t indexlsd = files.FindFirst( [](const LevelFileIndex::entry_t & entry)->bool
             {
-                return utils::CompareStrIgnoreCase(entry.getExtension(), filetypes::LSD_FileExt);
+                return entry.info.type == eScriptFileType::LSD;
             });
-            if( itfoundlsd != processqueue.end() )
-            {
-                //slog() <<" ->Parsing LSD file..\n";
-                LoadLSD(curset, itfoundlsd->toString());
-                processqueue.erase(itfoundlsd);
-                //slog() <<"\n";
-            }
+            if( indexlsd != LevelFileIndex::npos )
+                LoadLSD(curset, files.Take(indexlsd));
         }
 
         //#3 Check for enter.sse/enterXX.ssb
-        LoadGrpEnter( processqueue, curset );
+        LoadGrpEnter( files, curset );
 
         //#4 Load script files from LSD
         if( !curset.LSDTable().empty() )
-            LoadGrpLSDContent( curdir, processqueue, curset );
+            LoadGrpLSDContent( curdir, files, curset );
 
         //#5 Load the SSS subs
-        auto lambdafindsss = [](const Poco::Path & p)->bool{return p.getExtension() == filetypes::SSS_FileExt;};
-        auto itcur         = processqueue.begin();
-        while( (itcur = std::find_if( processqueue.begin(), processqueue.end(), lambdafindsss)) != processqueue.end() )
-        {
-            Poco::Path p = *itcur;
-            processqueue.erase(itcur); //Delete here, because we invalidate the iterator in the LoadSub method
-            LoadSub(p, processqueue, curset);
-        }
-
-        //#8 - List files remaining in the queue
-        if( !processqueue.empty() )
+        auto lambdafindsss = [](const LevelFileIndex::entry_t & entry)->bool{ return entry.info.type == eScriptFileType::SSS; };
+        size_t indexsss = LevelFileIndex::npos;
+        while( (indexsss = files.FindFirst(lambdafindsss)) != LevelFileIndex::npos )
+            LoadSub(indexsss, files, curset);
+
+        //#8 - List files that weren't loaded
+        const vector<string> ignored = files.ListNotTaken();
+        if( !ignored.empty() )
         {
-            slog() <<" ->" <<processqueue.size() <<" files were ignored:\n";
-                 
-            while( !processqueue.empty() )
-            {
-                slog() <<"\t" <<processqueue.front().getFileName() <<"\n";
-                processqueue.pop_front();
-            }
+            slog() <<" ->" <<ignored.size() <<" files were ignored:\n";
+            for( const auto & fname : ignored )
+                slog() <<"\t" <<fname <<"\n";
         }
         return std::move(curset);
     }
 
     void GameScriptsHandler::WriteDirectory(const LevelScript & set, const std::string & path)
     {
+        UTILS_TRACE_ZONE("Scripts Write Level");
         //Create it first if needed
         Poco::File tgtdir(path);
         if( !tgtdir.exists() )
@@ -419,8 +443,7 @@ namespace pmd2
         else if( tgtdir.exists() && !tgtdir.isDirectory() )
             throw std::runtime_error("GameScriptsHandler::WriteDirectory(): Output dir exist already as a file! Can't overwrite with a directory!");
 
-        if( utils::LibWide().isLogOn() )
-            slog() << "#Writing Level Directory " <<utils::GetBaseNameOnly(path) <<"/\n";
+        UTILS_LOG_INFO("#Writing Level Directory {}/\n", utils::GetBaseNameOnly(path));
 
         //Write LSD table if needed
         Poco::Path lsdpath(path);
@@ -441,42 +464,55 @@ namespace pmd2
     {
         if( ! set.LSDTable().empty() )
         {
-            if( utils::LibWide().isLogOn() )
-                slog()<<" ->Writing LSD file...\n";
+            UTILS_LOG_DEBUG(" ->Writing LSD file...\n");
             filetypes::WriteLSD( set.LSDTable(), fpath );
         }
     }
 
     void GameScriptsHandler::WriteGroups(const LevelScript & lvlscr, const std::string & dirpath)
     {
-        if( utils::LibWide().isLogOn() )
-            slog() << " ->Writing " <<lvlscr.Components().size() <<" script set(s) to " <<Poco::Path(dirpath).getBaseName() <<"/\n";
+        UTILS_LOG_DEBUG(" ->Writing {} script set(s) to {}/\n", lvlscr.Components().size(), Poco::Path(dirpath).getBaseName());
 
+        //Each data file and each SSB is compiled and written on its own, so they're queued up and written in parallel
+        vector<std::function<void()>> jobs;
         for( const auto & set : lvlscr ) 
         {
-            if( utils::LibWide().isLogOn() )
-                slog() << "\t\t*" <<set.Identifier() <<"...\n";
+            UTILS_LOG_DEBUG("\t\t*{}...\n", set.Identifier());
 
             //Write data file
             if( set.Data() )
             {
-                filetypes::WriteScriptData( Poco::Path(dirpath).append(set.Data()->Name()).makeFile().setExtension(set.GetDataFext()).toString(),
-                                            *set.Data() );
+                const ScriptData * pdata = set.Data();
+                string             fpath = Poco::Path(dirpath).append(pdata->Name()).makeFile().setExtension(set.GetDataFext()).toString();
+                jobs.push_back( [pdata, fpath]()
+                {
+                    filetypes::WriteScriptData( fpath, *pdata );
+                });
             }
 
             //Write SSBs
             for( const auto & seq : set.Sequences() )
             {
-                filetypes::WriteScript( Poco::Path(dirpath).append(seq.first).makeFile().setExtension(filetypes::SSB_FileExt).toString(), 
-                                        seq.second,
-                                        m_parent.Region(), 
-                                        m_parent.Version(),
-                                        m_parent.GetConfig().GetLanguageFilesDB() );
+                const Script * pscript = &seq.second;
+                string         fpath   = Poco::Path(dirpath).append(seq.first).makeFile().setExtension(filetypes::SSB_FileExt).toString();
+                jobs.push_back( [this, pscript, fpath]()
+                {
+                    UTILS_TRACE_ZONE("Scripts Compile SSB");
+                    filetypes::WriteScript( fpath, 
+                                            *pscript,
+                                            m_parent.Region(), 
+                                            m_parent.Version(),
+                                            m_parent.GetConfig().GetLanguageFilesDB() );
+                });
             }
-            
-            //if( utils::LibWide().isLogOn() )
-            //    slog() <<"\n";
         }
+
+        utils::JobErrorList errors;
+        utils::RunIndexedJobs( jobs.size(), [&]( size_t cntjob )
+        {
+            jobs[cntjob]();
+        }, errors );
+        errors.ThrowIfAny( "GameScriptsHandler::WriteGroups()" );
     }
 
 
@@ -539,11 +575,13 @@ namespace pmd2
 
     void GameScripts::ImportXML(const std::string & dir)
     {
+        UTILS_TRACE_ZONE("Scripts Import XML");
         ImportXMLGameScripts(dir,*this, m_options);
     }
 
     void GameScripts::ExportXML(const std::string & dir)
     {
+        UTILS_TRACE_ZONE("Scripts Export XML");
         ExportGameScriptsXML(dir,*this, m_options); //We don't want pugixml to escape characters if we already did!!
     }
 
@@ -589,7 +627,10 @@ namespace pmd2
     {
         const string tgtdir = Poco::Path(m_scriptdir).append(set.Name()).toString();
         if( set.Name() != DirNameScriptCommon )
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
             m_setsindex.insert_or_assign(set.Name(), std::forward<ScrSetLoader>(ScrSetLoader(*this, tgtdir)) ); //Add to index if doesn't exists
+        }
         m_pHandler->WriteDirectory(set, tgtdir);
     }
 
@@ -64,10 +64,33 @@ namespace pmd2
     const std::string ScriptPrefix_V = ResourcePrefix_V;   //Visual?
 
     /*
-        MatchingRegexes
+        Script File Classification
     */
-    extern const std::regex MatchScriptFileTypes;       //Matches all ssa,ssb,sss, and lsd files
-    extern const std::string ScriptRegExNameNumSSBSuff; //Regex to suffix to the basename to get the pattern for the numbered SSBs
+    enum struct eScriptFileType : uint8_t
+    {
+        Invalid,    //Not a file used by the script engine
+        SSS,
+        SSA,
+        SSE,
+        SSB,
+        LSD,
+    };
+
+    struct scriptfileinfo
+    {
+        eScriptFileType type;
+        std::string     basename;   //The file name without its extension
+        std::string     numprefix;  //For ssb files whose base name ends with 2 digits, the base name without them. Empty otherwise.
+        int             number;     //The value of those 2 digits, or -1
+    };
+
+    /*
+        ClassifyScriptFile
+            Figures out the type of a script engine file, and the parts of its name that tie it to other files,
+            in a single pass over the file name. "m01a0201.ssb" gives a SSB, numbered 1, and tied to "m01a02".
+            The type is Invalid for anything else than ssa, sse, sss, ssb and lsd files.
+    */
+    scriptfileinfo ClassifyScriptFile( const std::string & filename );
 
     /*
         scriptprocoptions
@@ -80,8 +103,9 @@ namespace pmd2
         bool bmarkoffsets;      //Whether the offsets of each instructions should be marked by comments
         bool bscriptdebug;      //Whether the debug_branch instructions should be tweaked to work as if debug mode was on
         bool basdir;            //Whether the scripts' XML data is exported/imported to/from a directory containing sub-files if true, or a single XML file if false.
+        bool bincremental;      //Whether levels whose files didn't change since the last export/import are skipped. (See pmd2_scripts_manifest.hpp)
     };
-    const scriptprocoptions DefConfigOptions{true, true, false, false, false};
+    const scriptprocoptions DefConfigOptions{true, true, false, false, false, false};
 
 //==========================================================================================================
 //  Script Manager/Loader
@@ -156,7 +180,7 @@ namespace pmd2
         //eGameRegion                                  m_scrRegion;
         //eGameVersion                                 m_gameVersion;
         std::unique_ptr<GameScriptsHandler>          m_pHandler;
-        //std::mutex                                   m_mutex;
+        std::mutex                                   m_mutex;            //Guards m_setsindex when levels are written in parallel
         //const LanguageFilesDB                      * m_langdat;
         scriptprocoptions                            m_options;
         //bool                                         m_escapexml;
@@ -0,0 +1,185 @@
+#include "pmd2_scripts_manifest.hpp"
+#include <ppmdu/pmd2/pmd2_scripts.hpp>
+#include <utils/gbyteutils.hpp>
+#include <utils/fnv_hash.hpp>
+#include <utils/gfileio.hpp>
+#include <utils/poco_wrapper.hpp>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <Poco/Path.h>
+#include <Poco/File.h>
+#include <Poco/DirectoryIterator.h>
+using namespace std;
+
+namespace pmd2
+{
+//======================================================================================
+//  Constants
+//======================================================================================
+    const std::string ScriptBuildManifest::ExportFileName = "ppmdu_scripts_export.manifest";
+    const std::string ScriptBuildManifest::ImportFileName = "ppmdu_scripts_import.manifest";
+
+    const std::array<char,4> ManifestMagic   {{ 'P', 'S', 'M', 'F' }};
+    const uint32_t           ManifestVersion = 1;
+
+//======================================================================================
+//  Helpers
+//======================================================================================
+    namespace
+    {
+        //64 bits values are stored as two little endian 32 bits halves, low half first
+        template<class _init>
+            inline uint64_t ReadUInt64( _init & itread, _init itend )
+        {
+            const uint64_t lo = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+            const uint64_t hi = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+            return lo | (hi << 32);
+        }
+
+        template<class _outit>
+            inline _outit WriteUInt64( uint64_t val, _outit itw )
+        {
+            itw = utils::WriteIntToBytes( static_cast<uint32_t>(val & 0xFFFFFFFFULL), itw );
+            return utils::WriteIntToBytes( static_cast<uint32_t>(val >> 32), itw );
+        }
+
+        inline uint64_t HashAFile( const std::string & path, const std::string & fname, uint64_t seed, std::vector<uint8_t> & buffer )
+        {
+            utils::io::ReadFileToByteVector( path, buffer );
+            return HashLevelFileData( fname, buffer.data(), buffer.size(), seed );
+        }
+    };
+
+//======================================================================================
+//  Hashing
+//======================================================================================
+    uint64_t HashLevelFileData( const std::string & fname, const void * pdata, size_t len, uint64_t seed )
+    {
+        //Hash the length and name too, so renaming or moving bytes between files changes the hash
+        const uint64_t len64 = len;
+        seed = utils::HashFNV1a( fname.data(), fname.size(), seed );
+        seed = utils::HashFNV1a( &len64, sizeof(len64), seed );
+        return utils::HashFNV1a( pdata, len, seed );
+    }
+
+    uint64_t HashLevelFiles( const std::string & path, bool bscriptfilesonly )
+    {
+        Poco::File target(path);
+        if( !target.exists() )
+            return 0;
+
+        vector<uint8_t> buffer;
+        if( target.isFile() )
+            return HashAFile( path, Poco::Path(path).getFileName(), utils::FNV1aOffsetBasis, buffer );
+
+        //Directories are hashed in name order, since the iteration order isn't the same on every filesystem
+        vector<pair<string,string>> files; //name, path
+        Poco::DirectoryIterator     itdir(target);
+        Poco::DirectoryIterator     itdirend;
+        for( ; itdir != itdirend; ++itdir )
+        {
+            if( !itdir->isFile() || itdir->isHidden() )
+                continue;
+            string fname = itdir.path().getFileName();
+            if( bscriptfilesonly && ClassifyScriptFile(fname).type == eScriptFileType::Invalid )
+                continue;
+            files.push_back( make_pair( std::move(fname), itdir.path().toString() ) );
+        }
+        std::sort( files.begin(), files.end() );
+
+        uint64_t hash = utils::FNV1aOffsetBasis;
+        for( const auto & file : files )
+            hash = HashAFile( file.second, file.first, hash, buffer );
+        return hash;
+    }
+
+//======================================================================================
+//  ScriptBuildManifest
+//======================================================================================
+    ScriptBuildManifest::ScriptBuildManifest( uint64_t settingshash )
+        :m_settingshash(settingshash)
+    {}
+
+    bool ScriptBuildManifest::Load( const std::string & path )
+    {
+        if( !utils::isFile(path) )
+            return false;
+
+        vector<uint8_t> data;
+        utils::io::ReadFileToByteVector( path, data );
+        auto       itread = data.cbegin();
+        const auto itend  = data.cend();
+
+        if( data.size() < (ManifestMagic.size() + sizeof(uint32_t)) || !std::equal( ManifestMagic.begin(), ManifestMagic.end(), itread ) )
+            throw std::runtime_error("ScriptBuildManifest::Load(): \"" + path + "\" is not a script manifest file!");
+        std::advance( itread, ManifestMagic.size() );
+
+        //An older format, or other settings, just means everything has to be processed again
+        if( utils::ReadIntFromBytes<uint32_t>( itread, itend ) != ManifestVersion )
+            return false;
+        if( ReadUInt64( itread, itend ) != m_settingshash )
+            return false;
+
+        std::map<std::string, levelentry_t> levels;
+        const uint32_t nblevels = utils::ReadIntFromBytes<uint32_t>( itread, itend );
+        for( uint32_t cntlvl = 0; cntlvl < nblevels; ++cntlvl )
+        {
+            const uint16_t namelen = utils::ReadIntFromBytes<uint16_t>( itread, itend );
+            if( static_cast<size_t>( std::distance( itread, itend ) ) < namelen )
+                throw std::runtime_error("ScriptBuildManifest::Load(): Unexpected end of file in \"" + path + "\"!");
+            string name( itread, itread + namelen );
+            std::advance( itread, namelen );
+
+            levelentry_t entry;
+            entry.inputhash  = ReadUInt64( itread, itend );
+            entry.outputhash = ReadUInt64( itread, itend );
+            levels.emplace( std::move(name), entry );
+        }
+
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_levels = std::move(levels);
+        return true;
+    }
+
+    void ScriptBuildManifest::Write( const std::string & path )const
+    {
+        vector<uint8_t> data;
+        auto            itw = std::back_inserter(data);
+        std::copy( ManifestMagic.begin(), ManifestMagic.end(), itw );
+        itw = utils::WriteIntToBytes( ManifestVersion, itw );
+        itw = WriteUInt64( m_settingshash, itw );
+
+        {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            itw = utils::WriteIntToBytes( static_cast<uint32_t>(m_levels.size()), itw );
+            for( const auto & level : m_levels )
+            {
+                itw = utils::WriteIntToBytes( static_cast<uint16_t>(level.first.size()), itw );
+                std::copy( level.first.begin(), level.first.end(), itw );
+                itw = WriteUInt64( level.second.inputhash,  itw );
+                itw = WriteUInt64( level.second.outputhash, itw );
+            }
+        }
+        utils::io::WriteByteVectorToFile( path, data );
+    }
+
+    bool ScriptBuildManifest::IsUpToDate( const std::string & level, uint64_t inputhash, uint64_t outputhash )const
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        auto itfound = m_levels.find(level);
+        return itfound != m_levels.end() &&
+               itfound->second.inputhash  == inputhash &&
+               itfound->second.outputhash == outputhash &&
+               outputhash != 0;
+    }
+
+    void ScriptBuildManifest::Set( const std::string & level, uint64_t inputhash, uint64_t outputhash )
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_levels[level] = levelentry_t{ inputhash, outputhash };
+    }
+};
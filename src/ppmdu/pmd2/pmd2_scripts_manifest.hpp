@@ -0,0 +1,90 @@
+#ifndef PMD2_SCRIPTS_MANIFEST_HPP
+#define PMD2_SCRIPTS_MANIFEST_HPP
+/*
+pmd2_scripts_manifest.hpp
+2016/10/29
+psycommando@gmail.com
+Description:
+    Keeps track of the content of the files each level's scripts were last exported or imported from and to,
+    so script export/import can skip the levels that didn't change since the last run.
+*/
+#include <utils/fnv_hash.hpp>
+#include <cstdint>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace pmd2
+{
+//======================================================================================
+//  ScriptBuildManifest
+//======================================================================================
+    /*
+        ScriptBuildManifest
+            Hashes of the input and output files of each level, from the last time it was exported or imported.
+            A level whose input and output files still hash to the same values can be skipped.
+
+            The manifest also stores a hash of the settings everything was processed with. (Options, game version,
+            configuration file, etc..) When the settings changed, the previous entries are discarded on load.
+
+            Levels can be looked up and updated from several threads at once.
+    */
+    class ScriptBuildManifest
+    {
+    public:
+        static const std::string ExportFileName;
+        static const std::string ImportFileName;
+
+        explicit ScriptBuildManifest( uint64_t settingshash );
+
+        /*
+            Load
+                Reads the manifest at "path". Returns false, and keeps the manifest empty, if the file doesn't exist,
+                is from another version of the format, or was made with different settings.
+                Throws if the file isn't a manifest.
+        */
+        bool Load ( const std::string & path );
+        void Write( const std::string & path )const;
+
+        /*
+            IsUpToDate
+                Whether the level was processed before, from and to files with those hashes.
+        */
+        bool IsUpToDate( const std::string & level, uint64_t inputhash, uint64_t outputhash )const;
+        void Set       ( const std::string & level, uint64_t inputhash, uint64_t outputhash );
+
+        inline uint64_t SettingsHash()const { return m_settingshash; }
+
+    private:
+        struct levelentry_t
+        {
+            uint64_t inputhash;
+            uint64_t outputhash;
+        };
+
+        uint64_t                            m_settingshash;
+        std::map<std::string, levelentry_t> m_levels;       //By level name, so the file is written in a stable order
+        mutable std::mutex                  m_mtx;
+    };
+
+//======================================================================================
+//  Hashing
+//======================================================================================
+    /*
+        HashLevelFiles
+            Hashes the names and content of the files at "path". It can be either a single file, or a directory,
+            in which case all the files directly within it are hashed in name order.
+            If "bscriptfilesonly" is set, only files used by the script engine are hashed. (ssb, ssa, lsd, etc..)
+            Returns 0 if there's nothing at "path".
+    */
+    uint64_t HashLevelFiles( const std::string & path, bool bscriptfilesonly );
+
+    /*
+        HashLevelFileData
+            Hashes the name and content of a single file the same way HashLevelFiles does, from data already in memory.
+            "seed" is the hash of the files that come before it in name order, when hashing a whole directory.
+    */
+    uint64_t HashLevelFileData( const std::string & fname, const void * pdata, size_t len, uint64_t seed = utils::FNV1aOffsetBasis );
+};
+
+#endif
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 
 namespace pmd2
@@ -1138,9 +1140,9 @@ namespace pmd2
 
     const std::string ParameterReferences::Face(int16_t id) const
     {
-        if( id < static_cast<int16_t>(m_gconf.GetGameScriptData().FaceNames().size()) )
+        if( id < static_cast<int16_t>(m_scrdata.FaceNames().size()) )
         {
-            return *(m_gconf.GetGameScriptData().FaceNames().FindByIndex(id));
+            return *(m_scrdata.FaceNames().FindByIndex(id));
         }
         else if( id == NullFaceID )
         {
@@ -1200,6 +1202,60 @@ namespace pmd2
         return std::move( RoutineTyToStr(static_cast<uint16_t>(ty)) );
     }
 
+//
+//  Name Lookups
+//
+    /*
+        The indices of the opcodes having a given name, in the order they appear in the opcode list.
+        Several opcodes can share a name, and differ only by their nb of parameters.
+    */
+    typedef std::unordered_map<std::string, std::vector<uint16_t>> opcodenameindex_t;
+
+    template<class _OpCodeInfoList>
+        opcodenameindex_t MakeOpCodeNameIndex( const _OpCodeInfoList & infolist )
+    {
+        opcodenameindex_t index;
+        index.reserve(infolist.size());
+        for( size_t i = 0; i < infolist.size(); ++i )
+            index[infolist[i].name].push_back( static_cast<uint16_t>(i) );
+        return index;
+    }
+
+    std::unordered_map<std::string, eOpParamTypes> MakeOpParamTypesIndex()
+    {
+        std::unordered_map<std::string, eOpParamTypes> index;
+        for( size_t i = 0; i < OpParamTypesNames.size(); ++i )
+            index.emplace( OpParamTypesNames[i], static_cast<eOpParamTypes>(i) );
+        return index;
+    }
+
+    const opcodenameindex_t                              OpCodeNameIndexEoS   = MakeOpCodeNameIndex(OpCodesInfoListEoS);
+    const opcodenameindex_t                              OpCodeNameIndexEoTD  = MakeOpCodeNameIndex(OpCodesInfoListEoTD);
+    const std::unordered_map<std::string, eOpParamTypes> OpParamTypesIndex    = MakeOpParamTypesIndex();
+
+    eOpParamTypes FindOpParamTypesByName( const std::string & name )
+    {
+        auto itf = OpParamTypesIndex.find(name);
+        if( itf != OpParamTypesIndex.end() )
+            return itf->second;
+        else
+            return eOpParamTypes::Invalid;
+    }
+
+    eScriptOpCodesEoTD FindOpCodeByName_EoTD( const std::string & name, size_t nbparams )
+    {
+        auto itf = OpCodeNameIndexEoTD.find(name);
+        if( itf == OpCodeNameIndexEoTD.end() )
+            return eScriptOpCodesEoTD::INVALID;
+
+        for( uint16_t opcode : itf->second )
+        {
+            if( OpCodesInfoListEoTD[opcode].nbparams == nbparams )
+                return static_cast<eScriptOpCodesEoTD>(opcode);
+        }
+        return eScriptOpCodesEoTD::INVALID;
+    }
+
     eScriptOpCodesEoS FindOpCodeByName_EoS(const std::string & name, size_t nbparams)
 #if 0
     {
@@ -1222,16 +1278,17 @@ namespace pmd2
     }
 #else
     {
+        auto itf = OpCodeNameIndexEoS.find(name);
+        if( itf == OpCodeNameIndexEoS.end() )
+            return eScriptOpCodesEoS::INVALID;
+
         size_t foundmultiparam = 0;
-        for( size_t i = 0; i < OpCodesInfoListEoS.size(); ++i )
+        for( uint16_t i : itf->second )
         {
-            if( OpCodesInfoListEoS[i].name == name )
-            {
-                if( OpCodesInfoListEoS[i].nbparams == nbparams )
-                    return static_cast<eScriptOpCodesEoS>(i);   //Exact match, return
-                else if( OpCodesInfoListEoS[i].nbparams == -1 )
-                    foundmultiparam = i;                        //Mark any command that matched with -1 parameters for later
-            }
+            if( OpCodesInfoListEoS[i].nbparams == nbparams )
+                return static_cast<eScriptOpCodesEoS>(i);   //Exact match, return
+            else if( OpCodesInfoListEoS[i].nbparams == -1 )
+                foundmultiparam = i;                        //Mark any command that matched with -1 parameters for later
         }
         //Return the -1 parameter that matched the name if we didn't find an exact match
         if( foundmultiparam != 0 )
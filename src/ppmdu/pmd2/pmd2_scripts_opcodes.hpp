@@ -1045,15 +1045,12 @@ namespace pmd2
             return nullptr;
     }
 
-    inline eOpParamTypes FindOpParamTypesByName( const std::string & name )
-    {
-        for( size_t i = 0; i < OpParamTypesNames.size(); ++i )
-        {
-            if( OpParamTypesNames[i] == name )
-                return static_cast<eOpParamTypes>(i);
-        }
-        return eOpParamTypes::Invalid;
-    }
+    /*
+        FindOpParamTypesByName
+            Returns the parameter type with the specified name, or eOpParamTypes::Invalid.
+            Looked up in a hash table, since its called for every parameter of every command when compiling scripts.
+    */
+    eOpParamTypes FindOpParamTypesByName( const std::string & name );
 
     struct OpParamInfo
     {
@@ -1143,15 +1140,7 @@ namespace pmd2
         return FindOpCodeInfo_EoTD( static_cast<uint16_t>(opcode) );
     }
 
-    inline eScriptOpCodesEoTD FindOpCodeByName_EoTD( const std::string & name, size_t nbparams )
-    {
-        for( size_t i = 0; i < OpCodesInfoListEoTD.size(); ++i )
-        {
-            if( OpCodesInfoListEoTD[i].name == name && OpCodesInfoListEoTD[i].nbparams == nbparams )
-                return static_cast<eScriptOpCodesEoTD>(i);
-        }
-        return eScriptOpCodesEoTD::INVALID;
-    }
+    eScriptOpCodesEoTD FindOpCodeByName_EoTD( const std::string & name, size_t nbparams );
 
     inline size_t GetNbOpCodes_EoTD()
     {
@@ -1647,8 +1636,9 @@ namespace pmd2
     class ParameterReferences
     {
     public:
+        //The tables are only ever read, and already hashed by name, so compilers on several threads can share them.
         ParameterReferences( const ConfigLoader & conf )
-            :m_gconf(conf)
+            :m_scrdata(conf.GetGameScriptData())
         {}
 
         //Face Names
@@ -1657,7 +1647,7 @@ namespace pmd2
         inline int16_t Face( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<NullFaceID>(m_gconf.GetGameScriptData().FaceNames(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
+                return FindIDByName<NullFaceID>(m_scrdata.FaceNames(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1665,13 +1655,13 @@ namespace pmd2
         //Face Posistion Modes
         inline const std::string * FacePosMode( int16_t id )const 
         {
-            return m_gconf.GetGameScriptData().FacePosModes().FindByIndex(id);
+            return m_scrdata.FacePosModes().FindByIndex(id);
         }
 
         inline int16_t FacePosMode( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().FacePosModes(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
+                return FindIDByName<ScriptNullVal>( m_scrdata.FacePosModes(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1679,13 +1669,13 @@ namespace pmd2
         //Common Routine Info
         inline const commonroutine_info * CRoutine( int16_t id )const 
         {
-            return m_gconf.GetGameScriptData().CommonRoutineInfo().FindByIndex(id);
+            return m_scrdata.CommonRoutineInfo().FindByIndex(id);
         }
 
         inline int16_t CRoutine( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<InvalidCRoutineID>( m_gconf.GetGameScriptData().CommonRoutineInfo(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
+                return FindIDByName<InvalidCRoutineID>( m_scrdata.CommonRoutineInfo(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1693,13 +1683,13 @@ namespace pmd2
         //Level Info
         inline const level_info * LevelInfo( int16_t id )const 
         {
-            return m_gconf.GetGameScriptData().LevelInfo().FindByIndex(id);
+            return m_scrdata.LevelInfo().FindByIndex(id);
         }
 
         inline int16_t LevelInfo( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().LevelInfo(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
+                return FindIDByName<ScriptNullVal>( m_scrdata.LevelInfo(), name, ScriptNullValName, false ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1707,13 +1697,13 @@ namespace pmd2
         //Lives Info
         inline const livesent_info * LivesInfo( int16_t id )const 
         {
-            return m_gconf.GetGameScriptData().LivesEnt().FindByIndex(id);
+            return m_scrdata.LivesEnt().FindByIndex(id);
         }
 
         inline int16_t LivesInfo( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().LivesEnt(), name ); //Don't allow converting to a number when not found!
+                return FindIDByName<ScriptNullVal>( m_scrdata.LivesEnt(), name ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1721,20 +1711,20 @@ namespace pmd2
         //GameVar Info
         inline const gamevariable_info * GameVarInfo( int16_t id )const 
         {
-            if( id > 0x400 ) //Extended game var starts at 0x400
-                return m_gconf.GetGameScriptData().ExGameVariables().FindByIndex(id - 0x400);
+            if( id >= 0x400 ) //Extended game var starts at 0x400
+                return m_scrdata.ExGameVariables().FindByIndex(id - 0x400);
             else
-                return m_gconf.GetGameScriptData().GameVariables().FindByIndex(id);
+                return m_scrdata.GameVariables().FindByIndex(id);
         }
 
         inline int16_t GameVarInfo( const std::string & name )const 
         {
-            size_t ret = m_gconf.GetGameScriptData().GameVariables().FindIndexByName(name);
+            size_t ret = m_scrdata.GameVariables().FindIndexByName(name);
 
             if( ret == std::numeric_limits<size_t>::max() )
             {
-                ret = m_gconf.GetGameScriptData().ExGameVariables().FindIndexByName(name);
-                if(ret != ret == std::numeric_limits<size_t>::max() )
+                ret = m_scrdata.ExGameVariables().FindIndexByName(name);
+                if( ret != std::numeric_limits<size_t>::max() )
                     ret += 0x400; //Extended game var starts at 0x400
             }
 
@@ -1744,13 +1734,13 @@ namespace pmd2
         //Object Info
         inline const object_info * ObjectInfo( int16_t id )const
         {
-            return m_gconf.GetGameScriptData().ObjectsInfo().FindByIndex(id);
+            return m_scrdata.ObjectsInfo().FindByIndex(id);
         }
 
         inline int16_t ObjectInfo( const std::string & name )const 
         {
             if( !DoesStringBeginsWithNumber(name) )
-                return FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().ObjectsInfo(), name ); //Don't allow converting to a number when not found!
+                return FindIDByName<ScriptNullVal>( m_scrdata.ObjectsInfo(), name ); //Don't allow converting to a number when not found!
             else
                 return utils::parseHexaValToValue<int16_t>(name);
         }
@@ -1789,7 +1779,7 @@ namespace pmd2
             if( static_cast<uint16_t>(dir) > 8 )
                 return std::to_string(dir); //In this case, put the value as-is
 
-            const std::string * pstr = m_gconf.GetGameScriptData().Directions().FindByIndex((dir - 1)); //Directions go from 1 to 8!
+            const std::string * pstr = m_scrdata.Directions().FindByIndex((dir - 1)); //Directions go from 1 to 8!
             if(!pstr)
                 return ScriptNullValName;
             else
@@ -1798,7 +1788,7 @@ namespace pmd2
 
         inline int16_t DirectionData( const std::string & name )const
         {
-            int16_t dirid = FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().Directions(), name );
+            int16_t dirid = FindIDByName<ScriptNullVal>( m_scrdata.Directions(), name );
 
             //We need to do this, since a direction of 0 is invalid, but since we opted for using indices to represent directions 
             // internally in the GameScriptData, our internal invalid value of -1 must be converted to the script's invalid direction of 0! We can't do it otherwise, because 0 
@@ -1814,7 +1804,7 @@ namespace pmd2
         //Direction (For use in script parameters)
         inline const std::string & Direction( int16_t dir )const
         {
-            const std::string * pstr = m_gconf.GetGameScriptData().Directions().FindByIndex(dir); //Directions go from 0 to 7!
+            const std::string * pstr = m_scrdata.Directions().FindByIndex(dir); //Directions go from 0 to 7!
             if(!pstr)
                 return ScriptNullValName;
             else
@@ -1823,7 +1813,7 @@ namespace pmd2
 
         inline int16_t Direction( const std::string & name )const
         {
-            return FindIDByName<ScriptNullVal>( m_gconf.GetGameScriptData().Directions(), name );
+            return FindIDByName<ScriptNullVal>( m_scrdata.Directions(), name );
         }
 
         //Item IDs
@@ -1844,7 +1834,9 @@ namespace pmd2
 
         static inline bool DoesStringBeginsWithNumber(const std::string & str)
         {
-            return (std::isdigit(str.front(), std::locale::classic() ) || str.front() == '-');
+            if( str.empty() )
+                return false;
+            return (str.front() >= '0' && str.front() <= '9') || str.front() == '-';
         }
 
         //This check if the value is std::numeric_limits<size_t>::max(), the error value when no index was found,
@@ -1858,7 +1850,7 @@ namespace pmd2
         }
 
         template<int16_t _INVALIDID, class _EntryTy>
-            inline const std::string FindByIndex( _EntryTy container, int16_t id, const std::string & invalidstr = ScriptNullValName )const 
+            inline const std::string FindByIndex( const _EntryTy & container, int16_t id, const std::string & invalidstr = ScriptNullValName )const 
         { 
             if( id == _INVALIDID )
                 return invalidstr;
@@ -1876,7 +1868,7 @@ namespace pmd2
 
         //tryconverttoint : If true, will attempt converting to an integer when there are no matches!
         template<int16_t _INVALIDID, class _EntryTy>
-            inline int16_t FindIDByName( _EntryTy container, const std::string & name, const std::string & invalidstr = ScriptNullValName, bool tryconverttoint = true )const 
+            inline int16_t FindIDByName( const _EntryTy & container, const std::string & name, const std::string & invalidstr = ScriptNullValName, bool tryconverttoint = true )const 
         { 
             if( name == invalidstr )
                 return _INVALIDID;
@@ -1892,7 +1884,7 @@ namespace pmd2
         }
 
     private:
-        const ConfigLoader & m_gconf;
+        const GameScriptData & m_scrdata;
     };
 
 
@@ -8,7 +8,11 @@
 #include <utils/utility.hpp>
 #include <ppmdu/pmd2/pmd2_scripts_opcodes.hpp>
 #include <ppmdu/pmd2/pmd2_xml_sniffer.hpp>
+#include <ppmdu/pmd2/pmd2_scripts_manifest.hpp>
 #include <utils/pugixml_utils.hpp>
+#include <utils/fnv_hash.hpp>
+#include <utils/async_file_sink.hpp>
+#include <utils/xml_stream_reader.hpp>
 #include <utils/library_wide.hpp>
 //#include <utils/multiple_task_handler.hpp>
 #include <utils/parallel_tasks.hpp>
@@ -277,6 +281,27 @@ namespace pmd2
         unsigned long long getFileOffset()const { return m_foffset; }
     };
 
+//==============================================================================
+//  XML Fragments
+//==============================================================================
+    const unsigned int ScriptXMLParseSettings = pugi::parse_default | pugi::parse_ws_pcdata_single;
+
+    /*
+        LoadXMLFragment
+            Loads a single element copied out of a script XML file by a utils::XMLStreamReader into "doc", and returns its node.
+            - fileoffset: Offset of the element in the XML file. Used to report parsing errors at the right spot.
+    */
+    inline xml_node LoadXMLFragment( xml_document & doc, size_t fileoffset, const std::string & text )
+    {
+        xml_parse_result parseres = doc.load_buffer( text.data(), text.size(), ScriptXMLParseSettings, pugi::encoding_utf8 );
+        if(!parseres)
+        {
+            throw CompileErrorException( "LoadXMLFragment(): Error while parsing XML.. " + string(parseres.description()),
+                                         fileoffset + static_cast<size_t>(parseres.offset) );
+        }
+        return doc.first_child();
+    }
+
 //==============================================================================
 //  CompilerReport
 //==============================================================================
@@ -544,7 +569,8 @@ namespace pmd2
              m_opinfo(version),
              m_gconf(conf), 
              m_paraminf(conf),
-             m_preportentry(ptrres)
+             m_preportentry(ptrres),
+             m_baseoffset(0)
         {}
 
         /*****************************************************************************************
@@ -559,12 +585,58 @@ namespace pmd2
             {
                 stringstream sstr;
                 PrintErrorPos(sstr, seqn) << "SSBXMLParser::operator(): Sequence is missing its \"name\" attribute!!";
-                throw CompileErrorException(sstr.str(), seqn.offset_debug());
+                throw CompileErrorException(sstr.str(), NodeOffset(seqn));
             }
 
             xml_node xcode = seqn.child(NODE_Code.c_str());
             m_out = std::move( Script(xname.value()) );
             ParseCode(xcode);
+            return std::move(FinishScript());
+        }
+
+        /*****************************************************************************************
+            operator()
+                - reader: Reader on the start tag of the ScriptSequence element to parse. 
+                          Afterwards, the reader is on the end tag of that element.
+                Only a single routine start tag, or a single instruction element is loaded as
+                a XML document at a time.
+        *****************************************************************************************/
+        Script operator()( utils::XMLStreamReader & reader )
+        {
+            using namespace scriptXML;
+            const std::string * pname = reader.Attribute(ATTR_ScrSeqName);
+            if(!pname)
+            {
+                stringstream sstr;
+                PrintErrorPos(sstr, reader.Offset()) << "SSBXMLParser::operator(): Sequence is missing its \"name\" attribute!!";
+                throw CompileErrorException(sstr.str(), reader.Offset());
+            }
+
+            const utils::XMLStreamReader::name_t pcode = reader.Intern(NODE_Code);
+            bool bfoundcode = false;
+            m_out = std::move( Script(*pname) );
+            while( reader.Next() == utils::XMLStreamReader::eToken::StartElement )
+            {
+                if( !bfoundcode && reader.Name() == pcode ) //Only the first code element is parsed, like child() does
+                {
+                    bfoundcode = true;
+                    ParseCode(reader);
+                }
+                else
+                    reader.SkipElement();
+            }
+            return std::move(FinishScript());
+        }
+
+    private:
+
+        /*****************************************************************************************
+            FinishScript
+                Checks labels and builds the string tables once all the routines were parsed.
+                Returns the parsed script.
+        *****************************************************************************************/
+        Script & FinishScript()
+        {
             CheckLabelReferences();
             OffsetAllStringReferencesParameters(); //Offset all string id parameters in all commands by the nb of entries in the const table.
 
@@ -575,10 +647,29 @@ namespace pmd2
             {
                 m_out.StrTblSet().emplace( aq.first, std::move(Script::strtbl_t(aq.second.begin(), aq.second.end())) );
             }
-            return std::move(m_out);
+            return m_out;
         }
 
-    private:
+        /*****************************************************************************************
+            NodeOffset
+                Returns the offset in the XML file of the node specified. Nodes loaded from a
+                fragment are offset by where the fragment begins in the file.
+        *****************************************************************************************/
+        inline ptrdiff_t NodeOffset( const xml_node & node )const
+        {
+            return m_baseoffset + node.offset_debug();
+        }
+
+        /*****************************************************************************************
+            LoadFragment
+                Loads an element copied out of the XML file, and returns its node.
+                The node stays valid until the next fragment is loaded.
+        *****************************************************************************************/
+        inline xml_node LoadFragment( size_t fileoffset, const std::string & text )
+        {
+            m_baseoffset = static_cast<ptrdiff_t>(fileoffset);
+            return LoadXMLFragment( m_fragdoc, fileoffset, text );
+        }
 
         /*****************************************************************************************
             PrintErrorPos
@@ -586,12 +677,17 @@ namespace pmd2
                  the current offset of the node specified.
                 Returns the stringstream passed as reference.
         *****************************************************************************************/
-        inline stringstream & PrintErrorPos( stringstream & sstr, const xml_node & errornode )const
+        inline stringstream & PrintErrorPos( stringstream & sstr, ptrdiff_t fileoffset )const
         {
-            sstr <<m_out.Name() <<", file offset : " <<dec <<nouppercase <<errornode.offset_debug() <<" -> ";
+            sstr <<m_out.Name() <<", file offset : " <<dec <<nouppercase <<fileoffset <<" -> ";
             return sstr;
         }
 
+        inline stringstream & PrintErrorPos( stringstream & sstr, const xml_node & errornode )const
+        {
+            return PrintErrorPos( sstr, NodeOffset(errornode) );
+        }
+
         /*****************************************************************************************
             OffsetAllStringReferencesParameters
                 This offsets the index of every single string id parameter used in commands that 
@@ -647,7 +743,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer,routinen) <<"SSBXMLParser::ParseTypedRoutine(): Routine has unknown parameter type \"" 
                                                <<static_cast<uint16_t>(ptype) <<"\"!!";
-                throw CompileErrorException(sstrer.str(), routinen.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(routinen));
             }
 
             xml_attribute attr = routinen.attribute(ppname->c_str());
@@ -663,7 +759,7 @@ namespace pmd2
                     stringstream sstrer;
                     PrintErrorPos(sstrer,routinen) <<"SSBXMLParser::ParseTypedRoutine(): Routine is missing its expected parameter \"" 
                                                    <<*ppname <<"\"!!";
-                    throw CompileErrorException(sstrer.str(), routinen.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(routinen));
                 }
                 ptype = eOpParamTypes::UNK_Placeholder; //We want to handle it as a regular value/placeholder
             }
@@ -679,55 +775,98 @@ namespace pmd2
                 //If the parameter isn't either a placeholder, or a valid entity type, return an error
                 stringstream sstrer;
                 PrintErrorPos(sstrer,routinen) <<"SSBXMLParser::ParseTypedRoutine(): Routine has an invalid parameter attribute name \"" <<attr.name() <<"\"!!";
-                throw CompileErrorException(sstrer.str(), routinen.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(routinen));
             }
             else if( ptype == eOpParamTypes::UNK_Placeholder ) //If the parameter is a placeholder, just copy the value as-is
                 entid = ToWord( attr.as_uint() );
             grpout.parameter = entid;
         }
 
+        /*****************************************************************************************
+            ParseRoutineHead
+                Reads the type and parameter of a routine node, but not its instructions.
+                Returns false if the routine isn't of a valid type, and should be skipped.
+                - lastroutinetype: Type of the previous routine. Updated with the type of this one.
+        *****************************************************************************************/
+        bool ParseRoutineHead( const xml_node & routine, uint16_t & lastroutinetype, ScriptRoutine & rtnout )
+        {
+            using namespace scriptXML;
+            uint16_t routinety = 0;
+            bool     isalias   = NODE_RoutineAlias == routine.name();
+
+            if(isalias) //If routine is an alias, we use the same type as the last routine.
+            {
+                if(m_out.Routines().empty()) //If the first routine is an alias, trigger an error.
+                {
+                    stringstream sstrer;
+                    PrintErrorPos(sstrer,routine) 
+                        << "SSBXMLParser::ParseCode(): The first routine cannot be an alias!";
+                    throw CompileErrorException(sstrer.str(), NodeOffset(routine));
+                }
+                routinety = lastroutinetype;
+            }
+            else
+                routinety = StrToRoutineTyInt(routine.name());
+            lastroutinetype = routinety; //Set the type of the last routine
+
+            //Parse the attributes if the routine is a valid type!
+            if(routinety == 0)
+                return false;
+            ParseTypedRoutine(routine, routinety, rtnout, isalias); //Handle routines depending on their type
+            return true;
+        }
+
         /*****************************************************************************************
             ParseCode
                 Read routines and parse their instructions.
         *****************************************************************************************/
         void ParseCode( const xml_node & coden )
         {
-            using namespace scriptXML;
             Script::grptbl_t & outtbl = m_out.Routines();
 
             uint16_t lastroutinetype = 0;
             for( const xml_node & routine : coden.children() )
             {
-                uint16_t routinety = 0;
-                bool     isalias   = NODE_RoutineAlias == routine.name();
+                ScriptRoutine rtnout;
+                if( !ParseRoutineHead(routine, lastroutinetype, rtnout) )
+                    continue;
+                if(!rtnout.isalias) //We only handle instructions for non-aliases routines to avoid duplicating instructions.
+                {
+                    for( const xml_node & inst : routine )
+                        ParseInstruction(inst, rtnout.instructions);
+                }
+                outtbl.push_back(std::move(rtnout));
+            }
+        }
+
+        /*****************************************************************************************
+            ParseCode
+                Same as above, but for a reader on the start tag of the code element.
+                Routines and instructions are loaded one element at a time, since command 
+                overloads are picked by looking at the whole command element first.
+        *****************************************************************************************/
+        void ParseCode( utils::XMLStreamReader & reader )
+        {
+            Script::grptbl_t & outtbl = m_out.Routines();
 
-                if(isalias) //If routine is an alias, we use the same type as the last routine.
+            uint16_t lastroutinetype = 0;
+            while( reader.Next() == utils::XMLStreamReader::eToken::StartElement )
+            {
+                ScriptRoutine rtnout;
+                const bool    bvalid = ParseRoutineHead( LoadFragment(reader.Offset(), reader.StartTagAsEmptyElement()), lastroutinetype, rtnout );
+                if( bvalid && !rtnout.isalias ) //We only handle instructions for non-aliases routines to avoid duplicating instructions.
                 {
-                    if(m_out.Routines().empty()) //If the first routine is an alias, trigger an error.
+                    while( reader.Next() == utils::XMLStreamReader::eToken::StartElement )
                     {
-                        stringstream sstrer;
-                        PrintErrorPos(sstrer,routine) 
-                            << "SSBXMLParser::ParseCode(): The first routine cannot be an alias!";
-                        throw CompileErrorException(sstrer.str(), routine.offset_debug());
+                        const size_t instoffset = reader.Offset();
+                        ParseInstruction( LoadFragment(instoffset, reader.ReadElementText()), rtnout.instructions );
                     }
-                    routinety = lastroutinetype;
                 }
                 else
-                    routinety = StrToRoutineTyInt(routine.name());
-                
-                //Parse the attributes and instructions if the routine is a valid type!
-                if(routinety != 0)
-                {
-                    ScriptRoutine rtnout;
-                    ParseTypedRoutine(routine, routinety, rtnout, isalias); //Handle routines depending on their type
-                    if(!isalias) //We only handle instructions for non-aliases routines to avoid duplicating instructions.
-                    {
-                        for( const xml_node & inst : routine )
-                            ParseInstruction(inst, rtnout.instructions);
-                    }
+                    reader.SkipElement();
+
+                if(bvalid)
                     outtbl.push_back(std::move(rtnout));
-                }
-                lastroutinetype = routinety; //Set the type of the last routine
             }
         }
 
@@ -759,7 +898,7 @@ namespace pmd2
             xml_attribute xid = instn.attribute(ATTR_LblID.c_str());
 
             if( !xid )
-                throw CompileErrorException("SSBXMLParser::ParseInstruction(): Label with invalid ID found! " + instn.path(), instn.offset_debug());
+                throw CompileErrorException("SSBXMLParser::ParseInstruction(): Label with invalid ID found! " + instn.path(), NodeOffset(instn));
 
             uint16_t labelid = ToWord(xid.as_int());
             m_labelchecker[labelid].bexists = true; //We know this label exists
@@ -786,10 +925,11 @@ namespace pmd2
             using namespace scriptXML;
             xml_attribute_iterator  itat     = instn.attributes_begin();
             xml_attribute_iterator  itatend  = instn.attributes_end();
-            const std::string       nodename = instn.name();
-            size_t                  nbparams = std::distance( itat, itatend );
+            const std::string       nodename   = instn.name();
+            size_t                  nbparams   = std::distance( itat, itatend );
+            const bool              hasstrings = instn.child(NODE_String.c_str());
 
-            if( instn.child(NODE_String.c_str()) )
+            if( hasstrings )
                 ++nbparams; //If we got a string, add it to the parameter count!
 
             uint16_t foundop  = m_opinfo.Code( nodename, nbparams );
@@ -798,7 +938,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer,instn) <<"SSBXMLParser::TryParseCommandNode(): Script \"" <<m_out.Name() <<"\", instruction group #" << m_out.Routines().size() 
                     <<", in group instruction #" <<outcnt.size() <<" Node name " <<nodename <<" doesn't match any known meta instructions or command!!";
-                throw CompileErrorException(sstrer.str(), instn.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(instn));
             }
 
             OpCodeInfoWrapper opinfo = m_opinfo.Info(foundop);
@@ -807,7 +947,7 @@ namespace pmd2
             outinstr.type  = opinfo.GetMyInstructionType();
 
             //Read parameters
-            DecideHowParseParams( instn, itat, itatend, nbparams, opinfo, instn.child(NODE_String.c_str()), outinstr, outcnt );
+            DecideHowParseParams( instn, itat, itatend, nbparams, opinfo, hasstrings, outinstr, outcnt );
 
             //Parse child instructions, if required
             if( outinstr.type  != eInstructionType::Command )
@@ -843,7 +983,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer,instn) <<"SSBXMLParser::ParseInstruction(): Script \"" <<m_out.Name() <<"\", instruction group #" << m_out.Routines().size() 
                                             <<", in group instruction #" <<outcnt.size() <<" doesn't have a \"" <<ATTR_Name <<"\" attribute!!";
-                throw CompileErrorException(sstrer.str(), instn.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(instn));
             }
             else
                 instname = name.value();
@@ -876,7 +1016,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer, instn) << "SSBXMLParser::ParseCommand(): No matching command for " 
                     <<instname <<", taking " <<nbparams <<" parameter(s) found!";;
-                throw CompileErrorException(sstrer.str(), instn.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(instn));
             }
 
             //#3 - Parse parameters
@@ -918,7 +1058,7 @@ namespace pmd2
                     if( ParseDefinedParameters( instn, itat, itatend, oinf, hasstrings, outinstr ) != oinf.NbParams() )
                     {
                         assert(false); //should never happen!!
-                        throw CompileErrorException("SSBXMLParser::ParseCommand(): Parsed less parameters than expected!!", instn.offset_debug());
+                        throw CompileErrorException("SSBXMLParser::ParseCommand(): Parsed less parameters than expected!!", NodeOffset(instn));
                     }
                 }
                 else if( oinf.ParamInfo().size() < oinf.NbParams() &&   //If not all parameters were defined
@@ -932,7 +1072,7 @@ namespace pmd2
                         //Error, lacks required parameters!!
                         stringstream sstrer;
                         PrintErrorPos(sstrer,instn) <<"SSBXMLParser::ParseCommand(): Command \"" <<instn.path() <<"\" had less parameters specified than expected!!";
-                        throw CompileErrorException(sstrer.str(), instn.offset_debug());
+                        throw CompileErrorException(sstrer.str(), NodeOffset(instn));
                     }
                 }
             }
@@ -947,7 +1087,7 @@ namespace pmd2
                 //Error, lacks required parameters!!
                 stringstream sstrer;
                 PrintErrorPos(sstrer,instn) <<"SSBXMLParser::ParseCommand(): Command \"" <<instn.path() <<"\" had less parameters specified than expected!!";
-                throw CompileErrorException(sstrer.str(), instn.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(instn));
             }
 
         }
@@ -976,8 +1116,7 @@ namespace pmd2
 
             for( ;begat < nbtoparse && itat != itatend; ++itat )
             {
-                const string attrname = CleanAttributeName(itat->name());
-                if( attrname == ATTR_Param )
+                if( IsCleanAttributeName( itat->name(), ATTR_Param ) )
                 {
                     outinstr.parameters.push_back( ToWord(itat->as_uint()) );
                     ++begat;
@@ -1052,7 +1191,7 @@ namespace pmd2
                             stringstream ss;
                             PrintErrorPos(ss,instn) <<"SSBXMLParser::ParseDefinedParameters(): Expected String node or constref, but neither were found! " 
                                                     << instn.path();
-                            throw CompileErrorException(ss.str(), instn.offset_debug());
+                            throw CompileErrorException(ss.str(), NodeOffset(instn));
                         }
                     }
                     else
@@ -1060,7 +1199,7 @@ namespace pmd2
                         stringstream ss;
                         PrintErrorPos(ss,instn) <<"SSBXMLParser::ParseDefinedParameters(): Unexpected parameter " <<itat->name() <<"\", " <<attrname <<"\"! "
                                                 << instn.path();
-                        throw CompileErrorException(ss.str(), instn.offset_debug());
+                        throw CompileErrorException(ss.str(), NodeOffset(instn));
                     }
                 }
                 else if( pinf.ptype == eOpParamTypes::String ) 
@@ -1079,7 +1218,7 @@ namespace pmd2
                         stringstream ss;
                         PrintErrorPos(ss,instn) <<"SSBXMLParser::ParseDefinedParameters(): Expected String node, but none were found! "
                                                 << instn.path();
-                        throw CompileErrorException(ss.str(), instn.offset_debug());
+                        throw CompileErrorException(ss.str(), NodeOffset(instn));
                     }
                     break; //Break immediatetly, since, we don't have any attributes left!!
                 }
@@ -1119,7 +1258,7 @@ namespace pmd2
 
                         if( lang == eGameLanguages::Invalid )
                         {
-                            throw CompileErrorException("SSBXMLParser::ParseTypedCommandParameterAttribute(): Encountered unknown language "s + xlang.value() + " for string!", strs.offset_debug());
+                            throw CompileErrorException("SSBXMLParser::ParseTypedCommandParameterAttribute(): Encountered unknown language "s + xlang.value() + " for string!", NodeOffset(strs));
                         }
                         m_strqueues[lang].push_back(cdatatext.get());
                     }
@@ -1132,7 +1271,7 @@ namespace pmd2
 
                         if( lang == eGameLanguages::Invalid )
                         {
-                            throw CompileErrorException("SSBXMLParser::ParseTypedCommandParameterAttribute(): Encountered unknown language "s + xlang.value() + " for string!", strs.offset_debug());
+                            throw CompileErrorException("SSBXMLParser::ParseTypedCommandParameterAttribute(): Encountered unknown language "s + xlang.value() + " for string!", NodeOffset(strs));
                         }
                         m_strqueues[lang].push_back(xval.value());
                     }
@@ -1147,18 +1286,38 @@ namespace pmd2
 
 
         /*****************************************************************************************
-            CleanAttributeName
-                Remove any suffixed numbers from a command parameter attribute identifier.
+            CleanAttributeNameLen
+                Returns the length of a command parameter attribute identifier, without its 
+                suffixed number, if any. Doesn't allocate, since its called for every parameter.
         *****************************************************************************************/
-        inline string CleanAttributeName( const pugi::char_t * cname )
+        static inline size_t CleanAttributeNameLen( const pugi::char_t * cname )
         {
-            string name(cname);
-            for( size_t i = 0; i < name.size(); ++i )
+            size_t i = 0;
+            for( ; cname[i] != 0; ++i )
             {
-                if( name[i] == '_' && (i + 1 < name.size()) && std::isdigit(name[i+1], locale::classic()) ) //Check if the parameter name is followed by "_XX" where XX is a number.
-                    return name.substr(0,i);
+                if( cname[i] == '_' && cname[i+1] >= '0' && cname[i+1] <= '9' ) //Check if the parameter name is followed by "_XX" where XX is a number.
+                    return i;
             }
-            return std::move(name);
+            return i;
+        }
+
+        /*****************************************************************************************
+            CleanAttributeName
+                Remove any suffixed numbers from a command parameter attribute identifier.
+        *****************************************************************************************/
+        static inline string CleanAttributeName( const pugi::char_t * cname )
+        {
+            return string( cname, CleanAttributeNameLen(cname) );
+        }
+
+        /*****************************************************************************************
+            IsCleanAttributeName
+                Whether the attribute identifier is "name", once any suffixed number is removed.
+        *****************************************************************************************/
+        static inline bool IsCleanAttributeName( const pugi::char_t * cname, const std::string & name )
+        {
+            const size_t len = CleanAttributeNameLen(cname);
+            return len == name.size() && name.compare( 0, len, cname, len ) == 0;
         }
 
         /*****************************************************************************************
@@ -1201,12 +1360,12 @@ namespace pmd2
                     auto itf = m_labelchecker.find( lblid ); //See if we have a reference to this label already
                     
                     if( itf != m_labelchecker.end() )
-                        itf->second.referersoffsets.push_back(parentinstn.offset_debug()); //If it exists already, add this command to the list of references to this label
+                        itf->second.referersoffsets.push_back(NodeOffset(parentinstn)); //If it exists already, add this command to the list of references to this label
                     else
                     {
                         labelRefInf lblr;
                         lblr.bexists         = false;                           //We don't know if the label exists yet
-                        lblr.referersoffsets = {{parentinstn.offset_debug()}};  //Mark the offset we got the reference at
+                        lblr.referersoffsets = {{NodeOffset(parentinstn)}};  //Mark the offset we got the reference at
                         m_labelchecker.emplace( std::make_pair(lblid, std::move(lblr)) );  //Add this command as a reference to this label
                     }
 
@@ -1223,9 +1382,9 @@ namespace pmd2
                         stringstream sstr; 
                         sstr << "Invalid common routine name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outinst.parameters.push_back( ToWord(param.as_int()) );
                     }
 
@@ -1241,9 +1400,9 @@ namespace pmd2
                         stringstream sstr; 
                         sstr << "Invalid face name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outinst.parameters.push_back( ToWord(param.as_int()) );
                     }
                     break;
@@ -1258,9 +1417,9 @@ namespace pmd2
                         stringstream sstr; 
                         sstr << "Invalid game variable name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outinst.parameters.push_back( ToWord(param.as_int()) );
                     }
                     break;
@@ -1273,9 +1432,9 @@ namespace pmd2
                         stringstream sstr;
                         sstr << "Invalid level id name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outinst.parameters.push_back(ToSWord(param.as_int()));
                     }
 
@@ -1292,9 +1451,9 @@ namespace pmd2
                         stringstream sstr;
                         sstr << "Invalid face position mode name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outinst.parameters.push_back(ToSWord(param.as_int()));
                     }
                     break;
@@ -1347,7 +1506,7 @@ namespace pmd2
                         stringstream sstrer;
                         sstrer << "Invalid parameter name!\"" <<param.name() <<"\"!";
                         string msg = sstrer.str();
-                        throw CompileErrorException(sstrer.str(), parentinstn.offset_debug());
+                        throw CompileErrorException(sstrer.str(), NodeOffset(parentinstn));
                     }
                     outinst.parameters.push_back(outval);
                 }
@@ -1374,9 +1533,9 @@ namespace pmd2
                         stringstream sstr; 
                         sstr << "Invalid actor name \"" <<param.value() <<"\"! Interpreting value as a raw integer!";
                         string msg = sstr.str();
-                        slog() <<parentinstn.path() <<", " <<parentinstn.offset_debug() <<" : " <<msg <<"\n"; 
+                        slog() <<parentinstn.path() <<", " <<NodeOffset(parentinstn) <<" : " <<msg <<"\n"; 
                         if(m_preportentry)
-                            m_preportentry->InsertWarning( parentinstn.offset_debug(), std::move(msg) );
+                            m_preportentry->InsertWarning( NodeOffset(parentinstn), std::move(msg) );
                         outval =  ToWord(param.as_int());
                     }
                     break;
@@ -1400,7 +1559,7 @@ namespace pmd2
                         PrintErrorPos(sstrer,parentinstn) 
                             << "SSBXMLParser::ParseTypedCommandParameterAttribute(): Object id " <<param.value() 
                             <<", is missing object number! Can't reliably pinpoint the correct object instance!";
-                        throw_with_nested( CompileErrorException(sstrer.str(), parentinstn.offset_debug()) );
+                        throw_with_nested( CompileErrorException(sstrer.str(), NodeOffset(parentinstn)) );
                     }
                     break;
                 }
@@ -1431,14 +1590,14 @@ namespace pmd2
                     stringstream sstrer;
                     sstrer << "SSBXMLParser::ParseConsts(): Script \"" <<m_out.Name() <<"\", String block #"  <<m_out.StrTblSet().size()
                            <<" is missing its \"" <<ATTR_Language <<"\" attribute!";
-                    throw CompileErrorException(sstrer.str(), strblkn.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(strblkn));
             }
             if( (glang = StrToGameLang(xlang.value())) == eGameLanguages::Invalid )
             {
                     stringstream sstrer;
                     sstrer << "SSBXMLParser::ParseConsts(): Script \"" <<m_out.Name() <<"\", String block #"  <<m_out.StrTblSet().size()
                            <<" has an invalid value\"" <<xlang.value() <<"\" as its \"" <<ATTR_Language <<"\" attribute value!";
-                    throw CompileErrorException(sstrer.str(), strblkn.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(strblkn));
             }
 
             deque<string> langstr; //save on realloc each times on a vector
@@ -1453,7 +1612,7 @@ namespace pmd2
                     sstrer << "SSBXMLParser::ParseConsts(): Script \"" <<m_out.Name() <<"\", String block #"  <<m_out.StrTblSet().size()
                            <<", language \"" <<xlang.value() <<"\", string #" <<langstr.size() 
                            <<", is missing its \"" <<ATTR_Value <<"\" attribute!";
-                    throw CompileErrorException(sstrer.str(), str.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(str));
                 }
             }
             m_out.InsertStrLanguage( glang, std::move(Script::strtbl_t( langstr.begin(), langstr.end() )) );
@@ -1480,6 +1639,8 @@ namespace pmd2
         ParameterReferences  m_paraminf;
         const ConfigLoader & m_gconf;
         CompilerReport::compileresult * m_preportentry; //Compiler report entry pointer, when applicable, null otherwise
+        xml_document     m_fragdoc;         //Holds the element currently parsed, when parsing from a XMLStreamReader
+        ptrdiff_t        m_baseoffset;      //Offset in the file of the loaded fragment, added to node offsets
     };
 
 
@@ -1489,15 +1650,21 @@ namespace pmd2
     *****************************************************************************************/
     class SSDataXMLParser
     {
+        //Offset in the file of the data node, when it was loaded on its own from a fragment of the file.
+        inline ptrdiff_t NodeOffset( const xml_node & node )const
+        {
+            return m_baseoffset + node.offset_debug();
+        }
+
         inline stringstream & PrintErrorPos( stringstream & sstr, const xml_node & errornode )const
         {
-            sstr <<m_out.Name() <<", file offset : " <<dec <<nouppercase <<errornode.offset_debug() <<" -> ";
+            sstr <<m_out.Name() <<", file offset : " <<dec <<nouppercase <<NodeOffset(errornode) <<" -> ";
             return sstr;
         }
 
     public:
-        SSDataXMLParser( const ConfigLoader & conf, CompilerReport::compileresult * preport = nullptr )
-            :m_gconf(conf), m_paraminf(conf), m_preport(preport)
+        SSDataXMLParser( const ConfigLoader & conf, CompilerReport::compileresult * preport = nullptr, ptrdiff_t baseoffset = 0 )
+            :m_gconf(conf), m_paraminf(conf), m_preport(preport), m_baseoffset(baseoffset)
         {}
 
         ScriptData operator()(xml_node & datan)
@@ -1509,7 +1676,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer,datan) << "SSDataXMLParser::operator(): Script data is missing its \"" 
                                             << ATTR_ScrDatName << "\" attribute!!";
-                throw CompileErrorException(sstrer.str(), datan.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(datan));
             }
             xml_attribute xtype = datan.attribute(ATTR_ScriptType.c_str());
             if(!xtype)
@@ -1517,7 +1684,7 @@ namespace pmd2
                 stringstream sstrer;
                 PrintErrorPos(sstrer,datan) << "SSDataXMLParser::operator(): Script data is missing its \"" 
                                             << ATTR_ScriptType <<"\" attribute!!";
-                throw CompileErrorException(sstrer.str(), datan.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(datan));
             }
 
             eScrDataTy dataty = StrToScriptDataType(xtype.value());
@@ -1525,7 +1692,7 @@ namespace pmd2
             {
                 stringstream sstrer;
                 PrintErrorPos(sstrer,datan) << "SSDataXMLParser::operator(): Invalid script data type!!";
-                throw CompileErrorException(sstrer.str(), datan.offset_debug());
+                throw CompileErrorException(sstrer.str(), NodeOffset(datan));
             }
 
             //Init output data
@@ -1557,7 +1724,7 @@ namespace pmd2
                 //{
                 //    stringstream sstrer;
                 //    PrintErrorPos(sstrer,curunk1entry) << "SSDataXMLParser::ParseTriggers(): A trigger entry is missing its \"" <<AttrID <<"\" attribute(s)!  Or one or more of them is not written correctly!";
-                //    throw CompileErrorException(sstrer.str(), curunk1entry.offset_debug());
+                //    throw CompileErrorException(sstrer.str(), NodeOffset(curunk1entry));
                 //}
                 if(xcrtnid && xunk1 && xunk2 && xscrid)
                 {
@@ -1579,19 +1746,19 @@ namespace pmd2
                     if(!xscrid)
                         sstrer << ATTR_ScriptID << " ";
                     sstrer <<"attribute(s)! Or one or more of them is not written correctly!";
-                    throw CompileErrorException(sstrer.str(), curunk1entry.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(curunk1entry));
                 }
 
                 entry.croutineid = m_paraminf.CRoutine(xcrtnid.value());
                 if(entry.croutineid == InvalidCRoutineID)
                 {
                     std::stringstream sstr;
-                    sstr << "SSDataXMLParser::ParseActions(), offset: " <<curunk1entry.offset_debug() <<": Got invalid common routine name " 
+                    sstr << "SSDataXMLParser::ParseActions(), offset: " <<NodeOffset(curunk1entry) <<": Got invalid common routine name " 
                          <<xcrtnid.value() <<"! Interpreting as number instead!";
                     std::string msg = sstr.str();
                     slog()<<msg <<"\n";
                     if(m_preport)
-                        m_preport->InsertWarning(curunk1entry.offset_debug(), std::move(msg));
+                        m_preport->InsertWarning(NodeOffset(curunk1entry), std::move(msg));
                     entry.croutineid = ToSWord(xcrtnid.as_int());
                 }
 
@@ -1664,19 +1831,19 @@ namespace pmd2
                 {
                     stringstream sstrer;
                     PrintErrorPos(sstrer,actor) << "SSDataXMLParser::ParseActors(): Missing actor id attribute!!";
-                    throw CompileErrorException(sstrer.str(), actor.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(actor));
                 }
 
                 entry.livesid = m_paraminf.LivesInfo(xid.value());
                 if(entry.livesid == InvalidLivesID)
                 {
                     std::stringstream sstr;
-                    sstr << "SSDataXMLParser::ParseActors(), offset: " <<actor.offset_debug() <<": Got invalid actor name " 
+                    sstr << "SSDataXMLParser::ParseActors(), offset: " <<NodeOffset(actor) <<": Got invalid actor name " 
                          <<entry.livesid <<"! Interpreting as number instead!";
                     std::string msg = sstr.str();
                     slog()<<msg <<"\n";
                     if(m_preport)
-                        m_preport->InsertWarning(actor.offset_debug(), std::move(msg));
+                        m_preport->InsertWarning(NodeOffset(actor), std::move(msg));
                     entry.livesid = ToSWord(xid.as_int());
                 }
 
@@ -1712,7 +1879,7 @@ namespace pmd2
                 {
                     stringstream sstrer;
                     PrintErrorPos(sstrer,object) << "SSDataXMLParser::ParseObjects(): Missing " <<AttrID <<" attribute!!";
-                    throw CompileErrorException(sstrer.str(), object.offset_debug());
+                    throw CompileErrorException(sstrer.str(), NodeOffset(object));
                 }
 
                 const string objid = xid.value();
@@ -1726,7 +1893,7 @@ namespace pmd2
                     PrintErrorPos(sstrer,object) 
                         << "SSDataXMLParser::ParseObjects(): Object id " <<objid 
                         <<", is missing object number! Can't reliably pinpoint the correct object instance!";
-                    throw_with_nested(CompileErrorException(sstrer.str(), object.offset_debug()));
+                    throw_with_nested(CompileErrorException(sstrer.str(), NodeOffset(object)));
                 }
 
                 for( const auto & attr : object.attributes() )
@@ -1800,19 +1967,19 @@ namespace pmd2
                 //{
                 //    stringstream sstrer;
                 //    PrintErrorPos(sstrer,aevent) << "SSDataXMLParser::ParseEvents(): Missing " <<AttrID <<" attribute!!";
-                //    throw CompileErrorException(sstrer.str(), aevent.offset_debug());
+                //    throw CompileErrorException(sstrer.str(), NodeOffset(aevent));
                 //}
 
                 //entry.croutineid = m_paraminf.CRoutine(xevid.value());
                 //if(entry.croutineid == InvalidCRoutineID)
                 //{
                 //    std::stringstream sstr;
-                //    sstr << "SSDataXMLParser::ParseEvents(), offset: " <<aevent.offset_debug() <<": Got invalid common routine name " 
+                //    sstr << "SSDataXMLParser::ParseEvents(), offset: " <<NodeOffset(aevent) <<": Got invalid common routine name " 
                 //         <<xevid.value() <<"! Interpreting as number instead!";
                 //    std::string msg = sstr.str();
                 //    slog()<<msg <<"\n";
                 //    if(m_preport)
-                //        m_preport->InsertWarning(aevent.offset_debug(), std::move(msg));
+                //        m_preport->InsertWarning(NodeOffset(aevent), std::move(msg));
                 //    entry.croutineid = ToSWord(xevid.as_int());
                 //}
 
@@ -1838,7 +2005,7 @@ namespace pmd2
                             stringstream sstrer;
                             PrintErrorPos(sstrer,aevent) << "SSDataXMLParser::ParseEvents(): The current event has an invalid action index of " <<entry.actionidx 
                                                          <<", while we have only " <<m_out.ActionTable().size() <<" actions in the action table!";
-                            throw CompileErrorException(sstrer.str(), aevent.offset_debug());
+                            throw CompileErrorException(sstrer.str(), NodeOffset(aevent));
                         }
                     }
                 }
@@ -1851,6 +2018,7 @@ namespace pmd2
         ScriptData                      m_out;
         ParameterReferences             m_paraminf;
         CompilerReport::compileresult * m_preport;
+        ptrdiff_t                       m_baseoffset;
     };
 
     /*****************************************************************************************
@@ -1859,10 +2027,9 @@ namespace pmd2
     *****************************************************************************************/
     class GameScriptsXMLParser
     {
-        static const unsigned int XML_ParseSettings = pugi::parse_default | pugi::parse_ws_pcdata_single;
     public:
         GameScriptsXMLParser(eGameRegion & out_reg, eGameVersion & out_gver, const ConfigLoader & conf)
-            :m_out_reg(out_reg), m_out_gver(out_gver), m_gconf(conf), m_preport(nullptr)
+            :m_out_reg(out_reg), m_out_gver(out_gver), m_gconf(conf), m_preport(nullptr), m_fragoffset(0)
         {}
 
         inline LevelScript Parse( const std::string & path, const scriptprocoptions & options, CompilerReport * reporter = nullptr )
@@ -1949,13 +2116,16 @@ namespace pmd2
             if( utils::LibWide().isLogOn() )
                 slog() << "#Parsing " <<m_curfilebasename <<".xml \n";
 
-            xml_document doc;
+            utils::XMLStreamReader reader;
             try
             {
-                xml_node    parentn = HandleLoadXMLDoc(doc, file, ROOT_ScripDir);
+                LevelScript::scriptsets_t sets;
+                LevelScript::lsdtbl_t     lsdtbl;
+                HandleLoadXMLDoc(reader, file, ROOT_ScripDir);
+                ParseRootChildren(reader, &sets, &lsdtbl);
                 LevelScript reslvlscr( m_curfilebasename, 
-                                     std::move(ParseSets(parentn)),
-                                     std::move(ParseLSD (parentn)));
+                                     std::move(sets),
+                                     std::move(lsdtbl));
                 if(m_preport)
                     m_preport->InsertSuccess(m_curfilebasename);
                 return std::move(reslvlscr);
@@ -1966,6 +2136,12 @@ namespace pmd2
                     m_preport->InsertError( m_curfilebasename, e.getFileOffset(), e.what() );
                 rethrow_exception(current_exception());
             }
+            catch( const utils::XMLStreamError & e )
+            {
+                if(m_preport)
+                    m_preport->InsertError( m_curfilebasename, e.Offset(), e.what() );
+                rethrow_exception(current_exception());
+            }
             catch(...)
             {
                 //If this happens, its not the compiler's problem
@@ -2015,6 +2191,12 @@ namespace pmd2
                     m_preport->InsertError( m_curfilebasename, e.getFileOffset(), e.what() );
                 rethrow_exception(current_exception());
             }
+            catch( const utils::XMLStreamError & e )
+            {
+                if(m_preport)
+                    m_preport->InsertError( m_curfilebasename, e.Offset(), e.what() );
+                rethrow_exception(current_exception());
+            }
             catch(...)
             {
                 //If this happens, its not the compiler's problem
@@ -2026,17 +2208,18 @@ namespace pmd2
 
         /*
             HandleLoadXMLDoc
-                Load a xml document through pugixml and handle exceptions and dealing with game version the file is for!
-                Returns the specified root node.
+                Load a xml file into the reader and handle exceptions and dealing with game version the file is for!
+                Leaves the reader on the start tag of the root element.
+
+                The file is read in a single pass afterwards, without building a document for the whole file.
+                Only the elements the parsers need to look at as a whole are loaded, one at a time, through LoadFragment.
 
                 - parentdirname: relevant when importing subfiles. Because most subfiles have similar names between levels. So the level name (parent dir name) is added to the name
                                  so it can be differentiated from the other compiled files with the same name!
         */
-        xml_node HandleLoadXMLDoc( xml_document & doc, const std::string & fpath, const std::string & rootnodename, const std::string * parentdirname = nullptr)
+        void HandleLoadXMLDoc( utils::XMLStreamReader & reader, const std::string & fpath, const std::string & rootnodename, const std::string * parentdirname = nullptr)
         {
             using namespace scriptXML;
-            //xml_document        doc;
-            xml_parse_result    parseres;
             stringstream        sstrcurfname;
 
             if(parentdirname)
@@ -2052,28 +2235,23 @@ namespace pmd2
 
             try
             {
-                //HandleParsingError( doc.load_file(file.c_str(), pugi::parse_default | pugi::parse_ws_pcdata_single), file);
-                parseres = doc.load_file(fpath.c_str(), XML_ParseSettings);
+                reader.LoadFile(fpath);
             }
-            catch(const std::exception & ) //This is in case of a fatal error, when pugi throws an exception
-            {
-                if(m_preport)
-                    m_preport->InsertError( m_curfilebasename, parseres.offset, parseres.description() );
-                throw_with_nested(std::runtime_error("GameScriptsXMLParser::HandleLoadXMLDoc() : Fatal error loading file! Pugixml returned an exception!!"));
-            }
-
-            if(!parseres)
+            catch(const std::exception & e)
             {
                 if(m_preport)
-                    m_preport->InsertError( m_curfilebasename, parseres.offset, parseres.description() );
-                throw std::runtime_error("GameScriptsXMLParser::HandleLoadXMLDoc() : Error while parsing XML.. (offset: " + std::to_string(parseres.offset) + ") " + parseres.description() );
+                    m_preport->InsertError( m_curfilebasename, 0, e.what() );
+                throw_with_nested(std::runtime_error("GameScriptsXMLParser::HandleLoadXMLDoc() : Fatal error loading file!!"));
             }
 
-            xml_node        parentn     = doc.child(rootnodename.c_str());
-            //xml_attribute   xversion    = doc.attribute(ATTR_GVersion.c_str());
-            //xml_attribute   xregion     = doc.attribute(ATTR_GRegion.c_str());
-            eGameVersion    vertmp      ;//= StrToGameVersion(xversion.value());
-            eGameRegion     regtmp      ;//= StrToGameRegion (xregion.value());
+            //Load only the root's start tag, to read the version attributes. Malformed markup is reported by the caller.
+            xml_document    rootdoc;
+            xml_node        parentn;
+            if( reader.Next() == utils::XMLStreamReader::eToken::StartElement && *reader.Name() == rootnodename )
+                parentn = LoadXMLFragment(rootdoc, reader.Offset(), reader.StartTagAsEmptyElement());
+            const size_t    rootoffset  = reader.Offset();
+            eGameVersion    vertmp      ;
+            eGameRegion     regtmp      ;
             string toolsetver;
             GetPPMDU_RootNodeXMLAttributes( parentn, vertmp, regtmp, toolsetver);
 
@@ -2085,7 +2263,7 @@ namespace pmd2
                 stringstream sstr;
                 sstr << "GameScriptsXMLParser::HandleLoadXMLDoc() : XML data was exported with a different version of the library! Version " <<PMD2ToolsetVersionStruct <<" can't parse version \"" <<toolsetver <<"\"!";
                 if(m_preport)
-                    m_preport->InsertError(m_curfilebasename, parentn.offset_debug(), sstr.str());
+                    m_preport->InsertError(m_curfilebasename, rootoffset, sstr.str());
                 throw std::runtime_error(sstr.str());
             }
 
@@ -2095,7 +2273,7 @@ namespace pmd2
                 stringstream sstr;
                 sstr << "GameScriptsXMLParser::HandleLoadXMLDoc() : Invalid game version or region specified in root node of file \"" <<fpath <<"\"!";
                 if(m_preport)
-                    m_preport->InsertError(m_curfilebasename, parentn.offset_debug(), sstr.str());
+                    m_preport->InsertError(m_curfilebasename, rootoffset, sstr.str());
                 throw std::runtime_error(sstr.str());
             }
             
@@ -2106,14 +2284,13 @@ namespace pmd2
                 stringstream sstr;
                 sstr << "GameScriptsXMLParser::HandleLoadXMLDoc() : Game version or region specified in root node of file \"" <<fpath <<"\" doesn't match the other files!";
                 if(m_preport)
-                    m_preport->InsertError(m_curfilebasename, parentn.offset_debug(), sstr.str());
+                    m_preport->InsertError(m_curfilebasename, rootoffset, sstr.str());
                 throw std::runtime_error(sstr.str());
             }
 
-            //Setup and return
+            //Setup
             m_out_gver = vertmp;
             m_out_reg  = regtmp;
-            return std::move(parentn);
         }
 
         /*
@@ -2125,12 +2302,12 @@ namespace pmd2
             if(m_preport)
                 m_preport->SetNbExpected( m_preport->GetNbExpected() + 1 );
 
-            xml_document doc;
-            xml_node     rootn = HandleLoadXMLDoc(doc, fpath, ROOT_ScriptSet, &lvlname);
+            utils::XMLStreamReader reader;
+            HandleLoadXMLDoc(reader, fpath, ROOT_ScriptSet, &lvlname);
 
             if( utils::LibWide().isLogOn() )
                 slog() << "#Parsing Script Set file " <<m_curfilebasename <<".xml \n";
-            ParseSets(rootn, destsets);
+            ParseRootChildren(reader, &destsets, nullptr);
 
             if(m_preport)
                 m_preport->InsertSuccess(m_curfilebasename);
@@ -2145,65 +2322,100 @@ namespace pmd2
             if(m_preport)
                 m_preport->SetNbExpected( m_preport->GetNbExpected() + 1 );
 
-            xml_document doc;
-            xml_node     rootn = HandleLoadXMLDoc(doc, fpath, ROOT_LSD, &lvlname);
+            utils::XMLStreamReader reader;
+            HandleLoadXMLDoc(reader, fpath, ROOT_LSD, &lvlname);
 
             if( utils::LibWide().isLogOn() )
                 slog() << "#Parsing LSD file " <<m_curfilebasename <<".xml \n";
-            destlsd = ParseLSD(rootn);
+            destlsd.clear();
+            ParseRootChildren(reader, nullptr, &destlsd);
 
             if(m_preport)
                 m_preport->InsertSuccess(m_curfilebasename);
         }
 
         /*
+            LoadFragment
+                Loads an element copied out of the file being read, and returns its node.
+                The node stays valid until the next fragment is loaded.
+        */
+        inline xml_node LoadFragment( size_t fileoffset, const std::string & text )
+        {
+            m_fragoffset = static_cast<ptrdiff_t>(fileoffset);
+            return LoadXMLFragment( m_fragdoc, fileoffset, text );
+        }
+
+        /*
+            ParseRootChildren
+                Parse the elements within the root element the reader is on.
+                Script sets are appended to "psets", and the first LSD table is parsed into "plsd".
+                Either can be null when the file isn't expected to contain them.
         */
-        void ParseSets( xml_node & parentn, LevelScript::scriptsets_t & sets )
+        void ParseRootChildren( utils::XMLStreamReader & reader, LevelScript::scriptsets_t * psets, LevelScript::lsdtbl_t * plsd )
         {
             using namespace scriptXML;
-            for( auto & curset : parentn.children(NODE_ScriptSet.c_str()) )
-            {
-                xml_attribute xname = curset.attribute(ATTR_GrpName.c_str());
-                if( !xname )
-                {
-                    if(utils::LibWide().isLogOn())
-                        slog()<<" ->Skipped unnamed set!\n";
-                    if(m_preport)
-                        m_preport->InsertWarning( m_curfilebasename, curset.offset_debug(), "Skipped script set with no name!" );
-                    continue;
-                }
-                else if( utils::LibWide().isLogOn() )
-                    slog()<<" ->Parsing script set \"" <<xname.value() <<"\"\n";
+            const utils::XMLStreamReader::name_t pset    = reader.Intern(NODE_ScriptSet);
+            const utils::XMLStreamReader::name_t plsdtbl = reader.Intern(NODE_LSDTbl);
+            bool bfoundlsd = false;
 
-                LevelScript::scriptsets_t::value_type outset( xname.value() );
-                for( auto & comp : curset )
+            while( reader.Next() == utils::XMLStreamReader::eToken::StartElement )
+            {
+                if( psets && reader.Name() == pset )
+                    ParseSet(reader, *psets);
+                else if( plsd && !bfoundlsd && reader.Name() == plsdtbl )
                 {
-                    if( comp.name() == NODE_ScriptSeq )
-                        HandleSequence( comp, outset );
-                    else if( comp.name() == NODE_ScriptData )
-                        HandleData(comp, outset );
+                    bfoundlsd = true;
+                    const size_t lsdoffset = reader.Offset();
+                    (*plsd) = ParseLSD( LoadFragment(lsdoffset, reader.ReadElementText()) );
                 }
-                sets.push_back(std::forward<LevelScript::scriptsets_t::value_type>(outset));
+                else
+                    reader.SkipElement();
             }
         }
 
         /*
         */
-        inline LevelScript::scriptsets_t ParseSets( xml_node & parentn )
+        void ParseSet( utils::XMLStreamReader & reader, LevelScript::scriptsets_t & sets )
         {
             using namespace scriptXML;
-            LevelScript::scriptsets_t sets;
-            ParseSets(parentn, sets);
-            return std::move(sets);
+            const std::string * pname = reader.Attribute(ATTR_GrpName);
+            if( !pname )
+            {
+                if(utils::LibWide().isLogOn())
+                    slog()<<" ->Skipped unnamed set!\n";
+                if(m_preport)
+                    m_preport->InsertWarning( m_curfilebasename, reader.Offset(), "Skipped script set with no name!" );
+                reader.SkipElement();
+                return;
+            }
+            else if( utils::LibWide().isLogOn() )
+                slog()<<" ->Parsing script set \"" <<*pname <<"\"\n";
+
+            const utils::XMLStreamReader::name_t pseq  = reader.Intern(NODE_ScriptSeq);
+            const utils::XMLStreamReader::name_t pdata = reader.Intern(NODE_ScriptData);
+            LevelScript::scriptsets_t::value_type outset( *pname );
+            while( reader.Next() == utils::XMLStreamReader::eToken::StartElement )
+            {
+                if( reader.Name() == pseq )
+                    HandleSequence( reader, outset );
+                else if( reader.Name() == pdata )
+                {
+                    const size_t datoffset = reader.Offset();
+                    HandleData( LoadFragment(datoffset, reader.ReadElementText()), outset );
+                }
+                else
+                    reader.SkipElement();
+            }
+            sets.push_back(std::forward<LevelScript::scriptsets_t::value_type>(outset));
         }
 
         /*
+            Parse the entries of a LSD table node.
         */
-        LevelScript::lsdtbl_t ParseLSD( xml_node & parentn )
+        LevelScript::lsdtbl_t ParseLSD( const xml_node & xlsd )
         {
             using namespace scriptXML;
             LevelScript::lsdtbl_t table;
-            xml_node xlsd = parentn.child(NODE_LSDTbl.c_str());
 
             for( auto & lsde : xlsd.children(NODE_GrpNameRef.c_str()) )
             {
@@ -2225,22 +2437,24 @@ namespace pmd2
         /*
             Returns if the sequence was unionall.ssb
         */
-        void HandleSequence(xml_node & seqn, LevelScript::scriptsets_t::value_type & destgrp)
+        void HandleSequence(utils::XMLStreamReader & reader, LevelScript::scriptsets_t::value_type & destgrp)
         {
             using namespace scriptXML;
-            xml_attribute xname = seqn.attribute( ATTR_ScrSeqName.c_str() );
-            string        name  = xname.value();
+            const std::string * pname = reader.Attribute( ATTR_ScrSeqName );
 
-            if( !xname )
+            if( !pname )
             {
                 if( utils::LibWide().isLogOn() )
                     slog() << "\t*Unamed sequence, skipping!\n";
                 if(m_preport)
-                    m_preport->InsertWarning( m_curfilebasename, seqn.offset_debug(), "Skipped script with no name!" );
+                    m_preport->InsertWarning( m_curfilebasename, reader.Offset(), "Skipped script with no name!" );
+                reader.SkipElement();
                 return;
             }
             else if( utils::LibWide().isLogOn() )
-                slog() << "\t*Parsing " <<name <<", type : ssb\n";
+                slog() << "\t*Parsing " <<*pname <<", type : ssb\n";
+
+            string name = *pname; //Copy it, since the reader moves on to the next tags while parsing
 
             //If we're unionall.ssb, change the type accordingly
             if( name == ScriptPrefix_unionall )
@@ -2249,14 +2463,14 @@ namespace pmd2
             CompilerReport::compileresult * prepres = nullptr;
             if(m_preport)
                 prepres = &(*m_preport)[m_curfilebasename];
-            destgrp.Sequences().emplace( std::forward<string>(name), 
-                                         std::forward<Script>( SSBXMLParser(m_out_gver, m_out_reg, m_gconf, prepres)(seqn) ) );
+            Script parsed = SSBXMLParser(m_out_gver, m_out_reg, m_gconf, prepres)(reader);
+            destgrp.Sequences().emplace( std::forward<string>(name), std::forward<Script>(parsed) );
         }
 
         /*
             Return a type based on the kind of data it is
         */
-        void HandleData(xml_node & datan, LevelScript::scriptsets_t::value_type & destgrp)
+        void HandleData(xml_node datan, LevelScript::scriptsets_t::value_type & destgrp)
         {
             using namespace scriptXML;
             xml_attribute    xname = datan.attribute( ATTR_ScrDatName.c_str() );
@@ -2266,7 +2480,7 @@ namespace pmd2
                 if( utils::LibWide().isLogOn() )
                     slog() << "\t*Untyped script data, skipping!\n";
                 if(m_preport)
-                    m_preport->InsertWarning( m_curfilebasename, datan.offset_debug(), "Skipped script data with no type!" );
+                    m_preport->InsertWarning( m_curfilebasename, m_fragoffset + datan.offset_debug(), "Skipped script data with no type!" );
                 return;
             }
             eScrDataTy scrty = StrToScriptDataType(xtype.value());
@@ -2276,7 +2490,7 @@ namespace pmd2
                 if( utils::LibWide().isLogOn() )
                     slog() << "\t*Unamed script data, skipping!\n";
                 if(m_preport)
-                    m_preport->InsertWarning( m_curfilebasename, datan.offset_debug(), "Skipped script data with no name!" );
+                    m_preport->InsertWarning( m_curfilebasename, m_fragoffset + datan.offset_debug(), "Skipped script data with no name!" );
                 return;
             }
             else if( utils::LibWide().isLogOn() )
@@ -2305,7 +2519,7 @@ namespace pmd2
                     if( utils::LibWide().isLogOn() )
                         slog() << "\t*Couldn't determine script type. Skipping!\n";
                     if(m_preport)
-                        m_preport->InsertWarning( m_curfilebasename, datan.offset_debug(), "Skipped script data. Couldn't determine type \"" + string(xtype.value()) + "\"!" );
+                        m_preport->InsertWarning( m_curfilebasename, m_fragoffset + datan.offset_debug(), "Skipped script data. Couldn't determine type \"" + string(xtype.value()) + "\"!" );
                     return;
                 }
             };
@@ -2313,7 +2527,7 @@ namespace pmd2
             CompilerReport::compileresult * prepres = nullptr;
             if(m_preport)
                 prepres = &(*m_preport)[m_curfilebasename];
-            destgrp.SetData( SSDataXMLParser(m_gconf,prepres)(datan) );
+            destgrp.SetData( SSDataXMLParser(m_gconf,prepres,m_fragoffset)(datan) );
         }
 
     private:
@@ -2322,6 +2536,8 @@ namespace pmd2
         const ConfigLoader  & m_gconf;
         CompilerReport      * m_preport;
         std::string           m_curfilebasename;
+        xml_document          m_fragdoc;        //Holds the element currently parsed as a whole
+        ptrdiff_t             m_fragoffset;     //Offset in the current file of the element in m_fragdoc
     };
 
 
@@ -3227,7 +3443,7 @@ namespace pmd2
     {
     public:
         GameScriptsXMLWriter( const LevelScript & set, const ConfigLoader & conf )
-            :m_scrset(set), m_gconf(conf), m_xmlflags(pugi::format_default)
+            :m_scrset(set), m_gconf(conf), m_xmlflags(pugi::format_default), m_outhash(utils::FNV1aOffsetBasis)
         {}
 
         /*
@@ -3235,6 +3451,7 @@ namespace pmd2
         */
         inline void Write(const std::string & destdir, const scriptprocoptions & options )
         {
+            m_outhash = utils::FNV1aOffsetBasis;
             if(options.basdir)
                 WriteAsDirectory(destdir, options);
             else
@@ -3264,10 +3481,16 @@ namespace pmd2
             m_xmlflags = (m_options.bescapepcdata)? pugi::format_default  :
                                         pugi::format_indent | pugi::format_no_escapes;
             //Write doc
-            if( ! doc.save_file( sstrfname.str().c_str(), "    "/*"\t"*/, m_xmlflags, pugi::encoding_utf8 ) )
-                throw std::runtime_error("GameScriptsXMLWriter::Write(): PugiXML can't write xml file " + sstrfname.str());
+            SaveDoc( doc, sstrfname.str(), "GameScriptsXMLWriter::Write()" );
         }
 
+        /*
+            OutputHash
+                The hash of the files written by the last call to Write(), as HashLevelFiles() would compute it
+                once they're on disk. The serialized files are hashed as they're handed over to be written.
+        */
+        inline uint64_t OutputHash()const { return m_outhash; }
+
         /*
             WriteAsDirectory
                 Write the content of the level's script data to a directory with sub-files instead of a single XML file.
@@ -3282,14 +3505,42 @@ namespace pmd2
             utils::DoCreateDirectory(newdestdir);
             m_xmlflags = (m_options.bescapepcdata)? pugi::format_default  :
                            pugi::format_indent | pugi::format_no_escapes;
-            //Write stuff
-            WriteLSDAsFile(newdestdir);
-
+            //Files are written in name order, so the output hash is chained in the same order HashLevelFiles() uses
+            vector<pair<string, const ScriptSet*>> files; //File name, set to write, or null for the LSD table
+            if( !m_scrset.LSDTable().empty() )
+                files.push_back( make_pair( FNAME_LSD + ".xml", nullptr ) );
             for( const auto & entry : m_scrset.Components() )
-                WriteSetAsFile(entry, newdestdir);
+                files.push_back( make_pair( SetFileName(entry), &entry ) );
+            std::sort( files.begin(), files.end(), []( const pair<string, const ScriptSet*> & a, const pair<string, const ScriptSet*> & b ){ return a.first < b.first; } );
+
+            for( const auto & file : files )
+            {
+                if( file.second )
+                    WriteSetAsFile(*file.second, newdestdir);
+                else
+                    WriteLSDAsFile(newdestdir);
+            }
         }
 
     private:
+        /*
+            SaveDoc
+                Serializes the document, hands it over to be written, and adds it to the output hash.
+        */
+        void SaveDoc( const xml_document & doc, const std::string & fpath, const char * caller )
+        {
+            if( ! SaveDocumentWithBuffer( doc, fpath, m_xmlbuf, "    ", m_xmlflags, pugi::encoding_utf8 ) )
+                throw std::runtime_error(std::string(caller) + ": PugiXML can't write xml file " + fpath);
+            m_outhash = HashLevelFileData( Poco::Path(fpath).getFileName(), m_xmlbuf.data(), m_xmlbuf.size(), m_outhash );
+        }
+
+        static std::string SetFileName( const ScriptSet & set )
+        {
+            if( set.Data() )
+                return set.Data()->Name() + ".xml";
+            else
+                return set.Identifier() + ".xml";
+        }
 
         /*
             WriteSetAsFile
@@ -3303,21 +3554,14 @@ namespace pmd2
             xml_node     xroot = doc.append_child( ROOT_ScriptSet.c_str() );
             stringstream sstrfname;
 
-            sstrfname <<utils::TryAppendSlash(destdir);
-            //string name;
-            if( set.Data() )
-                sstrfname <<set.Data()->Name();
-            else
-                sstrfname <<set.Identifier();
+            sstrfname <<utils::TryAppendSlash(destdir) <<SetFileName(set);
             //std::transform( name.begin(), name.end(), std::ostream_iterator<char>(sstrfname), std::bind(std::tolower<char>, std::placeholders::_1, std::cref(std::locale::classic()) ) );
-            sstrfname <<".xml";
 
             SetPPMDU_RootNodeXMLAttributes(xroot, m_gconf.GetGameVersion().version, m_gconf.GetGameVersion().region);
             WriteSet(xroot, set);
 
             //Write doc
-            if( ! doc.save_file( sstrfname.str().c_str(), "    ", m_xmlflags, pugi::encoding_utf8 ) )
-                throw std::runtime_error("GameScriptsXMLWriter::WriteSetAsFile(): PugiXML can't write xml file " + sstrfname.str());
+            SaveDoc( doc, sstrfname.str(), "GameScriptsXMLWriter::WriteSetAsFile()" );
         }
 
         /*
@@ -3340,8 +3584,7 @@ namespace pmd2
             WriteLSDTable(xroot);
 
             //Write doc
-            if( ! doc.save_file( sstrfname.str().c_str(), "    ", m_xmlflags, pugi::encoding_utf8 ) )
-                throw std::runtime_error("GameScriptsXMLWriter::WriteLSDAsFile(): PugiXML can't write xml file " + sstrfname.str());
+            SaveDoc( doc, sstrfname.str(), "GameScriptsXMLWriter::WriteLSDAsFile()" );
         }
 
         /*
@@ -3439,15 +3682,45 @@ namespace pmd2
         const ConfigLoader      & m_gconf;
         scriptprocoptions         m_options;
         unsigned int              m_xmlflags;
+        std::string               m_xmlbuf;     //Serialized documents are built in there, so its capacity is reused from one set to the next
+        uint64_t                  m_outhash;    //Hash of the files written so far, chained in the order they were written
     };
 
 //==============================================================================
 //  GameScripts
 //==============================================================================
+    /*
+        ScriptSettingsHash
+            Hash of everything, besides a level's own files, that changes the result of exporting or importing it.
+            Used to tell whether a script manifest is still valid.
+    */
+    uint64_t ScriptSettingsHash( const ConfigLoader & gconf, const scriptprocoptions & options, bool bimport )
+    {
+        const string  toolver = static_cast<std::string>(PMD2ToolsetVersionStruct);
+        const uint8_t flags[] = 
+        {
+            static_cast<uint8_t>(bimport),
+            static_cast<uint8_t>(options.bescapepcdata),
+            static_cast<uint8_t>(options.bnodeisinst),
+            static_cast<uint8_t>(options.bmarkoffsets),
+            static_cast<uint8_t>(options.bscriptdebug),
+            static_cast<uint8_t>(options.basdir),
+            static_cast<uint8_t>(gconf.GetGameVersion().version),
+            static_cast<uint8_t>(gconf.GetGameVersion().region),
+        };
+        const uint64_t confighash = HashLevelFiles( gconf.GetConfigFilePath(), false );
+        uint64_t       hash       = utils::HashFNV1a( toolver.data(), toolver.size() );
+        hash = utils::HashFNV1a( flags,       sizeof(flags),      hash );
+        hash = utils::HashFNV1a( &confighash, sizeof(confighash), hash );
+        return hash;
+    }
+
     /*
         RunLevelXMLImport
             Helper for importing script data from XML.
             Is used in packaged tasks to be handled by the thread pool.
+            If "pmanifest" isn't null, the level is skipped when its XML and the level directory it'd be written to
+            didn't change since the last import.
     */
     //bool RunLevelXMLImport( const ScrSetLoader & ldr, string fname, eGameRegion reg, eGameVersion ver, atomic<uint32_t> & completed )
     bool RunLevelXMLImport( GameScripts      & gs, 
@@ -3455,8 +3728,24 @@ namespace pmd2
                             string             dest, 
                             atomic<uint32_t> & completed,
                             CompilerReport   & reporter,
-                            const scriptprocoptions & options)
+                            const scriptprocoptions & options,
+                            ScriptBuildManifest     * pmanifest,
+                            atomic<uint32_t>        & skipped )
     {
+        const string levelname = Poco::Path(fname).getBaseName();
+        uint64_t     inputhash = 0;
+        if( pmanifest )
+        {
+            inputhash = HashLevelFiles( fname, false );
+            if( pmanifest->IsUpToDate( levelname, inputhash, HashLevelFiles( dest, true ) ) )
+            {
+                UTILS_LOG_DEBUG("##### Skipping unchanged {} #####\n", fname);
+                ++skipped;
+                ++completed;
+                return true;
+            }
+        }
+
         if( utils::LibWide().isLogOn() )
             slog() <<"##### Importing " << fname <<" #####\n";
         try
@@ -3466,6 +3755,8 @@ namespace pmd2
             gs.WriteScriptSet( std::move( GameScriptsXMLParser(tempregion,tempversion, gs.GetConfig()).Parse(fname, options,&reporter) ) );
             if( tempregion != gs.Region() || tempversion != gs.Version() )
                 throw std::runtime_error("GameScripts::ImportXML(): Event " + fname + " from the wrong region or game version was loaded!! Ensure the version and region attributes are set properly!!");
+            if( pmanifest )
+                pmanifest->Set( levelname, inputhash, HashLevelFiles( dest, true ) );
         }
         catch(const std::exception & e)
         {
@@ -3486,18 +3777,41 @@ namespace pmd2
         RunLevelXMLExport
             Helper for exporting script data as XML.
             Is used in packaged tasks to be handled by the thread pool.
+            If "pmanifest" isn't null, the level is skipped when its script files and the XML it'd be written to
+            didn't change since the last export.
     */
     bool RunLevelXMLExport( const ScrSetLoader      & entry, 
                             const string            & dir, 
                             const ConfigLoader      & gs, 
                             const scriptprocoptions & options,
-                            atomic<uint32_t>        & completed )
+                            atomic<uint32_t>        & completed,
+                            ScriptBuildManifest     * pmanifest,
+                            atomic<uint32_t>        & skipped )
     {
+        const string levelname = utils::GetBaseNameOnly(entry.path());
+        const string outpath   = utils::TryAppendSlash(dir) + levelname + (options.basdir? "" : ".xml");
+        uint64_t     inputhash = 0;
+        if( pmanifest )
+        {
+            inputhash = HashLevelFiles( entry.path(), true );
+            if( pmanifest->IsUpToDate( levelname, inputhash, HashLevelFiles( outpath, false ) ) )
+            {
+                UTILS_LOG_DEBUG("##### Skipping unchanged {} #####\n", entry.path());
+                ++skipped;
+                ++completed;
+                return true;
+            }
+        }
+
         if( utils::LibWide().isLogOn() )
             slog() <<"##### Exporting " <<entry.path() <<" #####\n";
         try
         {
-            GameScriptsXMLWriter(entry(), gs).Write(dir, options);
+            const LevelScript    level = entry();
+            GameScriptsXMLWriter writer(level, gs);
+            writer.Write(dir, options);
+            if( pmanifest )
+                pmanifest->Set( levelname, inputhash, writer.OutputHash() );
         }
         catch(const std::exception & e)
         {
@@ -3546,8 +3860,17 @@ namespace pmd2
         eGameVersion                 tempversion = eGameVersion::Invalid;
         atomic_bool                  shouldUpdtProgress = true;
         atomic<uint32_t>             completed = 0;
+        atomic<uint32_t>             skipped   = 0;
         future<void>                 updatethread;
         CompilerReport               reporter;
+        const string                 manifestpath = utils::TryAppendSlash(dir) + ScriptBuildManifest::ImportFileName;
+        ScriptBuildManifest          manifest( ScriptSettingsHash( out_dest.GetConfig(), options, true ) );
+        ScriptBuildManifest        * pmanifest = nullptr;
+        if( options.bincremental )
+        {
+            manifest.Load(manifestpath);
+            pmanifest = &manifest;
+        }
         //Grab our version and region from the 
         if(utils::LibWide().ShouldDisplayProgress())
             cout<<"<*>- Loading COMON.xml..\n";
@@ -3604,7 +3927,9 @@ namespace pmd2
                                                                          destination.toString(),
                                                                          std::ref(completed),
                                                                          std::ref(reporter),
-                                                                         std::cref(options)) ) );
+                                                                         std::cref(options),
+                                                                         pmanifest,
+                                                                         std::ref(skipped)) ) );
                     if(utils::LibWide().isLogOn())
                         slog() << "\t+ " <<dirit.path().getBaseName() <<"\n";
                     ++cntdir;
@@ -3629,7 +3954,9 @@ namespace pmd2
                                                                          destination.toString(),
                                                                          std::ref(completed),
                                                                          std::ref(reporter),
-                                                                         std::cref(options)) ) );
+                                                                         std::cref(options),
+                                                                         pmanifest,
+                                                                         std::ref(skipped)) ) );
                     if(utils::LibWide().isLogOn())
                         slog() << "\t+ " <<dirit.path().getFileName() <<"\n";
                     ++cntdir;
@@ -3667,12 +3994,14 @@ namespace pmd2
                 updatethread.get();
             if(utils::LibWide().ShouldDisplayProgress())
                 cout<<"\r100%"; //Can't be bothered to make another drawing update
+            if( pmanifest )
+                pmanifest->Write(manifestpath);
 
             ofstream outputresult( utils::MakeAbsolutePath( utils::LibWide().StringValue(ScriptCompilerReportFname), utils::LibWide().StringValue(utils::lwData::eBasicValues::ProgramLogDir) ) );
             outputresult.exceptions(std::ios::badbit);
 
             if( !options.basdir ) //We need to specify the nb when imported as XML files
-                reporter.SetNbExpected( cntdir + 1 ); //Add one for the unionall.ssb script!
+                reporter.SetNbExpected( cntdir + 1 - skipped ); //Add one for the unionall.ssb script! Skipped levels aren't compiled.
             reporter.PrintErrorReport(outputresult); 
         }
         catch(...)
@@ -3680,11 +4009,25 @@ namespace pmd2
             shouldUpdtProgress = false;
             if(updatethread.valid())
                 updatethread.get();
+            //Keep track of the levels that made it through, without hiding the actual error
+            if( pmanifest )
+            {
+                try
+                {
+                    pmanifest->Write(manifestpath);
+                }
+                catch(...)
+                {}
+            }
             std::rethrow_exception( std::current_exception() );
         }
 
         if(utils::LibWide().ShouldDisplayProgress())
+        {
             cout<<"\n";
+            if( skipped != 0 )
+                cout<<"<*>- " <<skipped <<" level(s) unchanged since the last import, skipped.\n";
+        }
         if(utils::LibWide().isLogOn())
             slog()<<"All import tasks completed!\n";
     }
@@ -3705,8 +4048,17 @@ namespace pmd2
         atomic_bool                  shouldUpdtProgress = true;
         future<void>                 updtProgress;
         atomic<uint32_t>             completed = 0;
+        atomic<uint32_t>             skipped   = 0;
         //multitask::CMultiTaskHandler taskhandler;
         utils::AsyncTaskHandler      taskhandler;
+        const string                 manifestpath = utils::TryAppendSlash(dir) + ScriptBuildManifest::ExportFileName;
+        ScriptBuildManifest          manifest( ScriptSettingsHash( gs.GetConfig(), options, false ) );
+        ScriptBuildManifest        * pmanifest = nullptr;
+        if( options.bincremental )
+        {
+            manifest.Load(manifestpath);
+            pmanifest = &manifest;
+        }
         if(utils::LibWide().isLogOn())
             slog() << "<*>- Listing level directories to export..\n";
         //Export everything else
@@ -3717,7 +4069,9 @@ namespace pmd2
                                                                  std::cref(dir), 
                                                                  std::cref(gs.GetConfig()),
                                                                  std::cref(options),
-                                                                 std::ref(completed) ) ) );
+                                                                 std::ref(completed),
+                                                                 pmanifest,
+                                                                 std::ref(skipped) ) ) );
             if(utils::LibWide().isLogOn())
                 slog() << "\t+ " << utils::GetBaseNameOnly(entry.first) <<"\n";
         }
@@ -3746,17 +4100,33 @@ namespace pmd2
                 updtProgress.get();
             if(utils::LibWide().ShouldDisplayProgress())
                 cout<<"\r100%"; //Can't be bothered to make another drawing update
+            if( pmanifest )
+                pmanifest->Write(manifestpath);
         }
         catch(...)
         {
             shouldUpdtProgress = false;
             if( updtProgress.valid() )
                 updtProgress.get();
+            //Keep track of the levels that made it through, without hiding the actual error
+            if( pmanifest )
+            {
+                try
+                {
+                    pmanifest->Write(manifestpath);
+                }
+                catch(...)
+                {}
+            }
             std::rethrow_exception( std::current_exception() );
         }
 
         if(utils::LibWide().ShouldDisplayProgress())
+        {
             cout<<"\n";
+            if( skipped != 0 )
+                cout<<"<*>- " <<skipped <<" level(s) unchanged since the last export, skipped.\n";
+        }
         if(utils::LibWide().isLogOn())
             slog()<<"All export tasks completed!\n";
     }
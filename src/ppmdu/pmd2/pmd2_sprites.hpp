@@ -18,6 +18,7 @@ No crappyrights. All wrong reversed!
 #include <ppmdu/pmd2/pmd2_image_formats.hpp>
 #include <ppmdu/pmd2/pmd2_filetypes.hpp>
 #include <ppmdu/fmts/sir0.hpp>
+#include <utils/struct_layout.hpp>
 #include <utility>
 
 namespace pmd2{ namespace graphics
@@ -56,34 +57,31 @@ namespace pmd2{ namespace graphics
         std::string toString()const;
 
 
+        typedef utils::StructLayout<sprite_info_data,
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, ptr_ptrstable_e),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, ptr_offset_f),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, ptr_offset_g),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, nb_blocks_in_offset_g),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, nb_entries_offset_e),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, unknown1),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, unknown2),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, unknown3),
+                                    UTILS_LAYOUT_FIELD(sprite_info_data, unknown4)> layout_t;
+        static_assert( layout_t::Size == DATA_LEN, "sprite_info_data: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( ptr_ptrstable_e,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( ptr_offset_f,          itwriteto );
-            itwriteto = utils::WriteIntToBytes( ptr_offset_g,          itwriteto );
-            itwriteto = utils::WriteIntToBytes( nb_blocks_in_offset_g, itwriteto );
-            itwriteto = utils::WriteIntToBytes( nb_entries_offset_e,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown1,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown2,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown3,              itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown4,              itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<DATA_LEN>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( ptr_ptrstable_e,       itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( ptr_offset_f,          itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( ptr_offset_g,          itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( nb_blocks_in_offset_g, itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( nb_entries_offset_e,   itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown1,              itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown2,              itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown3,              itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown4,              itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<DATA_LEN>( *this, itReadfrom, itPastEnd );
         }
 
     };
@@ -108,28 +106,28 @@ namespace pmd2{ namespace graphics
         unsigned int size()const{return DATA_LEN;}
         std::string toString()const;
 
+        typedef utils::StructLayout<sprite_frame_data,
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, ptr_frm_ptrs_table),
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, ptrPal),
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, unkn_1),
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, unkn_2),
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, unkn_3),
+                                    UTILS_LAYOUT_FIELD(sprite_frame_data, nbImgsTblPtr)> layout_t;
+        static_assert( layout_t::Size == DATA_LEN, "sprite_frame_data: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( ptr_frm_ptrs_table, itwriteto );
-            itwriteto = utils::WriteIntToBytes( ptrPal,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unkn_1,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unkn_2,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( unkn_3,             itwriteto );
-            itwriteto = utils::WriteIntToBytes( nbImgsTblPtr,       itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<DATA_LEN>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( ptr_frm_ptrs_table, itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( ptrPal,             itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unkn_1,             itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unkn_2,             itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unkn_3,             itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( nbImgsTblPtr,       itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<DATA_LEN>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -153,24 +151,26 @@ namespace pmd2{ namespace graphics
         unsigned int size()const{return DATA_LEN;}
         std::string toString()const;
 
+        typedef utils::StructLayout<sprite_data_header,
+                                    UTILS_LAYOUT_FIELD(sprite_data_header, spr_ptr_info),
+                                    UTILS_LAYOUT_FIELD(sprite_data_header, spr_ptr_frames),
+                                    UTILS_LAYOUT_FIELD(sprite_data_header, unknown0),
+                                    UTILS_LAYOUT_FIELD(sprite_data_header, unknown1)> layout_t;
+        static_assert( layout_t::Size == DATA_LEN, "sprite_data_header: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( spr_ptr_info,   itwriteto );
-            itwriteto = utils::WriteIntToBytes( spr_ptr_frames, itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown0,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown1,       itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<DATA_LEN>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( spr_ptr_info,   itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes( spr_ptr_frames, itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes( unknown0,       itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes( unknown1,       itReadfrom, itPastEnd);
-            return itReadfrom;
+            return utils::ReadWithCursor<DATA_LEN>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -200,28 +200,28 @@ namespace pmd2{ namespace graphics
         //const uint8_t & operator[](unsigned int index)const;
         std::string toString(unsigned int indent=0)const;
 
+        typedef utils::StructLayout<datablock_i_entry,
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Unk0),
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Index),
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Val0),
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Val1),
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Val2),
+                                    UTILS_LAYOUT_FIELD(datablock_i_entry, Val3)> layout_t;
+        static_assert( layout_t::Size == MY_SIZE, "datablock_i_entry: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( Unk0,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( Index, itwriteto );
-            itwriteto = utils::WriteIntToBytes( Val0,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( Val1,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( Val2,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( Val3,  itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<MY_SIZE>( *this, itwriteto );
         }
 
         template<class _init>
-            _init ReadFromContainer( _init itReadfrom,  _init itPastEnd )
+            _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes (Unk0,  itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes (Index, itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes (Val0,  itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes (Val1,  itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes (Val2,  itReadfrom, itPastEnd);
-            itReadfrom = utils::ReadIntFromBytes (Val3,  itReadfrom, itPastEnd);
-            return itReadfrom;
+            return utils::ReadWithCursor<MY_SIZE>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -273,21 +273,24 @@ namespace pmd2{ namespace graphics
         unsigned int size()const{return MY_SIZE;}
         bool isNullEntry()const { return !ptrtoarray && !szofarray; }
 
+        typedef utils::StructLayout<datablock_g_entry,
+                                    UTILS_LAYOUT_FIELD(datablock_g_entry, ptrtoarray),
+                                    UTILS_LAYOUT_FIELD(datablock_g_entry, szofarray)> layout_t;
+        static_assert( layout_t::Size == MY_SIZE, "datablock_g_entry: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( ptrtoarray, itwriteto );
-            itwriteto = utils::WriteIntToBytes( szofarray,  itwriteto );
-
-            return itwriteto;
+            return utils::WriteWithWriter<MY_SIZE>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( ptrtoarray, itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( szofarray,  itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<MY_SIZE>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -313,28 +316,28 @@ namespace pmd2{ namespace graphics
         //uint8_t & operator[](unsigned int index);
         //const uint8_t & operator[](unsigned int index)const;
 
+        typedef utils::StructLayout<datablock_s_entry,
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, id),
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, val0),
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, val1),
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, val2),
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, val3),
+                                    UTILS_LAYOUT_FIELD(datablock_s_entry, endofentry)> layout_t;
+        static_assert( layout_t::Size == MY_SIZE, "datablock_s_entry: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( id,         itwriteto );
-            itwriteto = utils::WriteIntToBytes( val0,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( val1,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( val2,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( val3,       itwriteto );
-            itwriteto = utils::WriteIntToBytes( endofentry, itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<MY_SIZE>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( id,         itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( val0,       itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( val1,       itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( val2,       itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( val3,       itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( endofentry, itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<MY_SIZE>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -373,20 +376,24 @@ namespace pmd2{ namespace graphics
         std::string toString( unsigned int indent = 0 )const;
         void reset();
 
+        typedef utils::StructLayout<datablock_f_entry,
+                                    UTILS_LAYOUT_FIELD(datablock_f_entry, val0),
+                                    UTILS_LAYOUT_FIELD(datablock_f_entry, val1)> layout_t;
+        static_assert( layout_t::Size == MY_SIZE, "datablock_f_entry: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( val0,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( val1,  itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<MY_SIZE>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( val0, itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( val1, itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<MY_SIZE>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -416,28 +423,28 @@ namespace pmd2{ namespace graphics
         std::string     toString( unsigned int indent = 0 )const;
         void            reset(); //Set all values to 0
 
+        typedef utils::StructLayout<palette_fmtinf,
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, ptrpalbeg),
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, unknown0),
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, unknown1),
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, unknown2),
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, unknown3),
+                                    UTILS_LAYOUT_FIELD(palette_fmtinf, endofdata)> layout_t;
+        static_assert( layout_t::Size == MY_SIZE, "palette_fmtinf: Layout doesn't match the struct's size!" );
+
+        void Write( utils::ByteWriter & wr )const { layout_t::Write(wr, *this); }
+        void Read ( utils::ByteCursor & cur )     { layout_t::Read(cur, *this); }
+
         template<class _outit>
             _outit WriteToContainer( _outit itwriteto )const
         {
-            itwriteto = utils::WriteIntToBytes( ptrpalbeg, itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown0,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown1,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown2,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( unknown3,  itwriteto );
-            itwriteto = utils::WriteIntToBytes( endofdata, itwriteto );
-            return itwriteto;
+            return utils::WriteWithWriter<MY_SIZE>( *this, itwriteto );
         }
 
         template<class _init>
             _init ReadFromContainer( _init itReadfrom, _init itPastEnd )
         {
-            itReadfrom = utils::ReadIntFromBytes( ptrpalbeg, itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown0,  itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown1,  itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown2,  itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( unknown3,  itReadfrom, itPastEnd );
-            itReadfrom = utils::ReadIntFromBytes( endofdata, itReadfrom, itPastEnd );
-            return itReadfrom;
+            return utils::ReadWithCursor<MY_SIZE>( *this, itReadfrom, itPastEnd );
         }
 
         //std::vector<uint8_t>::iterator       WriteToContainer(  std::vector<uint8_t>::iterator       itwriteto )const;
@@ -333,6 +333,56 @@ namespace pmd2
         langtbl_t            m_languages;
     };
 
+//==================================================================================
+//  PendingStringEdits
+//==================================================================================
+    /****************************************************************************************
+            A list of strings to be put into a GameText later on.
+            Lets parsers running on several threads gather the text of an entry, while the
+            shared GameText is only modified afterwards, from a single thread.
+    ****************************************************************************************/
+    class PendingStringEdits
+    {
+    public:
+        struct strentry
+        {
+            eGameLanguages lang;
+            eStringBlocks  blk;
+            std::string    str;
+        };
+
+        inline void Push( eGameLanguages lang, eStringBlocks blk, std::string && str )
+        {
+            m_edits.push_back( strentry{ lang, blk, std::move(str) } );
+        }
+
+        inline bool   empty()const { return m_edits.empty(); }
+        inline size_t size()const  { return m_edits.size();  }
+
+        /*
+            Apply
+                Puts all the strings at "index" in their respective language and block.
+                Throws if a block doesn't contain the index. Languages that aren't loaded are skipped.
+        */
+        void Apply( GameText & gtext, size_t index )const
+        {
+            for( const auto & edit : m_edits )
+            {
+                auto itlang = gtext.GetStrings(edit.lang);
+                if( itlang == gtext.end() )
+                    continue;
+                std::string * pstr = itlang->second.GetStringIfBlockExists( edit.blk, index );
+                if(!pstr)
+                    throw std::runtime_error("PendingStringEdits::Apply(): Couldn't access string #" + std::to_string(index) + " in the " + 
+                                             StringBlocksNames[static_cast<unsigned int>(edit.blk)] + " string block!");
+                *pstr = edit.str;
+            }
+        }
+
+    private:
+        std::vector<strentry> m_edits;
+    };
+
 };
 
 #endif
\ No newline at end of file
@@ -15,8 +15,14 @@
 #include <utils/utility.hpp>
 #include <utils/utility.hpp>
 #include <utils/library_wide.hpp>
+#include <utils/poco_wrapper.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <Poco/Path.h>
+#include <Poco/File.h>
 #include <Poco/Exception.h>
+#include <iomanip>
+#include <set>
+#include <atomic>
 
 #include <utils/cmdline_util.hpp>
 using namespace utils::cmdl;
@@ -42,6 +48,10 @@ namespace ppx_compress
     static const string                          OPTION_COMPRESSION_LVL = "l";
     static const string                          OPTION_ZEALOUS         = "z";
     static const string                          OPTION_QUIET           = "q";
+    static const string                          OPTION_BATCH           = "batch";
+    static const string                          OPTION_FORMAT          = "f";
+    static const string                          OPTION_THREADS         = "th";
+    static const string                          OPTION_MAXMEM          = "mem";
     static const std::vector<optionparsing_t>    MY_OPTIONS     = 
     {{
         //Option to disable progress output
@@ -62,8 +72,35 @@ namespace ppx_compress
             0,
             "Prioritize compression efficiency over speed.\n Search for matching strings first, instead of\ntrying faster methods of compression first !", 
         },
+        //Option to compress whole directory trees over several threads
+        {
+            OPTION_BATCH,
+            0,
+            "Batch mode. Compresses all the files in directories and glob patterns, recursively, in parallel.",
+        },
+        //Sets the output format of batch mode
+        {
+            OPTION_FORMAT,
+            1,
+            "Set the format batch mode compresses to. One of at4px, pkdpx, sir0at4px, sir0pkdpx.",
+        },
+        //Sets the nb of threads
+        {
+            OPTION_THREADS,
+            1,
+            "Set the maximum number of threads to use in batch mode.",
+        },
+        //Sets the memory budget of batch mode
+        {
+            OPTION_MAXMEM,
+            1,
+            "Set the maximum amount of memory, in MB, files being compressed at once may use in batch mode.",
+        },
     }};
 
+    static const unsigned int DefBatchMaxMemMB     = 256;
+    static const uint64_t     BatchMemPerInputByte = 3;    //Room reserved per byte of input, for the input, the compressed output, and a SIR0 wrapped copy
+
     static const string EXE_NAME             = "ppmd_pxcomp.exe";
     static const string PVERSION             = "0.31";
 
@@ -75,6 +112,16 @@ namespace ppx_compress
         ePXCompLevel   compressionlvl;
         bool           isZealous;
         bool           isQuiet;
+        bool           isBatch;
+        string         batchformat;     //File extension of the format batch mode compresses to
+        unsigned int   maxmemmb;        //Memory budget of batch mode
+    };
+
+    //The files to compress in batch mode, and where to write them
+    struct pxcomp_batch
+    {
+        vector<Poco::Path> inputpaths;
+        vector<Poco::Path> outputpaths;
     };
 
 
@@ -96,7 +143,8 @@ namespace ppx_compress
 // Decompression Handlers
 //=================================================================================================
 
-    void DoCompress( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, const pxcomp_params & params )
+    //Returns the length of the compressed file
+    size_t DoCompress( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, const pxcomp_params & params )
     {
         if( !params.isQuiet )
             cout << "\n-----------------------------------------------------------\n";
@@ -134,6 +182,7 @@ namespace ppx_compress
         if( !params.isQuiet )
             cout <<"\nWriting data to : \n" << outputfile.toString() <<"\n\n";
         WriteByteVectorToFile( outputfile.toString(), compressed );
+        return compressed.size();
     }
 
     void ReadAndCompressFile( const pxcomp_params & params ) // const string & inputpath, const string & outputpath, ePXCompLevel compressionlevel, bool isZealous )
@@ -144,6 +193,61 @@ namespace ppx_compress
         DoCompress( filedata.begin(), filedata.end(), params ); //params.inputpath.getFileName(), outputpath, compressionlevel, isZealous );
     }
 
+    //Compress all the files of the batch over several threads, and print a summary at the end. Returns false if any file failed.
+    bool CompressBatch( const pxcomp_batch & batch, const pxcomp_params & params )
+    {
+        const size_t nbfiles = batch.inputpaths.size();
+
+        //Make the output directories first, so the workers don't race each others creating them
+        std::set<string> outdirs;
+        for( const auto & outpath : batch.outputpaths )
+            outdirs.insert( Poco::Path(outpath).makeParent().toString() );
+        for( const auto & outdir : outdirs )
+            Poco::File(outdir).createDirectories();
+
+        MemoryBudget          budget( static_cast<uint64_t>(params.maxmemmb) * 1024 * 1024 );
+        JobErrorList          errors;
+        std::atomic<uint64_t> totalin(0);
+        std::atomic<uint64_t> totalout(0);
+        ProgressReporter      progress( "Compressing", nbfiles, !params.isQuiet );
+        auto                  tstart = chrono::steady_clock::now();
+
+        progress.Start();
+        RunIndexedJobs( nbfiles, [&]( size_t cntfile )
+        {
+            const uint64_t            filesz = Poco::File(batch.inputpaths[cntfile]).getSize();
+            MemoryBudget::Reservation reserved( budget, filesz * BatchMemPerInputByte );
+            pxcomp_params             fileparams( params );
+            vector<uint8_t>           filedata;
+
+            fileparams.inputpath  = batch.inputpaths[cntfile];
+            fileparams.outputpath = batch.outputpaths[cntfile];
+            fileparams.isQuiet    = true;
+
+            ReadFileToByteVector( fileparams.inputpath.toString(), filedata );
+            totalout += DoCompress( filedata.begin(), filedata.end(), fileparams );
+            totalin  += filedata.size();
+        }, errors, &progress.Completed() );
+        progress.Stop();
+
+        const double   elapsed  = std::max( chrono::duration<double>(chrono::steady_clock::now() - tstart).count(), 0.001 );
+        const uint64_t insz     = totalin;
+        const uint64_t outsz    = totalout;
+        const size_t   nbfailed = errors.size();
+        const double   MB       = 1024.0 * 1024.0;
+
+        cout <<"\n"
+             <<"Compressed : " <<(nbfiles - nbfailed) <<" file(s)\n"
+             <<"Failed     : " <<nbfailed <<" file(s)\n"
+             <<fixed <<setprecision(2)
+             <<"Time       : " <<elapsed <<" s, " <<(nbfiles / elapsed) <<" files/s, " <<((insz / MB) / elapsed) <<" MB/s\n"
+             <<"Ratio      : " <<((insz != 0)? ((100.0 * outsz) / insz) : 0.0) <<"% (" <<insz <<" bytes in, " <<outsz <<" bytes out)\n";
+
+        for( const auto & err : errors.GetSorted() )
+            cerr <<"<!>-Error: \"" <<batch.inputpaths[err.first].toString() <<"\" : " <<err.second <<"\n";
+        return errors.empty();
+    }
+
 //=================================================================================================
 // Utility
 //=================================================================================================
@@ -173,11 +277,27 @@ namespace ppx_compress
              << "                            cost of speed!\n"
              << "   -"<<OPTION_QUIET  <<"                     : Disable console progress output.\n"
              << "                            This will make the whole thing a little faster!\n"
+             << "   -"<<OPTION_BATCH  <<"                 : Batch mode. The input can be a directory\n"
+             << "                            or a quoted glob pattern, and more can be\n"
+             << "                            added with \"+\". All files are compressed\n"
+             << "                            recursively, in parallel, into the output\n"
+             << "                            directory, keeping their sub-directories.\n"
+             << "                            A summary is printed at the end.\n"
+             << "   -"<<OPTION_FORMAT <<" (format)            : Batch mode output format. One of \"" <<AT4PX_FILEX <<"\",\n"
+             << "                            \"" <<PKDPX_FILEX <<"\", \"" <<SIR0_AT4PX_FILEX <<"\", \"" <<SIR0_PKDPX_FILEX <<"\".\n"
+             << "                            Defaults to \"" <<PKDPX_FILEX <<"\".\n"
+             << "   -"<<OPTION_THREADS <<" (nb threads)       : Max nb of threads used in batch mode.\n"
+             << "   -"<<OPTION_MAXMEM <<" (MB)              : Max memory used by the files being\n"
+             << "                            compressed at once in batch mode.\n"
+             << "                            Defaults to " <<DefBatchMaxMemMB <<" MB.\n"
+             << "   -trace (path)            : Write a Chrome trace event file of where the\n"
+             << "                            time was spent, when built with tracing.\n"
 		     << "Example:\n"
              <<EXE_NAME <<" ./file.txt\n"
 		     <<EXE_NAME <<" ./file.sir0 ./\n"
              <<EXE_NAME <<" -l 3 ./file.sir0 ./\n"
              <<EXE_NAME <<" -l 3 -z ./file.sir0 ./\n"
+             <<EXE_NAME <<" -batch -f sir0pkdpx -th 8 ./decompressed/data ./compressed/data\n"
              << "\n\n"
              << "Compresses files using PX compression(custom LZ?). Supports both AT4PX\n"
              << "and PKDPX output. By default, all files will be compressed to PKDPX,\n" 
@@ -192,16 +312,153 @@ namespace ppx_compress
     }
 
 
-    bool HandleArguments( int argc, const char * argv[], pxcomp_params & params )// string & inputpath, string & outputpath, ePXCompLevel & compressionlvl, bool & isZealous )
+    //Parse the options and interpret their value accordingly
+    void GetOurOptions( const vector<vector<string>> & optionsfound, pxcomp_params & params )
+    {
+        for( auto & anoption : optionsfound )
+        {
+            //If we want to set the compression level
+            if( anoption.size() == 2 && anoption.front().compare(OPTION_COMPRESSION_LVL) == 0 )
+            {
+                stringstream   strs;
+                unsigned int   clvl;
+                strs << anoption[1];
+                strs >> clvl;
+
+                //Verify if the compression lvl is valid
+                if( clvl >= static_cast<unsigned int>(ePXCompLevel::LEVEL_0) && 
+                    clvl <= static_cast<unsigned int>(ePXCompLevel::LEVEL_3) )
+                {
+                    if( !params.isQuiet )
+                        cout<<"-" <<OPTION_COMPRESSION_LVL <<" specified, compressing using level " <<clvl <<" compression !\n";
+                    params.compressionlvl = static_cast<ePXCompLevel>(clvl);
+                }
+                else
+                {
+                    if( !params.isQuiet )
+                    {
+                        cout<<"-" <<OPTION_COMPRESSION_LVL <<" specified with invalid compression level.\nDefaulting to level " 
+                            <<static_cast<unsigned int>(ePXCompLevel::LEVEL_3) <<" compression !\n";
+                    }
+                    params.compressionlvl = ePXCompLevel::LEVEL_3; //Default to lvl 3 !
+                }
+
+            }
+
+            if( anoption.size() == 2 && anoption.front().compare(OPTION_FORMAT) == 0 )
+            {
+                if( anoption[1] == AT4PX_FILEX || anoption[1] == PKDPX_FILEX || anoption[1] == SIR0_AT4PX_FILEX || anoption[1] == SIR0_PKDPX_FILEX )
+                {
+                    params.batchformat = anoption[1];
+                    if( !params.isQuiet )
+                        cout<<"-" <<OPTION_FORMAT <<" specified, batch mode compresses to \"" <<params.batchformat <<"\" !\n";
+                }
+                else
+                    cerr<<"-" <<OPTION_FORMAT <<" specified with invalid format \"" <<anoption[1] <<"\" ! Defaulting to \"" <<params.batchformat <<"\" !\n";
+            }
+            else if( anoption.size() == 2 && anoption.front().compare(OPTION_THREADS) == 0 )
+            {
+                unsigned int nbthreads = 0;
+                stringstream strs( anoption[1] );
+                strs >> nbthreads;
+                if( nbthreads != 0 )
+                    utils::LibWide().setNbThreadsToUse(nbthreads);
+                else
+                    cerr<<"-" <<OPTION_THREADS <<" specified with invalid number of threads \"" <<anoption[1] <<"\" !\n";
+            }
+            else if( anoption.size() == 2 && anoption.front().compare(OPTION_MAXMEM) == 0 )
+            {
+                unsigned int maxmem = 0;
+                stringstream strs( anoption[1] );
+                strs >> maxmem;
+                if( maxmem != 0 )
+                    params.maxmemmb = maxmem;
+                else
+                    cerr<<"-" <<OPTION_MAXMEM <<" specified with invalid memory budget \"" <<anoption[1] <<"\" !\n";
+            }
+
+            if( anoption.size() == 1 )
+            {
+                if( anoption.front().compare(OPTION_ZEALOUS) == 0 )
+                {
+                    params.isZealous = true; //Don't put it outside the "if" or it will get reset to false every turns.. 
+
+                    if( !params.isQuiet )
+                        cout<<"-" <<OPTION_ZEALOUS <<" specified, enabling zealous search mode!\n";
+                }
+                else if(  anoption.front().compare(OPTION_QUIET) == 0 )
+                {
+                    params.isQuiet = true; //Don't put it outside the "if" or it will get reset to false every turns.. 
+                    //Don't echo anything at the console
+                }
+                else if( anoption.front().compare(OPTION_BATCH) == 0 )
+                {
+                    params.isBatch = true;
+                }
+            }
+        }
+    }
+
+    //Adds every files designated by a path or glob pattern to the batch, including the content of sub-directories.
+    //Output paths keep the sub-directories the files had under the input's base directory, with the format's extension appended.
+    void AddBatchInput( const string & pathorpattern, const Poco::Path & outputdir, const pxcomp_params & params, pxcomp_batch & out_batch )
+    {
+        string         basedir;
+        vector<string> relpaths = utils::ExpandInputPath( pathorpattern, true, basedir );
+        Poco::Path     inputdir = Poco::Path(basedir).makeDirectory();
+
+        for( const auto & relpath : relpaths )
+        {
+            Poco::Path inpath (inputdir);
+            Poco::Path outpath(outputdir);
+            inpath .append( Poco::Path(relpath, Poco::Path::PATH_UNIX) );
+            outpath.append( Poco::Path(relpath, Poco::Path::PATH_UNIX) );
+            outpath.setFileName( outpath.getFileName() + "." + params.batchformat ); //Keep the original extension, so files with the same base name don't collide
+
+            out_batch.inputpaths .push_back( std::move(inpath)  );
+            out_batch.outputpaths.push_back( std::move(outpath) );
+        }
+    }
+
+    bool HandleBatchArguments( CArgsParser & argsparser, const string & firstarg, const string & secondarg, pxcomp_params & params, pxcomp_batch & out_batch )
+    {
+        if( secondarg.empty() )
+        {
+            cerr << "<!>-Fatal Error: Batch mode needs an output directory!\n";
+            return false;
+        }
+
+        vector<string> inputs( 1, firstarg );
+        argsparser.appendAllAdditionalInputParams(inputs);
+
+        Poco::Path outputdir = Poco::Path(secondarg).makeAbsolute().makeDirectory();
+        for( const auto & input : inputs )
+            AddBatchInput( input, outputdir, params, out_batch );
+
+        if( !params.isQuiet )
+            cout <<"Added " <<out_batch.inputpaths.size() <<" file(s) to the batch!\n";
+        return true;
+    }
+
+    bool HandleArguments( int argc, const char * argv[], pxcomp_params & params, pxcomp_batch & out_batch )// string & inputpath, string & outputpath, ePXCompLevel & compressionlvl, bool & isZealous )
     {
         //#0 - Handle options
-        CArgsParser        argsparser( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ), argv, argc );
+        CArgsParser        argsparser( utils::cmdl::WithCommonOptions( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ) ), argv, argc );
         auto               optionsfound = argsparser.getAllFoundOptions();
+        if( !utils::cmdl::ParseCommonOptions( optionsfound ) )
+            return false;
         string             firstarg     = argsparser.getNextParam(),
                            secondarg    = argsparser.getNextParam();
         Poco::Path         inputfile,
                            outputfile;
         
+        //Batch mode handles its parameters differently
+        if( !firstarg.empty() && find( optionsfound.begin(), optionsfound.end(), vector<string>{OPTION_BATCH} ) != optionsfound.end() )
+        {
+            GetOurOptions( optionsfound, params );
+            return HandleBatchArguments( argsparser, firstarg, secondarg, params, out_batch );
+        }
+
         //#1 - Handle the parameters
         if( !firstarg.empty() )
         {
@@ -221,52 +478,7 @@ namespace ppx_compress
                 }
 
                 //Get all valid command line options !
-                for( auto & anoption : optionsfound )
-                {
-                    //If we want to set the compression level
-                    if( anoption.size() == 2 && anoption.front().compare(OPTION_COMPRESSION_LVL) == 0 )
-                    {
-                        stringstream   strs;
-                        unsigned int   clvl;
-                        strs << anoption[1];
-                        strs >> clvl;
-
-                        //Verify if the compression lvl is valid
-                        if( clvl >= static_cast<unsigned int>(ePXCompLevel::LEVEL_0) && 
-                            clvl <= static_cast<unsigned int>(ePXCompLevel::LEVEL_3) )
-                        {
-                            if( !params.isQuiet )
-                                cout<<"-" <<OPTION_COMPRESSION_LVL <<" specified, compressing using level " <<clvl <<" compression !\n";
-                            params.compressionlvl = static_cast<ePXCompLevel>(clvl);
-                        }
-                        else
-                        {
-                            if( !params.isQuiet )
-                            {
-                                cout<<"-" <<OPTION_COMPRESSION_LVL <<" specified with invalid compression level.\nDefaulting to level " 
-                                    <<static_cast<unsigned int>(ePXCompLevel::LEVEL_3) <<" compression !\n";
-                            }
-                            params.compressionlvl = ePXCompLevel::LEVEL_3; //Default to lvl 3 !
-                        }
-
-                    }
-
-                    if( anoption.size() == 1 )
-                    {
-                        if( anoption.front().compare(OPTION_ZEALOUS) == 0 )
-                        {
-                            params.isZealous = true; //Don't put it outside the "if" or it will get reset to false every turns.. 
-
-                            if( !params.isQuiet )
-                                cout<<"-" <<OPTION_ZEALOUS <<" specified, enabling zealous search mode!\n";
-                        }
-                        else if(  anoption.front().compare(OPTION_QUIET) == 0 )
-                        {
-                            params.isQuiet = true; //Don't put it outside the "if" or it will get reset to false every turns.. 
-                            //Don't echo anything at the console
-                        }
-                    }
-                }
+                GetOurOptions( optionsfound, params );
             }
             else
             {
@@ -298,7 +510,11 @@ int main( int argc, const char * argv[] )
         ePXCompLevel::LEVEL_3,  //Compression level
         false,                  //Use zealous string search ?
         false,                  //Disable progress output
+        false,                  //Batch mode
+        PKDPX_FILEX,            //Batch mode output format
+        DefBatchMaxMemMB,       //Batch mode memory budget
     };
+    pxcomp_batch batch;
 
 	cout <<"==================================================\n"
             <<"==  Baz the Poochyena's PMD:EoS/T/D PXComp - "<<PVERSION <<" ==\n"
@@ -308,10 +524,16 @@ int main( int argc, const char * argv[] )
 
     try
     {
-        if( HandleArguments( argc, argv, params ) )
+        if( HandleArguments( argc, argv, params, batch ) )
         {
             MrChronometer mychrono("Total");
-            ReadAndCompressFile( params );
+            if( params.isBatch )
+            {
+                if( !CompressBatch( batch, params ) )
+                    returnval = -1;
+            }
+            else
+                ReadAndCompressFile( params );
         }
         else
             returnval = -1;
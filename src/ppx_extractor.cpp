@@ -7,6 +7,8 @@
 #include <utils/utility.hpp>
 #include <utils/library_wide.hpp>
 #include <utils/cmdline_util.hpp>
+#include <utils/poco_wrapper.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <ppmdu/fmts/sir0.hpp>
 #include <ppmdu/fmts/at4px.hpp>
 #include <ppmdu/fmts/pkdpx.hpp>
@@ -18,6 +20,8 @@
 #include <algorithm>
 #include <sstream>
 #include <chrono>
+#include <set>
+#include <atomic>
 #include <Poco/Path.h>
 #include <Poco/File.h>
 #include <Poco/DirectoryIterator.h>
@@ -38,7 +42,10 @@ namespace ppx_extract
     static const string                          OPT_WRITE_LOG_SYMBOL          = "wl";
     static const string                          OPT_FORCE_FILEXTENSION_SYMBOL = "fext";
     static const string                          OPT_QUIET_SYMBOL              = "q";
-    static const array<optionparsing_t,3>        MY_OPTIONS     = 
+    static const string                          OPT_BATCH_SYMBOL              = "batch";
+    static const string                          OPT_THREADS_SYMBOL            = "th";
+    static const string                          OPT_MAXMEM_SYMBOL             = "mem";
+    static const array<optionparsing_t,6>        MY_OPTIONS     = 
     {{
         //Switch to enable logging the decompression process
         { 
@@ -60,8 +67,32 @@ namespace ppx_extract
             0,
             "Disable progress output to console! (faster!)",
         },
+        //Switch to process whole directory trees over several threads
+        {
+            OPT_BATCH_SYMBOL,
+            0,
+            "Batch mode! Directories are processed recursively, glob patterns\n"
+            "              are accepted as input, files are decompressed in parallel,\n"
+            "              and a summary is printed at the end. Files that aren't PX\n"
+            "              compressed are skipped. Needs an output directory!",
+        },
+        //Set the nb of threads to use in batch mode
+        {
+            OPT_THREADS_SYMBOL,
+            1,
+            "Set the maximum number of threads to use in batch mode!",
+        },
+        //Set the memory budget of batch mode
+        {
+            OPT_MAXMEM_SYMBOL,
+            1,
+            "Set the maximum amount of memory, in MB, that files being\n"
+            "              decompressed at once may use in batch mode! Default 256.",
+        },
     }};
 
+    static const unsigned int DefBatchMaxMemMB     = 256;
+
     static const string EXE_NAME             = "ppmd_unpx.exe";
     static const string PVERSION             = "0.41";
 
@@ -73,6 +104,8 @@ namespace ppx_extract
         bool               isLogEnabled;
         bool               isQuiet;
         string             forcedextension;
+        bool               isBatch;
+        unsigned int       maxmemmb;        //Memory budget of batch mode
     };
 
 //=================================================================================================
@@ -102,8 +135,8 @@ namespace ppx_extract
 //=================================================================================================
 // Decompression Handlers
 //=================================================================================================
-    void DoDecompressPKDPX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
-                            const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
+    size_t DoDecompressPKDPX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
+                              const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
     {
         //MrChronometer   mychrono("DoDecompressPKDPX");
         vector<uint8_t> decompressed;
@@ -121,10 +154,11 @@ namespace ppx_extract
 
         //Write file out
         WriteByteVectorToFile( outputpath.toString(), decompressed );
+        return decompressed.size();
     }
 
-    void DoDecompressAT4PX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
-                            const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
+    size_t DoDecompressAT4PX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
+                              const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
     {
         using namespace pmd2::filetypes;
         //MrChronometer   mychrono("DoDecompressAT4PX");
@@ -145,22 +179,23 @@ namespace ppx_extract
         DecompressAT4PX( itdatabeg, itdataend, decompressed, !isQuiet, blogenabled );
 
         WriteByteVectorToFile( outputpath.toString(), decompressed ); 
+        return decompressed.size();
     }
 
-    void DoDecompressSIR0AT4PX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
-                                const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
+    size_t DoDecompressSIR0AT4PX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
+                                  const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
     {
         sir0_header hdr;
         hdr.ReadFromContainer( itdatabeg, itdataend );
-        DoDecompressAT4PX( itdatabeg + hdr.subheaderptr, itdatabeg + hdr.ptrPtrOffsetLst, outfilepath, blogenabled, isQuiet );
+        return DoDecompressAT4PX( itdatabeg + hdr.subheaderptr, itdatabeg + hdr.ptrPtrOffsetLst, outfilepath, blogenabled, isQuiet );
     }
 
-    void DoDecompressSIR0PKDPX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
-                                const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
+    size_t DoDecompressSIR0PKDPX( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend, 
+                                  const Poco::Path & outfilepath, bool blogenabled, bool isQuiet )
     {
         sir0_header hdr;
         hdr.ReadFromContainer( itdatabeg, itdataend );
-        DoDecompressPKDPX( itdatabeg + hdr.subheaderptr, itdatabeg + hdr.ptrPtrOffsetLst, outfilepath, blogenabled, isQuiet );
+        return DoDecompressPKDPX( itdatabeg + hdr.subheaderptr, itdatabeg + hdr.ptrPtrOffsetLst, outfilepath, blogenabled, isQuiet );
     }
 
 //=================================================================================================
@@ -189,6 +224,8 @@ namespace ppx_extract
 
         //List our options
         for( auto & anoption : MY_OPTIONS )
+            cout <<"    -" <<left  <<setw(10) <<setfill(' ') <<anoption.optionsymbol <<right <<" : " <<anoption.description <<"\n";
+        for( auto & anoption : utils::cmdl::CommonOptions() )
             cout <<"    -" <<left  <<setw(10) <<setfill(' ') <<anoption.optionsymbol <<right <<" : " <<anoption.description <<"\n";
 
 		cout << "\nExample:\n"
@@ -200,6 +237,8 @@ namespace ppx_extract
              << EXE_NAME <<" -" <<OPT_WRITE_LOG_SYMBOL <<" -" <<OPT_FORCE_FILEXTENSION_SYMBOL <<" \"sir0\"" <<" ./file.pkdpx ./output/path/ +./another/inputpath/ +./and/another/file.pkdpx\n"
              << EXE_NAME <<" -" <<OPT_WRITE_LOG_SYMBOL <<" -" <<OPT_FORCE_FILEXTENSION_SYMBOL <<" \"sir0\"" <<" ./file.pkdpx +./another/inputpath/ +./and/another/file.pkdpx\n"
              << EXE_NAME <<" ./file.pkdpx +./another/inputpath +./and/another/file.pkdpx\n"
+             << EXE_NAME <<" -" <<OPT_BATCH_SYMBOL <<" -" <<OPT_THREADS_SYMBOL <<" 8 ./rom/data ./output/path/\n"
+             << EXE_NAME <<" -" <<OPT_BATCH_SYMBOL <<" \"./rom/data/MONSTER/*.bin\" ./output/path/ +./rom/data/BACK\n"
              << "\n\n"
              << "-> Note that the last example will output files with unspecified\n" 
              << "   file extensions, depending on their individual content!\n"
@@ -207,6 +246,10 @@ namespace ppx_extract
              << "   files, the files will be outputed to \"outputpath\"'s parent \n"
              << "   directory, with no effect on their respective filenames\n"
              << "   or extensions.\n"
+             << "-> In batch mode, the files keep the sub-directories they had under\n"
+             << "   the input directory, or under the part of a glob pattern before\n"
+             << "   its first wildcard. Quote glob patterns so the shell doesn't\n"
+             << "   expand them!\n"
              << "-> !! Log files are cleared at each new session !!\n"
              << "----------------------------------------------------------\n"
 		     << "Named in honour of Baz, the awesome Poochyena of doom, which\n"
@@ -222,6 +265,9 @@ namespace ppx_extract
     {
         for( auto & anoption : optionlist )
         {
+            if( utils::cmdl::IsCommonOption(anoption) ) //Those are handled by ParseCommonOptions
+                continue;
+
             if( anoption.size() == 1 )
             {
                 //NOTE TO SELF : Do this only once. Do not assign the result of this boolean exp at each turn !
@@ -236,6 +282,11 @@ namespace ppx_extract
                     params.isQuiet = true;
                     //Don't write anything to console!
                 }
+                else if( anoption.front().compare( OPT_BATCH_SYMBOL ) == 0 )
+                {
+                    params.isBatch = true;
+                    cout <<"-" <<OPT_BATCH_SYMBOL <<" was specified. Batch mode enabled!\n";
+                }
                 else
                     cerr<<"Ecountered invalid option " <<anoption.front() <<" !\n";
             }
@@ -246,6 +297,32 @@ namespace ppx_extract
                     params.forcedextension = anoption[1];
                     cout <<"-" <<OPT_FORCE_FILEXTENSION_SYMBOL <<" was specified. Forcing output file extension to \"*." <<params.forcedextension <<"\"!\n";
                 }
+                else if( anoption.front().compare( OPT_THREADS_SYMBOL ) == 0 )
+                {
+                    unsigned int nbthreads = 0;
+                    stringstream sstr( anoption[1] );
+                    sstr >> nbthreads;
+                    if( nbthreads != 0 )
+                    {
+                        utils::LibWide().setNbThreadsToUse(nbthreads);
+                        cout <<"-" <<OPT_THREADS_SYMBOL <<" was specified. Using up to " <<utils::LibWide().getNbThreadsToUse() <<" threads!\n";
+                    }
+                    else
+                        cerr<<"Invalid number of threads \"" <<anoption[1] <<"\" !\n";
+                }
+                else if( anoption.front().compare( OPT_MAXMEM_SYMBOL ) == 0 )
+                {
+                    unsigned int maxmem = 0;
+                    stringstream sstr( anoption[1] );
+                    sstr >> maxmem;
+                    if( maxmem != 0 )
+                    {
+                        params.maxmemmb = maxmem;
+                        cout <<"-" <<OPT_MAXMEM_SYMBOL <<" was specified. Using up to " <<params.maxmemmb <<" MB for files in flight!\n";
+                    }
+                    else
+                        cerr<<"Invalid memory budget \"" <<anoption[1] <<"\" !\n";
+                }
                 else
                     cerr<<"Ecountered invalid option " <<anoption.front() <<" !\n";
             }
@@ -395,11 +472,63 @@ namespace ppx_extract
     }
 
 
+    //Adds every files designated by a path or glob pattern to the queue, including the content of sub-directories.
+    //Output paths keep the sub-directories the files had under the input's base directory.
+    //Returns the amount of files added to the queue
+    unsigned int AddBatchInput( const string & pathorpattern, const Poco::Path & outputdir, pxextract_params & params )
+    {
+        string         basedir;
+        vector<string> relpaths = utils::ExpandInputPath( pathorpattern, true, basedir );
+        Poco::Path     inputdir = Poco::Path(basedir).makeDirectory();
+
+        params.inputpaths.reserve ( params.inputpaths.size()  + relpaths.size() );
+        params.outputpaths.reserve( params.outputpaths.size() + relpaths.size() );
+        for( const auto & relpath : relpaths )
+        {
+            Poco::Path inpath (inputdir);
+            Poco::Path outpath(outputdir);
+            inpath .append( Poco::Path(relpath, Poco::Path::PATH_UNIX) );
+            outpath.append( Poco::Path(relpath, Poco::Path::PATH_UNIX) );
+
+            //Keep the original extension, so files with the same base name don't collide.
+            //Only the extension the batch compressor appends is removed.
+            const string fileext = outpath.getExtension();
+            if( fileext == AT4PX_FILEX || fileext == PKDPX_FILEX || fileext == SIR0_AT4PX_FILEX || fileext == SIR0_PKDPX_FILEX )
+                outpath.setFileName( outpath.getBaseName() );
+            if( !params.forcedextension.empty() )
+                outpath.setFileName( outpath.getFileName() + "." + params.forcedextension );
+
+            params.inputpaths .push_back( std::move(inpath)  );
+            params.outputpaths.push_back( std::move(outpath) );
+        }
+        return relpaths.size();
+    }
+
+    bool HandleBatchArguments( const string & firstarg, const string & secondarg, const vector<string> & additionalpaths, pxextract_params & params )
+    {
+        if( secondarg.empty() )
+        {
+            cerr << "<!>-Error: Batch mode needs an output directory!\n";
+            return false;
+        }
+        Poco::Path outputdir = Poco::Path(secondarg).makeDirectory();
+
+        unsigned int nbvalidinputs = AddBatchInput( firstarg, outputdir, params );
+        for( auto & entry : additionalpaths )
+            nbvalidinputs += AddBatchInput( entry, outputdir, params );
+
+        if( !params.isQuiet )
+            cout <<"Added " <<nbvalidinputs <<" file(s) to processing queue!\n";
+        return true;
+    }
+
     bool HandleArguments( int argc, const char * argv[], pxextract_params & params )//vector<Poco::Path> & out_inputpaths, vector<Poco::Path> & out_outputpaths, bool & benablelog )
     {
         //#0 - Handle options
-        CArgsParser             argsparser( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ), argv, argc );
+        CArgsParser             argsparser( utils::cmdl::WithCommonOptions( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ) ), argv, argc );
         vector<vector<string> > optionsfound = argsparser.getAllFoundOptions();
+        if( !utils::cmdl::ParseCommonOptions( optionsfound ) )
+            return false;
         string                  firstarg     = argsparser.getNextParam(),
                                 secondarg    = argsparser.getNextParam();
         vector<string>          additionalpaths;
@@ -408,6 +537,13 @@ namespace ppx_extract
         //Get extra input paths preceded by "+"
         argsparser.appendAllAdditionalInputParams(additionalpaths);
 
+        //Batch mode handles its parameters differently
+        if( !firstarg.empty() && find( optionsfound.begin(), optionsfound.end(), vector<string>{OPT_BATCH_SYMBOL} ) != optionsfound.end() )
+        {
+            GetOurOptions( optionsfound, params );
+            return HandleBatchArguments( firstarg, secondarg, additionalpaths, params );
+        }
+
         //#1 - Handle the parameters
         if( !firstarg.empty() && HandleASingleArgument( firstarg, params.inputpaths ) == 1 )
         {
@@ -431,28 +567,39 @@ namespace ppx_extract
         return true;
     }
 
-    void DetermineAndRunHandler( const Poco::Path & inputpath, Poco::Path & outputpath, bool blogenabled, bool isQuiet )
+    //Decompresses the file data with the appropriate handler, and puts the length of the decompressed data in "out_decompsz".
+    //Returns false if the data isn't PX compressed.
+    bool RunHandler( const vector<uint8_t> & filedata, const Poco::Path & outputpath, bool blogenabled, bool isQuiet, size_t & out_decompsz )
     {
-
-        vector<uint8_t> filedata;
-
-        //#1 - Copy the whole file to a vector
-        ReadFileToByteVector( inputpath.toString(), filedata );
-
-        //#2 - Run analysis on the file content
+        //#1 - Run analysis on the file content
         auto contentInfo = CContentHandler::GetInstance().AnalyseContent( analysis_parameter( filedata.begin(), 
                                                                                               filedata.end() ) );
 
-        //#3 - Determine what handler to run!
+        //#2 - Determine what handler to run!
         if( contentInfo._type == CnTy_AT4PX )
-            DoDecompressAT4PX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
+            out_decompsz = DoDecompressAT4PX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
         else if( contentInfo._type == CnTy_PKDPX )
-            DoDecompressPKDPX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
+            out_decompsz = DoDecompressPKDPX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
         else if( contentInfo._type == CnTy_SIR0_AT4PX )
-            DoDecompressSIR0AT4PX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
+            out_decompsz = DoDecompressSIR0AT4PX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
         else if( contentInfo._type == CnTy_SIR0_PKDPX )
-            DoDecompressSIR0PKDPX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
+            out_decompsz = DoDecompressSIR0PKDPX( filedata.begin(), filedata.end(), outputpath, blogenabled, isQuiet );
         else
+            return false;
+        return true;
+    }
+
+    void DetermineAndRunHandler( const Poco::Path & inputpath, Poco::Path & outputpath, bool blogenabled, bool isQuiet )
+    {
+
+        vector<uint8_t> filedata;
+        size_t          decompsz = 0;
+
+        //#1 - Copy the whole file to a vector
+        ReadFileToByteVector( inputpath.toString(), filedata );
+
+        //#2 - Decompress
+        if( !RunHandler( filedata, outputpath, blogenabled, isQuiet, decompsz ) )
         {
             cerr << "<!>-Error: The content of \"" <<inputpath.toString() <<"\" was not recognized as a valid PX compressed file! Skipping!\n";
             return;
@@ -482,6 +629,106 @@ namespace ppx_extract
                 DetermineAndRunHandler( params.inputpaths[i], params.outputpaths[i], params.isLogEnabled, params.isQuiet );
         }
     }
+
+    //Reads the decompressed size in the PX header of a file, wrapped in SIR0 or not, without loading the whole file.
+    //Returns 0 if the file doesn't begin with a PX header.
+    uint64_t ReadPXDecompressedSize( const Poco::Path & inputpath )
+    {
+        ifstream                                     infile( inputpath.toString(), ios::in | ios::binary );
+        std::array<uint8_t, pkdpx_header::HEADER_SZ> hdrbuf;  //The largest PX header, also larger than the SIR0 header
+        hdrbuf.fill(0);
+        infile.read( reinterpret_cast<char*>(hdrbuf.data()), hdrbuf.size() );
+
+        auto itread = hdrbuf.begin();
+        if( utils::ReadIntFromBytes<uint32_t>( itread, hdrbuf.end(), false ) == MagicNumber_SIR0 )
+        {
+            const uint32_t subheaderptr = utils::ReadIntFromBytes<uint32_t>( itread, hdrbuf.end() );
+            hdrbuf.fill(0);
+            infile.clear();
+            infile.seekg( subheaderptr, ios::beg );
+            infile.read( reinterpret_cast<char*>(hdrbuf.data()), hdrbuf.size() );
+        }
+
+        if( std::equal( MagicNumber_AT4PX.begin(), MagicNumber_AT4PX.end(), hdrbuf.begin() ) )
+        {
+            at4px_header hdr;
+            hdr.ReadFromContainer( hdrbuf.begin(), hdrbuf.end() );
+            return hdr.decompsz;
+        }
+        else if( std::equal( MagicNumber_PKDPX.begin(), MagicNumber_PKDPX.end(), hdrbuf.begin() ) )
+        {
+            pkdpx_header hdr;
+            hdr.ReadFromContainer( hdrbuf.begin(), hdrbuf.end() );
+            return hdr.decompsz;
+        }
+        return 0;
+    }
+
+    //Decompress all our input files over several threads, and print a summary at the end. Returns false if any file failed.
+    bool DecompressBatch( const pxextract_params & params )
+    {
+        const size_t nbfiles = params.inputpaths.size();
+
+        //Make the output directories first, so the workers don't race each others creating them
+        std::set<string> outdirs;
+        for( const auto & outpath : params.outputpaths )
+            outdirs.insert( Poco::Path(outpath).makeParent().toString() );
+        for( const auto & outdir : outdirs )
+            Poco::File(outdir).createDirectories();
+
+        //The decompression log is a single file, so only one file can be decompressed at a time when it's on
+        if( params.isLogEnabled && utils::LibWide().getNbThreadsToUse() > 1 )
+        {
+            cout <<"<!>- Logging is enabled, decompressing on a single thread!\n";
+            utils::LibWide().setNbThreadsToUse(1);
+        }
+
+        MemoryBudget          budget( static_cast<uint64_t>(params.maxmemmb) * 1024 * 1024 );
+        JobErrorList          errors;
+        std::atomic<uint64_t> totalcompressed(0);
+        std::atomic<uint64_t> totaldecompressed(0);
+        std::atomic<uint32_t> nbskipped(0);
+        ProgressReporter      progress( "Decompressing", nbfiles, !params.isQuiet );
+        auto                  tstart = chrono::steady_clock::now();
+
+        progress.Start();
+        RunIndexedJobs( nbfiles, [&]( size_t cntfile )
+        {
+            //Hold enough of the budget for the compressed data, and the decompressed data as big as the PX header says
+            const uint64_t            filesz = Poco::File(params.inputpaths[cntfile]).getSize();
+            MemoryBudget::Reservation reserved( budget, filesz + ReadPXDecompressedSize(params.inputpaths[cntfile]) );
+            vector<uint8_t>           filedata;
+            size_t                    decompsz = 0;
+
+            ReadFileToByteVector( params.inputpaths[cntfile].toString(), filedata );
+            if( RunHandler( filedata, params.outputpaths[cntfile], params.isLogEnabled, true, decompsz ) )
+            {
+                totalcompressed   += filedata.size();
+                totaldecompressed += decompsz;
+            }
+            else
+                ++nbskipped;
+        }, errors, &progress.Completed() );
+        progress.Stop();
+
+        const double   elapsed  = std::max( chrono::duration<double>(chrono::steady_clock::now() - tstart).count(), 0.001 );
+        const uint64_t insz     = totalcompressed;
+        const uint64_t outsz    = totaldecompressed;
+        const size_t   nbfailed = errors.size();
+        const double   MB       = 1024.0 * 1024.0;
+
+        cout <<"\n"
+             <<"Decompressed  : " <<(nbfiles - nbfailed - nbskipped) <<" file(s)\n"
+             <<"Skipped       : " <<nbskipped <<" file(s) not PX compressed\n"
+             <<"Failed        : " <<nbfailed  <<" file(s)\n"
+             <<fixed <<setprecision(2)
+             <<"Time          : " <<elapsed <<" s, " <<(nbfiles / elapsed) <<" files/s, " <<((insz / MB) / elapsed) <<" MB/s compressed, " <<((outsz / MB) / elapsed) <<" MB/s decompressed\n"
+             <<"Ratio         : " <<((outsz != 0)? ((100.0 * insz) / outsz) : 0.0) <<"% (" <<insz <<" bytes compressed, " <<outsz <<" bytes decompressed)\n";
+
+        for( const auto & err : errors.GetSorted() )
+            cerr <<"<!>-Error: \"" <<params.inputpaths[err.first].toString() <<"\" : " <<err.second <<"\n";
+        return errors.empty();
+    }
 };
 
 //=================================================================================================
@@ -501,6 +748,8 @@ int main( int argc, const char * argv[] )
         false,                //Enable logging
         false,                //Disable progress output to console
         "",                   //Forced file extension
+        false,                //Batch mode
+        DefBatchMaxMemMB,     //Batch mode memory budget
     };
 
 
@@ -515,7 +764,13 @@ int main( int argc, const char * argv[] )
         if( HandleArguments( argc, argv, params ) )//inputpaths, outputpaths, benablelogging ) )
         {
             MrChronometer mychrono("Total");
-            DecompressAll( params );// inputpaths, outputpaths, benablelogging );
+            if( params.isBatch )
+            {
+                if( !DecompressBatch( params ) )
+                    return -1;
+            }
+            else
+                DecompressAll( params );// inputpaths, outputpaths, benablelogging );
         }
         else
             return -1;
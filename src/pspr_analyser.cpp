@@ -247,6 +247,8 @@ namespace pspr_analyser
              << "                              worker threads to handle the analysis!\n"
              << "                              DO NOT set this too high, or you'll choke your\n"
              << "                              system to death.. Use a sane value of 1 to 8..\n"
+             << "      -trace \"path\"          : Write a Chrome trace event file of where the\n"
+             << "                              time was spent, when built with tracing.\n"
              << "\n"
 		     << "Example:\n"
              << "---------\n"
@@ -275,8 +277,10 @@ namespace pspr_analyser
     int HandleArguments( int argc, const char * argv[], vector<string> & inputpaths, string & outputpath )
     {
         //#0 - Handle options
-        CArgsParser        argsparser( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ), argv, argc );
+        CArgsParser        argsparser( utils::cmdl::WithCommonOptions( vector<optionparsing_t>( MY_OPTIONS.begin(), MY_OPTIONS.end() ) ), argv, argc );
         auto               optionsfound = argsparser.getAllFoundOptions();
+        if( !utils::cmdl::ParseCommonOptions( optionsfound ) )
+            return -1;
         string             firstarg     = argsparser.getNextParam(),
                            secondarg    = argsparser.getNextParam();
 
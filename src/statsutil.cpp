@@ -10,7 +10,9 @@
 //#include <ppmdu/pmd2/pmd2_scripts.hpp>
 #include <ppmdu/pmd2/pmd2_xml_sniffer.hpp>
 #include <ppmdu/pmd2/pmd2_asm.hpp>
+#include <ppmdu/pmd2/pmd2_assetcatalog.hpp>
 #include <utils/poco_wrapper.hpp>
+#include <utils/async_file_sink.hpp>
 #include <utils/whereami_wrapper.hpp>
 #include <iostream>
 #include <iomanip>
@@ -218,6 +220,38 @@ namespace statsutil
             "-scrasdir",
             std::bind( &CStatsUtil::ParseOptionScriptAsDir, &GetInstance(), placeholders::_1 ),
         },
+
+        //Don't skip unchanged levels when exporting/importing scripts
+        {
+            "scrfull",
+            0,
+            "If present, the script manifests are ignored, and every level is exported/imported again, "
+            "instead of skipping the levels that didn't change since the last run.",
+            "-scrfull",
+            std::bind( &CStatsUtil::ParseOptionScriptFullRebuild, &GetInstance(), placeholders::_1 ),
+        },
+
+        //Export/Import stats as a single binary file
+        {
+            "statsbin",
+            0,
+            "If present, Pokemon, move and item data are exported/imported as a single binary file named \"game_stats.bin\", "
+            "instead of many XML files. The whole file is always imported, the -pokemon, -moves and -items options only select what is written to the game.",
+            "-statsbin",
+            std::bind( &CStatsUtil::ParseOptionStatsBin, &GetInstance(), placeholders::_1 ),
+        },
+
+        //Convert stats between XML and binary
+        {
+            "convstats",
+            0,
+            "Convert Pokemon, move and item data between the XML directories and the single binary file. "
+            "If the input path is a binary stats file, XML data is written to the output directory. "
+            "If it's a directory containing exported XML data, a binary stats file is written to the output path. "
+            "Requires the \"-romroot\" option, to get the game's version and text!",
+            "-convstats",
+            std::bind( &CStatsUtil::ParseOptionConvStats, &GetInstance(), placeholders::_1 ),
+        },
 ////////////////////////////////////////////////////////////////////////////////////////////
 
         //Specify the root of the extracted rom directory to work with
@@ -251,6 +285,15 @@ namespace statsutil
             std::bind( &CStatsUtil::ParseOptionDumpActorList, &GetInstance(), placeholders::_1 ),
         },
 
+        //catalog
+        {
+            "catalog",
+            0,
+            "Build or update the catalog of all the files and content of the ROM. The catalog path may be given as input path, otherwise it's placed in the rom root directory.",
+            "-catalog",
+            std::bind( &CStatsUtil::ParseOptionAssetCatalog, &GetInstance(), placeholders::_1 ),
+        },
+
 ////////////////////////////////////////////////////////////////////////////////////////////
         //Set nb threads to use
         {
@@ -314,6 +357,8 @@ namespace statsutil
         m_dumplvllist     = false;
         m_dumpactorlist   = false;
         m_scriptasdir     = false;
+        m_scriptfullrebuild = false;
+        m_statsbin        = false;
         utils::LibWide().StringValue(ScriptCompilerReportFname) = "compiler_report.txt"; //Set this keyvalue to our default report filename!
     }
 
@@ -526,6 +571,32 @@ namespace statsutil
         return m_scriptasdir = true;
     }
 
+    bool CStatsUtil::ParseOptionScriptFullRebuild(const std::vector<std::string> & optdata )
+    {
+        cout << "<!>- Exporting/Importing all script levels, even unchanged ones!\n";
+        return m_scriptfullrebuild = true;
+    }
+
+    bool CStatsUtil::ParseOptionStatsBin( const std::vector<std::string> & optdata )
+    {
+        cout << "<!>- Exporting/Importing Pokemon, move and item data as a single binary file!\n";
+        return m_statsbin = true;
+    }
+
+    bool CStatsUtil::ParseOptionConvStats( const std::vector<std::string> & optdata )
+    {
+        cout << "<!>- Converting stats data between XML and binary!\n";
+        m_operationMode = eOpMode::ConvertStats;
+        return true;
+    }
+
+    bool CStatsUtil::ParseOptionAssetCatalog( const std::vector<std::string> & optdata )
+    {
+        cout << "<!>- Updating the ROM asset catalog!\n";
+        m_operationMode = eOpMode::UpdateAssetCatalog;
+        return true;
+    }
+
     void CStatsUtil::SetupCFGPath(const std::string & cfgrelpath)
     {
         assert(!m_applicationdir.empty());
@@ -560,7 +631,7 @@ namespace statsutil
             //Now that the command line is parsed, do stuff with it
             if(utils::LibWide().isLogOn())
             {
-                utils::LibWide().Logger(new logging::SingleOutMTLogger);
+                utils::LibWide().Logger(new logging::AsyncLogger(&std::clog));
                 utils::LibWide().Logger() << "Logger initiated!\n";
             }
             SetupCFGPath(m_pmd2cfg);
@@ -787,6 +858,14 @@ namespace statsutil
             else if(!m_romrootdir.empty())
             {
                 ValidateRomRoot();
+                if( m_operationMode == eOpMode::UpdateAssetCatalog )
+                {
+                    cout <<"================================================\n"
+                         <<"Updating asset catalog...\n"
+                         <<"================================================\n";
+                    return DoUpdateAssetCatalog();
+                }
+
                 GameDataLoader gloader( m_romrootdir, m_pmd2cfg );
                 gloader.AnalyseGame();
 
@@ -803,6 +882,13 @@ namespace statsutil
                         ValidateRomRoot();
                         return DoDumpActorList(m_firstparam, gloader );
                     }
+                    case eOpMode::ConvertStats:
+                    {
+                        cout <<"================================================\n"
+                             <<"Converting stats...\n"
+                             <<"================================================\n";
+                        return DoConvertStats( gloader );
+                    }
                 };
             }
             else //This is for mainly drag and drop stuff!!
@@ -993,7 +1079,7 @@ namespace statsutil
         {
             cout <<"\nScripts\n"
                  <<"---------------------------------\n";
-            GameScripts * pgamescripts = gloader.InitScripts(pmd2::scriptprocoptions{true, true, false, m_scriptdebug, m_scriptasdir});
+            GameScripts * pgamescripts = gloader.InitScripts(pmd2::scriptprocoptions{true, true, false, m_scriptdebug, m_scriptasdir, !m_scriptfullrebuild});
             if(!pgamescripts)
                 throw std::runtime_error("CStatsUtil::HandleImport(): Couldn't load scripts!");
 
@@ -1020,7 +1106,30 @@ namespace statsutil
                 throw std::runtime_error("CStatsUtil::HandleImport(): Couldn't load game stats!");
         }
 
-        if(m_hndlPkmn || bhandleall)
+        if( m_statsbin && (m_hndlPkmn || m_hndlMoves || m_hndlItems || bhandleall) )
+        {
+            cout <<"\nStats Binary File\n"
+                 <<"---------------------------------\n";
+            Poco::Path statsbinpath(frompath);
+            statsbinpath.append(pmd2::GameStats::DefStatsBinFile);
+            if( utils::isFile(statsbinpath.toString()) )
+            {
+                pgamestats->ImportAllBinary(statsbinpath.toString());
+                if(m_hndlPkmn || bhandleall)
+                    pgamestats->WritePkmn();
+                if(m_hndlMoves || bhandleall)
+                    pgamestats->WriteMoves();
+                if(m_hndlItems || bhandleall)
+                    pgamestats->WriteItems();
+            }
+            else
+            {
+                cout <<"Failed to import stats.. File " <<pmd2::GameStats::DefStatsBinFile
+                     <<" is missing from specified input directory.\n Skipping over...\n";
+            }
+        }
+
+        if( !m_statsbin && (m_hndlPkmn || bhandleall) )
         {
             cout <<"\nPokemon Data\n"
                  <<"---------------------------------\n";
@@ -1038,7 +1147,7 @@ namespace statsutil
             }
         }
 
-        if(m_hndlMoves || bhandleall)
+        if( !m_statsbin && (m_hndlMoves || bhandleall) )
         {
             cout <<"\nPokemon Move Data\n"
                  <<"-----------------------------------\n";
@@ -1057,7 +1166,7 @@ namespace statsutil
             }
         }
 
-        if(m_hndlItems || bhandleall)
+        if( !m_statsbin && (m_hndlItems || bhandleall) )
         {
             cout <<"\nItem Data\n"
                  <<"-----------------------------------\n";
@@ -1102,6 +1211,10 @@ namespace statsutil
             parentout.createDirectory();
         }
 
+        //The xml files of every exported element are written behind by the sink's I/O threads
+        utils::AsyncFileSink        outsink;
+        utils::ScopedActiveFileSink activesink(outsink);
+
         if(m_hndlStrings || bhandleall)
         {
             cout <<"\nGame Strings\n"
@@ -1122,7 +1235,7 @@ namespace statsutil
         {
             cout <<"\nScripts\n"
                  <<"---------------------------------\n";
-            GameScripts * pgamescripts = gloader.InitScripts(pmd2::scriptprocoptions{true, true, false, m_scriptdebug, m_scriptasdir});
+            GameScripts * pgamescripts = gloader.InitScripts(pmd2::scriptprocoptions{true, true, false, m_scriptdebug, m_scriptasdir, !m_scriptfullrebuild});
             if(!pgamescripts)
                 throw std::runtime_error("CStatsUtil::HandleExport(): Couldn't load scripts!");
 
@@ -1141,7 +1254,14 @@ namespace statsutil
                 throw std::runtime_error("CStatsUtil::HandleExport(): Couldn't load game stats!");
         }
 
-        if(m_hndlPkmn || bhandleall)
+        if( m_statsbin && (m_hndlPkmn || m_hndlMoves || m_hndlItems || bhandleall) )
+        {
+            cout <<"\nStats Binary File\n"
+                 <<"---------------------------------\n";
+            pgamestats->ExportAllBinary( Poco::Path(outpath).append(GameStats::DefStatsBinFile).toString() );
+        }
+
+        if( !m_statsbin && (m_hndlPkmn || bhandleall) )
         {
             cout <<"\nPokemon Data\n"
                  <<"---------------------------------\n";
@@ -1151,7 +1271,7 @@ namespace statsutil
             pgamestats->ExportPkmn( targetdir );
         }
 
-        if(m_hndlMoves || bhandleall)
+        if( !m_statsbin && (m_hndlMoves || bhandleall) )
         {
             cout <<"\nPokemon Move Data\n"
                  <<"-----------------------------------\n";
@@ -1161,7 +1281,7 @@ namespace statsutil
             pgamestats->ExportMoves(targetdir);
         }
 
-        if(m_hndlItems || bhandleall)
+        if( !m_statsbin && (m_hndlItems || bhandleall) )
         {
             cout <<"\nExporting Item Data\n"
                  <<"-----------------------------------\n";
@@ -1171,6 +1291,10 @@ namespace statsutil
             pgamestats->ExportItems(targetdir);
         }
 
+        cout <<"\nWaiting for the output files to be written..";
+        outsink.Finish();
+        cout <<"done! (" <<outsink.getNbFilesWritten() <<" files)\n";
+
         return 0;
     }
 
@@ -1284,6 +1408,42 @@ namespace statsutil
     }
 
 
+    int CStatsUtil::DoConvertStats( pmd2::GameDataLoader & gloader )
+    {
+        Poco::Path inpath = Poco::Path(m_firstparam).makeAbsolute();
+        GameStats * pgamestats = gloader.InitStats();
+        if(!pgamestats)
+            throw std::runtime_error("CStatsUtil::DoConvertStats(): Couldn't load game stats!");
+
+        //The game's own data and text are only used as a base, nothing is written to the game
+        if( utils::isFile(inpath.toString()) && IsStatsBinFile(inpath.toString()) )
+        {
+            Poco::Path outpath;
+            if( m_outputPath.empty() )
+                outpath = Poco::Path(inpath).makeParent().append(inpath.getBaseName()).makeDirectory();
+            else
+                outpath = Poco::Path(m_outputPath).makeAbsolute().makeDirectory();
+
+            CreateDirIfDoesntExist(outpath);
+            pgamestats->ImportAllBinary( inpath.toString() );
+            pgamestats->ExportAll( outpath.toString() );
+        }
+        else if( utils::isFolder(inpath.toString()) && isImportAllDir(inpath.toString()) )
+        {
+            string outpath;
+            if( m_outputPath.empty() )
+                outpath = Poco::Path(inpath).makeDirectory().append(GameStats::DefStatsBinFile).toString();
+            else
+                outpath = Poco::Path(m_outputPath).makeAbsolute().toString();
+
+            pgamestats->ImportAll( inpath.toString() );
+            pgamestats->ExportAllBinary( outpath );
+        }
+        else
+            throw runtime_error("CStatsUtil::DoConvertStats(): Input path is neither a stats binary file, nor a directory containing exported stats!");
+        return 0;
+    }
+
     int CStatsUtil::DoDumpActorList( std::string fpath, pmd2::GameDataLoader & gloader )
     {
         const pmd2::ConfigLoader & confload = MainPMD2ConfigWrapper::CfgInstance();
@@ -1297,6 +1457,29 @@ namespace statsutil
         return 0;
     }
 
+    int CStatsUtil::DoUpdateAssetCatalog()
+    {
+        string catalogpath = m_firstparam;
+        if( catalogpath.empty() )
+            catalogpath = Poco::Path(m_romrootdir).makeDirectory().append(pmd2::AssetCatalog::DefaultFileName).toString();
+
+        pmd2::AssetCatalog catalog;
+        if( catalog.Load(catalogpath) )
+            cout <<"Loaded catalog \"" <<catalogpath <<"\", " <<catalog.size() <<" files.\n";
+        else
+            cout <<"No catalog at \"" <<catalogpath <<"\", building a new one.\n";
+
+        pmd2::AssetCatalog::updatestats stats = catalog.Update(m_romrootdir);
+        catalog.Write(catalogpath);
+
+        cout <<"Catalog up to date, " <<stats.nbfiles <<" files:\n"
+             <<"  " <<stats.nbunchanged <<" unchanged\n"
+             <<"  " <<stats.nbtouched   <<" touched, but identical\n"
+             <<"  " <<stats.nbanalysed  <<" analysed\n"
+             <<"  " <<stats.nbremoved   <<" removed\n";
+        return 0;
+    }
+
     int CStatsUtil::DoDumpLevelList( std::string fpath, pmd2::GameDataLoader & gloader )
 #if 1
     {
@@ -59,6 +59,10 @@ namespace statsutil
         bool ParseOptionDumpLvlList( const std::vector<std::string> & optdata );
         bool ParseOptionDumpActorList( const std::vector<std::string> & optdata );
         bool ParseOptionScriptAsDir(const std::vector<std::string> & optdata ); 
+        bool ParseOptionScriptFullRebuild(const std::vector<std::string> & optdata );
+        bool ParseOptionStatsBin   ( const std::vector<std::string> & optdata );
+        bool ParseOptionConvStats  ( const std::vector<std::string> & optdata );
+        bool ParseOptionAssetCatalog( const std::vector<std::string> & optdata );
 
         //Execution
         void DetermineOperation();
@@ -98,6 +102,8 @@ namespace statsutil
 
         int DoDumpLevelList( std::string fpath, pmd2::GameDataLoader & gloader );
         int DoDumpActorList( std::string fpath, pmd2::GameDataLoader & gloader );
+        int DoConvertStats ( pmd2::GameDataLoader & gloader );
+        int DoUpdateAssetCatalog();
 
         int HandleImport( const std::string & frompath, pmd2::GameDataLoader & gloader );
         int HandleExport( const std::string & topath,   pmd2::GameDataLoader & gloader );
@@ -164,6 +170,10 @@ namespace statsutil
             DumpLevelList,
             DumpActorList,
 
+            ConvertStats,
+
+            UpdateAssetCatalog,
+
             ImportAll,
             ExportAll,
         };
@@ -193,6 +203,8 @@ namespace statsutil
         bool        m_dumplvllist;
         bool        m_dumpactorlist;
         bool        m_scriptasdir;  //Whether scripts are exported/imported as directories
+        bool        m_scriptfullrebuild; //Whether script levels are all exported/imported, even when the manifest says they're unchanged
+        bool        m_statsbin;     //Whether pokemon, move and item data are exported/imported as a single binary file
         
         pmd2::eGameRegion  m_region;
         pmd2::eGameVersion m_version;
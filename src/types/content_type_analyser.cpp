@@ -1,5 +1,9 @@
 #include <types/content_type_analyser.hpp>
+#include <utils/parallel_tasks.hpp>
 #include <limits>
+#include <algorithm>
+#include <cctype>
+#include <iostream>
 
 #ifndef USE_PPMDU_CONTENT_TYPE_ANALYSER
     static_assert(false, "Possibly forgot to add the preprocessor definition USE_PPMDU_CONTENT_TYPE_ANALYSER to enable the content type analyser! Otherwise, exclude content_type_analyser.cpp from build!")
@@ -7,6 +11,26 @@
 
 namespace filetypes
 {
+//==================================================================
+// Helpers
+//==================================================================
+    static const size_t MagicNumberKeyLen = 4; //Nb of leading bytes used to look up rules
+
+    inline uint32_t MakeMagicNumberKey( std::vector<uint8_t>::const_iterator itbeg )
+    {
+        uint32_t key = 0;
+        for( size_t i = 0; i < MagicNumberKeyLen; ++i, ++itbeg )
+            key = (key << 8) | (*itbeg);
+        return key;
+    }
+
+    inline std::string MakeFileExtKey( const std::string & filext )
+    {
+        std::string key( (!filext.empty() && filext.front() == '.')? filext.substr(1) : filext );
+        std::transform( key.begin(), key.end(), key.begin(), []( char c ){ return static_cast<char>( std::tolower( static_cast<unsigned char>(c) ) ); } );
+        return key;
+    }
+
 //==================================================================
 // CContentHandler
 //==================================================================
@@ -40,6 +64,7 @@ namespace filetypes
             //Set the rule id
             rule->setRuleID( ++m_current_ruleid );
             m_vRules.push_back( std::unique_ptr<IContentHandlingRule>( rule ) );
+            RebuildRuleIndex();
 
             return m_current_ruleid;
         }
@@ -49,33 +74,159 @@ namespace filetypes
 
     bool CContentHandler::UnregisterRule( cntRID_t ruleid )
     {
-        for( auto &arule : m_vRules )
+        for( auto itrule = m_vRules.begin(); itrule != m_vRules.end(); ++itrule )
         {
-            if( arule->getRuleID() == ruleid )
+            if( (*itrule)->getRuleID() == ruleid )
             {
-                delete arule.release();
+                m_vRules.erase(itrule);
+                RebuildRuleIndex();
                 return true;
             }
         }
         return false;
     }
 
+    void CContentHandler::RebuildRuleIndex()
+    {
+        m_rulesbymagic.clear();
+        m_rulesbyext.clear();
+        m_unkeyedrules.clear();
+
+        //Rules are added in registration order, so every lists stays sorted
+        for( size_t cntrule = 0; cntrule < m_vRules.size(); ++cntrule )
+        {
+            const std::vector<uint8_t> magic  = m_vRules[cntrule]->getMagicNumber();
+            const std::string          filext = m_vRules[cntrule]->getFileExtension();
+
+            if( magic.size() >= MagicNumberKeyLen )
+                m_rulesbymagic[MakeMagicNumberKey(magic.begin())].push_back(cntrule);
+            else if( !filext.empty() )
+                m_rulesbyext[MakeFileExtKey(filext)].push_back(cntrule);
+            else
+                m_unkeyedrules.push_back(cntrule);
+        }
+    }
+
+    size_t CContentHandler::FindMatchingRule( const analysis_parameter & parameters )
+    {
+        static const std::vector<size_t> NoRules;
+        const std::vector<size_t> * candidates[3] = { &NoRules, &NoRules, &m_unkeyedrules };
+        size_t                      positions [3] = { 0, 0, 0 };
+
+        if( std::distance( parameters._itdatabeg, parameters._itdataend ) >= static_cast<ptrdiff_t>(MagicNumberKeyLen) )
+        {
+            auto itfound = m_rulesbymagic.find( MakeMagicNumberKey(parameters._itdatabeg) );
+            if( itfound != m_rulesbymagic.end() )
+                candidates[0] = &(itfound->second);
+        }
+        if( !parameters._filextension.empty() && !m_rulesbyext.empty() )
+        {
+            auto itfound = m_rulesbyext.find( MakeFileExtKey(parameters._filextension) );
+            if( itfound != m_rulesbyext.end() )
+                candidates[1] = &(itfound->second);
+        }
+
+        //Merge the candidate lists, so rules are still tested in registration order
+        for(;;)
+        {
+            size_t best = 3;
+            for( size_t cntlst = 0; cntlst < 3; ++cntlst )
+            {
+                if( positions[cntlst] < candidates[cntlst]->size() && 
+                    ( best == 3 || (*candidates[cntlst])[positions[cntlst]] < (*candidates[best])[positions[best]] ) )
+                    best = cntlst;
+            }
+            if( best == 3 )
+                return NoRuleMatched;
+
+            const size_t ruleindex = (*candidates[best])[positions[best]++];
+            if( m_vRules[ruleindex]->isMatch( parameters._itdatabeg, parameters._itdataend, parameters._filextension ) )
+                return ruleindex;
+        }
+    }
+
     //File analysis
     ContentBlock CContentHandler::AnalyseContent( const analysis_parameter & parameters )
     {
-        ContentBlock contentdetails;
+        const size_t ruleindex = FindMatchingRule(parameters);
+        if( ruleindex == NoRuleMatched )
+            return ContentBlock();
+        return m_vRules[ruleindex]->Analyse( parameters );
+    }
+
+    ContentTreeNode CContentHandler::AnalyseContentTree( const std::vector<uint8_t> & data, const std::string & filext, bool bparallel, bool bkeepdecoded )
+    {
+        ContentTreeNode root;
+        root._endoffset = data.size();
+        AnalyseTreeNode( data.begin(), data.end(), filext, root, 0, bparallel, bkeepdecoded );
+        return std::move(root);
+    }
 
-        //Feed the data through all the rules we have and check which one returns true
-        for( auto &rule : m_vRules )
+    void CContentHandler::AnalyseTreeNode( std::vector<uint8_t>::const_iterator itdatabeg, 
+                                           std::vector<uint8_t>::const_iterator itdataend, 
+                                           const std::string                  & filext, 
+                                           ContentTreeNode                    & out_node, 
+                                           unsigned                             depth, 
+                                           bool                                 bparallel, 
+                                           bool                                 bkeepdecoded )
+    {
+        analysis_parameter params( itdatabeg, itdataend, filext );
+        const size_t       ruleindex = FindMatchingRule(params);
+        if( ruleindex == NoRuleMatched )
+            return;
+
+        out_node._content = m_vRules[ruleindex]->Analyse(params);
+        if( depth >= MaxContentDepth )
+            return;
+
+        std::vector<SubContent> subcnt;
+        m_vRules[ruleindex]->ListSubContent( params, out_node._content, subcnt );
+        if( subcnt.empty() )
+            return;
+
+        const size_t datalen = static_cast<size_t>( std::distance( itdatabeg, itdataend ) );
+        out_node._subcontent.resize( subcnt.size() );
+
+        auto lambdasubcnt = [&]( size_t cntsub, bool bsubparallel )
         {
-            if( rule->isMatch( parameters._itdatabeg, parameters._itdataend, parameters._filextension ) )
+            const SubContent & cursub = subcnt[cntsub];
+            ContentTreeNode  & child  = out_node._subcontent[cntsub];
+            child._startoffset = cursub._startoffset;
+            child._endoffset   = cursub._endoffset;
+            try
             {
-                contentdetails = rule->Analyse( parameters );
-                break;
+                if( cursub._decoded )
+                {
+                    AnalyseTreeNode( cursub._decoded->begin(), cursub._decoded->end(), cursub._filextension, child, depth + 1, bsubparallel, bkeepdecoded );
+                    if( bkeepdecoded )
+                        child._decoded = cursub._decoded;
+                }
+                else if( cursub._startoffset < cursub._endoffset && cursub._endoffset <= datalen )
+                {
+                    AnalyseTreeNode( itdatabeg + cursub._startoffset, itdatabeg + cursub._endoffset, cursub._filextension, child, depth + 1, bsubparallel, bkeepdecoded );
+                }
             }
-        }
+            catch( const std::exception & e )
+            {
+                //Leave it as invalid content
+                child._content    = ContentBlock();
+                child._subcontent.clear();
+                if( utils::LibWide().isLogOn() )
+                    std::clog <<"CContentHandler::AnalyseContentTree(): Couldn't analyse sub-content #" <<cntsub <<" at depth " <<(depth + 1) <<" : " <<e.what() <<"\n";
+            }
+        };
 
-        return contentdetails;
+        if( bparallel && subcnt.size() > 1 )
+        {
+            utils::JobErrorList errors;
+            utils::RunIndexedJobs( subcnt.size(), [&]( size_t cntsub ){ lambdasubcnt(cntsub, false); }, errors );
+            errors.ThrowIfAny("CContentHandler::AnalyseContentTree()");
+        }
+        else
+        {
+            for( size_t cntsub = 0; cntsub < subcnt.size(); ++cntsub )
+                lambdasubcnt(cntsub, bparallel);
+        }
     }
 
     bool CContentHandler::isValidRule( cntRID_t theid )const 
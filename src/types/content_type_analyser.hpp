@@ -13,6 +13,8 @@ All wrongs reversed, no crappyrights :P
 #include <vector>
 #include <types/contentid_generator.hpp>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace filetypes
 {
@@ -106,6 +108,42 @@ namespace filetypes
         cntRID_t                  _rule_id_that_matched;
     };
 
+    /*************************************************************************************
+        SubContent
+            A piece of content nested inside a container, as listed by the rule that
+            identified the container. Either a range within the container's data, or
+            data decoded from that range, for compressed content.
+    *************************************************************************************/
+    struct SubContent
+    {
+        SubContent( size_t begoffset = 0, size_t endoffset = 0 )
+            :_startoffset(begoffset), _endoffset(endoffset)
+        {}
+
+        size_t                                      _startoffset;  //Range of the sub-content within the container's data
+        size_t                                      _endoffset;
+        std::shared_ptr<const std::vector<uint8_t>> _decoded;      //If not null, the sub-content is this data, decoded from the range, instead of the range itself
+        std::string                                 _filextension; //The file extension of the sub-content, if known
+    };
+
+    /*************************************************************************************
+        ContentTreeNode
+            The result of a recursive analysis. A piece of content, and all the 
+            content identified inside of it.
+    *************************************************************************************/
+    struct ContentTreeNode
+    {
+        ContentTreeNode()
+            :_startoffset(0), _endoffset(0)
+        {}
+
+        ContentBlock                                _content;     //What the content was identified as. Offsets are relative to the content's own data.
+        size_t                                      _startoffset; //Range of the content within its parent's data. For decoded content, the range of the encoded data.
+        size_t                                      _endoffset;
+        std::shared_ptr<const std::vector<uint8_t>> _decoded;     //The decoded data, if the content was decoded from its range, and decoded data was kept.
+        std::vector<ContentTreeNode>                _subcontent;  //The content nested inside, in the order the container lists it.
+    };
+
 //==================================================================
 // Classes
 //==================================================================
@@ -137,6 +175,19 @@ namespace filetypes
         virtual bool isMatch(  std::vector<uint8_t>::const_iterator   itdatabeg, 
                                std::vector<uint8_t>::const_iterator   itdataend,
                                const std::string                     & filext ) = 0;
+
+        //Optional. The magic number all content this rule matches begins with.
+        // Rules returning one are only tested against data beginning with its first 4 bytes.
+        // Magic numbers shorter than 4 bytes are ignored.
+        virtual std::vector<uint8_t> getMagicNumber()const { return std::vector<uint8_t>(); }
+
+        //Optional. The file extension all content this rule matches has, without the dot.
+        // Rules returning one, and no magic number, are only tested against data with that extension. Case doesn't matter.
+        virtual std::string getFileExtension()const { return std::string(); }
+
+        //Optional. For containers, lists the content nested in the data this rule matched, so it can be analysed recursively.
+        // "cnt" is what "Analyse" returned for the same parameters.
+        virtual void ListSubContent( const analysis_parameter & parameters, const ContentBlock & cnt, std::vector<SubContent> & out_subcnt ) {}
     };
 
 
@@ -173,13 +224,53 @@ namespace filetypes
         //ContentBlock AnalyseContent( vector<uint8_t>::const_iterator itdatabeg, vector<uint8_t>::const_iterator itdataend );
         ContentBlock AnalyseContent( const analysis_parameter & parameters );
 
+        /*
+            AnalyseContentTree
+                Identifies the content of "data", and then recursively the content nested inside of it.
+                Like the sub-files of a pack file, or the decompressed data of a PX compressed file.
+
+                - filext       : The file extension of the data, if any.
+                - bparallel    : Analyse the sub-content of the first container holding more than one, 
+                                 over the library-wide thread budget. Deeper levels are analysed by the 
+                                 same thread as their parent.
+                - bkeepdecoded : Keep the decoded data of compressed content in the tree, so it doesn't
+                                 need to be decoded again afterwards.
+
+                Sub-content that fails to be analysed is left as invalid content.
+                Rules must not be registered or unregistered while an analysis is running.
+        */
+        ContentTreeNode AnalyseContentTree( const std::vector<uint8_t> & data, 
+                                            const std::string          & filext       = "", 
+                                            bool                         bparallel    = true, 
+                                            bool                         bkeepdecoded = false );
+
     private:
         CContentHandler(); //no contruction for outsiders
         CContentHandler( const CContentHandler & ); //no copy
 
+        static const size_t   NoRuleMatched     = static_cast<size_t>(-1);
+        static const unsigned MaxContentDepth   = 8; //Guards against containers listing themselves as sub-content
+
+        //Returns the index of the first rule matching the data, in registration order, or NoRuleMatched.
+        size_t FindMatchingRule( const analysis_parameter & parameters );
+        void   RebuildRuleIndex();
+        void   AnalyseTreeNode( std::vector<uint8_t>::const_iterator itdatabeg, 
+                                std::vector<uint8_t>::const_iterator itdataend, 
+                                const std::string                  & filext, 
+                                ContentTreeNode                    & out_node, 
+                                unsigned                             depth, 
+                                bool                                 bparallel, 
+                                bool                                 bkeepdecoded );
+
         //The list of rules 
         std::vector< std::unique_ptr<IContentHandlingRule> > m_vRules;
 
+        //Indices into m_vRules, in registration order, of the rules to test for a given leading magic number, or file extension.
+        // Rules with neither are always tested.
+        std::unordered_map<uint32_t,    std::vector<size_t>> m_rulesbymagic;
+        std::unordered_map<std::string, std::vector<size_t>> m_rulesbyext;
+        std::vector<size_t>                                  m_unkeyedrules;
+
         //The current rule id counter, for assigning ruleids
         cntRID_t m_current_ruleid;
     };
@@ -220,6 +311,18 @@ namespace filetypes
         return CContentHandler::GetInstance().AnalyseContent( analysis_parameter(itbegdata,itenddata,filext) );
     }
 
+    /*
+        Use this function to avoid having to type this everytimes:
+            CContentHandler::GetInstance().AnalyseContentTree(...)
+    */
+    inline ContentTreeNode DetermineCntTree( const std::vector<uint8_t> & data, 
+                                             const std::string          & filext       = "", 
+                                             bool                         bparallel    = true,
+                                             bool                         bkeepdecoded = false )
+    {
+        return CContentHandler::GetInstance().AnalyseContentTree( data, filext, bparallel, bkeepdecoded );
+    }
+
 };
 
 #endif
\ No newline at end of file
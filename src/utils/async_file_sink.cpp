@@ -0,0 +1,262 @@
+#include "async_file_sink.hpp"
+#include "trace.hpp"
+#include <Poco/File.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+using namespace std;
+
+namespace utils
+{
+    namespace
+    {
+        std::atomic<AsyncFileSink*> s_pactivesink(nullptr);
+
+        //Returns the part of the path before the last separator, or an empty string if there are none.
+        inline string GetParentDir( const string & path )
+        {
+            const size_t possep = path.find_last_of("/\\");
+            return (possep != string::npos)? path.substr(0, possep) : string();
+        }
+
+        //Flushes the file's content to the storage device. Returns false on failure.
+        bool SyncFileToDisk( const string & path )
+        {
+            FILE * pf = fopen( path.c_str(), "r+b" );
+            if( !pf )
+                return false;
+            bool bsuccess = (fflush(pf) == 0);
+#ifdef _WIN32
+            bsuccess = bsuccess && (_commit( _fileno(pf) ) == 0);
+#else
+            bsuccess = bsuccess && (fsync( fileno(pf) ) == 0);
+#endif
+            fclose(pf);
+            return bsuccess;
+        }
+    };
+
+//======================================================================================================================================
+//  AsyncFileSink
+//======================================================================================================================================
+    AsyncFileSink::AsyncFileSink( size_t nbiothreads, uint64_t maxqueuedbytes, bool bsyncatend )
+        :m_queuebudget(maxqueuedbytes), m_bsyncatend(bsyncatend), m_nextindex(0), m_bstopping(false), m_bfinished(false),
+         m_nbfiles(0), m_nbbytes(0)
+    {
+        const size_t nbth = std::max<size_t>( nbiothreads, 1 );
+        for( size_t cntth = 0; cntth < nbth; ++cntth )
+            m_iothreads.push_back( std::thread( &AsyncFileSink::IOLoop, this ) );
+    }
+
+    AsyncFileSink::~AsyncFileSink()
+    {
+        try
+        {
+            Finish();
+        }
+        catch(...)
+        {}
+    }
+
+    void AsyncFileSink::Write( const std::string & path, std::vector<uint8_t> && data )
+    {
+        //Wait for room in the queue before taking the file
+        m_queuebudget.Acquire( data.size() );
+
+        {
+            std::lock_guard<std::mutex> lck(m_mtxqueue);
+            if( m_bstopping )
+            {
+                m_queuebudget.Release( data.size() );
+                throw std::logic_error("AsyncFileSink::Write(): Tried to write \"" + path + "\" after the sink was finished!");
+            }
+            writejob_t job;
+            job.index = m_nextindex++;
+            job.path  = path;
+            job.data  = std::move(data);
+            m_queue.push_back( std::move(job) );
+        }
+        m_cvqueue.notify_one();
+    }
+
+    void AsyncFileSink::Write( const std::string & path, const std::string & text )
+    {
+        Write( path, std::vector<uint8_t>( text.begin(), text.end() ) );
+    }
+
+    void AsyncFileSink::Finish()
+    {
+        if( m_bfinished )
+            return;
+        StopIOThreads();
+        m_bfinished = true;
+
+        if( m_bsyncatend )
+            SyncWrittenFiles();
+        m_errors.ThrowIfAny( "AsyncFileSink::Finish()" );
+    }
+
+    void AsyncFileSink::StopIOThreads()
+    {
+        {
+            std::lock_guard<std::mutex> lck(m_mtxqueue);
+            m_bstopping = true;
+        }
+        m_cvqueue.notify_all();
+
+        for( auto & th : m_iothreads )
+        {
+            if( th.joinable() )
+                th.join();
+        }
+        m_iothreads.clear();
+    }
+
+    /*
+        Takes up to MaxBatchLen files from the queue at a time, and writes them.
+        Returns once the sink is stopping and the queue is empty.
+    */
+    void AsyncFileSink::IOLoop()
+    {
+        UTILS_TRACE_THREAD_NAME("File Sink I/O");
+        vector<writejob_t> batch;
+        batch.reserve(MaxBatchLen);
+
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lck(m_mtxqueue);
+                m_cvqueue.wait( lck, [&](){ return m_bstopping || !m_queue.empty(); } );
+                if( m_queue.empty() )
+                    return; //Stopping, and nothing left to write
+
+                while( !m_queue.empty() && batch.size() < MaxBatchLen )
+                {
+                    batch.push_back( std::move(m_queue.front()) );
+                    m_queue.pop_front();
+                }
+            }
+
+            UTILS_TRACE_ZONE("File Sink Write Batch");
+            CreateParentDirs(batch);
+
+            for( const auto & job : batch )
+            {
+                try
+                {
+                    WriteAFile(job);
+                }
+                catch( const std::exception & e )
+                {
+                    m_errors.Push( job.index, e.what() );
+                }
+                m_queuebudget.Release( job.data.size() );
+            }
+            batch.clear();
+        }
+    }
+
+    /*
+        Creates the parent directories of all the files in the batch that weren't seen before.
+        Failures are only reported when the file itself can't be written.
+    */
+    void AsyncFileSink::CreateParentDirs( const std::vector<writejob_t> & batch )
+    {
+        vector<string> newdirs;
+        {
+            std::lock_guard<std::mutex> lck(m_mtxdirs);
+            for( const auto & job : batch )
+            {
+                string dir = GetParentDir(job.path);
+                if( !dir.empty() && m_knowndirs.insert(dir).second )
+                    newdirs.push_back( std::move(dir) );
+            }
+        }
+
+        for( const auto & dir : newdirs )
+        {
+            try
+            {
+                Poco::File(dir).createDirectories();
+            }
+            catch(...)
+            {}
+        }
+    }
+
+    void AsyncFileSink::WriteAFile( const writejob_t & job )
+    {
+        ofstream outf( job.path, ios::out | ios::binary );
+        if( !outf.is_open() )
+            throw std::runtime_error("Couldn't open file \"" + job.path + "\" for writing!");
+
+        outf.write( reinterpret_cast<const char*>(job.data.data()), job.data.size() );
+        outf.close();
+        if( outf.fail() )
+            throw std::runtime_error("Couldn't write file \"" + job.path + "\"!");
+
+        ++m_nbfiles;
+        m_nbbytes += job.data.size();
+
+        if( m_bsyncatend )
+        {
+            std::lock_guard<std::mutex> lck(m_mtxwritten);
+            m_written.push_back(job.path);
+        }
+    }
+
+    void AsyncFileSink::SyncWrittenFiles()
+    {
+        for( size_t cntf = 0; cntf < m_written.size(); ++cntf )
+        {
+            if( !SyncFileToDisk( m_written[cntf] ) )
+                m_errors.Push( m_nextindex + cntf, "Couldn't flush file \"" + m_written[cntf] + "\" to disk!" );
+        }
+        m_written.clear();
+    }
+
+//======================================================================================================================================
+//  Active Sink
+//======================================================================================================================================
+    ScopedActiveFileSink::ScopedActiveFileSink( AsyncFileSink & sink )
+        :m_pprevious( s_pactivesink.exchange(&sink) )
+    {}
+
+    ScopedActiveFileSink::ScopedActiveFileSink( AsyncFileSink * psink )
+        :m_pprevious( s_pactivesink.exchange(psink) )
+    {}
+
+    ScopedActiveFileSink::~ScopedActiveFileSink()
+    {
+        s_pactivesink = m_pprevious;
+    }
+
+    AsyncFileSink * GetActiveFileSink()
+    {
+        return s_pactivesink.load();
+    }
+
+    void WriteFileBehind( const std::string & path, std::vector<uint8_t> && data )
+    {
+        AsyncFileSink * psink = s_pactivesink.load();
+        if( psink )
+        {
+            psink->Write( path, std::move(data) );
+            return;
+        }
+
+        ofstream outf( path, ios::out | ios::binary );
+        if( !outf.is_open() )
+            throw std::runtime_error("WriteFileBehind(): Couldn't open file \"" + path + "\" for writing!");
+        outf.write( reinterpret_cast<const char*>(data.data()), data.size() );
+        if( outf.fail() )
+            throw std::runtime_error("WriteFileBehind(): Couldn't write file \"" + path + "\"!");
+    }
+};
@@ -0,0 +1,144 @@
+#ifndef ASYNC_FILE_SINK_HPP
+#define ASYNC_FILE_SINK_HPP
+/*
+async_file_sink.hpp
+2016/10/27
+psycommando@gmail.com
+Description:
+    A write-behind output sink for tools that export thousands of small files.
+    Worker threads hand over the content of their files, and a few I/O threads do the actual writing,
+    so the CPU work isn't held back by the latency of the filesystem.
+*/
+#include <utils/parallel_tasks.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_set>
+
+namespace utils
+{
+//======================================================================================================================================
+//  AsyncFileSink
+//======================================================================================================================================
+    /*
+        AsyncFileSink
+            Producers queue (path, content) pairs with Write(), and the sink's I/O threads write them to disk.
+
+            - The parent directory of each file is created if needed. Each directory is only checked once for the whole
+              lifetime of the sink, and the I/O threads create the directories of a whole batch of files at once.
+            - The total size of the files waiting to be written is bounded. Write() blocks while the queue is full,
+              so fast producers can't use up all the memory.
+            - If "bsyncatend" is set, Finish() flushes every written file to the storage device before returning.
+
+            Errors are collected, and thrown all at once by Finish(). The destructor finishes writing, but ignores errors,
+            so Finish() should always be called explicitly.
+    */
+    class AsyncFileSink
+    {
+    public:
+        static const size_t   DefNbIOThreads    = 2;
+        static const uint64_t DefMaxQueuedBytes = 64 * 1024 * 1024; //64 MB
+        static const size_t   MaxBatchLen       = 32;                //Max nb of files an I/O thread takes from the queue at once
+
+        AsyncFileSink( size_t nbiothreads = DefNbIOThreads, uint64_t maxqueuedbytes = DefMaxQueuedBytes, bool bsyncatend = false );
+        ~AsyncFileSink();
+
+        /*
+            Write
+                Queues the content of a file to be written at "path". Any existing file is overwritten.
+                Blocks while the queue is full.
+        */
+        void Write( const std::string & path, std::vector<uint8_t> && data );
+        void Write( const std::string & path, const std::string & text );
+
+        /*
+            Finish
+                Waits until all the queued files were written, and stops the I/O threads.
+                Throws a single exception listing every files that couldn't be written.
+                Nothing can be written to the sink afterwards.
+        */
+        void Finish();
+
+        inline uint64_t getNbFilesWritten()const { return m_nbfiles; }
+        inline uint64_t getNbBytesWritten()const { return m_nbbytes; }
+
+    private:
+        struct writejob_t
+        {
+            size_t               index;
+            std::string          path;
+            std::vector<uint8_t> data;
+        };
+
+        void IOLoop();
+        void CreateParentDirs( const std::vector<writejob_t> & batch );
+        void WriteAFile      ( const writejob_t & job );
+        void SyncWrittenFiles();
+        void StopIOThreads   ();
+
+    private:
+        MemoryBudget                    m_queuebudget;
+        bool                            m_bsyncatend;
+
+        std::mutex                      m_mtxqueue;
+        std::condition_variable         m_cvqueue;
+        std::deque<writejob_t>          m_queue;
+        size_t                          m_nextindex;
+        bool                            m_bstopping;
+        bool                            m_bfinished;
+        std::vector<std::thread>        m_iothreads;
+
+        std::mutex                      m_mtxdirs;
+        std::unordered_set<std::string> m_knowndirs;
+
+        std::mutex                      m_mtxwritten;
+        std::vector<std::string>        m_written;      //Only filled when syncing at the end
+
+        JobErrorList                    m_errors;
+        std::atomic<uint64_t>           m_nbfiles;
+        std::atomic<uint64_t>           m_nbbytes;
+    };
+
+//======================================================================================================================================
+//  Active Sink
+//======================================================================================================================================
+    /*
+        ScopedActiveFileSink
+            Makes "sink" the sink used by WriteFileBehind() and the other export helpers for as long as it exists,
+            so the code deep inside an export doesn't have to pass the sink around.
+            The previously active sink is restored afterwards.
+            Passing a null sink makes files be written right away within the scope.
+    */
+    class ScopedActiveFileSink
+    {
+    public:
+        explicit ScopedActiveFileSink( AsyncFileSink & sink );
+        explicit ScopedActiveFileSink( AsyncFileSink * psink );
+        ~ScopedActiveFileSink();
+
+    private:
+        ScopedActiveFileSink( const ScopedActiveFileSink & )            = delete;
+        ScopedActiveFileSink & operator=( const ScopedActiveFileSink & ) = delete;
+
+        AsyncFileSink * m_pprevious;
+    };
+
+    /*
+        Returns the active sink, or null if there are none.
+    */
+    AsyncFileSink * GetActiveFileSink();
+
+    /*
+        WriteFileBehind
+            Queues the file on the active sink if there is one. Otherwise, writes it right away.
+            Only meant for output files that won't be read back before the sink is finished.
+    */
+    void WriteFileBehind( const std::string & path, std::vector<uint8_t> && data );
+};
+
+#endif
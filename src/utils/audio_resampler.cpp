@@ -0,0 +1,221 @@
+#include "audio_resampler.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <stdexcept>
+#include <sstream>
+using namespace std;
+
+namespace utils
+{
+//=============================================================================================
+//  Helpers
+//=============================================================================================
+    const double PI_Val           = 3.14159265358979323846;
+    const double ResamplerRolloff = 0.94;   //The cutoff is placed a bit under the nyquist frequency, to leave room for the transition band
+    const double ResamplerBeta    = 7.0;    //Kaiser window beta parameter
+    const size_t ResamplerPadding = PolyphaseResampler::HalfTaps + 1;  //Nb of extra input samples needed on each side of a range
+
+    //Zeroth order modified bessel function of the first kind, for the Kaiser window
+    double BesselI0( double x )
+    {
+        double sum  = 1.0;
+        double term = 1.0;
+        for( int k = 1; k < 50; ++k )
+        {
+            const double halfxk = x / (2.0 * k);
+            term *= halfxk * halfxk;
+            sum  += term;
+            if( term < (sum * 1e-12) )
+                break;
+        }
+        return sum;
+    }
+
+    inline double Sinc( double x )
+    {
+        if( x == 0.0 )
+            return 1.0;
+        return sin( PI_Val * x ) / ( PI_Val * x );
+    }
+
+    inline pcm16s_t FloatToPCM16( float smpl )
+    {
+        smpl = std::min( std::max( smpl, -32768.0f ), 32767.0f );
+        return static_cast<pcm16s_t>( (smpl >= 0.0f)? (smpl + 0.5f) : (smpl - 0.5f) );
+    }
+
+//=============================================================================================
+//  PolyphaseResampler
+//=============================================================================================
+    PolyphaseResampler::PolyphaseResampler( uint32_t srcrate, uint32_t destrate )
+        :m_srcrate(srcrate), m_destrate(destrate)
+    {
+        if( srcrate == 0 || destrate == 0 )
+        {
+            stringstream sstr;
+            sstr <<"PolyphaseResampler::PolyphaseResampler(): Invalid sample rates " <<srcrate <<" -> " <<destrate <<"!";
+            throw std::invalid_argument(sstr.str());
+        }
+
+        const double cutoff  = std::min( 1.0, Ratio() ) * ResamplerRolloff;
+        const double wndnorm = BesselI0(ResamplerBeta);
+
+        //Build one filter per phase, plus one, so the last phase can be interpolated with the next input sample
+        m_coefs.resize( (NbPhases + 1) * NbTaps );
+        for( size_t cntph = 0; cntph <= NbPhases; ++cntph )
+        {
+            const double frac   = static_cast<double>(cntph) / static_cast<double>(NbPhases);
+            float      * prow   = m_coefs.data() + (cntph * NbTaps);
+            double       rowsum = 0.0;
+            double       row[NbTaps];
+
+            for( size_t cnttap = 0; cnttap < NbTaps; ++cnttap )
+            {
+                //Distance between the input sample for this tap and the output position
+                const double dist    = static_cast<double>(cnttap) - static_cast<double>(HalfTaps - 1) - frac;
+                const double wndpos  = dist / static_cast<double>(HalfTaps);
+                const double wnd     = (std::abs(wndpos) < 1.0)? BesselI0( ResamplerBeta * sqrt( 1.0 - (wndpos * wndpos) ) ) / wndnorm : 0.0;
+                row[cnttap] = cutoff * Sinc( cutoff * dist ) * wnd;
+                rowsum     += row[cnttap];
+            }
+
+            //Normalize, so a constant signal stays the same
+            for( size_t cnttap = 0; cnttap < NbTaps; ++cnttap )
+                prow[cnttap] = static_cast<float>( row[cnttap] / rowsum );
+        }
+
+        m_deltas.resize( NbPhases * NbTaps );
+        for( size_t cntcoef = 0; cntcoef < m_deltas.size(); ++cntcoef )
+            m_deltas[cntcoef] = m_coefs[cntcoef + NbTaps] - m_coefs[cntcoef];
+    }
+
+    std::shared_ptr<const PolyphaseResampler> PolyphaseResampler::Get( uint32_t srcrate, uint32_t destrate )
+    {
+        static std::mutex                                                                 s_mtx;
+        static std::map<std::pair<uint32_t,uint32_t>, std::shared_ptr<const PolyphaseResampler>> s_resamplers;
+
+        std::lock_guard<std::mutex> lck(s_mtx);
+        auto & presampler = s_resamplers[std::make_pair(srcrate, destrate)];
+        if( !presampler )
+            presampler = std::make_shared<const PolyphaseResampler>( srcrate, destrate );
+        return presampler;
+    }
+
+    size_t PolyphaseResampler::ConvertLength( size_t srclen )const
+    {
+        return static_cast<size_t>( ( (static_cast<uint64_t>(srclen) * m_destrate) + (m_srcrate / 2) ) / m_srcrate );
+    }
+
+    pcm16ssmpls_t PolyphaseResampler::Resample( const pcm16ssmpls_t & smpl )const
+    {
+        const size_t  nbout = std::max<size_t>( ConvertLength(smpl.size()), (smpl.empty())? 0 : 1 );
+        pcm16ssmpls_t out(nbout);
+        if( smpl.empty() )
+            return std::move(out);
+
+        //Silence before and after the sample
+        vector<float> buf( smpl.size() + (2 * ResamplerPadding), 0.0f );
+        std::copy( smpl.begin(), smpl.end(), buf.begin() + ResamplerPadding );
+
+        RenderSection( buf.data() + ResamplerPadding, 0, smpl.size(), nbout, out.data() );
+        return std::move(out);
+    }
+
+    pcm16ssmpls_t PolyphaseResampler::Resample( const pcm16ssmpls_t & smpl, size_t & inout_loopbeg, size_t & inout_loopend )const
+    {
+        const size_t loopbeg = inout_loopbeg;
+        const size_t loopend = inout_loopend;
+        if( loopbeg >= loopend || loopend > smpl.size() )
+        {
+            inout_loopbeg = std::min( ConvertLength(loopbeg), ConvertLength(smpl.size()) );
+            inout_loopend = std::min( ConvertLength(loopend), ConvertLength(smpl.size()) );
+            return Resample(smpl);
+        }
+
+        const size_t looplen    = loopend - loopbeg;
+        const size_t postlen    = smpl.size() - loopend;
+        const size_t newloopbeg = ConvertLength(loopbeg);
+        const size_t newlooplen = std::max<size_t>( ConvertLength(looplen), 1 );
+        const size_t newpostlen = ConvertLength(postlen);
+        pcm16ssmpls_t out( newloopbeg + newlooplen + newpostlen );
+
+        auto lambdaloopsmpl = [&]( size_t index )->float
+        {
+            return smpl[loopbeg + (index % looplen)];
+        };
+
+        //Before the loop: The sample leads into the loop, which repeats past its end
+        if( newloopbeg != 0 )
+        {
+            vector<float> buf( loopend + (2 * ResamplerPadding), 0.0f );
+            std::copy( smpl.begin(), smpl.begin() + loopend, buf.begin() + ResamplerPadding );
+            for( size_t cntpad = 0; cntpad < ResamplerPadding; ++cntpad )
+                buf[ResamplerPadding + loopend + cntpad] = lambdaloopsmpl(looplen + cntpad);
+            RenderSection( buf.data() + ResamplerPadding, 0, loopbeg, newloopbeg, out.data() );
+        }
+
+        //The loop: Periodic on both sides, so the end of the loop blends into its beginning
+        {
+            vector<float> buf( looplen + (2 * ResamplerPadding) );
+            const size_t  padloops = (ResamplerPadding / looplen) + 1;
+            for( size_t cntsmpl = 0; cntsmpl < buf.size(); ++cntsmpl )
+                buf[cntsmpl] = lambdaloopsmpl( (padloops * looplen) + cntsmpl - ResamplerPadding );
+            RenderSection( buf.data() + ResamplerPadding, 0, looplen, newlooplen, out.data() + newloopbeg );
+        }
+
+        //After the loop: Played once the loop is over, so it follows the end of the loop
+        if( newpostlen != 0 )
+        {
+            vector<float> buf( smpl.size() + (2 * ResamplerPadding), 0.0f );
+            std::copy( smpl.begin(), smpl.end(), buf.begin() + ResamplerPadding );
+            RenderSection( buf.data() + ResamplerPadding, loopend, postlen, newpostlen, out.data() + newloopbeg + newlooplen );
+        }
+
+        inout_loopbeg = newloopbeg;
+        inout_loopend = newloopbeg + newlooplen;
+        return std::move(out);
+    }
+
+    void PolyphaseResampler::RenderSection( const float * psrc, size_t srcbeg, size_t srclen, size_t nbout, pcm16s_t * pout )const
+    {
+        static const size_t NbAccumulators = 8;  //Several independent sums, so the compiler can vectorize the filter loop
+        static const double FixedOne       = 4294967296.0; //Positions are fixed point 32.32
+        if( nbout == 0 )
+            return;
+
+        const uint64_t step    = static_cast<uint64_t>( (static_cast<double>(srclen) / static_cast<double>(nbout)) * FixedOne );
+        const uint64_t posbeg  = static_cast<uint64_t>(srcbeg) << 32;
+        const float    FracMul = static_cast<float>( 1.0 / FixedOne );
+
+        for( size_t cntout = 0; cntout < nbout; ++cntout )
+        {
+            const uint64_t pos      = posbeg + (cntout * step);
+            const size_t   ipos     = static_cast<size_t>( pos >> 32 );
+            const uint64_t phasepos = (pos & 0xFFFFFFFFULL) * NbPhases;
+            const size_t   phase    = static_cast<size_t>( phasepos >> 32 );
+            const float    alpha    = static_cast<float>( phasepos & 0xFFFFFFFFULL ) * FracMul;
+
+            const float * px      = psrc + ipos - (HalfTaps - 1);
+            const float * pcoefs  = m_coefs.data()  + (phase * NbTaps);
+            const float * pdeltas = m_deltas.data() + (phase * NbTaps);
+            float         acc[NbAccumulators] = {0.0f};
+
+            for( size_t cnttap = 0; cnttap < NbTaps; cnttap += NbAccumulators )
+            {
+                for( size_t cntacc = 0; cntacc < NbAccumulators; ++cntacc )
+                {
+                    const size_t tap = cnttap + cntacc;
+                    acc[cntacc] += px[tap] * (pcoefs[tap] + (alpha * pdeltas[tap]));
+                }
+            }
+
+            float sum = 0.0f;
+            for( size_t cntacc = 0; cntacc < NbAccumulators; ++cntacc )
+                sum += acc[cntacc];
+            pout[cntout] = FloatToPCM16(sum);
+        }
+    }
+
+};
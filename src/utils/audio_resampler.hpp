@@ -0,0 +1,89 @@
+#ifndef AUDIO_RESAMPLER_HPP
+#define AUDIO_RESAMPLER_HPP
+/*
+audio_resampler.hpp
+2016/10/24
+psycommando@gmail.com
+Description:
+    A polyphase windowed-sinc resampler for mono PCM16 samples, that keeps loop points sample accurate.
+*/
+#include <utils/audio_utilities.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace utils
+{
+    /*
+        PolyphaseResampler
+            Resamples PCM16 samples from one sample rate to another.
+
+            Each output sample is computed from "NbTaps" input samples, weighted by a Kaiser windowed
+            sinc filter. The filter is precomputed for "NbPhases" fractional positions between two input
+            samples, and coefficients are interpolated linearly between the two nearest positions.
+            The cutoff of the filter is lowered when downsampling, to avoid aliasing.
+
+            Looped samples are split into the part before the loop, the loop, and the part after it.
+            Each part is resampled separately, with the loop treated as periodic, so the resampled loop
+            is still seamless. The loop's length is rounded to a whole nb of samples, so loops
+            a few samples long may end up slightly out of tune.
+    */
+    class PolyphaseResampler
+    {
+    public:
+        static const size_t NbTaps   = 32;
+        static const size_t HalfTaps = NbTaps / 2;
+        static const size_t NbPhases = 512;
+
+        PolyphaseResampler( uint32_t srcrate, uint32_t destrate );
+
+        /*
+            Get
+                Returns a shared resampler for the given rates.
+                Filter banks are built once per rate ratio, and shared by all threads.
+        */
+        static std::shared_ptr<const PolyphaseResampler> Get( uint32_t srcrate, uint32_t destrate );
+
+        inline uint32_t SrcRate ()const { return m_srcrate; }
+        inline uint32_t DestRate()const { return m_destrate; }
+        inline double   Ratio   ()const { return static_cast<double>(m_destrate) / static_cast<double>(m_srcrate); }
+
+        /*
+            ConvertLength
+                Returns the nb of samples a span of "srclen" samples at the source rate takes at the destination rate.
+        */
+        size_t ConvertLength( size_t srclen )const;
+
+        /*
+            Resample
+                Resamples a non-looped sample.
+        */
+        pcm16ssmpls_t Resample( const pcm16ssmpls_t & smpl )const;
+
+        /*
+            Resample
+                Resamples a looped sample. The loop is the [inout_loopbeg, inout_loopend) range.
+                The loop points are replaced with their position in the resampled sample.
+                If the loop points are invalid, the sample is resampled without a loop, and the loop
+                points are only scaled.
+        */
+        pcm16ssmpls_t Resample( const pcm16ssmpls_t & smpl, size_t & inout_loopbeg, size_t & inout_loopend )const;
+
+    private:
+        /*
+            Computes "nbout" samples, evenly spread over the "srclen" input samples beginning at "srcbeg".
+            "psrc" points to the first sample of the input, and must have at least "HalfTaps + 1" valid
+            samples before the range, and after it.
+        */
+        void RenderSection( const float * psrc, size_t srcbeg, size_t srclen, size_t nbout, pcm16s_t * pout )const;
+
+    private:
+        uint32_t            m_srcrate;
+        uint32_t            m_destrate;
+        std::vector<float>  m_coefs;    //The filter for each phase, NbTaps coefficients per phase, plus an extra phase for interpolating the last one
+        std::vector<float>  m_deltas;   //The difference between the coefficients of each phase and of the next one
+    };
+
+};
+
+#endif
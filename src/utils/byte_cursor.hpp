@@ -0,0 +1,354 @@
+#ifndef BYTE_CURSOR_HPP
+#define BYTE_CURSOR_HPP
+/*
+byte_cursor.hpp
+2016/10/27
+psycommando@gmail.com
+Description:
+    Cursors for reading and writing integers from/to contiguous bytes, with the byte order picked at compile time.
+    Meant to replace the byte by byte ReadIntFromBytes/WriteIntToBytes for parsing headers and other fixed size structures.
+
+    A structure makes a single bounds check with Require() for its whole length, then loads each of its fields with
+    the unchecked methods, which compile down to a memcpy, plus a byte swap when the byte order differs from the host's.
+*/
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#ifdef _MSC_VER
+    #include <stdlib.h>
+#endif
+
+namespace utils
+{
+//======================================================================================================
+//  Byte Order
+//======================================================================================================
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    static const bool HostIsLittleEndian = true;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static const bool HostIsLittleEndian = false;
+#else
+    #error "byte_cursor.hpp: Couldn't determine the byte order of the target platform!"
+#endif
+
+    /*
+        uint_of_size
+            The unsigned integer type with the given size in bytes.
+    */
+    template<size_t _NbBytes> struct uint_of_size;
+    template<> struct uint_of_size<1> { typedef uint8_t  type; };
+    template<> struct uint_of_size<2> { typedef uint16_t type; };
+    template<> struct uint_of_size<4> { typedef uint32_t type; };
+    template<> struct uint_of_size<8> { typedef uint64_t type; };
+
+    inline uint8_t  ByteSwap( uint8_t  val ) { return val; }
+#ifdef _MSC_VER
+    inline uint16_t ByteSwap( uint16_t val ) { return _byteswap_ushort(val); }
+    inline uint32_t ByteSwap( uint32_t val ) { return _byteswap_ulong (val); }
+    inline uint64_t ByteSwap( uint64_t val ) { return _byteswap_uint64(val); }
+#else
+    inline uint16_t ByteSwap( uint16_t val ) { return __builtin_bswap16(val); }
+    inline uint32_t ByteSwap( uint32_t val ) { return __builtin_bswap32(val); }
+    inline uint64_t ByteSwap( uint64_t val ) { return __builtin_bswap64(val); }
+#endif
+
+    /*
+        LoadInt
+            Reads an integer of type T from "psrc", stored in little endian if _LittleEndian is true, or big endian otherwise.
+            No bounds checking is done.
+    */
+    template<class T, bool _LittleEndian>
+        inline T LoadInt( const uint8_t * psrc )
+    {
+        static_assert( std::is_integral<T>::value, "LoadInt(): Type T is not an integer!" );
+        typedef typename uint_of_size<sizeof(T)>::type uint_t;
+        uint_t val;
+        std::memcpy( &val, psrc, sizeof(T) );
+        if( _LittleEndian != HostIsLittleEndian )
+            val = ByteSwap(val);
+        return static_cast<T>(val);
+    }
+
+    /*
+        StoreInt
+            Writes an integer of type T to "pdest", in little endian if _LittleEndian is true, or big endian otherwise.
+            No bounds checking is done.
+    */
+    template<bool _LittleEndian, class T>
+        inline void StoreInt( T val, uint8_t * pdest )
+    {
+        static_assert( std::is_integral<T>::value, "StoreInt(): Type T is not an integer!" );
+        typedef typename uint_of_size<sizeof(T)>::type uint_t;
+        uint_t uval = static_cast<uint_t>(val);
+        if( _LittleEndian != HostIsLittleEndian )
+            uval = ByteSwap(uval);
+        std::memcpy( pdest, &uval, sizeof(T) );
+    }
+
+//======================================================================================================
+//  ByteCursor
+//======================================================================================================
+    /*
+        ByteCursor
+            Reads integers and raw bytes sequentially from a range of contiguous bytes.
+            Integers are little endian by default, like everything on the NDS. The "BE" variants read big endian values,
+            like magic numbers.
+
+            The checked methods throw a std::runtime_error if the range doesn't have enough bytes left.
+            The "Unchecked" methods don't check anything, and are meant to be used after a single call to Require().
+    */
+    class ByteCursor
+    {
+    public:
+        ByteCursor( const uint8_t * pbeg, const uint8_t * pend )
+            :m_pbeg(pbeg), m_pcur(pbeg), m_pend(pend)
+        {}
+
+        explicit ByteCursor( const std::vector<uint8_t> & data, size_t offset = 0 )
+            :m_pbeg(data.data()), m_pcur(data.data()), m_pend(data.data() + data.size())
+        {
+            Seek(offset);
+        }
+
+        //Throws if there are less than "nbbytes" left to read.
+        inline const ByteCursor & Require( size_t nbbytes )const
+        {
+            if( nbbytes > Remaining() )
+                ThrowOutOfRange(nbbytes);
+            return *this;
+        }
+
+        template<class T> inline T Read()            { Require(sizeof(T)); return ReadUnchecked<T>(); }
+        template<class T> inline T ReadBE()          { Require(sizeof(T)); return ReadUncheckedBE<T>(); }
+        template<class T> inline T ReadUnchecked()   { T val = LoadInt<T,true> (m_pcur); m_pcur += sizeof(T); return val; }
+        template<class T> inline T ReadUncheckedBE() { T val = LoadInt<T,false>(m_pcur); m_pcur += sizeof(T); return val; }
+
+        //Reads into an existing variable, so the type doesn't have to be repeated.
+        template<class T> inline ByteCursor & Read           ( T & dest ) { dest = Read<T>();            return *this; }
+        template<class T> inline ByteCursor & ReadBE         ( T & dest ) { dest = ReadBE<T>();          return *this; }
+        template<class T> inline ByteCursor & ReadUnchecked  ( T & dest ) { dest = ReadUnchecked<T>();   return *this; }
+        template<class T> inline ByteCursor & ReadUncheckedBE( T & dest ) { dest = ReadUncheckedBE<T>(); return *this; }
+
+        inline void ReadBytes( void * pdest, size_t nbbytes )
+        {
+            Require(nbbytes);
+            ReadBytesUnchecked( pdest, nbbytes );
+        }
+
+        inline void ReadBytesUnchecked( void * pdest, size_t nbbytes )
+        {
+            std::memcpy( pdest, m_pcur, nbbytes );
+            m_pcur += nbbytes;
+        }
+
+        inline void Skip( size_t nbbytes )
+        {
+            Require(nbbytes);
+            m_pcur += nbbytes;
+        }
+
+        inline void Seek( size_t offset )
+        {
+            if( offset > size() )
+                ThrowOutOfRange( offset - Tell() );
+            m_pcur = m_pbeg + offset;
+        }
+
+        /*
+            SubCursor
+                Returns a cursor over the next "nbbytes" bytes, and moves past them.
+        */
+        inline ByteCursor SubCursor( size_t nbbytes )
+        {
+            Require(nbbytes);
+            ByteCursor sub( m_pcur, m_pcur + nbbytes );
+            m_pcur += nbbytes;
+            return sub;
+        }
+
+        inline size_t          Tell     ()const { return static_cast<size_t>(m_pcur - m_pbeg); }
+        inline size_t          Remaining()const { return static_cast<size_t>(m_pend - m_pcur); }
+        inline size_t          size     ()const { return static_cast<size_t>(m_pend - m_pbeg); }
+        inline bool            AtEnd    ()const { return m_pcur == m_pend; }
+        inline const uint8_t * current  ()const { return m_pcur; }
+
+    private:
+        void ThrowOutOfRange( size_t nbbytes )const
+        {
+            std::stringstream sstr;
+            sstr << "ByteCursor::Require(): Tried to read " <<nbbytes <<" bytes at offset " <<Tell() <<", but only " <<Remaining() <<" bytes are left!";
+            throw std::runtime_error(sstr.str());
+        }
+
+    private:
+        const uint8_t * m_pbeg;
+        const uint8_t * m_pcur;
+        const uint8_t * m_pend;
+    };
+
+//======================================================================================================
+//  ByteWriter
+//======================================================================================================
+    /*
+        ByteWriter
+            Writes integers and raw bytes sequentially into a range of contiguous bytes, the same way ByteCursor reads them.
+            The writer never allocates. To append to a vector, resize it first, and write into the new part.
+    */
+    class ByteWriter
+    {
+    public:
+        ByteWriter( uint8_t * pbeg, uint8_t * pend )
+            :m_pbeg(pbeg), m_pcur(pbeg), m_pend(pend)
+        {}
+
+        //Throws if there are less than "nbbytes" left to write to.
+        inline const ByteWriter & Require( size_t nbbytes )const
+        {
+            if( nbbytes > Remaining() )
+                ThrowOutOfRange(nbbytes);
+            return *this;
+        }
+
+        template<class T> inline ByteWriter & Write           ( T val ) { Require(sizeof(T)); return WriteUnchecked(val); }
+        template<class T> inline ByteWriter & WriteBE         ( T val ) { Require(sizeof(T)); return WriteUncheckedBE(val); }
+        template<class T> inline ByteWriter & WriteUnchecked  ( T val ) { StoreInt<true> (val, m_pcur); m_pcur += sizeof(T); return *this; }
+        template<class T> inline ByteWriter & WriteUncheckedBE( T val ) { StoreInt<false>(val, m_pcur); m_pcur += sizeof(T); return *this; }
+
+        inline void WriteBytes( const void * psrc, size_t nbbytes )
+        {
+            Require(nbbytes);
+            WriteBytesUnchecked( psrc, nbbytes );
+        }
+
+        inline void WriteBytesUnchecked( const void * psrc, size_t nbbytes )
+        {
+            std::memcpy( m_pcur, psrc, nbbytes );
+            m_pcur += nbbytes;
+        }
+
+        //Writes "nbbytes" copies of "val"
+        inline void Fill( uint8_t val, size_t nbbytes )
+        {
+            Require(nbbytes);
+            std::memset( m_pcur, val, nbbytes );
+            m_pcur += nbbytes;
+        }
+
+        inline size_t    Tell     ()const { return static_cast<size_t>(m_pcur - m_pbeg); }
+        inline size_t    Remaining()const { return static_cast<size_t>(m_pend - m_pcur); }
+        inline size_t    size     ()const { return static_cast<size_t>(m_pend - m_pbeg); }
+        inline uint8_t * current  ()const { return m_pcur; }
+
+    private:
+        void ThrowOutOfRange( size_t nbbytes )const
+        {
+            std::stringstream sstr;
+            sstr << "ByteWriter::Require(): Tried to write " <<nbbytes <<" bytes at offset " <<Tell() <<", but only " <<Remaining() <<" bytes are left!";
+            throw std::runtime_error(sstr.str());
+        }
+
+    private:
+        uint8_t * m_pbeg;
+        uint8_t * m_pcur;
+        uint8_t * m_pend;
+    };
+
+//======================================================================================================
+//  Iterator Adapters
+//======================================================================================================
+    /*
+        is_contiguous_byte_iterator
+            Whether the iterator type is known to point into contiguous bytes, so cursors can work on the memory directly.
+    */
+    template<class _ItTy> struct is_contiguous_byte_iterator : std::integral_constant<bool,
+        std::is_same<_ItTy, uint8_t*>::value                             ||
+        std::is_same<_ItTy, const uint8_t*>::value                       ||
+        std::is_same<_ItTy, std::vector<uint8_t>::iterator>::value       ||
+        std::is_same<_ItTy, std::vector<uint8_t>::const_iterator>::value >
+    {};
+
+    template<size_t _NbBytes, class _StructTy, class _init>
+        inline _init ReadWithCursor_impl( _StructTy & dest, _init itbeg, _init itend, std::true_type )
+    {
+        const size_t    len  = static_cast<size_t>( std::distance( itbeg, itend ) );
+        const uint8_t * pbeg = (len != 0)? &(*itbeg) : nullptr;
+        ByteCursor      cur( pbeg, pbeg + len );
+        dest.Read(cur);
+        std::advance( itbeg, cur.Tell() );
+        return itbeg;
+    }
+
+    template<size_t _NbBytes, class _StructTy, class _init>
+        inline _init ReadWithCursor_impl( _StructTy & dest, _init itbeg, _init itend, std::false_type )
+    {
+        std::array<uint8_t, _NbBytes> buf;
+        size_t cntby = 0;
+        for( ; cntby < _NbBytes && itbeg != itend; ++cntby, ++itbeg )
+            buf[cntby] = static_cast<uint8_t>(*itbeg);
+        ByteCursor cur( buf.data(), buf.data() + cntby );
+        dest.Read(cur);
+        return itbeg;
+    }
+
+    /*
+        ReadWithCursor
+            Lets a structure that reads itself with a "void Read( ByteCursor & )" method keep its iterator based
+            "ReadFromContainer( itbeg, itend )" interface, so the code using it doesn't have to change.
+
+            Iterators over contiguous bytes are read in place. For any other iterators, the "_NbBytes" bytes the structure
+            reads are first copied into a buffer.
+            Returns the iterator past the last byte read.
+    */
+    template<size_t _NbBytes, class _StructTy, class _init>
+        inline _init ReadWithCursor( _StructTy & dest, _init itbeg, _init itend )
+    {
+        return ReadWithCursor_impl<_NbBytes>( dest, itbeg, itend, is_contiguous_byte_iterator<_init>() );
+    }
+
+    template<size_t _NbBytes, class _StructTy, class _outit>
+        inline _outit WriteWithWriter_impl( const _StructTy & src, _outit itw, std::true_type )
+    {
+        uint8_t  * pbeg = &(*itw);
+        ByteWriter wr( pbeg, pbeg + _NbBytes );
+        src.Write(wr);
+        std::advance( itw, wr.Tell() );
+        return itw;
+    }
+
+    template<size_t _NbBytes, class _StructTy, class _outit>
+        inline _outit WriteWithWriter_impl( const _StructTy & src, _outit itw, std::false_type )
+    {
+        std::array<uint8_t, _NbBytes> buf;
+        ByteWriter wr( buf.data(), buf.data() + _NbBytes );
+        src.Write(wr);
+        return std::copy( buf.begin(), buf.begin() + wr.Tell(), itw );
+    }
+
+    /*
+        WriteWithWriter
+            Lets a structure that writes itself with a "void Write( ByteWriter & )const" method keep its iterator based
+            "WriteToContainer( itw )" interface.
+
+            Mutable iterators over contiguous bytes are written in place, and must have at least "_NbBytes" bytes of room,
+            like with WriteIntToBytes. Anything else, like back_insert_iterators, gets a copy of the bytes once the
+            structure is written into a buffer.
+            Returns the iterator past the last byte written.
+    */
+    template<size_t _NbBytes, class _StructTy, class _outit>
+        inline _outit WriteWithWriter( const _StructTy & src, _outit itw )
+    {
+        return WriteWithWriter_impl<_NbBytes>( src, itw, std::integral_constant<bool,
+                                                                               std::is_same<_outit, uint8_t*>::value ||
+                                                                               std::is_same<_outit, std::vector<uint8_t>::iterator>::value>() );
+    }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "cmdline_util.hpp"
+#include <utils/trace.hpp>
 #include <vector>
 #include <sstream>
 #include <algorithm>
@@ -18,6 +19,72 @@ namespace utils{ namespace cmdl
     const std::string CArgsParser::ADDITIONAL_INPUT_PARAM_SYMBOL = "+";
 
 
+//============================================================================================
+//  Common Options
+//============================================================================================
+    const std::string OPTION_TRACE = "trace";
+
+    bool ParseOptionTrace( const std::vector<std::string> & optdata )
+    {
+        if( optdata.size() != 2 || optdata.back().empty() )
+            return false;
+        cout <<"<*>-Tracing enabled! Writing trace events to \"" <<optdata.back() <<"\".\n";
+        utils::trace::BeginSession( optdata.back() );
+        return true;
+    }
+
+    const std::vector<optionparsing_t> & CommonOptions()
+    {
+        static const vector<optionparsing_t> CommonOpts=
+        {{
+            //Trace file output
+            {
+                OPTION_TRACE,
+                1,
+                "Record where the time is spent, and write it as a Chrome trace event file (chrome://tracing). Detailed events are only recorded when the program was built with tracing enabled.",
+                "-trace \"path/to/trace.json\"",
+                &ParseOptionTrace,
+            },
+        }};
+        return CommonOpts;
+    }
+
+    std::vector<optionparsing_t> WithCommonOptions( std::vector<optionparsing_t> options )
+    {
+        const auto & common = CommonOptions();
+        options.insert( options.end(), common.begin(), common.end() );
+        return std::move(options);
+    }
+
+    bool ParseCommonOptions( const std::vector<std::vector<std::string>> & optionsfound )
+    {
+        bool bsuccess = true;
+        for( const auto & anopt : CommonOptions() )
+        {
+            for( const auto & found : optionsfound )
+            {
+                if( !found.empty() && found.front() == anopt.optionsymbol && !anopt.myOptionParseFun(found) )
+                {
+                    cerr <<"<!>- Error while parsing option : \"" <<anopt.optionsymbol <<"\"!\n";
+                    bsuccess = false;
+                }
+            }
+        }
+        return bsuccess;
+    }
+
+    bool IsCommonOption( const std::vector<std::string> & optionfound )
+    {
+        if( optionfound.empty() )
+            return false;
+        for( const auto & anopt : CommonOptions() )
+        {
+            if( optionfound.front() == anopt.optionsymbol )
+                return true;
+        }
+        return false;
+    }
+
 //============================================================================================
 //  RAIIClogRedirect
 //============================================================================================
@@ -271,7 +338,7 @@ namespace utils{ namespace cmdl
         static const string               BulletChr = "->";
         static const string               OptTag    = "(opt)";
         const vector<argumentparsing_t> & refMyArgs = getArgumentsList();
-        const vector<optionparsing_t>   & refMyOpts = getOptionsList();
+        const vector<optionparsing_t>     refMyOpts = WithCommonOptions( getOptionsList() );
         const argumentparsing_t         * myExtra   = getExtraArg();
         bool                              bDisplayOptValLegend = false; //Whether we got at least one option that has a value
         unsigned int                      longestargname    = 0;
@@ -468,7 +535,7 @@ namespace utils{ namespace cmdl
 
     void CommandLineUtility::parseOptions( CArgsParser & argsparse )
     {
-        const auto &           refOptions = getOptionsList();
+        const auto             refOptions = WithCommonOptions( getOptionsList() );
         vector<vector<string>> rawoptions = argsparse.getAllFoundOptions();
 
         for( auto & anopt : refOptions )
@@ -80,6 +80,25 @@ namespace utils{ namespace cmdl
     };
 
 
+//===============================================================================================
+// Common Options
+//===============================================================================================
+    /************************************************************************
+        CommonOptions
+            Options every command line tool accepts, on top of its own.
+            CommandLineUtility handles them by itself. Tools using CArgsParser
+            directly pass their option list through WithCommonOptions, and the
+            options found to ParseCommonOptions.
+    ************************************************************************/
+    const std::vector<optionparsing_t> & CommonOptions();
+    std::vector<optionparsing_t>         WithCommonOptions ( std::vector<optionparsing_t> options );
+
+    //Returns false if one of the common options found couldn't be parsed.
+    bool                                 ParseCommonOptions( const std::vector<std::vector<std::string>> & optionsfound );
+
+    //Whether an option found is one of the common options. Tools skip those when handling their own options.
+    bool                                 IsCommonOption    ( const std::vector<std::string> & optionfound );
+
 //===============================================================================================
 // Classes
 //===============================================================================================
@@ -199,7 +218,7 @@ namespace utils{ namespace cmdl
             }
             else
             {
-                CArgsParser parsemyargs( getOptionsList(), argv, argc ); //#TODO: eventually combine CArgParser with this class!
+                CArgsParser parsemyargs( WithCommonOptions(getOptionsList()), argv, argc ); //#TODO: eventually combine CArgParser with this class!
                 parseArgs(parsemyargs);
                 parseOptions(parsemyargs);
                 parseExtraArgs(parsemyargs);
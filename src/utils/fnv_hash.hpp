@@ -0,0 +1,37 @@
+#ifndef FNV_HASH_HPP
+#define FNV_HASH_HPP
+/*
+fnv_hash.hpp
+2016/10/30
+psycommando@gmail.com
+Description:
+    64 bits FNV-1a hashing of raw bytes. Used to find identical tiles, images and strips when writing graphics,
+    and to tell whether files changed since they were last exported or imported.
+    The values end up in asset catalogs and script manifests, so the algorithm must never change!
+*/
+#include <cstdint>
+#include <cstddef>
+
+namespace utils
+{
+    const uint64_t FNV1aOffsetBasis = 0xCBF29CE484222325ULL;
+    const uint64_t FNV1aPrime       = 0x100000001B3ULL;
+
+    /*
+        HashFNV1a
+            FNV-1a over a range of bytes. "seed" is the hash of whatever came before, to chain several ranges.
+    */
+    inline uint64_t HashFNV1a( const void * pdata, size_t len, uint64_t seed = FNV1aOffsetBasis )
+    {
+        const uint8_t * pbytes = static_cast<const uint8_t*>(pdata);
+        uint64_t        hash   = seed;
+        for( size_t cntby = 0; cntby < len; ++cntby )
+        {
+            hash ^= pbytes[cntby];
+            hash *= FNV1aPrime;
+        }
+        return hash;
+    }
+};
+
+#endif
@@ -138,7 +138,37 @@ namespace utils
         {
             return ::utils::LibWide().Logger().Log();
         }
+
+        /*
+            slogf
+                Formats the text into a per-thread scratch string, replacing each "{}" with the next argument,
+                and hands it to the logger in one go. Use it through the UTILS_LOG_* macros below, so the
+                arguments aren't even evaluated when logging is off.
+        */
+        template<class ... _ArgsTy>
+            void slogf( logging::eLogLevel lvl, const char * fmt, const _ArgsTy & ... args )
+        {
+            thread_local std::string text;
+            text.clear();
+            logging::FormatLogText( text, fmt, args... );
+            ::utils::LibWide().Logger().Write( lvl, text.data(), text.size() );
+        }
     };
 };
 
+/*
+    Level filtered logging
+        Levels below PPMDU_LOG_MIN_LEVEL are removed at compile time, and the others only
+        format their arguments when logging is on.
+        Ex:  UTILS_LOG_DEBUG("\tLoading {}.{}..\n", prefix, fext);
+*/
+#define UTILS_LOG(LVL, ...) \
+    do{ if( static_cast<int>(LVL) >= PPMDU_LOG_MIN_LEVEL && ::utils::LibWide().isLogOn() ) ::utils::logutil::slogf( LVL, __VA_ARGS__ ); }while(false)
+
+#define UTILS_LOG_TRACE(...)    UTILS_LOG( ::logging::eLogLevel::Trace,   __VA_ARGS__ )
+#define UTILS_LOG_DEBUG(...)    UTILS_LOG( ::logging::eLogLevel::Debug,   __VA_ARGS__ )
+#define UTILS_LOG_INFO(...)     UTILS_LOG( ::logging::eLogLevel::Info,    __VA_ARGS__ )
+#define UTILS_LOG_WARNING(...)  UTILS_LOG( ::logging::eLogLevel::Warning, __VA_ARGS__ )
+#define UTILS_LOG_ERROR(...)    UTILS_LOG( ::logging::eLogLevel::Error,   __VA_ARGS__ )
+
 #endif
\ No newline at end of file
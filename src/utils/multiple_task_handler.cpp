@@ -1,6 +1,7 @@
 #include "multiple_task_handler.hpp"
 #include "library_wide.hpp"
 #include "utility.hpp"
+#include "trace.hpp"
 #include <thread>
 #include <mutex>
 #include <future>
@@ -134,6 +135,7 @@ namespace multitask
 
     bool CMultiTaskHandler::WorkerThread( thRunParam & taskSlot )
     {
+        UTILS_TRACE_THREAD_NAME("Task Worker");
         while( !( m_stopWorkers.load() ) )
         {
             packaged_task<pktaskret_t()> mytask;
@@ -159,6 +161,7 @@ namespace multitask
             {
                 try
                 {
+                    UTILS_TRACE_ZONE("Task");
                     future<pktaskret_t> myfuture = mytask.get_future();
                     mytask();
                     myfuture.get();
@@ -255,6 +258,7 @@ namespace multitask
     //This is what the manager thread runs!
     void CMultiTaskHandler::RunTasks()
     {
+        UTILS_TRACE_THREAD_NAME("Task Manager");
         auto                                        nbthreads = LibraryWide::getInstance().Data().getNbThreadsToUse();
         vector<thread>                              threadpool(nbthreads);
         vector<thRunParam>                          taskSlots(nbthreads);
@@ -1,5 +1,6 @@
 #include "multithread_logger.hpp"
 #include "library_wide.hpp"
+#include <chrono>
 
 namespace logging
 {
@@ -7,4 +8,325 @@ namespace logging
     {
         return utils::LibWide().StringValue(utils::lwData::eBasicValues::ProgramLogDir);
     }
-};
\ No newline at end of file
+
+//==========================================================================================================
+//  AsyncLogger Internals
+//==========================================================================================================
+    namespace
+    {
+        std::atomic<uint64_t> s_nextloggerid(1);
+
+        //Last logger the thread wrote to, so the thread's buffer is only looked up once
+        struct threadlogcache_t
+        {
+            uint64_t loggerid;
+            void   * plog;
+        };
+        thread_local threadlogcache_t t_logcache = { 0, nullptr };
+    };
+
+    /*
+        threadlog
+            The text of a single thread. Only ever touched by its own thread, except when the logger is destroyed.
+            It's also the stream buffer behind the thread's log stream, and stages what's written to it
+            in a small fixed buffer before adding it to the pending text.
+    */
+    class AsyncLogger::threadlog : public std::streambuf
+    {
+    public:
+        threadlog( AsyncLogger & owner, std::thread::id thid )
+            :m_owner(owner), m_thid(thid), m_seenflushgen(0), m_stream(this)
+        {
+            m_pending.reserve(HandoffLen);
+            setp( m_stage, m_stage + StreamBufLen );
+        }
+
+        //Moves the staged text to the pending text
+        inline void SyncStage()
+        {
+            if( pptr() != pbase() )
+            {
+                m_pending.append( pbase(), pptr() );
+                setp( m_stage, m_stage + StreamBufLen );
+            }
+        }
+
+        inline std::ostream & Stream() { return m_stream; }
+
+    protected:
+        int_type overflow( int_type c )override
+        {
+            SyncStage();
+            if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+                m_pending.push_back( traits_type::to_char_type(c) );
+            m_owner.CheckHandoff(*this);
+            return traits_type::not_eof(c);
+        }
+
+        int sync()override
+        {
+            SyncStage();
+            m_owner.CheckHandoff(*this);
+            return 0;
+        }
+
+    public:
+        AsyncLogger       & m_owner;
+        std::thread::id     m_thid;
+        std::string         m_pending;
+        uint64_t            m_seenflushgen;
+
+    private:
+        char                m_stage[StreamBufLen];
+        std::ostream        m_stream;
+    };
+
+    /*
+        redirectbuf
+            Replaces the output's stream buffer, and sends what's written to the output into the calling thread's text.
+            Holds no state of its own, so any number of threads can write through it at the same time.
+    */
+    class AsyncLogger::redirectbuf : public std::streambuf
+    {
+    public:
+        explicit redirectbuf( AsyncLogger & owner )
+            :m_owner(owner)
+        {}
+
+    protected:
+        std::streamsize xsputn( const char * s, std::streamsize n )override
+        {
+            threadlog & tl = m_owner.ThreadLog();
+            tl.SyncStage();
+            tl.m_pending.append( s, static_cast<size_t>(n) );
+            m_owner.CheckHandoff(tl);
+            return n;
+        }
+
+        int_type overflow( int_type c )override
+        {
+            if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            {
+                threadlog & tl = m_owner.ThreadLog();
+                tl.SyncStage();
+                tl.m_pending.push_back( traits_type::to_char_type(c) );
+                m_owner.CheckHandoff(tl);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync()override
+        {
+            threadlog & tl = m_owner.ThreadLog();
+            tl.SyncStage();
+            m_owner.CheckHandoff(tl);
+            return 0;
+        }
+
+    private:
+        AsyncLogger & m_owner;
+    };
+
+//==========================================================================================================
+//  AsyncLogger
+//==========================================================================================================
+    AsyncLogger::AsyncLogger( std::ostream * output, eLogLevel minlevel )
+        :m_id(s_nextloggerid++), m_minlevel(minlevel), m_pout(output), m_poutbuf(nullptr),
+         m_phead(nullptr), m_nbpushed(0), m_flushgen(0), m_nbwritten(0), m_bflushreq(false), m_bstop(false)
+    {
+        if( !m_pout )
+            throw std::invalid_argument("AsyncLogger::AsyncLogger(): Output stream is null!");
+        m_pout->flush();
+        m_predirect.reset( new redirectbuf(*this) );
+        m_poutbuf     = m_pout->rdbuf( m_predirect.get() );
+        m_flushthread = std::thread( &AsyncLogger::FlushLoop, this );
+    }
+
+    AsyncLogger::~AsyncLogger()
+    {
+        {
+            std::lock_guard<std::mutex> lck(m_mtxflush);
+            m_bstop = true;
+        }
+        m_cvwake.notify_one();
+        if( m_flushthread.joinable() )
+            m_flushthread.join();
+
+        //Give the output its buffer back before writing the rest, so nothing is lost
+        if( m_pout->rdbuf() == m_predirect.get() )
+            m_pout->rdbuf( m_poutbuf );
+
+        std::lock_guard<std::mutex> lck(m_mtxthreads);
+        for( auto & ptl : m_threadlogs )
+        {
+            ptl->SyncStage();
+            if( !ptl->m_pending.empty() )
+                PushChunk( std::move(ptl->m_pending) );
+        }
+        WriteChunks( m_phead.exchange(nullptr) );
+        m_poutbuf->pubsync();
+
+        if( t_logcache.loggerid == m_id )
+            t_logcache = threadlogcache_t{ 0, nullptr };
+    }
+
+    std::ostream & AsyncLogger::Log()
+    {
+        threadlog & tl = ThreadLog();
+        tl.SyncStage();
+        CheckHandoff(tl);
+        return tl.Stream();
+    }
+
+    void AsyncLogger::Write( eLogLevel lvl, const char * text, size_t len )
+    {
+        if( lvl < m_minlevel )
+            return;
+        threadlog & tl = ThreadLog();
+        tl.SyncStage();
+        tl.m_pending.append( text, len );
+        CheckHandoff(tl);
+    }
+
+    void AsyncLogger::Flush()
+    {
+        threadlog & tl = ThreadLog();
+        tl.SyncStage();
+        HandOff( tl, true );
+        ++m_flushgen;
+
+        const uint64_t target = m_nbpushed.load();
+        std::unique_lock<std::mutex> lck(m_mtxflush);
+        m_bflushreq = true;
+        m_cvwake.notify_one();
+        m_cvwritten.wait( lck, [&](){ return m_nbwritten >= target || m_bstop; } );
+    }
+
+    AsyncLogger::threadlog & AsyncLogger::ThreadLog()
+    {
+        if( t_logcache.loggerid == m_id )
+            return *static_cast<threadlog*>(t_logcache.plog);
+
+        //First write of this thread since it last used another logger
+        const std::thread::id thid = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lck(m_mtxthreads);
+        threadlog * ptl = nullptr;
+        for( auto & pexisting : m_threadlogs )
+        {
+            if( pexisting->m_thid == thid )
+            {
+                ptl = pexisting.get();
+                break;
+            }
+        }
+        if( !ptl )
+        {
+            m_threadlogs.push_back( std::unique_ptr<threadlog>( new threadlog( *this, thid ) ) );
+            ptl = m_threadlogs.back().get();
+        }
+        t_logcache = threadlogcache_t{ m_id, ptl };
+        return *ptl;
+    }
+
+    void AsyncLogger::CheckHandoff( threadlog & tl )
+    {
+        const uint64_t curgen = m_flushgen.load( std::memory_order_relaxed );
+        if( tl.m_seenflushgen != curgen )
+        {
+            tl.m_seenflushgen = curgen;
+            HandOff( tl, true );
+        }
+        else if( tl.m_pending.size() >= HandoffLen )
+            HandOff( tl, tl.m_pending.size() >= MaxPendingLen );
+    }
+
+    /*
+        Pushes the thread's text to the flush thread. Unless "bwholetext" is set, an unfinished last line
+        is kept, so lines of different threads don't get mixed up.
+    */
+    void AsyncLogger::HandOff( threadlog & tl, bool bwholetext )
+    {
+        if( tl.m_pending.empty() )
+            return;
+
+        size_t cutpos = tl.m_pending.size();
+        if( !bwholetext )
+        {
+            const size_t lastnl = tl.m_pending.rfind('\n');
+            if( lastnl == std::string::npos )
+                return;
+            cutpos = lastnl + 1;
+        }
+
+        std::string leftover( tl.m_pending, cutpos );
+        tl.m_pending.resize(cutpos);
+        PushChunk( std::move(tl.m_pending) );
+        tl.m_pending = std::move(leftover);
+        tl.m_pending.reserve(HandoffLen);
+    }
+
+    void AsyncLogger::PushChunk( std::string && text )
+    {
+        chunk_t * pchunk = new chunk_t{ nullptr, std::move(text) };
+        //Count it before it's visible, so Flush() never waits on fewer chunks than were pushed before it
+        ++m_nbpushed;
+        chunk_t * phead = m_phead.load( std::memory_order_relaxed );
+        do
+        {
+            pchunk->pnext = phead;
+        }while( !m_phead.compare_exchange_weak( phead, pchunk, std::memory_order_release, std::memory_order_relaxed ) );
+    }
+
+    /*
+        Writes a list taken from m_phead to the original output buffer, oldest first. Returns the nb of chunks written.
+    */
+    size_t AsyncLogger::WriteChunks( chunk_t * plist )
+    {
+        //Reverse the list, since it's newest first
+        chunk_t * pordered = nullptr;
+        while( plist )
+        {
+            chunk_t * pnext = plist->pnext;
+            plist->pnext    = pordered;
+            pordered        = plist;
+            plist           = pnext;
+        }
+
+        size_t nbwritten = 0;
+        while( pordered )
+        {
+            std::unique_ptr<chunk_t> pcur(pordered);
+            pordered = pcur->pnext;
+            m_poutbuf->sputn( pcur->text.data(), static_cast<std::streamsize>(pcur->text.size()) );
+            ++nbwritten;
+        }
+        return nbwritten;
+    }
+
+    void AsyncLogger::FlushLoop()
+    {
+        for(;;)
+        {
+            bool bstopping = false;
+            {
+                std::unique_lock<std::mutex> lck(m_mtxflush);
+                m_cvwake.wait_for( lck, std::chrono::milliseconds( static_cast<int>(FlushIntervalMs) ), [&](){ return m_bflushreq || m_bstop; } );
+                m_bflushreq = false;
+                bstopping   = m_bstop;
+            }
+
+            const size_t nbwritten = WriteChunks( m_phead.exchange( nullptr, std::memory_order_acquire ) );
+            if( nbwritten != 0 )
+                m_poutbuf->pubsync();
+
+            {
+                std::lock_guard<std::mutex> lck(m_mtxflush);
+                m_nbwritten += nbwritten;
+            }
+            m_cvwritten.notify_all();
+
+            if( bstopping )
+                return; //The destructor writes whatever is left
+        }
+    }
+};
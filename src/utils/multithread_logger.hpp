@@ -17,11 +17,41 @@ Description: A simple and quick implementation of a multi-thread logger.
 #include <cassert>
 #include <atomic>
 #include <future>
+#include <string>
+#include <vector>
+#include <memory>
+#include <condition_variable>
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+#include <algorithm>
 #include "gfileutils.hpp"
 
+/*
+    PPMDU_LOG_MIN_LEVEL
+        Log calls made through the UTILS_LOG_* macros with a level below this are compiled out entirely.
+        Values match logging::eLogLevel. Define it in the project settings to override the default.
+*/
+#ifndef PPMDU_LOG_MIN_LEVEL
+    #define PPMDU_LOG_MIN_LEVEL 1 //Debug
+#endif
+
 
 namespace logging
 {
+    /***********************************************************************************
+        eLogLevel
+            Severity of a log entry.
+    ***********************************************************************************/
+    enum struct eLogLevel : int
+    {
+        Trace   = 0,
+        Debug   = 1,
+        Info    = 2,
+        Warning = 3,
+        Error   = 4,
+    };
+
     /***********************************************************************************
         Meant to be used with a fixed threadpool. 
     ***********************************************************************************/
@@ -41,6 +71,12 @@ namespace logging
         virtual ~BaseLogger(){}
         virtual std::ostream & Log(){ return std::clog; }
 
+        /*
+            Write
+                Logs a block of already formatted text. Loggers may filter it depending on its level.
+        */
+        virtual void Write( eLogLevel /*lvl*/, const char * text, size_t len ){ Log().write( text, len ); }
+
         virtual void Flush(){};
         //inline operator std::ostream&()
         //{
@@ -259,6 +295,156 @@ namespace logging
     };
 
 
+    /***********************************************************************************
+        AsyncLogger
+            Shared output for multi-thread applications, made to not slow down the threads doing the logging.
+
+            Each thread writes into its own buffer, registered with the logger on the thread's first write.
+            Filled buffers are pushed onto a lock-free list, and a background thread writes them to the output
+            in large blocks. The text of a single thread stays in order, but the lines of several threads may interleave.
+
+            The logger takes over the stream buffer of the output stream for its lifetime, so anything written
+            directly to that stream (usually std::clog) also goes through the calling thread's buffer.
+
+            Flush() hands over the calling thread's text, and waits until everything handed over so far is written.
+            The other threads hand over their text on their next write after a Flush(), or whenever their buffer is full.
+            On destruction, the text of all threads is written. No thread should still be logging at that point!
+    ***********************************************************************************/
+    class AsyncLogger : public BaseLogger
+    {
+    public:
+        static const size_t HandoffLen      = 8 * 1024;     //Size at which a thread hands its text to the flush thread
+        static const size_t MaxPendingLen   = 64 * 1024;    //Size at which the text is handed over, even if a line isn't finished
+        static const size_t StreamBufLen    = 512;          //Size of the per-thread stream buffer behind Log()
+        static const int    FlushIntervalMs = 100;
+
+        explicit AsyncLogger( std::ostream * output = &std::clog, eLogLevel minlevel = eLogLevel::Trace );
+        virtual ~AsyncLogger();
+
+        /*
+            Returns the calling thread's log stream. It's buffered, so it shouldn't be shared with other threads.
+        */
+        std::ostream & Log  ()override;
+        void           Write( eLogLevel lvl, const char * text, size_t len )override;
+        void           Flush()override;
+
+        inline void      SetMinLevel( eLogLevel lvl ) { m_minlevel = lvl; }
+        inline eLogLevel GetMinLevel()const           { return m_minlevel; }
+
+    private:
+        AsyncLogger( const AsyncLogger & )            = delete;
+        AsyncLogger & operator=( const AsyncLogger & ) = delete;
+
+        class  threadlog;
+        class  redirectbuf;
+        struct chunk_t
+        {
+            chunk_t   * pnext;
+            std::string text;
+        };
+
+        threadlog & ThreadLog();
+        void        CheckHandoff( threadlog & tl );
+        void        HandOff     ( threadlog & tl, bool bwholetext );
+        void        PushChunk   ( std::string && text );
+        size_t      WriteChunks ( chunk_t * plist );
+        void        FlushLoop   ();
+
+    private:
+        const uint64_t                          m_id;           //Unique per instance, to tell loggers apart in the thread-local cache
+        eLogLevel                               m_minlevel;
+        std::ostream                          * m_pout;
+        std::streambuf                        * m_poutbuf;      //The output's original stream buffer
+        std::unique_ptr<redirectbuf>            m_predirect;
+
+        std::mutex                              m_mtxthreads;
+        std::vector<std::unique_ptr<threadlog>> m_threadlogs;
+
+        std::atomic<chunk_t*>                   m_phead;        //Lock-free list of text waiting to be written, newest first
+        std::atomic<uint64_t>                   m_nbpushed;
+        std::atomic<uint64_t>                   m_flushgen;     //Incremented by Flush(), to ask threads to hand over their text
+
+        std::mutex                              m_mtxflush;
+        std::condition_variable                 m_cvwake;
+        std::condition_variable                 m_cvwritten;
+        uint64_t                                m_nbwritten;
+        bool                                    m_bflushreq;
+        bool                                    m_bstop;
+        std::thread                             m_flushthread;
+    };
+
+//==========================================================================================================
+//  Log Text Formatting
+//==========================================================================================================
+    namespace detail
+    {
+        inline void AppendLogArg( std::string & out, const char        * str ) { out.append( str? str : "(null)" ); }
+        inline void AppendLogArg( std::string & out, const std::string & str ) { out.append( str ); }
+        inline void AppendLogArg( std::string & out, char                c   ) { out.push_back( c ); }
+        inline void AppendLogArg( std::string & out, bool                b   ) { out.append( b? "true" : "false" ); }
+
+        template<class _IntTy>
+            typename std::enable_if<std::is_integral<_IntTy>::value>::type AppendLogArg( std::string & out, _IntTy val )
+        {
+            typedef typename std::make_unsigned<_IntTy>::type uint_t;
+            char         buf[24];
+            char * const pend = buf + sizeof(buf);
+            char *       pcur = pend;
+            const bool   bneg = std::is_signed<_IntTy>::value && (val < static_cast<_IntTy>(0));
+            uint_t       uval = bneg? static_cast<uint_t>(0) - static_cast<uint_t>(val) : static_cast<uint_t>(val);
+            do
+            {
+                *(--pcur) = static_cast<char>( '0' + (uval % 10) );
+                uval /= 10;
+            }while( uval != 0 );
+            if( bneg )
+                *(--pcur) = '-';
+            out.append( pcur, pend );
+        }
+
+        template<class _FltTy>
+            typename std::enable_if<std::is_floating_point<_FltTy>::value>::type AppendLogArg( std::string & out, _FltTy val )
+        {
+            char buf[32];
+            const int len = std::snprintf( buf, sizeof(buf), "%g", static_cast<double>(val) );
+            if( len > 0 )
+                out.append( buf, std::min<size_t>( static_cast<size_t>(len), sizeof(buf) - 1 ) );
+        }
+
+        //Anything else goes through its stream operator
+        template<class _Ty>
+            typename std::enable_if<!std::is_arithmetic<_Ty>::value>::type AppendLogArg( std::string & out, const _Ty & val )
+        {
+            std::ostringstream sstr;
+            sstr <<val;
+            out.append( sstr.str() );
+        }
+    };
+
+    /*
+        FormatLogText
+            Appends "fmt" to "out", replacing each "{}" with the next argument.
+            Integers, floats and strings are formatted without going through iostreams.
+    */
+    inline void FormatLogText( std::string & out, const char * fmt )
+    {
+        out.append( fmt );
+    }
+
+    template<class _FirstTy, class ... _ArgsTy>
+        void FormatLogText( std::string & out, const char * fmt, const _FirstTy & first, const _ArgsTy & ... rest )
+    {
+        const char * pfound = std::strstr( fmt, "{}" );
+        if( !pfound )
+        {
+            out.append( fmt );
+            return;
+        }
+        out.append( fmt, pfound );
+        detail::AppendLogArg( out, first );
+        FormatLogText( out, pfound + 2, rest... );
+    }
+
     /*
         DummyLogger
             A dummy logger which simply redirects to clog.
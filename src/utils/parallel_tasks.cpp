@@ -1,4 +1,5 @@
 #include "parallel_tasks.hpp"
+#include "trace.hpp"
 
 using namespace std;
 
@@ -23,14 +24,13 @@ namespace utils
     */
     bool TaskQueue::TryPop( TaskQueue::task_t & out_task )
     {
-        if(!empty())
-        {
-            std::lock_guard<std::mutex> lck(m_queuemtx);
-            out_task = std::move(m_taskqueue.front());
-            m_taskqueue.pop_front();
-            return true;
-        }
-        return false;
+        //Check within the lock, or several workers could pop the last task at the same time
+        std::lock_guard<std::mutex> lck(m_queuemtx);
+        if(m_taskqueue.empty())
+            return false;
+        out_task = std::move(m_taskqueue.front());
+        m_taskqueue.pop_front();
+        return true;
     }
 
     /*
@@ -47,6 +47,44 @@ namespace utils
         return TryPop(out_task);
     }
 
+//======================================================================================================================================
+//  Busy Workers
+//======================================================================================================================================
+    namespace
+    {
+        std::atomic<size_t> s_nbbusyworkers(0);
+        thread_local bool   t_bbusyworker = false;
+    };
+
+    BusyWorkerScope::BusyWorkerScope()
+        :m_bwasbusy(t_bbusyworker)
+    {
+        if( !m_bwasbusy )
+        {
+            t_bbusyworker = true;
+            ++s_nbbusyworkers;
+        }
+    }
+
+    BusyWorkerScope::~BusyWorkerScope()
+    {
+        if( !m_bwasbusy )
+        {
+            t_bbusyworker = false;
+            --s_nbbusyworkers;
+        }
+    }
+
+    size_t GetNbBusyWorkers()
+    {
+        return s_nbbusyworkers.load();
+    }
+
+    bool IsBusyWorkerThread()
+    {
+        return t_bbusyworker;
+    }
+
 //======================================================================================================================================
 //  Worker
 //======================================================================================================================================
@@ -110,6 +148,7 @@ namespace utils
     */
     void Worker::Work()
     {
+        UTILS_TRACE_THREAD_NAME("Worker");
         do
         {
             TaskQueue::task_t mytask;
@@ -176,6 +215,7 @@ namespace utils
 
     inline void Worker::RunATask( TaskQueue::task_t & curtask )
     {
+        UTILS_TRACE_ZONE("Task");
         try
         {
             m_bisbusy = true;
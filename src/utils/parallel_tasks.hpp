@@ -7,12 +7,21 @@ psycommando@gmail.com
 Description: A set of utilities for handling multi-threaded tasks execution. Meant to replace the previous implementation.
 */
 #include <utils/library_wide.hpp>
+#include <utils/trace.hpp>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
 #include <deque>
 #include <future>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
 
 namespace utils
 {
@@ -144,6 +153,34 @@ namespace utils
 
 #endif
 
+//======================================================================================================================================
+//  Busy Workers
+//======================================================================================================================================
+    /*
+        BusyWorkerScope
+            Marks the calling thread as running a task, for as long as it exists.
+            The library-wide count of busy workers lets jobs started from within another job spread only over the 
+            threads the other jobs left idle, instead of starting a whole new set of threads each.
+    */
+    class BusyWorkerScope
+    {
+    public:
+        BusyWorkerScope();
+        ~BusyWorkerScope();
+
+    private:
+        BusyWorkerScope( const BusyWorkerScope & )            = delete;
+        BusyWorkerScope & operator=( const BusyWorkerScope & ) = delete;
+
+        bool m_bwasbusy;
+    };
+
+    //Nb of threads currently running a task, library-wide.
+    size_t GetNbBusyWorkers();
+
+    //Whether the calling thread is currently running a task.
+    bool IsBusyWorkerThread();
+
 //======================================================================================================================================
 //  AsyncTasks
 //======================================================================================================================================
@@ -228,6 +265,7 @@ namespace utils
                 {
                     try
                     {
+                        BusyWorkerScope busy;
                         mytask();
                     }
                     catch(const std::exception &)
@@ -252,10 +290,13 @@ namespace utils
     public:
         typedef TaskQueue::task_t task_t;
 
-        AsyncTaskHandler()
+        /*
+            - nbthreads : Nb of worker threads to run the tasks on. Uses the library-wide thread budget if 0.
+        */
+        explicit AsyncTaskHandler( size_t nbthreads = 0 )
             :m_bshouldrun(false)
         {
-            const size_t nbth = utils::LibWide().getNbThreadsToUse();
+            const size_t nbth = (nbthreads != 0)? nbthreads : utils::LibWide().getNbThreadsToUse();
             for( size_t cnt = 0; cnt < nbth; ++cnt )
                 m_workers.emplace(m_workers.end(), m_taskqueue);
         }
@@ -302,6 +343,302 @@ namespace utils
         std::vector<AsyncWorker>    m_workers;
         std::atomic_bool            m_bshouldrun;
     };
+
+//======================================================================================================================================
+//  Indexed Jobs
+//======================================================================================================================================
+    /*
+        JobErrorList
+            Collects the error messages of independent jobs, along with the index of the job that raised them.
+            Errors are sorted by job index when reported, so the report doesn't depend on thread scheduling.
+    */
+    class JobErrorList
+    {
+    public:
+        typedef std::pair<size_t,std::string> joberr_t;
+
+        void Push( size_t jobindex, const std::string & msg )
+        {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            m_errors.push_back(std::make_pair(jobindex, msg));
+        }
+
+        inline bool   empty()const { return m_errors.empty(); }
+        inline size_t size()const  { return m_errors.size(); }
+
+        /*
+            Returns the errors sorted by job index.
+        */
+        std::vector<joberr_t> GetSorted()const
+        {
+            std::vector<joberr_t> sorted(m_errors.begin(), m_errors.end());
+            std::stable_sort( sorted.begin(), sorted.end(), []( const joberr_t & a, const joberr_t & b ){ return a.first < b.first; } );
+            return sorted;
+        }
+
+        /*
+            If any errors were collected, throws a single runtime_error listing all of them, prefixed with "context".
+        */
+        void ThrowIfAny( const std::string & context )const
+        {
+            if( m_errors.empty() )
+                return;
+            std::stringstream sstr;
+            sstr <<context <<": " <<m_errors.size() <<" job(s) failed!\n";
+            for( const auto & err : GetSorted() )
+                sstr <<"\t[" <<err.first <<"] " <<err.second <<"\n";
+            throw std::runtime_error(sstr.str());
+        }
+
+    private:
+        std::mutex              m_mtx;
+        std::deque<joberr_t>    m_errors;
+    };
+
+    /*
+        RunIndexedJobs
+            Runs "nbjobs" independent jobs, indexed from 0 to nbjobs-1, over the library-wide thread budget.
+            When called from within another job, only the threads left idle by the other running jobs are used,
+            plus one taking the place of the calling thread, which just waits on the slices and isn't using a core.
+            When there's a single slice, the calling thread runs it itself. So nesting jobs doesn't start more
+            threads than the budget allows.
+
+            The jobs are split into one slice per worker thread, and each slice gets its own copy of "stateproto".
+            That copy is passed to every job of the slice, so scratch buffers can be reused from one job to the next
+            without any locking.
+
+            Exceptions thrown by a job are caught and added to "out_errors" with the job's index, and the other jobs still run.
+            Jobs must not depend on the order in which they're executed.
+
+            - stateproto : Prototype of the per-thread state. Copied once per slice.
+            - jobfun     : Callable as jobfun( _StateTy & state, size_t jobindex ).
+            - out_errors : Receives the errors of failed jobs.
+            - pcompleted : If not null, incremented after each job, for progress display.
+    */
+    template<class _StateTy, class _JobFun>
+        void RunIndexedJobs( size_t                  nbjobs, 
+                             const _StateTy        & stateproto, 
+                             _JobFun                 jobfun, 
+                             JobErrorList          & out_errors, 
+                             std::atomic<uint32_t> * pcompleted = nullptr )
+    {
+        if( nbjobs == 0 )
+            return;
+
+        size_t nbthreads = std::max<size_t>( LibWide().getNbThreadsToUse(), 1 );
+        if( IsBusyWorkerThread() )
+        {
+            //The busy count includes the calling thread. It only waits on the slices, so its slot is given to one of them.
+            const size_t nbbusy = GetNbBusyWorkers();
+            nbthreads = (nbbusy < nbthreads)? (nbthreads - nbbusy + 1) : 1;
+        }
+        const size_t nbslices = std::min<size_t>( nbthreads, nbjobs );
+
+        //Jobs are interleaved between slices, so expensive neighbouring entries end up on different threads.
+        auto lambdaslice = [&]( size_t slice )
+        {
+            _StateTy state(stateproto);
+            for( size_t cntjob = slice; cntjob < nbjobs; cntjob += nbslices )
+            {
+                UTILS_TRACE_ZONE("Indexed Job");
+                try
+                {
+                    jobfun( state, cntjob );
+                }
+                catch( const std::exception & e )
+                {
+                    out_errors.Push( cntjob, e.what() );
+                }
+                catch(...)
+                {
+                    out_errors.Push( cntjob, "Unknown exception!" );
+                }
+                if(pcompleted)
+                    ++(*pcompleted);
+            }
+        };
+
+        if( nbslices == 1 )
+        {
+            lambdaslice(0);
+            return;
+        }
+
+        AsyncTaskHandler taskhandler(nbslices);
+        for( size_t cntslice = 0; cntslice < nbslices; ++cntslice )
+            taskhandler.QueueTask( AsyncTaskHandler::task_t( std::bind( lambdaslice, cntslice ) ) );
+        taskhandler.Start();
+        taskhandler.WaitTasksFinished();
+        taskhandler.WaitStop();
+    }
+
+    /*
+        RunIndexedJobs
+            Same as above, for jobs that don't need any per-thread state.
+            - jobfun : Callable as jobfun( size_t jobindex ).
+    */
+    template<class _JobFun>
+        void RunIndexedJobs( size_t                  nbjobs, 
+                             _JobFun                 jobfun, 
+                             JobErrorList          & out_errors, 
+                             std::atomic<uint32_t> * pcompleted = nullptr )
+    {
+        struct nostate_t {};
+        RunIndexedJobs( nbjobs, nostate_t(), [&]( nostate_t &, size_t cntjob ){ jobfun(cntjob); }, out_errors, pcompleted );
+    }
+
+//======================================================================================================================================
+//  MemoryBudget
+//======================================================================================================================================
+    /*
+        MemoryBudget
+            Bounds the amount of memory a batch of jobs may hold at once.
+            Jobs reserve what they expect to use before loading their data, and wait while the budget is used up.
+            A reservation larger than the whole budget is still granted once nothing else is reserved, so it can't wait forever.
+            Jobs must release their reservation before making another one, or they could wait on each others.
+    */
+    class MemoryBudget
+    {
+    public:
+        explicit MemoryBudget( uint64_t maxbytes )
+            :m_maxbytes(maxbytes), m_reserved(0)
+        {}
+
+        void Acquire( uint64_t nbbytes )
+        {
+            std::unique_lock<std::mutex> lck(m_mtx);
+            m_cvreleased.wait( lck, [&](){ return m_reserved == 0 || (m_reserved + nbbytes) <= m_maxbytes; } );
+            m_reserved += nbbytes;
+        }
+
+        void Release( uint64_t nbbytes )
+        {
+            {
+                std::lock_guard<std::mutex> lck(m_mtx);
+                m_reserved -= std::min( nbbytes, m_reserved );
+            }
+            m_cvreleased.notify_all();
+        }
+
+        inline uint64_t getMaxBytes()const { return m_maxbytes; }
+
+        /*
+            Reservation
+                Holds a part of the budget for as long as it exists.
+        */
+        class Reservation
+        {
+        public:
+            Reservation( MemoryBudget & budget, uint64_t nbbytes )
+                :m_budget(budget), m_nbbytes(nbbytes)
+            {
+                m_budget.Acquire(m_nbbytes);
+            }
+
+            ~Reservation()
+            {
+                m_budget.Release(m_nbbytes);
+            }
+
+        private:
+            Reservation( const Reservation & )            = delete;
+            Reservation & operator=( const Reservation & ) = delete;
+
+            MemoryBudget & m_budget;
+            uint64_t       m_nbbytes;
+        };
+
+    private:
+        uint64_t                m_maxbytes;
+        uint64_t                m_reserved;
+        std::mutex              m_mtx;
+        std::condition_variable m_cvreleased;
+    };
+
+//======================================================================================================================================
+//  ProgressReporter
+//======================================================================================================================================
+    /*
+        ProgressReporter
+            Displays the progress of a batch of jobs on the console.
+            Workers only increment the atomic counter, and a separate thread does all the printing,
+            so the output isn't garbled by several threads writing to cout at once.
+            Nothing is printed if progress display was disabled library-wide.
+    */
+    class ProgressReporter
+    {
+    public:
+        ProgressReporter( const std::string & label, uint32_t total, bool benabled = LibWide().ShouldDisplayProgress() )
+            :m_label(label), m_total(total), m_completed(0), m_bupdate(false), m_benabled(benabled)
+        {}
+
+        ~ProgressReporter()
+        {
+            try
+            {
+                Stop();
+            }
+            catch(...)
+            {}
+        }
+
+        inline std::atomic<uint32_t>       & Completed()       { return m_completed; }
+        inline const std::atomic<uint32_t> & Completed()const  { return m_completed; }
+        inline void                          Increment()       { ++m_completed; }
+
+        /*
+            Starts the display thread.
+        */
+        void Start()
+        {
+            if( !m_benabled || m_bupdate )
+                return;
+            m_bupdate  = true;
+            m_printfut = std::async( std::launch::async, &ProgressReporter::PrintLoop, this );
+        }
+
+        /*
+            Stops the display thread, and prints the final state of the counter.
+        */
+        void Stop()
+        {
+            if( !m_bupdate )
+                return;
+            m_bupdate = false;
+            if( m_printfut.valid() )
+                m_printfut.get();
+            PrintState();
+            std::cout <<"\n";
+        }
+
+    private:
+        void PrintLoop()
+        {
+            static const std::chrono::milliseconds ProgressUpdThWait = std::chrono::milliseconds(200);
+            while( m_bupdate )
+            {
+                PrintState();
+                std::this_thread::sleep_for(ProgressUpdThWait);
+            }
+        }
+
+        void PrintState()const
+        {
+            const uint32_t completed = std::min( m_completed.load(), m_total );
+            const uint32_t percent   = (m_total != 0)? ((100 * completed) / m_total) : 100;
+            std::stringstream sstr;
+            sstr <<"\r" <<m_label <<" " <<std::setw(3) <<std::setfill(' ') <<percent <<"% (" <<completed <<"/" <<m_total <<")" <<std::setw(10) <<std::setfill(' ') <<" ";
+            std::cout <<sstr.str() <<std::flush;
+        }
+
+    private:
+        std::string             m_label;
+        uint32_t                m_total;
+        std::atomic<uint32_t>   m_completed;
+        std::atomic_bool        m_bupdate;
+        bool                    m_benabled;
+        std::future<void>       m_printfut;
+    };
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include "poco_wrapper.hpp"
 #include <Poco/File.h>
 #include <Poco/DirectoryIterator.h>
+#include <Poco/Glob.h>
 #include <Poco/Util/Application.h>
 #include <Poco/Util/OptionSet.h>
 #include <cassert>
@@ -8,6 +9,8 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <set>
+#include <algorithm>
 using namespace std;
 
 namespace utils
@@ -98,6 +101,89 @@ namespace utils
         return std::move( dircontent );
     }
 
+    //Appends the files in a directory to "out_files", prefixed with "reldir".
+    void ListFilesInDir( const Poco::Path & dirpath, const string & reldir, bool brecursive, vector<string> & out_files )
+    {
+        Poco::DirectoryIterator itdirend;
+        for( Poco::DirectoryIterator itdir(dirpath); itdir != itdirend; ++itdir )
+        {
+            if( itdir->isHidden() )
+                continue;
+            const string relpath = reldir + Poco::Path::transcode(itdir.name());
+            if( itdir->isFile() )
+                out_files.push_back(relpath);
+            else if( brecursive && itdir->isDirectory() )
+                ListFilesInDir( itdir.path(), relpath + "/", brecursive, out_files );
+        }
+    }
+
+    //Returns "path" relative to the directory "basedir", or only its filename if it's not within "basedir".
+    string MakeRelativeTo( Poco::Path basedir, Poco::Path path )
+    {
+        basedir.makeAbsolute().makeDirectory();
+        path.makeAbsolute();
+
+        if( path.depth() < basedir.depth() )
+            return Poco::Path::transcode(path.getFileName());
+        for( int cntdir = 0; cntdir < basedir.depth(); ++cntdir )
+        {
+            if( path[cntdir] != basedir[cntdir] )
+                return Poco::Path::transcode(path.getFileName());
+        }
+
+        string relpath;
+        for( int cntdir = basedir.depth(); cntdir < path.depth(); ++cntdir )
+            relpath += Poco::Path::transcode(path[cntdir]) + "/";
+        return relpath + Poco::Path::transcode(path.getFileName());
+    }
+
+    std::vector<std::string> ExpandInputPath( const std::string & pathorpattern, bool brecursive, std::string & out_basedir )
+    {
+        vector<string> files;
+        const size_t   wildcardpos = pathorpattern.find_first_of("*?[{");
+
+        if( wildcardpos == string::npos )
+        {
+            Poco::File input(pathorpattern);
+            if( !input.exists() )
+                throw runtime_error("ExpandInputPath(): Path \"" + pathorpattern + "\" doesn't exist!");
+
+            if( input.isDirectory() )
+            {
+                out_basedir = Poco::Path(pathorpattern).makeDirectory().toString();
+                ListFilesInDir( Poco::Path(out_basedir), "", brecursive, files );
+            }
+            else
+            {
+                Poco::Path filepath(pathorpattern);
+                out_basedir = Poco::Path(filepath).makeParent().toString();
+                files.push_back( Poco::Path::transcode(filepath.getFileName()) );
+            }
+        }
+        else
+        {
+            //Everything up to the last separator before the first wildcard is the base directory
+            const size_t lastsep = pathorpattern.find_last_of( "/\\", wildcardpos );
+            out_basedir = (lastsep != string::npos)? pathorpattern.substr( 0, lastsep + 1 ) : Poco::Path::current();
+
+            std::set<string> matches;
+            Poco::Glob::glob( pathorpattern, matches, Poco::Glob::GLOB_DOT_SPECIAL );
+            for( const auto & match : matches )
+            {
+                Poco::File matched(match);
+                if( matched.isHidden() )
+                    continue;
+                if( matched.isFile() )
+                    files.push_back( MakeRelativeTo( Poco::Path(out_basedir), Poco::Path(match) ) );
+                else if( brecursive && matched.isDirectory() )
+                    ListFilesInDir( Poco::Path(match).makeDirectory(), MakeRelativeTo( Poco::Path(out_basedir), Poco::Path(match).makeFile() ) + "/", brecursive, files );
+            }
+        }
+
+        std::sort( files.begin(), files.end() );
+        return std::move(files);
+    }
+
     /*
         GetBaseNameOnly
             The basename is the the last dir in the path, or the name of the file without extension.
@@ -25,6 +25,23 @@ namespace utils
     ************************************************************************/
     std::vector<std::string> ListDirContent_FilesAndDirs( const std::string & dirpath, bool bFilenameOnly = false, bool noslashaftdir = false );
 
+    /************************************************************************
+        ExpandInputPath
+            Lists the files designated by a file path, a directory path, or 
+            a glob pattern like "data/MONSTER/*.bin". Hidden files are
+            skipped.
+
+            Returns the paths of the files, relative to "out_basedir", 
+            with '/' as separator, in alphabetical order.
+
+            -brecursive  : If set to true, the content of sub-directories
+                           is listed too.
+            -out_basedir : Receives the directory the relative paths start
+                           from. For a glob, the part of the pattern before
+                           the first wildcard.
+    ************************************************************************/
+    std::vector<std::string> ExpandInputPath( const std::string & pathorpattern, bool brecursive, std::string & out_basedir );
+
     /************************************************************************
         DoCreateDirectory
             Creates a new subdirectory at the path specified
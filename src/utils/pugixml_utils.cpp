@@ -1,4 +1,6 @@
 #include "pugixml_utils.hpp"
+#include <utils/async_file_sink.hpp>
+#include <fstream>
 
 namespace pugixmlutils
 {
@@ -92,4 +94,87 @@ namespace pugixmlutils
             throw runtime_error( sstr.str() );
         }
     }
+
+    /*
+        xml_string_writer
+            Appends pugixml's output to a std::string.
+    */
+    class xml_string_writer : public pugi::xml_writer
+    {
+    public:
+        xml_string_writer( std::string & dest ):m_dest(dest){}
+
+        virtual void write(const void* data, size_t size)override
+        {
+            m_dest.append( static_cast<const char*>(data), size );
+        }
+
+    private:
+        std::string & m_dest;
+    };
+
+    /*
+        SaveDocumentWithBuffer
+    */
+    bool SaveDocumentWithBuffer( const pugi::xml_document & doc, const std::string & fpath, std::string & scratch )
+    {
+        return SaveDocumentWithBuffer( doc, fpath, scratch, PUGIXML_TEXT("\t"), pugi::format_default, pugi::encoding_auto );
+    }
+
+    bool SaveDocumentWithBuffer( const pugi::xml_document & doc, 
+                                 const std::string        & fpath, 
+                                 std::string              & scratch, 
+                                 const pugi::char_t       * indent, 
+                                 unsigned int               flags, 
+                                 pugi::xml_encoding         encoding )
+    {
+        using namespace std;
+        scratch.clear(); //Keeps the capacity
+        xml_string_writer wr(scratch);
+        doc.save(wr, indent, flags, encoding);
+
+        utils::AsyncFileSink * psink = utils::GetActiveFileSink();
+        if( psink )
+        {
+            psink->Write( fpath, scratch );
+            return true;
+        }
+
+        ofstream outf( fpath, ios::out | ios::binary );
+        if( !outf.is_open() )
+            return false;
+        outf.write( scratch.data(), scratch.size() );
+        return !outf.fail();
+    }
+
+    /*
+        LoadDocumentWithBuffer
+    */
+    pugi::xml_parse_result LoadDocumentWithBuffer( pugi::xml_document & doc, const std::string & fpath, std::vector<char> & scratch )
+    {
+        using namespace std;
+        using namespace pugi;
+        xml_parse_result res;
+        ifstream         inf( fpath, ios::in | ios::binary | ios::ate );
+        if( !inf.is_open() )
+        {
+            res.status = status_file_not_found;
+            return res;
+        }
+
+        const streamoff flen = inf.tellg();
+        if( flen < 0 || !inf.seekg(0, ios::beg) )
+        {
+            res.status = status_io_error;
+            return res;
+        }
+
+        scratch.resize( static_cast<size_t>(flen) ); //Only reallocates if the file is larger than any previous one
+        if( flen > 0 && !inf.read( scratch.data(), flen ) )
+        {
+            res.status = status_io_error;
+            return res;
+        }
+        return doc.load_buffer_inplace( scratch.data(), scratch.size() );
+    }
 };
\ No newline at end of file
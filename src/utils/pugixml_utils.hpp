@@ -13,6 +13,7 @@ Description:
 #include <codecvt>
 #include <locale>
 #include <sstream>
+#include <vector>
 
 namespace pugixmlutils
 {
@@ -210,6 +211,45 @@ namespace pugixmlutils
             If there were no errors while parsing does nothing. Otherwise throws an appropriate exception!
     */
     void HandleParsingError( const pugi::xml_parse_result & result, const std::string & xmlpath );
+
+    /***************************************************************************************
+        XMLScratchBuffers
+            Buffers meant to be kept around by a thread that loads or saves many small 
+            XML documents in a row, so they don't have to be reallocated for every file.
+    ***************************************************************************************/
+    struct XMLScratchBuffers
+    {
+        std::string       outbuf;   //Serialized document, before it gets written to disk
+        std::vector<char> inbuf;    //Raw file content, parsed in-place by pugixml
+    };
+
+    /*
+        SaveDocumentWithBuffer
+            Serializes the document into "scratch", using the same formating as xml_document::save_file,
+            then writes it to the file in a single write. The capacity of "scratch" is kept between calls.
+            If an output sink is active, the serialized document is queued on it instead. (See utils::ScopedActiveFileSink)
+            Returns false if the file couldn't be written.
+    */
+    bool SaveDocumentWithBuffer( const pugi::xml_document & doc, const std::string & fpath, std::string & scratch );
+
+    /*
+        SaveDocumentWithBuffer
+            Same as above, with the formating options of xml_document::save_file.
+            If an output sink is active, the serialized document is queued on it instead of being written right away.
+    */
+    bool SaveDocumentWithBuffer( const pugi::xml_document & doc, 
+                                 const std::string        & fpath, 
+                                 std::string              & scratch, 
+                                 const pugi::char_t       * indent, 
+                                 unsigned int               flags, 
+                                 pugi::xml_encoding         encoding = pugi::encoding_auto );
+
+    /*
+        LoadDocumentWithBuffer
+            Reads the whole file into "scratch", and parses it in-place. 
+            **The document refers to the content of "scratch" until it's reset or destroyed!**
+    */
+    pugi::xml_parse_result LoadDocumentWithBuffer( pugi::xml_document & doc, const std::string & fpath, std::vector<char> & scratch );
 };
 
 #endif
\ No newline at end of file
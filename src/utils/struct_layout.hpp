@@ -0,0 +1,270 @@
+#ifndef STRUCT_LAYOUT_HPP
+#define STRUCT_LAYOUT_HPP
+/*
+struct_layout.hpp
+2016/10/27
+psycommando@gmail.com
+Description:
+    Compile-time description of the on-disk layout of fixed size structures, as an ordered list of member pointers.
+    The layout generates the structure's length, and its reads and writes through ByteCursor/ByteWriter, so the
+    fields only have to be listed once, instead of in a pair of hand-written ReadFromContainer/WriteToContainer.
+
+    It also reads and writes whole arrays of the structure with a single bounds check, which is what tables of
+    entries should be using, instead of going through iterators one entry at a time.
+
+    Ex:
+        struct MyEntry
+        {
+            uint16_t id    = 0;
+            uint32_t magic = 0;
+
+            typedef utils::StructLayout<MyEntry,
+                                        UTILS_LAYOUT_FIELD   (MyEntry, id),
+                                        UTILS_LAYOUT_PADDING (2),
+                                        UTILS_LAYOUT_FIELD_BE(MyEntry, magic)> layout_t;
+            static const uint32_t SIZE = layout_t::Size;
+        };
+*/
+#include <utils/byte_cursor.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+namespace utils
+{
+//======================================================================================================
+//  Field Types
+//======================================================================================================
+    /*
+        layout_field_io
+            How a member of a given type is read and written. Integers and enums are loaded with their
+            size in bytes and the given byte order. std::arrays of integers are loaded element by element.
+    */
+    template<class _FieldTy, bool _BigEndian, class _Enable = void>
+        struct layout_field_io
+    {
+        static_assert( std::is_integral<_FieldTy>::value, "layout_field_io: Unsupported field type!" );
+        static const size_t Size = sizeof(_FieldTy);
+
+        static inline void Read( ByteCursor & cur, _FieldTy & dest )
+        {
+            dest = (_BigEndian)? cur.ReadUncheckedBE<_FieldTy>() : cur.ReadUnchecked<_FieldTy>();
+        }
+        static inline void Write( ByteWriter & wr, _FieldTy val )
+        {
+            if(_BigEndian)
+                wr.WriteUncheckedBE(val);
+            else
+                wr.WriteUnchecked(val);
+        }
+    };
+
+    template<class _FieldTy, bool _BigEndian>
+        struct layout_field_io<_FieldTy, _BigEndian, typename std::enable_if<std::is_enum<_FieldTy>::value>::type>
+    {
+        typedef typename std::underlying_type<_FieldTy>::type     int_t;
+        typedef layout_field_io<int_t, _BigEndian>                io_t;
+        static const size_t Size = io_t::Size;
+
+        static inline void Read( ByteCursor & cur, _FieldTy & dest )
+        {
+            int_t val = 0;
+            io_t::Read(cur, val);
+            dest = static_cast<_FieldTy>(val);
+        }
+        static inline void Write( ByteWriter & wr, _FieldTy val )
+        {
+            io_t::Write( wr, static_cast<int_t>(val) );
+        }
+    };
+
+    template<class _ElemTy, size_t _NbElems, bool _BigEndian>
+        struct layout_field_io<std::array<_ElemTy,_NbElems>, _BigEndian, void>
+    {
+        typedef layout_field_io<_ElemTy, _BigEndian> io_t;
+        static const size_t Size = io_t::Size * _NbElems;
+
+        static inline void Read( ByteCursor & cur, std::array<_ElemTy,_NbElems> & dest )
+        {
+            for( auto & elem : dest )
+                io_t::Read(cur, elem);
+        }
+        static inline void Write( ByteWriter & wr, const std::array<_ElemTy,_NbElems> & src )
+        {
+            for( const auto & elem : src )
+                io_t::Write(wr, elem);
+        }
+    };
+
+    /*
+        LayoutField
+            A member of the structure, at the current position in the layout.
+            Use the UTILS_LAYOUT_FIELD/UTILS_LAYOUT_FIELD_BE macros to avoid repeating the member's type.
+    */
+    template<class _StructTy, class _FieldTy, _FieldTy _StructTy::* _PtrMember, bool _BigEndian = false>
+        struct LayoutField
+    {
+        typedef layout_field_io<_FieldTy, _BigEndian> io_t;
+        static const size_t Size = io_t::Size;
+
+        static inline void Read ( ByteCursor & cur, _StructTy & dest )      { io_t::Read ( cur, dest.*_PtrMember ); }
+        static inline void Write( ByteWriter & wr,  const _StructTy & src ) { io_t::Write( wr,  src.*_PtrMember  ); }
+    };
+
+    /*
+        LayoutPadding
+            Bytes that aren't stored in the structure. Skipped on read, and written as "_FillVal".
+    */
+    template<size_t _NbBytes, uint8_t _FillVal = 0>
+        struct LayoutPadding
+    {
+        static const size_t Size = _NbBytes;
+
+        template<class _StructTy> static inline void Read ( ByteCursor & cur, _StructTy & )      { cur.Skip(_NbBytes); }
+        template<class _StructTy> static inline void Write( ByteWriter & wr,  const _StructTy & ) { wr.Fill(_FillVal, _NbBytes); }
+    };
+
+#define UTILS_LAYOUT_FIELD(STRUCT, MEMBER)    utils::LayoutField<STRUCT, decltype(STRUCT::MEMBER), &STRUCT::MEMBER, false>
+#define UTILS_LAYOUT_FIELD_BE(STRUCT, MEMBER) utils::LayoutField<STRUCT, decltype(STRUCT::MEMBER), &STRUCT::MEMBER, true>
+#define UTILS_LAYOUT_PADDING(NBBYTES)         utils::LayoutPadding<NBBYTES>
+
+//======================================================================================================
+//  StructLayout
+//======================================================================================================
+    //Unrolls the field list at compile time, in order.
+    template<class... _Fields>
+        struct layout_fields;
+
+    template<>
+        struct layout_fields<>
+    {
+        static const size_t Size = 0;
+        template<class _StructTy> static inline void Read ( ByteCursor &, _StructTy & )      {}
+        template<class _StructTy> static inline void Write( ByteWriter &, const _StructTy & ) {}
+    };
+
+    template<class _First, class... _Rest>
+        struct layout_fields<_First, _Rest...>
+    {
+        static const size_t Size = _First::Size + layout_fields<_Rest...>::Size;
+
+        template<class _StructTy>
+            static inline void Read( ByteCursor & cur, _StructTy & dest )
+        {
+            _First::Read(cur, dest);
+            layout_fields<_Rest...>::Read(cur, dest);
+        }
+
+        template<class _StructTy>
+            static inline void Write( ByteWriter & wr, const _StructTy & src )
+        {
+            _First::Write(wr, src);
+            layout_fields<_Rest...>::Write(wr, src);
+        }
+    };
+
+    /*
+        StructLayout
+            The on-disk layout of "_StructTy", as the ordered list of its fields.
+            The Read/Write methods check the bounds once for the whole structure, or the whole array.
+    */
+    template<class _StructTy, class... _Fields>
+        struct StructLayout
+    {
+        typedef _StructTy                 struct_t;
+        typedef layout_fields<_Fields...> fields_t;
+        static const size_t Size = fields_t::Size;
+
+        static inline void ReadUnchecked ( ByteCursor & cur, _StructTy & dest )      { fields_t::Read (cur, dest); }
+        static inline void WriteUnchecked( ByteWriter & wr,  const _StructTy & src ) { fields_t::Write(wr,  src);  }
+
+        static inline void Read( ByteCursor & cur, _StructTy & dest )
+        {
+            cur.Require(Size);
+            ReadUnchecked(cur, dest);
+        }
+
+        static inline void Write( ByteWriter & wr, const _StructTy & src )
+        {
+            wr.Require(Size);
+            WriteUnchecked(wr, src);
+        }
+
+        static void ReadArray( ByteCursor & cur, _StructTy * pdest, size_t cnt )
+        {
+            cur.Require(Size * cnt);
+            for( size_t i = 0; i < cnt; ++i )
+                ReadUnchecked(cur, pdest[i]);
+        }
+
+        static void WriteArray( ByteWriter & wr, const _StructTy * psrc, size_t cnt )
+        {
+            wr.Require(Size * cnt);
+            for( size_t i = 0; i < cnt; ++i )
+                WriteUnchecked(wr, psrc[i]);
+        }
+
+        //Fills the whole vector.
+        static inline void ReadArray ( ByteCursor & cur, std::vector<_StructTy> & dest )     { ReadArray (cur, dest.data(), dest.size()); }
+        static inline void WriteArray( ByteWriter & wr,  const std::vector<_StructTy> & src ) { WriteArray(wr,  src.data(), src.size());  }
+    };
+
+//======================================================================================================
+//  Iterator Adapters
+//======================================================================================================
+    template<class _LayoutTy, class _init>
+        inline _init ReadArrayFromContainer_impl( typename _LayoutTy::struct_t * pdest, size_t cnt, _init itbeg, _init itend, std::true_type )
+    {
+        const size_t    len  = static_cast<size_t>( std::distance( itbeg, itend ) );
+        const uint8_t * pbeg = (len != 0)? &(*itbeg) : nullptr;
+        ByteCursor      cur( pbeg, pbeg + len );
+        _LayoutTy::ReadArray(cur, pdest, cnt);
+        std::advance( itbeg, cur.Tell() );
+        return itbeg;
+    }
+
+    template<class _LayoutTy, class _init>
+        inline _init ReadArrayFromContainer_impl( typename _LayoutTy::struct_t * pdest, size_t cnt, _init itbeg, _init itend, std::false_type )
+    {
+        std::vector<uint8_t> buf;
+        buf.reserve(_LayoutTy::Size * cnt);
+        for( ; buf.size() < (_LayoutTy::Size * cnt) && itbeg != itend; ++itbeg )
+            buf.push_back( static_cast<uint8_t>(*itbeg) );
+        ByteCursor cur( buf );
+        _LayoutTy::ReadArray(cur, pdest, cnt);
+        return itbeg;
+    }
+
+    /*
+        ReadArrayFromContainer
+            Reads all the entries of "dest" from the iterator range, using the "layout_t" of the entry type.
+            Throws if the range is too short for the whole array.
+            Returns the iterator past the last byte read.
+    */
+    template<class _StructTy, class _init>
+        inline _init ReadArrayFromContainer( std::vector<_StructTy> & dest, _init itbeg, _init itend )
+    {
+        typedef typename _StructTy::layout_t layout_t;
+        return ReadArrayFromContainer_impl<layout_t>( dest.data(), dest.size(), itbeg, itend, is_contiguous_byte_iterator<_init>() );
+    }
+
+    /*
+        WriteArrayToContainer
+            Writes all the entries of "src" to the output iterator, using the "layout_t" of the entry type.
+            Returns the iterator past the last byte written.
+    */
+    template<class _StructTy, class _outit>
+        inline _outit WriteArrayToContainer( const std::vector<_StructTy> & src, _outit itw )
+    {
+        typedef typename _StructTy::layout_t layout_t;
+        std::vector<uint8_t> buf( layout_t::Size * src.size() );
+        ByteWriter wr( buf.data(), buf.data() + buf.size() );
+        layout_t::WriteArray(wr, src);
+        return std::copy( buf.begin(), buf.end(), itw );
+    }
+};
+
+#endif
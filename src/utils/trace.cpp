@@ -0,0 +1,282 @@
+#include "trace.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdlib>
+using namespace std;
+
+namespace utils { namespace trace
+{
+    namespace
+    {
+        typedef std::chrono::steady_clock tclock_t;
+
+        struct traceevent_t
+        {
+            const char * name;
+            std::string  dynname;   //Only used when the name isn't a literal
+            char         phase;     //'X' for zones, 'C' for counters
+            int64_t      tsns;      //Nanoseconds since the session began
+            int64_t      durns;
+            int64_t      value;
+        };
+
+        /*
+            Events of a single thread. The lock is only contended while the session is being written.
+        */
+        struct threadbuffer_t
+        {
+            std::mutex                mtx;
+            uint32_t                  tid;
+            std::string               name;
+            std::vector<traceevent_t> events;
+        };
+
+        /*
+            TraceRegistry
+                Owns the buffers of all the threads that ever recorded something, so their events survive
+                the threads that recorded them.
+        */
+        class TraceRegistry
+        {
+        public:
+            static TraceRegistry & Instance()
+            {
+                static TraceRegistry reg;
+                return reg;
+            }
+
+            threadbuffer_t & ThreadBuffer()
+            {
+                thread_local threadbuffer_t * pbuf = nullptr;
+                if( !pbuf )
+                {
+                    std::lock_guard<std::mutex> lck(m_mtxbuffers);
+                    m_buffers.push_back( std::unique_ptr<threadbuffer_t>( new threadbuffer_t ) );
+                    pbuf      = m_buffers.back().get();
+                    pbuf->tid = static_cast<uint32_t>( m_buffers.size() );
+                }
+                return *pbuf;
+            }
+
+            inline bool    IsActive()const { return m_bactive.load( std::memory_order_acquire ); }
+            inline int64_t NowNs   ()const { return std::chrono::duration_cast<std::chrono::nanoseconds>( tclock_t::now() - m_epoch ).count(); }
+            inline int64_t ToNs( tclock_t::time_point tp )const { return std::chrono::duration_cast<std::chrono::nanoseconds>( tp - m_epoch ).count(); }
+
+            void Begin( const std::string & outpath )
+            {
+                std::lock_guard<std::mutex> lck(m_mtxsession);
+                if( IsActive() )
+                    return;
+                m_outpath = outpath;
+                m_epoch   = tclock_t::now();
+                m_bactive.store( true, std::memory_order_release );
+
+                if( !m_batexitset )
+                {
+                    std::atexit( &TraceRegistry::AtExit );
+                    m_batexitset = true;
+                }
+            }
+
+            void End()
+            {
+                std::lock_guard<std::mutex> lck(m_mtxsession);
+                if( !IsActive() )
+                    return;
+                m_bactive.store( false, std::memory_order_release );
+                WriteTraceFile();
+            }
+
+        private:
+            TraceRegistry()
+                :m_bactive(false), m_batexitset(false)
+            {}
+
+            static void AtExit()
+            {
+                try
+                {
+                    Instance().End();
+                }
+                catch( const std::exception & e )
+                {
+                    cerr <<"<!>- Couldn't write the trace file: " <<e.what() <<"\n";
+                }
+            }
+
+            static void WriteJSONString( std::ostream & out, const char * str )
+            {
+                out <<'"';
+                for( ; *str != 0; ++str )
+                {
+                    const char c = *str;
+                    if( c == '"' || c == '\\' )
+                        out <<'\\' <<c;
+                    else if( static_cast<unsigned char>(c) < 0x20 )
+                        out <<' ';
+                    else
+                        out <<c;
+                }
+                out <<'"';
+            }
+
+            void WriteTraceFile()
+            {
+                ofstream outf( m_outpath, ios::out | ios::trunc );
+                if( !outf.is_open() )
+                    throw std::runtime_error("TraceRegistry::WriteTraceFile(): Couldn't open trace file \"" + m_outpath + "\" for writing!");
+
+                outf <<"{\"traceEvents\":[\n" <<std::fixed <<std::setprecision(3);
+                size_t nbevents = 0;
+                bool   bfirst   = true;
+
+                std::lock_guard<std::mutex> lck(m_mtxbuffers);
+                for( auto & pbuf : m_buffers )
+                {
+                    std::lock_guard<std::mutex> lckbuf(pbuf->mtx);
+                    if( !pbuf->name.empty() )
+                    {
+                        outf <<(bfirst? "" : ",\n") <<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" <<pbuf->tid <<",\"args\":{\"name\":";
+                        WriteJSONString( outf, pbuf->name.c_str() );
+                        outf <<"}}";
+                        bfirst = false;
+                    }
+
+                    for( const auto & ev : pbuf->events )
+                    {
+                        const char * pname = ev.dynname.empty()? ev.name : ev.dynname.c_str();
+                        outf <<(bfirst? "" : ",\n") <<"{\"name\":";
+                        WriteJSONString( outf, pname );
+                        outf <<",\"ph\":\"" <<ev.phase <<"\",\"pid\":1,\"tid\":" <<pbuf->tid <<",\"ts\":" <<(ev.tsns / 1000.0);
+                        if( ev.phase == 'X' )
+                            outf <<",\"dur\":" <<(ev.durns / 1000.0);
+                        else
+                            outf <<",\"args\":{\"value\":" <<ev.value <<"}";
+                        outf <<"}";
+                        bfirst = false;
+                    }
+                    nbevents += pbuf->events.size();
+                    pbuf->events.clear();
+                    pbuf->events.shrink_to_fit();
+                }
+                outf <<"\n],\n\"displayTimeUnit\":\"ms\"}\n";
+                outf.close();
+
+                if( outf.fail() )
+                    throw std::runtime_error("TraceRegistry::WriteTraceFile(): Couldn't write trace file \"" + m_outpath + "\"!");
+                cout <<"<*>-Wrote " <<nbevents <<" trace events to \"" <<m_outpath <<"\"!\n";
+            }
+
+        private:
+            std::atomic<bool>                             m_bactive;
+            bool                                          m_batexitset;
+            tclock_t::time_point                          m_epoch;
+            std::string                                   m_outpath;
+            std::mutex                                    m_mtxsession;
+            std::mutex                                    m_mtxbuffers;
+            std::vector<std::unique_ptr<threadbuffer_t>>  m_buffers;
+        };
+
+        inline void PushEvent( traceevent_t && ev )
+        {
+            threadbuffer_t & buf = TraceRegistry::Instance().ThreadBuffer();
+            std::lock_guard<std::mutex> lck(buf.mtx);
+            buf.events.push_back( std::move(ev) );
+        }
+    };
+
+//==========================================================================================================
+//  Session
+//==========================================================================================================
+    void BeginSession( const std::string & outpath )
+    {
+        TraceRegistry & reg = TraceRegistry::Instance();
+        reg.Begin(outpath);
+
+        //Name the thread starting the session, if it wasn't already
+        threadbuffer_t & buf = reg.ThreadBuffer();
+        std::lock_guard<std::mutex> lck(buf.mtx);
+        if( buf.name.empty() )
+            buf.name = "main";
+    }
+
+    void EndSession()
+    {
+        TraceRegistry::Instance().End();
+    }
+
+    bool IsSessionActive()
+    {
+        return TraceRegistry::Instance().IsActive();
+    }
+
+//==========================================================================================================
+//  Events
+//==========================================================================================================
+    void SetThreadName( const std::string & name )
+    {
+        threadbuffer_t & buf = TraceRegistry::Instance().ThreadBuffer();
+        std::lock_guard<std::mutex> lck(buf.mtx);
+        buf.name = name;
+    }
+
+    void AddCounter( const char * name, int64_t value )
+    {
+        TraceRegistry & reg = TraceRegistry::Instance();
+        if( !reg.IsActive() )
+            return;
+
+        traceevent_t ev;
+        ev.name  = name;
+        ev.phase = 'C';
+        ev.tsns  = reg.NowNs();
+        ev.durns = 0;
+        ev.value = value;
+        PushEvent( std::move(ev) );
+    }
+
+//==========================================================================================================
+//  ScopedZone
+//==========================================================================================================
+    ScopedZone::ScopedZone( const char * name )
+        :m_name( (name != nullptr)? name : "" ), m_bactive( IsSessionActive() )
+    {
+        if( m_bactive )
+            m_start = tclock_t::now();
+    }
+
+    ScopedZone::ScopedZone( const std::string & name )
+        :m_name(""), m_bactive( IsSessionActive() )
+    {
+        if( m_bactive )
+        {
+            m_dynname = name;
+            m_start   = tclock_t::now();
+        }
+    }
+
+    ScopedZone::~ScopedZone()
+    {
+        TraceRegistry & reg = TraceRegistry::Instance();
+        //Zones still open when the session ended are dropped
+        if( !m_bactive || !reg.IsActive() )
+            return;
+
+        const tclock_t::time_point end = tclock_t::now();
+        traceevent_t ev;
+        ev.name    = m_name;
+        ev.dynname = std::move(m_dynname);
+        ev.phase   = 'X';
+        ev.tsns    = reg.ToNs(m_start);
+        ev.durns   = std::chrono::duration_cast<std::chrono::nanoseconds>( end - m_start ).count();
+        ev.value   = 0;
+        PushEvent( std::move(ev) );
+    }
+
+};};
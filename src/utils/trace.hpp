@@ -0,0 +1,103 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+/*
+trace.hpp
+2016/10/28
+psycommando@gmail.com
+Description:
+    Lightweight tracing of where the time goes, for profiling full runs of the tools without a profiler.
+    Code is instrumented with scoped zones, counters and thread names, which are recorded in per-thread buffers
+    while a trace session is active, and written out as a Chrome trace event JSON file when the session ends.
+    The files can be opened in chrome://tracing, or any other viewer supporting the format.
+
+    The instrumentation macros only expand to something when USE_PPMDU_TRACING is defined. (See vcprojects/tracing.props)
+    Without it, they compile to nothing, and the "-trace" option of the tools only records the spans timed with ChronoRAII.
+
+    Ex:
+        void CompressAFile()
+        {
+            UTILS_TRACE_ZONE("CompressAFile");
+            ...
+            UTILS_TRACE_COUNTER("BytesCompressed", compressedlen);
+        }
+*/
+#include <cstdint>
+#include <string>
+#include <chrono>
+
+namespace utils { namespace trace
+{
+//==========================================================================================================
+//  Session
+//==========================================================================================================
+    /*
+        BeginSession
+            Starts recording events. They'll be written to "outpath" when EndSession is called, or when the program exits.
+            Does nothing if a session is already active.
+    */
+    void BeginSession( const std::string & outpath );
+
+    /*
+        EndSession
+            Stops recording events, and writes the trace file. Does nothing if no session is active.
+            Throws if the file can't be written.
+    */
+    void EndSession();
+
+    bool IsSessionActive();
+
+//==========================================================================================================
+//  Events
+//==========================================================================================================
+    /*
+        SetThreadName
+            Names the calling thread in the trace.
+    */
+    void SetThreadName( const std::string & name );
+
+    /*
+        AddCounter
+            Records the value of a counter at the current time. "name" must be a string literal.
+    */
+    void AddCounter( const char * name, int64_t value );
+
+    /*
+        ScopedZone
+            Records the time spent between its construction and destruction, on the calling thread.
+            The "const char*" names must be string literals, they're stored as-is.
+    */
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone( const char * name );
+        explicit ScopedZone( const std::string & name );
+        ~ScopedZone();
+
+    private:
+        ScopedZone( const ScopedZone & )            = delete;
+        ScopedZone & operator=( const ScopedZone & ) = delete;
+
+        const char                            * m_name;
+        std::string                             m_dynname;
+        bool                                    m_bactive;
+        std::chrono::steady_clock::time_point   m_start;
+    };
+
+};};
+
+//==========================================================================================================
+//  Instrumentation Macros
+//==========================================================================================================
+#ifdef USE_PPMDU_TRACING
+    #define UTILS_TRACE_CONCAT_IMPL(A, B)   A##B
+    #define UTILS_TRACE_CONCAT(A, B)        UTILS_TRACE_CONCAT_IMPL(A, B)
+    #define UTILS_TRACE_ZONE(NAME)          ::utils::trace::ScopedZone UTILS_TRACE_CONCAT(_tracezone_, __LINE__)(NAME)
+    #define UTILS_TRACE_COUNTER(NAME, VAL)  ::utils::trace::AddCounter( NAME, static_cast<int64_t>(VAL) )
+    #define UTILS_TRACE_THREAD_NAME(NAME)   ::utils::trace::SetThreadName(NAME)
+#else
+    #define UTILS_TRACE_ZONE(NAME)
+    #define UTILS_TRACE_COUNTER(NAME, VAL)
+    #define UTILS_TRACE_THREAD_NAME(NAME)
+#endif
+
+#endif
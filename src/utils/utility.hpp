@@ -11,6 +11,7 @@ Description: A header with a bunch of useful includes for the PPMD utilities.
 #include "gstringutils.hpp"
 #include "gbyteutils.hpp"
 #include "poco_wrapper.hpp"
+#include "trace.hpp"
 #include <chrono>
 #include <string>
 #include <iosfwd>
@@ -79,7 +80,7 @@ namespace utils
         typedef TimescaleT timescale_t;
 
         ChronoRAII( const std::string & name = "*", std::ostream * messageoutput = nullptr )
-            :_name(name)
+            :_name(name), _zone(name)
         {
             _start  = std::chrono::steady_clock::now();
 
@@ -109,6 +110,7 @@ namespace utils
         std::chrono::steady_clock::time_point  _start;
         std::string                            _name;
         std::ostream                         * _output;
+        trace::ScopedZone                      _zone;   //Also shows up in the trace, when a trace session is active
     };
 
     //Default chrono
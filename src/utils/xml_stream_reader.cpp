@@ -0,0 +1,450 @@
+#include "xml_stream_reader.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+using namespace std;
+
+namespace utils
+{
+    namespace
+    {
+        inline bool IsXMLWhitespace( char c )
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        //Appends a unicode code point as UTF-8
+        void AppendUTF8( uint32_t cp, std::string & out )
+        {
+            if( cp < 0x80 )
+                out.push_back( static_cast<char>(cp) );
+            else if( cp < 0x800 )
+            {
+                out.push_back( static_cast<char>( 0xC0 | (cp >> 6) ) );
+                out.push_back( static_cast<char>( 0x80 | (cp & 0x3F) ) );
+            }
+            else if( cp < 0x10000 )
+            {
+                out.push_back( static_cast<char>( 0xE0 | (cp >> 12) ) );
+                out.push_back( static_cast<char>( 0x80 | ((cp >> 6) & 0x3F) ) );
+                out.push_back( static_cast<char>( 0x80 | (cp & 0x3F) ) );
+            }
+            else
+            {
+                out.push_back( static_cast<char>( 0xF0 | (cp >> 18) ) );
+                out.push_back( static_cast<char>( 0x80 | ((cp >> 12) & 0x3F) ) );
+                out.push_back( static_cast<char>( 0x80 | ((cp >> 6) & 0x3F) ) );
+                out.push_back( static_cast<char>( 0x80 | (cp & 0x3F) ) );
+            }
+        }
+    };
+
+//======================================================================================================================================
+//  XMLStreamReader
+//======================================================================================================================================
+    XMLStreamReader::XMLStreamReader()
+        :m_pos(0), m_tagbeg(0), m_tagend(0), m_curtoken(eToken::EndOfDocument), m_curname(nullptr),
+         m_bcurisempty(false), m_bpendingend(false), m_bdone(true)
+    {}
+
+    void XMLStreamReader::LoadFile( const std::string & fpath )
+    {
+        ifstream inf( fpath, ios::in | ios::binary | ios::ate );
+        if( !inf.is_open() )
+            throw std::runtime_error("XMLStreamReader::LoadFile(): Couldn't open file \"" + fpath + "\"!");
+
+        const streamoff flen = inf.tellg();
+        if( flen < 0 || !inf.seekg(0, ios::beg) )
+            throw std::runtime_error("XMLStreamReader::LoadFile(): Couldn't read file \"" + fpath + "\"!");
+
+        vector<char> text( static_cast<size_t>(flen) );
+        if( flen > 0 && !inf.read( text.data(), flen ) )
+            throw std::runtime_error("XMLStreamReader::LoadFile(): Couldn't read file \"" + fpath + "\"!");
+        LoadText( std::move(text) );
+    }
+
+    void XMLStreamReader::LoadText( std::vector<char> && text )
+    {
+        m_text        = std::move(text);
+        m_pos         = 0;
+        m_tagbeg      = 0;
+        m_tagend      = 0;
+        m_curtoken    = eToken::EndOfDocument;
+        m_curname     = nullptr;
+        m_bcurisempty = false;
+        m_bpendingend = false;
+        m_bdone       = false;
+        m_stack.clear();
+        m_attributes.clear();
+
+        if( m_text.size() >= 2 && ( (m_text[0] == '\xFF' && m_text[1] == '\xFE') || (m_text[0] == '\xFE' && m_text[1] == '\xFF') ) )
+            ThrowError( "XMLStreamReader::LoadText(): UTF-16 text isn't supported!", 0 );
+        if( m_text.size() >= 3 && m_text[0] == '\xEF' && m_text[1] == '\xBB' && m_text[2] == '\xBF' )
+            m_pos = 3; //Skip the UTF-8 BOM
+    }
+
+    XMLStreamReader::eToken XMLStreamReader::Next()
+    {
+        NextInternal(true);
+        return m_curtoken;
+    }
+
+    void XMLStreamReader::SkipElement()
+    {
+        if( m_curtoken != eToken::StartElement )
+            return;
+        const size_t depth = Depth();
+        //Attributes of the skipped elements aren't kept
+        while( NextInternal(false) )
+        {
+            if( m_curtoken == eToken::EndElement && Depth() == depth )
+                return;
+        }
+    }
+
+    const std::string & XMLStreamReader::ReadElementText()
+    {
+        if( m_curtoken != eToken::StartElement )
+            ThrowError( "XMLStreamReader::ReadElementText(): Not on a start tag!", m_tagbeg );
+        const size_t beg = m_tagbeg;
+        SkipElement();
+        m_elemtext.assign( m_text.data() + beg, m_text.data() + m_tagend );
+        return m_elemtext;
+    }
+
+    const std::string & XMLStreamReader::StartTagAsEmptyElement()
+    {
+        if( m_curtoken != eToken::StartElement )
+            ThrowError( "XMLStreamReader::StartTagAsEmptyElement(): Not on a start tag!", m_tagbeg );
+        if( m_bcurisempty )
+            m_elemtext.assign( m_text.data() + m_tagbeg, m_text.data() + m_tagend );
+        else
+        {
+            //Replace the closing '>' with "/>"
+            m_elemtext.assign( m_text.data() + m_tagbeg, m_text.data() + m_tagend - 1 );
+            m_elemtext.append("/>");
+        }
+        return m_elemtext;
+    }
+
+    const std::string * XMLStreamReader::Attribute( name_t name )const
+    {
+        for( const auto & attr : m_attributes )
+        {
+            if( attr.name == name )
+                return &attr.value;
+        }
+        return nullptr;
+    }
+
+    const std::string * XMLStreamReader::Attribute( const std::string & name )
+    {
+        return Attribute( Intern(name) );
+    }
+
+    XMLStreamReader::name_t XMLStreamReader::Intern( const std::string & name )
+    {
+        return &(*m_names.insert(name).first);
+    }
+
+    XMLStreamReader::name_t XMLStreamReader::Intern( const char * beg, const char * end )
+    {
+        //Look the name up through a reused string, so known names don't allocate anything
+        m_scratchname.assign( beg, end );
+        auto itfound = m_names.find(m_scratchname);
+        if( itfound != m_names.end() )
+            return &(*itfound);
+        return &(*m_names.insert(m_scratchname).first);
+    }
+
+    bool XMLStreamReader::NextInternal( bool bkeepattributes )
+    {
+        //Close the self-closing element we just returned
+        if( m_bpendingend )
+        {
+            m_bpendingend = false;
+            m_curname     = m_stack.back();
+            m_curtoken    = eToken::EndElement;
+            m_attributes.clear();
+            m_stack.pop_back();
+            if( m_stack.empty() )
+                m_bdone = true;
+            return true;
+        }
+
+        if( m_bdone )
+        {
+            m_curtoken = eToken::EndOfDocument;
+            return false;
+        }
+
+        const size_t len = m_text.size();
+        while( m_pos < len )
+        {
+            const char * pfound = static_cast<const char*>( memchr( m_text.data() + m_pos, '<', len - m_pos ) );
+            if( !pfound )
+                break;
+            const size_t tagpos = static_cast<size_t>( pfound - m_text.data() );
+            const char   next   = (tagpos + 1 < len)? m_text[tagpos + 1] : '\0';
+
+            if( next == '?' )
+                m_pos = SkipPast( tagpos + 2, "?>", 2, "processing instruction" );
+            else if( next == '!' )
+            {
+                const char * ptag = m_text.data() + tagpos;
+                if( len - tagpos >= 4 && strncmp( ptag, "<!--", 4 ) == 0 )
+                    m_pos = SkipPast( tagpos + 4, "-->", 3, "comment" );
+                else if( len - tagpos >= 9 && strncmp( ptag, "<![CDATA[", 9 ) == 0 )
+                    m_pos = SkipPast( tagpos + 9, "]]>", 3, "CDATA section" );
+                else
+                    m_pos = SkipDoctype( tagpos + 2 );
+            }
+            else
+            {
+                m_tagbeg = tagpos;
+                if( next == '/' )
+                    ReadEndTag();
+                else
+                    ReadStartTag(bkeepattributes);
+                return true;
+            }
+        }
+
+        if( !m_stack.empty() )
+            ThrowError( "XMLStreamReader::Next(): Reached the end of the text before the end of element \"" + *m_stack.back() + "\"!", len );
+        m_pos      = len;
+        m_bdone    = true;
+        m_curtoken = eToken::EndOfDocument;
+        return false;
+    }
+
+    void XMLStreamReader::ReadStartTag( bool bkeepattributes )
+    {
+        const size_t len  = m_text.size();
+        const char * ptxt = m_text.data();
+        size_t       i    = m_tagbeg + 1;
+
+        const size_t namebeg = i;
+        while( i < len && !IsXMLWhitespace(ptxt[i]) && ptxt[i] != '/' && ptxt[i] != '>' )
+            ++i;
+        if( i == namebeg )
+            ThrowError( "XMLStreamReader::Next(): Found a start tag with no name!", m_tagbeg );
+        m_curname = Intern( ptxt + namebeg, ptxt + i );
+        m_attributes.clear();
+
+        bool bisempty = false;
+        for(;;)
+        {
+            while( i < len && IsXMLWhitespace(ptxt[i]) )
+                ++i;
+            if( i >= len )
+                ThrowError( "XMLStreamReader::Next(): Reached the end of the text within the start tag of \"" + *m_curname + "\"!", m_tagbeg );
+
+            if( ptxt[i] == '>' )
+            {
+                ++i;
+                break;
+            }
+            else if( ptxt[i] == '/' )
+            {
+                if( i + 1 >= len || ptxt[i + 1] != '>' )
+                    ThrowError( "XMLStreamReader::Next(): Expected \"/>\" in the start tag of \"" + *m_curname + "\"!", i );
+                i += 2;
+                bisempty = true;
+                break;
+            }
+
+            //Attribute name
+            const size_t attrnamebeg = i;
+            while( i < len && !IsXMLWhitespace(ptxt[i]) && ptxt[i] != '=' && ptxt[i] != '>' && ptxt[i] != '/' )
+                ++i;
+            const size_t attrnameend = i;
+            while( i < len && IsXMLWhitespace(ptxt[i]) )
+                ++i;
+            if( attrnameend == attrnamebeg || i >= len || ptxt[i] != '=' )
+                ThrowError( "XMLStreamReader::Next(): Malformed attribute in the start tag of \"" + *m_curname + "\"!", attrnamebeg );
+            ++i;
+            while( i < len && IsXMLWhitespace(ptxt[i]) )
+                ++i;
+
+            //Attribute value
+            if( i >= len || (ptxt[i] != '"' && ptxt[i] != '\'') )
+                ThrowError( "XMLStreamReader::Next(): Attribute value isn't quoted in the start tag of \"" + *m_curname + "\"!", i );
+            const char   quote  = ptxt[i];
+            const size_t valbeg = ++i;
+            const char * pvalend = static_cast<const char*>( memchr( ptxt + valbeg, quote, len - valbeg ) );
+            if( !pvalend )
+                ThrowError( "XMLStreamReader::Next(): Attribute value isn't closed in the start tag of \"" + *m_curname + "\"!", valbeg );
+            i = static_cast<size_t>( pvalend - ptxt ) + 1;
+
+            if( bkeepattributes )
+            {
+                m_attributes.push_back( attribute_t{ Intern( ptxt + attrnamebeg, ptxt + attrnameend ), std::string() } );
+                DecodeAttrValue( ptxt + valbeg, pvalend, m_attributes.back().value );
+            }
+        }
+
+        m_tagend      = i;
+        m_pos         = i;
+        m_curtoken    = eToken::StartElement;
+        m_bcurisempty = bisempty;
+        m_bpendingend = bisempty;
+        m_stack.push_back(m_curname);
+    }
+
+    void XMLStreamReader::ReadEndTag()
+    {
+        const size_t len  = m_text.size();
+        const char * ptxt = m_text.data();
+        size_t       i    = m_tagbeg + 2;
+
+        const size_t namebeg = i;
+        while( i < len && !IsXMLWhitespace(ptxt[i]) && ptxt[i] != '>' )
+            ++i;
+        const size_t nameend = i;
+        while( i < len && IsXMLWhitespace(ptxt[i]) )
+            ++i;
+        if( nameend == namebeg || i >= len || ptxt[i] != '>' )
+            ThrowError( "XMLStreamReader::Next(): Malformed end tag!", m_tagbeg );
+
+        name_t name = Intern( ptxt + namebeg, ptxt + nameend );
+        if( m_stack.empty() || m_stack.back() != name )
+        {
+            stringstream sstr;
+            sstr << "XMLStreamReader::Next(): End tag \"" <<*name <<"\" doesn't match ";
+            if( m_stack.empty() )
+                sstr << "any open element!";
+            else
+                sstr << "the open element \"" <<*m_stack.back() <<"\"!";
+            ThrowError( sstr.str(), m_tagbeg );
+        }
+
+        m_stack.pop_back();
+        m_attributes.clear();
+        m_curname     = name;
+        m_curtoken    = eToken::EndElement;
+        m_bcurisempty = false;
+        m_tagend      = i + 1;
+        m_pos         = m_tagend;
+        if( m_stack.empty() )
+            m_bdone = true;
+    }
+
+    size_t XMLStreamReader::SkipPast( size_t from, const char * pattern, size_t patternlen, const char * what )
+    {
+        const size_t len = m_text.size();
+        for( size_t i = from; i + patternlen <= len; ++i )
+        {
+            if( m_text[i] == pattern[0] && memcmp( m_text.data() + i, pattern, patternlen ) == 0 )
+                return i + patternlen;
+        }
+        ThrowError( std::string("XMLStreamReader::Next(): Reached the end of the text within a ") + what + "!", from );
+    }
+
+    size_t XMLStreamReader::SkipDoctype( size_t from )
+    {
+        //Doctypes may have an internal subset between brackets, which contains '>' characters
+        const size_t len     = m_text.size();
+        size_t       nbopen  = 0;
+        char         inquote = '\0';
+        for( size_t i = from; i < len; ++i )
+        {
+            const char c = m_text[i];
+            if( inquote != '\0' )
+            {
+                if( c == inquote )
+                    inquote = '\0';
+            }
+            else if( c == '"' || c == '\'' )
+                inquote = c;
+            else if( c == '[' )
+                ++nbopen;
+            else if( c == ']' && nbopen != 0 )
+                --nbopen;
+            else if( c == '>' && nbopen == 0 )
+                return i + 1;
+        }
+        ThrowError( "XMLStreamReader::Next(): Reached the end of the text within a doctype!", from );
+    }
+
+    /*
+        Expands the character and entity references, and turns whitespace characters into spaces, like pugixml does by default.
+    */
+    size_t XMLStreamReader::DecodeReference( const char * pref, const char * end, std::string & out_value )
+    {
+        const char * psemi = static_cast<const char*>( memchr( pref, ';', static_cast<size_t>(end - pref) ) );
+        if( !psemi )
+            return 0;
+        const size_t reflen = static_cast<size_t>(psemi - pref);
+
+        if( reflen >= 2 && pref[0] == '#' )
+        {
+            uint32_t cp     = 0;
+            bool     bvalid = true;
+            if( pref[1] == 'x' )
+            {
+                bvalid = reflen > 2;
+                for( const char * pd = pref + 2; pd != psemi && bvalid; ++pd )
+                {
+                    if( *pd >= '0' && *pd <= '9' )      cp = (cp << 4) | static_cast<uint32_t>(*pd - '0');
+                    else if( *pd >= 'a' && *pd <= 'f' ) cp = (cp << 4) | static_cast<uint32_t>(*pd - 'a' + 10);
+                    else if( *pd >= 'A' && *pd <= 'F' ) cp = (cp << 4) | static_cast<uint32_t>(*pd - 'A' + 10);
+                    else                                bvalid = false;
+                }
+            }
+            else
+            {
+                for( const char * pd = pref + 1; pd != psemi && bvalid; ++pd )
+                {
+                    if( *pd >= '0' && *pd <= '9' ) cp = (cp * 10) + static_cast<uint32_t>(*pd - '0');
+                    else                           bvalid = false;
+                }
+            }
+            if( !bvalid )
+                return 0;
+            AppendUTF8( cp, out_value );
+        }
+        else if( reflen == 2 && strncmp( pref, "lt",   2 ) == 0 ) out_value.push_back('<');
+        else if( reflen == 2 && strncmp( pref, "gt",   2 ) == 0 ) out_value.push_back('>');
+        else if( reflen == 3 && strncmp( pref, "amp",  3 ) == 0 ) out_value.push_back('&');
+        else if( reflen == 4 && strncmp( pref, "quot", 4 ) == 0 ) out_value.push_back('"');
+        else if( reflen == 4 && strncmp( pref, "apos", 4 ) == 0 ) out_value.push_back('\'');
+        else
+            return 0;
+        return reflen + 1; //Include the ';'
+    }
+
+    void XMLStreamReader::DecodeAttrValue( const char * beg, const char * end, std::string & out_value )
+    {
+        out_value.clear();
+        out_value.reserve( static_cast<size_t>(end - beg) );
+        for( const char * p = beg; p != end; ++p )
+        {
+            const char c = *p;
+            if( c == '&' )
+            {
+                //Like pugixml, anything that isn't a valid reference is kept as-is, starting with the '&'
+                const size_t reflen = DecodeReference( p + 1, end, out_value );
+                if( reflen == 0 )
+                    out_value.push_back(c);
+                else
+                    p += reflen;
+            }
+            else if( c == '\r' )
+            {
+                out_value.push_back(' ');
+                if( p + 1 != end && p[1] == '\n' )
+                    ++p;
+            }
+            else if( c == '\n' || c == '\t' )
+                out_value.push_back(' ');
+            else
+                out_value.push_back(c);
+        }
+    }
+
+    void XMLStreamReader::ThrowError( const std::string & msg, size_t offset )const
+    {
+        throw XMLStreamError( msg, offset );
+    }
+};
@@ -0,0 +1,179 @@
+#ifndef XML_STREAM_READER_HPP
+#define XML_STREAM_READER_HPP
+/*
+xml_stream_reader.hpp
+2016/10/29
+psycommando@gmail.com
+Description:
+    A forward only XML tokenizer, for reading large XML files in a single pass without building a whole document tree.
+    It only reports the start and end of elements, along with their attributes. Text, comments, CDATA, processing
+    instructions and doctypes are skipped. Elements that need more than that can be copied out as a piece of text
+    and loaded on their own, one at a time.
+
+    Only handles UTF-8 text.
+*/
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <stdexcept>
+
+namespace utils
+{
+//======================================================================================================================================
+//  XMLStreamError
+//======================================================================================================================================
+    /*
+        XMLStreamError
+            Thrown when the XML text is malformed. Keeps the offset in the text where the error was found.
+    */
+    class XMLStreamError : public std::runtime_error
+    {
+    public:
+        XMLStreamError( const std::string & msg, size_t offset )
+            :std::runtime_error(msg), m_offset(offset)
+        {}
+
+        inline size_t Offset()const { return m_offset; }
+
+    private:
+        size_t m_offset;
+    };
+
+//======================================================================================================================================
+//  XMLStreamReader
+//======================================================================================================================================
+    /*
+        XMLStreamReader
+            Steps through the elements of a XML text, one tag at a time.
+
+            Element and attribute names are interned. Each distinct name is stored once for the lifetime of the reader,
+            and is represented by a pointer to that single copy. So names can be compared by pointer, once the names
+            to look for were interned with Intern().
+
+            Ex:
+                XMLStreamReader reader;
+                reader.LoadFile(path);
+                const XMLStreamReader::name_t pitem = reader.Intern("Item");
+                while( reader.Next() == XMLStreamReader::eToken::StartElement )
+                {
+                    if( reader.Name() == pitem )
+                        ...
+                    reader.SkipElement();
+                }
+    */
+    class XMLStreamReader
+    {
+    public:
+        typedef const std::string * name_t;
+
+        enum struct eToken
+        {
+            StartElement,
+            EndElement,
+            EndOfDocument,
+        };
+
+        struct attribute_t
+        {
+            name_t      name;
+            std::string value;
+        };
+
+        XMLStreamReader();
+
+        /*
+            LoadFile / LoadText
+                Replaces the text to read, and goes back to its beginning. Throws if the file can't be read.
+        */
+        void LoadFile( const std::string & fpath );
+        void LoadText( std::vector<char> && text );
+
+        /*
+            Next
+                Moves to the next start tag or end tag. A self-closing element returns a StartElement, followed
+                by an EndElement on the next call.
+                Returns EndOfDocument once the root element was closed, or the text ends.
+                Throws XMLStreamError if the markup is malformed.
+        */
+        eToken Next();
+
+        /*
+            SkipElement
+                When on a StartElement, moves past the matching end tag. Afterwards, the reader is on the EndElement
+                of the skipped element.
+        */
+        void SkipElement();
+
+        /*
+            ReadElementText
+                When on a StartElement, returns the text of the whole element, from its start tag to its end tag included,
+                and moves past it like SkipElement does.
+                The text stays valid until the next call to ReadElementText, StartTagAsEmptyElement, LoadFile or LoadText.
+        */
+        const std::string & ReadElementText();
+
+        /*
+            StartTagAsEmptyElement
+                When on a StartElement, returns the text of the start tag alone, turned into a self-closing element.
+                Handy for loading only the attributes of a large element. The text has the same length as the tag
+                it comes from, or one more character. Same lifetime as the text returned by ReadElementText.
+        */
+        const std::string & StartTagAsEmptyElement();
+
+        //Name of the current element, for both start and end tags.
+        inline name_t                           Name()const         { return m_curname; }
+        //Offset in the text of the '<' of the current tag.
+        inline size_t                           Offset()const       { return m_tagbeg; }
+        //Nb of elements the current element is nested in. The root element is at depth 0.
+        inline size_t                           Depth()const        { return m_stack.size() - ((m_curtoken == eToken::StartElement)? 1 : 0); }
+        inline eToken                           Token()const        { return m_curtoken; }
+        inline const std::vector<attribute_t> & Attributes()const   { return m_attributes; }
+
+        /*
+            Attribute
+                Returns the value of the attribute of the current start tag with that name, or null if there are none.
+                Values are decoded the same way pugixml does it. References that aren't valid, like a lone '&',
+                are kept as-is.
+        */
+        const std::string * Attribute( name_t name )const;
+        const std::string * Attribute( const std::string & name );
+
+        /*
+            Intern
+                Returns the unique pointer representing that name.
+        */
+        name_t Intern( const std::string & name );
+
+    private:
+        name_t Intern( const char * beg, const char * end );
+
+        void   ReadStartTag( bool bkeepattributes );
+        void   ReadEndTag();
+        size_t SkipPast( size_t from, const char * pattern, size_t patternlen, const char * what );
+        size_t SkipDoctype( size_t from );
+        bool   NextInternal( bool bkeepattributes );
+
+        void   DecodeAttrValue( const char * beg, const char * end, std::string & out_value );
+        size_t DecodeReference( const char * pref, const char * end, std::string & out_value );
+        [[noreturn]] void ThrowError( const std::string & msg, size_t offset )const;
+
+    private:
+        std::vector<char>               m_text;
+        size_t                          m_pos;
+        size_t                          m_tagbeg;
+        size_t                          m_tagend;           //Offset past the '>' of the current tag
+        eToken                          m_curtoken;
+        name_t                          m_curname;
+        bool                            m_bcurisempty;      //Whether the current start tag is self-closing
+        bool                            m_bpendingend;      //Whether the next token is the end of a self-closing element
+        bool                            m_bdone;
+        std::vector<name_t>             m_stack;
+        std::vector<attribute_t>        m_attributes;
+        std::unordered_set<std::string> m_names;
+        std::string                     m_scratchname;
+        std::string                     m_elemtext;
+    };
+};
+
+#endif